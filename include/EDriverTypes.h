@@ -36,6 +36,12 @@ enum E_DRIVER_TYPE
 
 	EDT_OPENGL3,
 
+	//! Software driver, rasterizes on the CPU without a window
+	/** Renders 3d triangles and 2d images into a memory buffer which can
+	be read with IVideoDriver::createScreenShot(). Useful for headless
+	rendering and image tests on machines without a GPU. */
+	EDT_SOFTWARE,
+
 	//! No driver, just for counting the elements
 	EDT_COUNT
 };
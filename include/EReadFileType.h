@@ -23,6 +23,12 @@ enum EREAD_FILE_TYPE
 	//! CLimitReadFile
 	ERFT_LIMIT_READ_FILE = MAKE_IRR_ID('r', 'l', 'i', 'm'),
 
+	//! CMappedReadFile, implements IMemoryReadFile
+	ERFT_MAPPED_READ_FILE = MAKE_IRR_ID('r', 'm', 'a', 'p'),
+
+	//! CInflateReadFile
+	ERFT_INFLATE_READ_FILE = MAKE_IRR_ID('r', 'i', 'n', 'f'),
+
 	//! Unknown type
 	EFIT_UNKNOWN = MAKE_IRR_ID('u', 'n', 'k', 'n')
 };
@@ -6,6 +6,8 @@
 
 #include "IReferenceCounted.h"
 #include "IFileArchive.h"
+#include "SPrefetchStats.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -259,6 +261,27 @@ public:
 	/** \param filename is the string identifying the file which should be tested for existence.
 	\return True if file exists, and false if it does not exist or an error occurred. */
 	virtual bool existFile(const path &filename) const = 0;
+
+	//! Reads files in the background, so opening them later is faster
+	/** The files are looked up right away, reading and decompressing them
+	happens on worker threads. A later createAndOpenFile() call for one of
+	the files returns the prefetched content, waiting for it if necessary.
+	A prefetched file is handed out once, then it is removed from the cache.
+	Files which are not found or don't fit into the budget are skipped.
+	Adding, removing or moving archives drops all prefetched files.
+	\param filenames Files to prefetch, named like for createAndOpenFile().
+	\return Number of files queued for prefetching. */
+	virtual u32 prefetchFiles(const core::array<path> &filenames) = 0;
+
+	//! Sets how many bytes the prefetched files may occupy at once
+	/** 64 MB by default. Doesn't affect files which are already cached. */
+	virtual void setPrefetchBudget(u64 bytes) = 0;
+
+	//! Drops all prefetched files which were not opened yet
+	virtual void clearPrefetchCache() = 0;
+
+	//! Returns counters of the prefetch cache
+	virtual const SPrefetchStats &getPrefetchStats() const = 0;
 };
 
 } // end namespace io
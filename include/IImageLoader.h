@@ -19,6 +19,22 @@ class IReadFile;
 namespace video
 {
 
+//! Provides the memory an image loader decodes rows into
+/** See IImageLoader::loadImageRows(). */
+class IImageRowTarget
+{
+public:
+	virtual ~IImageRowTarget() {}
+
+	//! Called once the size of the image is known, before any row is decoded
+	/** \param size Size of the image.
+	\param format Format the rows are decoded in.
+	\param pitch Receives the distance between the starts of two rows in
+	bytes.
+	\return Memory for the first row, or 0 to cancel decoding. */
+	virtual void *getRows(const core::dimension2du &size, ECOLOR_FORMAT format, u32 &pitch) = 0;
+};
+
 //! Class which is able to create a image from a file.
 /** If you want the Irrlicht Engine be able to load textures of
 currently unsupported file formats (e.g .gif), then implement
@@ -43,6 +59,36 @@ public:
 	/** \param file File handle to check.
 	\return Pointer to newly created image, or 0 upon error. */
 	virtual IImage *loadImage(io::IReadFile *file) const = 0;
+
+	//! Creates a reduced surface from the file
+	/** Formats which can be decoded at a lower resolution for less work,
+	like JPEG, return the smallest such image which still covers maxSize
+	when scaled to fit into it. Other loaders return the full image.
+	\param file File handle to check.
+	\param maxSize Size the image is going to be shown at. A zero
+	width or height doesn't limit that side.
+	\return Pointer to newly created image, or 0 upon error. */
+	virtual IImage *loadScaledImage(io::IReadFile *file, const core::dimension2du &maxSize) const
+	{
+		return loadImage(file);
+	}
+
+	//! Decodes the file row by row into memory of the caller
+	/** Saves creating an image which is converted and copied again, for
+	example when decoding into a locked texture or an upload buffer.
+	Loaders which can't do this return false without calling the target.
+	\param file File handle to decode.
+	\param format Format of the rows, ECF_A8R8G8B8 or ECF_R8G8B8. Images
+	without alpha channel get an opaque one. ECF_UNKNOWN picks whichever
+	of them fits the image.
+	\param swapRedBlue Exchange red and blue, so that ECF_A8R8G8B8 rows
+	are in the RGBA byte order of GL_RGBA uploads.
+	\param target Provides the memory for the rows.
+	\return True if the whole image was decoded. */
+	virtual bool loadImageRows(io::IReadFile *file, ECOLOR_FORMAT format, bool swapRedBlue, IImageRowTarget *target) const
+	{
+		return false;
+	}
 };
 
 } // end namespace video
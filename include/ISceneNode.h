@@ -220,6 +220,7 @@ public:
 	virtual void setVisible(bool isVisible)
 	{
 		IsVisible = isVisible;
+		notifyChange();
 	}
 
 	//! Get the id of the scene node.
@@ -254,6 +255,7 @@ public:
 			// Note: This iterator is not invalidated until we erase it.
 			child->ThisIterator = Children.insert(Children.end(), child);
 			child->Parent = this;
+			notifyChange();
 		}
 	}
 
@@ -274,6 +276,7 @@ public:
 		child->Parent = nullptr;
 		child->drop();
 		Children.erase(it);
+		notifyChange();
 		return true;
 	}
 
@@ -289,6 +292,7 @@ public:
 			child->drop();
 		}
 		Children.clear();
+		notifyChange();
 	}
 
 	//! Removes this scene node from the scene
@@ -346,6 +350,7 @@ public:
 	virtual void setScale(const core::vector3df &scale)
 	{
 		RelativeScale = scale;
+		notifyChange();
 	}
 
 	//! Gets the rotation of the node relative to its parent.
@@ -364,6 +369,7 @@ public:
 	virtual void setRotation(const core::vector3df &rotation)
 	{
 		RelativeRotation = rotation;
+		notifyChange();
 	}
 
 	//! Gets the position of the node relative to its parent.
@@ -381,6 +387,7 @@ public:
 	virtual void setPosition(const core::vector3df &newpos)
 	{
 		RelativeTranslation = newpos;
+		notifyChange();
 	}
 
 	//! Gets the absolute position of the node in world coordinates.
@@ -406,6 +413,7 @@ public:
 	void setAutomaticCulling(u32 state)
 	{
 		AutomaticCullingState = state;
+		notifyChange();
 	}
 
 	//! Gets the automatic culling state.
@@ -539,6 +547,19 @@ protected:
 			(*it)->clone(this, newManager);
 	}
 
+	//! Called when a child changed its transformation, visibility,
+	//! culling state or children, or when its geometry was replaced
+	/** The default implementation does nothing. The root node of the
+	scene manager uses it to keep its spatial index up to date. */
+	virtual void OnChildChanged(ISceneNode *child) {}
+
+	//! Tells the parent that this node changed
+	void notifyChange()
+	{
+		if (Parent)
+			Parent->OnChildChanged(this);
+	}
+
 	//! Sets the new scene manager for this node and all children.
 	//! Called by addChild when moving nodes between scene managers
 	void setSceneManager(ISceneManager *newManager)
@@ -70,6 +70,34 @@ public:
 	//! Preforms a software skin on this mesh based of joint positions
 	virtual void skinMesh() = 0;
 
+	//! Sets how many skinned poses may be kept for animated mesh scene nodes
+	/** With a cache size above 0, animated mesh scene nodes don't skin this
+	mesh in place anymore but get a skinned copy for their current frame.
+	Nodes showing the same frame share one copy, so the mesh is skinned once
+	per distinct pose instead of once per node. Each cached pose costs a copy
+	of the vertex and index buffers. Nodes using EJUOR_CONTROL joints still
+	skin the mesh itself. The cached poses are discarded by
+	useAnimationFrom(), setInterpolationMode(), updateNormalsWhenAnimating(),
+	bakeAnimation() and clearBakedAnimation().
+	\param size Maximum number of poses, 0 disables the cache (default). */
+	virtual void setPoseCacheSize(u32 size) = 0;
+
+	//! Samples the joint transforms of a frame range into a table
+	/** animateMesh() then reads frames in this range from the table
+	instead of interpolating the animation keys. Frames are rounded to the
+	nearest sample. Each sample stores rotation, position and scale of every
+	joint, 40 bytes per joint or 20 bytes with half precision. The table is
+	discarded by useAnimationFrom() and setInterpolationMode().
+	\param startFrame First frame to sample.
+	\param endFrame Last frame to sample.
+	\param samplesPerFrame Sampling rate, 1 samples every frame.
+	\param halfPrecision Store the values as 16 bit floats.
+	\return False if the mesh has no animation or the range is empty. */
+	virtual bool bakeAnimation(f32 startFrame, f32 endFrame, f32 samplesPerFrame = 1.f, bool halfPrecision = false) = 0;
+
+	//! Removes the table created by bakeAnimation()
+	virtual void clearBakedAnimation() = 0;
+
 	//! converts the vertex type of all meshbuffers to tangents.
 	/** E.g. used for bump mapping. */
 	virtual void convertMeshToTangents() = 0;
@@ -99,7 +127,6 @@ public:
 	private:
 		//! Internal members used by CSkinnedMesh
 		friend class CSkinnedMesh;
-		char *Moved;
 		core::vector3df StaticPos;
 		core::vector3df StaticNormal;
 	};
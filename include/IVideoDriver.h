@@ -16,6 +16,8 @@
 #include "EDriverTypes.h"
 #include "EDriverFeatures.h"
 #include "SExposedVideoData.h"
+#include "SFrameStats.h"
+#include "SMeshBufferDraw.h"
 #include "SOverrideMaterial.h"
 
 namespace irr
@@ -261,6 +263,17 @@ public:
 	IReferenceCounted::drop() for more information. */
 	virtual ITexture *getTexture(io::IReadFile *file) = 0;
 
+	//! Get access to several named textures at once.
+	/** Works like getTexture() for each file, but the images of
+	textures which are not loaded yet are decoded in parallel on
+	worker threads. The textures are created on the calling thread
+	once all images are decoded.
+	\param filenames Filenames of the textures to be loaded.
+	\param textures Receives a pointer to each texture in the order
+	of the filenames, or 0 for textures which could not be loaded.
+	The pointers should not be dropped. */
+	virtual void getTextures(const core::array<io::path> &filenames, core::array<ITexture *> &textures) = 0;
+
 	//! Returns amount of textures currently loaded
 	/** \return Amount of textures currently loaded */
 	virtual u32 getTextureCount() const = 0;
@@ -799,6 +812,16 @@ public:
 	/** \param mb Buffer to draw */
 	virtual void drawMeshBuffer(const scene::IMeshBuffer *mb) = 0;
 
+	//! Draws a list of mesh buffers, each with its own material and world transformation
+	/** Does the same as calling setTransform(ETS_WORLD), setMaterial() and
+	drawMeshBuffer() for each entry, but lets the driver merge consecutive
+	entries with the same mesh buffer and material into one draw call. To
+	profit from this, sort the list by mesh buffer and material. Afterwards
+	the world transformation and material of the last entry are set.
+	\param draws Array of entries to draw
+	\param count Number of entries in the array */
+	virtual void drawMeshBufferList(const SMeshBufferDraw *draws, u32 count) = 0;
+
 	//! Draws normals of a mesh buffer
 	/** \param mb Buffer to draw the normals of
 	\param length length scale factor of the normals
@@ -863,6 +886,11 @@ public:
 	\return Amount of primitives drawn in the last frame. */
 	virtual u32 getPrimitiveCountDrawn(u32 mode = 0) const = 0;
 
+	//! Returns draw calls and render state changes of the last frame
+	/** Useful to check how well the draws of a scene are sorted.
+	\return Counters of the frame finished by the last endScene(). */
+	virtual const SFrameStats &getFrameStats() const = 0;
+
 	//! Gets name of this video driver.
 	/** \return Returns the name of the video driver, e.g. in case
 	of the Direct3D8 driver, it would return "Direct3D 8.1". */
@@ -931,6 +959,64 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IImage *createImageFromFile(io::IReadFile *file) = 0;
 
+	//! Creates a reduced software image from a file.
+	/** Meant for previews and low quality textures. Formats which can
+	be decoded at a lower resolution for less work, currently JPEG, are
+	decoded at 1/2, 1/4 or 1/8 of their size as long as the image still
+	covers maxSize when scaled to fit into it. The image is not scaled
+	any further, use IImage::copyToScaling() for an exact size. Other
+	formats are loaded at their full size. The image cache is not used.
+	\param filename Name of the file from which the image is
+	created.
+	\param maxSize Size the image is going to be shown at. A zero
+	width or height doesn't limit that side.
+	\return The created image.
+	If you no longer need the image, you should call IImage::drop().
+	See IReferenceCounted::drop() for more information. */
+	virtual IImage *createScaledImageFromFile(const io::path &filename, const core::dimension2du &maxSize) = 0;
+
+	//! Creates a reduced software image from a file.
+	/** See createScaledImageFromFile(const io::path&, const core::dimension2du&).
+	\param file File from which the image is created.
+	\param maxSize Size the image is going to be shown at. A zero
+	width or height doesn't limit that side.
+	\return The created image.
+	If you no longer need the image, you should call IImage::drop().
+	See IReferenceCounted::drop() for more information. */
+	virtual IImage *createScaledImageFromFile(io::IReadFile *file, const core::dimension2du &maxSize) = 0;
+
+	//! Creates software images from several files at once.
+	/** The images are decoded in parallel on worker threads, this
+	call returns when all of them are done.
+	\param filenames Names of the files from which the images are
+	created.
+	\param images Receives the created images in the order of the
+	filenames, or 0 for files which could not be loaded. If you no
+	longer need an image, you should call IImage::drop(). */
+	virtual void createImagesFromFiles(const core::array<io::path> &filenames, core::array<IImage *> &images) = 0;
+
+	//! Creates software images from several files at once.
+	/** The images are decoded in parallel on worker threads, this
+	call returns when all of them are done.
+	\param files Files from which the images are created. They must
+	not be used elsewhere until this call returns.
+	\param images Receives the created images in the order of the
+	files, or 0 for files which could not be loaded. If you no longer
+	need an image, you should call IImage::drop(). */
+	virtual void createImagesFromFiles(const core::array<io::IReadFile *> &files, core::array<IImage *> &images) = 0;
+
+	//! Keeps decoded images of files on disk in a directory.
+	/** Images created from files afterwards, including the images of
+	textures, are looked up in the cache before decoding them. The
+	cache files are checked against the path, size and modification
+	time of their source file, so changed files are decoded again.
+	Images of files in archives are not cached.
+	\param directory Existing directory for the cache files, an empty
+	path disables the cache.
+	\param compress Compress the cached pixels with LZ4. Ignored if the
+	engine was built without LZ4. */
+	virtual void setImageCache(const io::path &directory, bool compress = false) = 0;
+
 	//! Writes the provided image to a file.
 	/** Requires that there is a suitable image writer registered
 	for writing the image.
@@ -0,0 +1,45 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Number of draw calls and render state changes of one frame
+/** See IVideoDriver::getFrameStats(). Drivers count what they actually
+send to the graphics API, so redundant state which is filtered out by the
+driver does not show up here. */
+struct SFrameStats
+{
+	SFrameStats() :
+			DrawCalls(0), MaterialChanges(0), TextureChanges(0), ShaderChanges(0),
+			VertexAttributeCalls(0) {}
+
+	//! Number of draw calls
+	/** An instanced draw of several mesh buffers counts once. 2D images,
+	rectangles and lines are only counted by the OpenGL 3 and OpenGL ES 2
+	drivers, the other drivers count the primitive lists they draw. */
+	u32 DrawCalls;
+
+	//! Number of times a different material was applied
+	u32 MaterialChanges;
+
+	//! Number of texture units which got a different texture bound
+	u32 TextureChanges;
+
+	//! Number of switches of the shader program or material renderer
+	u32 ShaderChanges;
+
+	//! Number of calls enabling, disabling or pointing vertex attributes
+	/** Only counted by the OpenGL 3 and OpenGL ES 2 drivers. With vertex
+	array objects, buffers drawn before need none. */
+	u32 VertexAttributeCalls;
+};
+
+} // end namespace video
+} // end namespace irr
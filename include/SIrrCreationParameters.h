@@ -47,10 +47,11 @@ struct SIrrlichtCreationParameters
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION),
 			PrivateData(0),
 #ifdef IRR_MOBILE_PATHS
-			OGLES2ShaderPath("media/Shaders/")
+			OGLES2ShaderPath("media/Shaders/"),
 #else
-			OGLES2ShaderPath("../../media/Shaders/")
+			OGLES2ShaderPath("../../media/Shaders/"),
 #endif
+			QuadIndices32Bit(false)
 	{
 	}
 
@@ -82,6 +83,7 @@ struct SIrrlichtCreationParameters
 		LoggingLevel = other.LoggingLevel;
 		PrivateData = other.PrivateData;
 		OGLES2ShaderPath = other.OGLES2ShaderPath;
+		QuadIndices32Bit = other.QuadIndices32Bit;
 		return *this;
 	}
 
@@ -262,6 +264,13 @@ struct SIrrlichtCreationParameters
 	/** This is about the shaders which can be found in media/Shaders by default. It's only necessary
 	to set when using OGL-ES 2.0 */
 	irr::io::path OGLES2ShaderPath;
+
+	//! Draw batched 2D quads with 32 bit indices
+	/** The OpenGL 3 and OpenGL ES 2 drivers draw up to 16384 queued 2D quads
+	per draw call with 16 bit indices. With 32 bit indices, if the context
+	supports them, it is 262144 quads, at the cost of a larger index buffer.
+	Default: false */
+	bool QuadIndices32Bit;
 };
 
 } // end namespace irr
@@ -0,0 +1,41 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "matrix4.h"
+
+namespace irr
+{
+namespace scene
+{
+class IMeshBuffer;
+} // end namespace scene
+
+namespace video
+{
+struct SMaterial;
+
+//! One entry of a draw list passed to IVideoDriver::drawMeshBufferList()
+/** The entry only points to its data, which has to stay valid until the
+list was drawn. */
+struct SMeshBufferDraw
+{
+	SMeshBufferDraw() :
+			MeshBuffer(0), Material(0), Transform(0) {}
+
+	SMeshBufferDraw(const scene::IMeshBuffer *mb, const SMaterial *material, const core::matrix4 *transform) :
+			MeshBuffer(mb), Material(material), Transform(transform) {}
+
+	//! Mesh buffer to draw
+	const scene::IMeshBuffer *MeshBuffer;
+
+	//! Material to draw the mesh buffer with
+	const SMaterial *Material;
+
+	//! World transformation of the mesh buffer
+	const core::matrix4 *Transform;
+};
+
+} // end namespace video
+} // end namespace irr
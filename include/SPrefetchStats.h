@@ -0,0 +1,41 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace io
+{
+
+//! Counters of the prefetch cache of the file system
+/** See IFileSystem::prefetchFiles(). */
+struct SPrefetchStats
+{
+	SPrefetchStats() :
+			Queued(0), Skipped(0), Hits(0), Misses(0), CachedFiles(0), CachedBytes(0) {}
+
+	//! Number of files queued for prefetching
+	u32 Queued;
+
+	//! Number of files not prefetched because they were not found or
+	//! did not fit into the budget
+	u32 Skipped;
+
+	//! Number of files opened from the prefetch cache
+	u32 Hits;
+
+	//! Number of files opened without help of the prefetch cache
+	u32 Misses;
+
+	//! Number of prefetched files which were not opened yet
+	u32 CachedFiles;
+
+	//! Size of the prefetched files which were not opened yet
+	u64 CachedBytes;
+};
+
+} // end namespace io
+} // end namespace irr
@@ -46,5 +46,35 @@ SceneManager->getParameters()->setAttribute(scene::OBJ_LOADER_IGNORE_MATERIAL_FI
 **/
 const c8 *const OBJ_LOADER_IGNORE_MATERIAL_FILES = "OBJ_IgnoreMaterialFiles";
 
+//! Number of worker threads used to animate skinned meshes
+/** When above 0, ISceneManager::drawAll() animates and skins the meshes
+of all visible animated mesh scene nodes on this many threads before
+rendering starts. Nodes sharing a mesh are processed on the same thread,
+and are only prepared early if the mesh keeps enough poses, see
+ISkinnedMesh::setPoseCacheSize(). 0 disables it (default).
+Use it like this:
+\code
+SceneManager->getParameters()->setAttribute(scene::ANIMATION_THREADS, 4);
+\endcode
+**/
+const c8 *const ANIMATION_THREADS = "Animation_Threads";
+
+//! Flag to keep the scene nodes in a spatial index for culling
+/** When enabled, mesh and animated mesh scene nodes which are direct
+children of the root node and have no children themselves are kept in a
+loose octree. ISceneManager::drawAll() then only lets the nodes of octree
+cells intersecting the view frustum register, so the registration cost
+depends on the number of visible nodes instead of the number of all nodes.
+Nodes without automatic culling are never indexed. Mesh scene nodes are
+only animated and re-indexed after they changed through their setters, so
+call IMeshSceneNode::setMesh() again after changing the bounding box of
+their mesh. Disabled by default.
+Use it like this:
+\code
+SceneManager->getParameters()->setAttribute(scene::SPATIAL_INDEX, true);
+\endcode
+**/
+const c8 *const SPATIAL_INDEX = "Spatial_Index";
+
 } // end namespace scene
 } // end namespace irr
@@ -75,7 +75,9 @@ inline io::path &deletePathFromFilename(io::path &filename)
 
 	if (p != s) {
 		++p;
-		filename = p;
+		// the name is copied first, assigning a pointer into the string itself
+		// would cut it off when the name is longer than the path
+		filename = filename.subString((u32)(p - s), filename.size());
 	}
 	return filename;
 }
@@ -119,10 +119,13 @@
 #include "SceneParameters.h"
 #include "SColor.h"
 #include "SExposedVideoData.h"
+#include "SFrameStats.h"
 #include "SIrrCreationParameters.h"
 #include "SMaterial.h"
 #include "SMesh.h"
 #include "SMeshBuffer.h"
+#include "SMeshBufferDraw.h"
+#include "SPrefetchStats.h"
 #include "SSkinMeshBuffer.h"
 #include "SVertexIndex.h"
 #include "SViewFrustum.h"
@@ -29,7 +29,7 @@ CAnimatedMeshSceneNode::CAnimatedMeshSceneNode(IAnimatedMesh *mesh,
 		const core::vector3df &rotation,
 		const core::vector3df &scale) :
 		IAnimatedMeshSceneNode(parent, mgr, id, position, rotation, scale),
-		Mesh(0),
+		Mesh(0), PreparedMesh(0),
 		StartFrame(0), EndFrame(0), FramesPerSecond(0.025f),
 		CurrentFrameNr(0.f), LastTimeMs(0),
 		TransitionTime(0), Transiting(0.f), TransitingBlend(0.f),
@@ -168,31 +168,69 @@ IMesh *CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 
 		CSkinnedMesh *skinnedMesh = static_cast<CSkinnedMesh *>(Mesh);
 
-		if (JointMode == EJUOR_CONTROL) // write to mesh
-			skinnedMesh->transferJointsToMesh(JointChildSceneNodes);
-		else
-			skinnedMesh->animateMesh(getFrameNr(), 1.0f);
+		if (JointMode != EJUOR_CONTROL) {
+			// Nodes in the same pose may share one skinned copy of the mesh
+			IMesh *pose = skinnedMesh->getSkinnedPose(getFrameNr(), 1.0f, LastTimeMs);
+
+			if (JointMode == EJUOR_READ) // read from mesh
+				readJointsFromMesh();
+
+			return pose;
+		}
+
+		// write to mesh
+		skinnedMesh->transferJointsToMesh(JointChildSceneNodes);
 
 		// Update the skinned mesh for the current joint transforms.
 		skinnedMesh->skinMesh();
 
-		if (JointMode == EJUOR_READ) { // read from mesh
-			skinnedMesh->recoverJointsFromMesh(JointChildSceneNodes);
+		// For meshes other than EJUOR_CONTROL, this is done by calling animateMesh()
+		skinnedMesh->updateBoundingBox();
 
-			//---slow---
-			for (u32 n = 0; n < JointChildSceneNodes.size(); ++n)
-				if (JointChildSceneNodes[n]->getParent() == this) {
-					JointChildSceneNodes[n]->updateAbsolutePositionOfAllChildren(); // temp, should be an option
-				}
-		}
+		return skinnedMesh;
+	}
+}
 
-		if (JointMode == EJUOR_CONTROL) {
-			// For meshes other than EJUOR_CONTROL, this is done by calling animateMesh()
-			skinnedMesh->updateBoundingBox();
+//! Moves the joint scene nodes to the pose of the current frame
+void CAnimatedMeshSceneNode::readJointsFromMesh()
+{
+	CSkinnedMesh *skinnedMesh = static_cast<CSkinnedMesh *>(Mesh);
+
+	// does nothing if the mesh was just skinned at this frame
+	skinnedMesh->animateMesh(getFrameNr(), 1.0f);
+	skinnedMesh->recoverJointsFromMesh(JointChildSceneNodes);
+
+	//---slow---
+	for (u32 n = 0; n < JointChildSceneNodes.size(); ++n)
+		if (JointChildSceneNodes[n]->getParent() == this) {
+			JointChildSceneNodes[n]->updateAbsolutePositionOfAllChildren(); // temp, should be an option
 		}
+}
 
-		return skinnedMesh;
-	}
+void CAnimatedMeshSceneNode::prepareMeshForCurrentFrame(u32 meshUsers)
+{
+	PreparedMesh = 0;
+
+	if (!Mesh || Mesh->getMeshType() != EAMT_SKINNED)
+		return;
+
+	// A mesh skinned in place only keeps the pose of the node which came
+	// last, so shared meshes need a cached pose for every node.
+	if (meshUsers > 1 && (JointMode == EJUOR_CONTROL ||
+								 static_cast<CSkinnedMesh *>(Mesh)->getPoseCacheSize() < meshUsers))
+		return;
+
+	// the joint scene nodes are moved by finishPreparedMesh()
+	if (JointMode == EJUOR_READ)
+		PreparedMesh = static_cast<CSkinnedMesh *>(Mesh)->getSkinnedPose(getFrameNr(), 1.0f, LastTimeMs);
+	else
+		PreparedMesh = getMeshForCurrentFrame();
+}
+
+void CAnimatedMeshSceneNode::finishPreparedMesh()
+{
+	if (PreparedMesh && JointMode == EJUOR_READ)
+		readJointsFromMesh();
 }
 
 //! OnAnimate() is called just before rendering the whole scene.
@@ -222,7 +260,7 @@ void CAnimatedMeshSceneNode::render()
 
 	++PassCount;
 
-	scene::IMesh *m = getMeshForCurrentFrame();
+	scene::IMesh *m = PreparedMesh ? PreparedMesh : getMeshForCurrentFrame();
 
 	if (m) {
 		Box = m->getBoundingBox();
@@ -242,7 +280,7 @@ void CAnimatedMeshSceneNode::render()
 		// and solid only in solid pass
 		if (transparent == isTransparentPass) {
 			scene::IMeshBuffer *mb = m->getMeshBuffer(i);
-			const video::SMaterial &material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+			const video::SMaterial &material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
 			if (RenderFromIdentity)
 				driver->setTransform(video::ETS_WORLD, core::IdentityMatrix);
 			else if (Mesh->getMeshType() == EAMT_SKINNED)
@@ -530,6 +568,8 @@ void CAnimatedMeshSceneNode::setMesh(IAnimatedMesh *mesh)
 
 		// grab the mesh (it's non-null!)
 		Mesh->grab();
+
+		PreparedMesh = 0;
 	}
 
 	// get materials and bounding box
@@ -136,10 +136,28 @@ public:
 	\return The newly created clone of this node. */
 	ISceneNode *clone(ISceneNode *newParent = 0, ISceneManager *newManager = 0) override;
 
+	//! Animates and skins the mesh for the current frame ahead of render()
+	/** May be called from a worker thread. All nodes using the same mesh
+	have to be prepared by the same thread. The joint scene nodes are left
+	alone, call finishPreparedMesh() afterwards.
+	\param meshUsers Number of nodes using the mesh in this frame. */
+	void prepareMeshForCurrentFrame(u32 meshUsers);
+
+	//! Reads the joints back from the prepared mesh in EJUOR_READ mode
+	/** Has to be called on the main thread after all nodes were prepared,
+	since it moves scene nodes. */
+	void finishPreparedMesh();
+
+	//! Forgets the mesh from prepareMeshForCurrentFrame()
+	void discardPreparedMesh() { PreparedMesh = 0; }
+
 private:
 	//! Get a static mesh for the current frame of this animated mesh
 	IMesh *getMeshForCurrentFrame();
 
+	//! Moves the joint scene nodes to the pose of the current frame
+	void readJointsFromMesh();
+
 	void buildFrameNr(u32 timeMs);
 	void checkJoints();
 	void beginTransition();
@@ -148,6 +166,9 @@ private:
 	core::aabbox3d<f32> Box;
 	IAnimatedMesh *Mesh;
 
+	//! Mesh of the current frame, set by prepareMeshForCurrentFrame()
+	IMesh *PreparedMesh;
+
 	s32 StartFrame;
 	s32 EndFrame;
 	f32 FramesPerSecond;
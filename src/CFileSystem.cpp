@@ -10,8 +10,11 @@
 #include "stdio.h"
 #include "os.h"
 #include "CReadFile.h"
+#include "CMappedReadFile.h"
 #include "CMemoryFile.h"
 #include "CLimitReadFile.h"
+#include "CInflateReadFile.h"
+#include "CThreadPool.h"
 #include "CWriteFile.h"
 #include <list>
 
@@ -42,7 +45,8 @@ namespace io
 {
 
 //! constructor
-CFileSystem::CFileSystem()
+CFileSystem::CFileSystem() :
+		ArchiveIndexDirty(true), PrefetchThreads(0), PrefetchBudget(64 * 1024 * 1024)
 {
 #ifdef _DEBUG
 	setDebugName("CFileSystem");
@@ -58,6 +62,9 @@ CFileSystem::CFileSystem()
 //! destructor
 CFileSystem::~CFileSystem()
 {
+	clearPrefetchCache();
+	delete PrefetchThreads;
+
 	u32 i;
 
 	for (i = 0; i < FileArchives.size(); ++i) {
@@ -75,10 +82,53 @@ IReadFile *CFileSystem::createAndOpenFile(const io::path &filename)
 	if (filename.empty())
 		return 0;
 
+	if (!Prefetched.empty()) {
+		auto it = Prefetched.find(getAbsolutePath(filename));
+		if (it != Prefetched.end()) {
+			SPrefetchEntry *entry = it->second;
+			Prefetched.erase(it);
+			++PrefetchStats.Hits;
+			return takePrefetched(entry);
+		}
+	}
+
+	++PrefetchStats.Misses;
+	return openFile(filename);
+}
+
+//! opens a file from the archives or the disk
+IReadFile *CFileSystem::openFile(const io::path &filename, bool streaming)
+{
 	IReadFile *file = 0;
-	u32 i;
+	u32 i = 0;
+
+	// The index knows the first archive with the file. Archives which are
+	// not indexed are asked directly if they come before that one.
+	const c8 last = filename.lastChar();
+	if (last != '/' && last != '\\') {
+		u32 entry = 0;
+		const u32 found = findIndexedFile(filename, entry);
+		for (u32 j = 0; j < UnindexedArchives.size() && UnindexedArchives[j] < found; ++j) {
+			file = FileArchives[UnindexedArchives[j]]->createAndOpenFile(filename);
+			if (file)
+				return file;
+		}
 
-	for (i = 0; i < FileArchives.size(); ++i) {
+		if (found < FileArchives.size()) {
+			// indexed archives are zip archives
+			if (streaming)
+				file = dynamic_cast<CZipReader *>(FileArchives[found])->createStreamingFile(entry);
+			else
+				file = FileArchives[found]->createAndOpenFile(entry);
+			if (file)
+				return file;
+		}
+
+		// only if the file could not be opened the later archives are tried
+		i = found + 1;
+	}
+
+	for (; i < FileArchives.size(); ++i) {
 		file = FileArchives[i]->createAndOpenFile(filename);
 		if (file)
 			return file;
@@ -86,7 +136,12 @@ IReadFile *CFileSystem::createAndOpenFile(const io::path &filename)
 
 	// Create the file using an absolute path so that it matches
 	// the scheme used by CNullDriver::getTexture().
-	return CReadFile::createReadFile(getAbsolutePath(filename));
+	const io::path absolutePath = getAbsolutePath(filename);
+	file = CMappedReadFile::createMappedReadFile(absolutePath);
+	if (file)
+		return file;
+
+	return CReadFile::createReadFile(absolutePath);
 }
 
 //! Creates an IReadFile interface for treating memory like a file.
@@ -168,6 +223,8 @@ bool CFileSystem::moveFileArchive(u32 sourceIndex, s32 relative)
 		FileArchives[s] = t;
 		r = true;
 	}
+	ArchiveIndexDirty = true;
+	clearPrefetchCache();
 	return r;
 }
 
@@ -246,6 +303,8 @@ bool CFileSystem::addFileArchive(const io::path &filename, bool ignoreCase,
 
 	if (archive) {
 		FileArchives.push_back(archive);
+		ArchiveIndexDirty = true;
+		clearPrefetchCache();
 		if (password.size())
 			archive->Password = password;
 		if (retArchive)
@@ -309,6 +368,8 @@ bool CFileSystem::addFileArchive(IReadFile *file, bool ignoreCase,
 
 		if (archive) {
 			FileArchives.push_back(archive);
+			ArchiveIndexDirty = true;
+			clearPrefetchCache();
 			if (password.size())
 				archive->Password = password;
 			if (retArchive)
@@ -332,6 +393,8 @@ bool CFileSystem::addFileArchive(IFileArchive *archive)
 			}
 		}
 		FileArchives.push_back(archive);
+		ArchiveIndexDirty = true;
+		clearPrefetchCache();
 		archive->grab();
 
 		return true;
@@ -347,6 +410,8 @@ bool CFileSystem::removeFileArchive(u32 index)
 	if (index < FileArchives.size()) {
 		FileArchives[index]->drop();
 		FileArchives.erase(index);
+		ArchiveIndexDirty = true;
+		clearPrefetchCache();
 		ret = true;
 	}
 	return ret;
@@ -738,9 +803,19 @@ IFileList *CFileSystem::createEmptyFileList(const io::path &path, bool ignoreCas
 //! determines if a file exists and would be able to be opened.
 bool CFileSystem::existFile(const io::path &filename) const
 {
-	for (u32 i = 0; i < FileArchives.size(); ++i)
-		if (FileArchives[i]->getFileList()->findFile(filename) != -1)
+	const c8 last = filename.lastChar();
+	if (last != '/' && last != '\\') {
+		u32 entry;
+		if (findIndexedFile(filename, entry) < FileArchives.size())
 			return true;
+		for (u32 i = 0; i < UnindexedArchives.size(); ++i)
+			if (FileArchives[UnindexedArchives[i]]->getFileList()->findFile(filename) != -1)
+				return true;
+	} else {
+		for (u32 i = 0; i < FileArchives.size(); ++i)
+			if (FileArchives[i]->getFileList()->findFile(filename) != -1)
+				return true;
+	}
 
 #if defined(_MSC_VER)
 	return (_access(filename.c_str(), 0) != -1);
@@ -751,6 +826,81 @@ bool CFileSystem::existFile(const io::path &filename) const
 #endif
 }
 
+u32 CFileSystem::findIndexedFile(const io::path &filename, u32 &entry) const
+{
+	if (ArchiveIndexDirty)
+		buildArchiveIndex();
+
+	// the same normalization CFileList::findFile() does, the lists compare
+	// names case insensitive no matter if the archive ignores the case
+	io::path name = filename;
+	name.replace('\\', '/');
+	name.make_lower();
+
+	u32 found = FileArchives.size();
+	auto it = FullPathIndex.find(name);
+	if (it != FullPathIndex.end()) {
+		found = it->second.Archive;
+		entry = it->second.Entry;
+	}
+
+	if (!FileNameIndex.empty()) {
+		core::deletePathFromFilename(name);
+		it = FileNameIndex.find(name);
+		if (it != FileNameIndex.end() && it->second.Archive < found) {
+			found = it->second.Archive;
+			entry = it->second.Entry;
+		}
+	}
+
+	return found;
+}
+
+void CFileSystem::buildArchiveIndex() const
+{
+	FullPathIndex.clear();
+	FileNameIndex.clear();
+	UnindexedArchives.clear();
+
+	for (u32 i = 0; i < FileArchives.size(); ++i) {
+		// other archives might open files which are not in their list
+		const CZipReader *zip = dynamic_cast<const CZipReader *>(FileArchives[i]);
+		if (!zip) {
+			UnindexedArchives.push_back(i);
+			continue;
+		}
+
+		auto &index = zip->isIgnoringPaths() ? FileNameIndex : FullPathIndex;
+		const IFileList *list = zip->getFileList();
+		for (u32 j = 0; j < list->getFileCount(); ++j) {
+			if (list->isDirectory(j))
+				continue;
+
+			io::path name = list->getFullFileName(j);
+			name.make_lower();
+
+			// earlier archives and entries take precedence
+			SIndexedFile file;
+			file.Archive = i;
+			file.Entry = j;
+			index.emplace(name, file);
+		}
+	}
+
+	ArchiveIndexDirty = false;
+}
+
+size_t CFileSystem::SPathHash::operator()(const io::path &path) const
+{
+	// FNV-1a
+	size_t hash = 2166136261u;
+	for (u32 i = 0; i < path.size(); ++i) {
+		hash ^= (u8)path[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
 //! creates a filesystem which is able to open files from the ordinary file system,
 //! and out of zipfiles, which are able to be added to the filesystem.
 IFileSystem *createFileSystem()
@@ -758,5 +908,121 @@ IFileSystem *createFileSystem()
 	return new CFileSystem();
 }
 
+u32 CFileSystem::prefetchFiles(const core::array<path> &filenames)
+{
+	u32 queued = 0;
+	for (u32 i = 0; i < filenames.size(); ++i) {
+		const io::path key = getAbsolutePath(filenames[i]);
+		if (Prefetched.find(key) != Prefetched.end())
+			continue;
+
+		// compressed files are decompressed by the worker
+		IReadFile *file = openFile(filenames[i], true);
+		if (!file || PrefetchStats.CachedBytes + file->getSize() > PrefetchBudget) {
+			if (file)
+				file->drop();
+			++PrefetchStats.Skipped;
+			continue;
+		}
+
+		SPrefetchEntry *entry = new SPrefetchEntry();
+		entry->File = file;
+		entry->Data = 0;
+		entry->Size = file->getSize();
+		entry->Done = false;
+		Prefetched[key] = entry;
+
+		++queued;
+		++PrefetchStats.Queued;
+		++PrefetchStats.CachedFiles;
+		PrefetchStats.CachedBytes += entry->Size;
+
+		if (!isReadableOnAnyThread(file)) {
+			prefetch(entry);
+			continue;
+		}
+
+		if (!PrefetchThreads)
+			PrefetchThreads = new CThreadPool(core::max_(std::thread::hardware_concurrency(), 1u));
+		PrefetchThreads->enqueue([this, entry]() { prefetch(entry); });
+	}
+	return queued;
+}
+
+bool CFileSystem::isReadableOnAnyThread(IReadFile *file)
+{
+	const EREAD_FILE_TYPE type = file->getType();
+	return type == ERFT_READ_FILE || type == ERFT_MEMORY_READ_FILE ||
+		   type == ERFT_MAPPED_READ_FILE ||
+		   (type == ERFT_INFLATE_READ_FILE && static_cast<CInflateReadFile *>(file)->isInputInMemory());
+}
+
+void CFileSystem::setPrefetchBudget(u64 bytes)
+{
+	PrefetchBudget = bytes;
+}
+
+void CFileSystem::clearPrefetchCache()
+{
+	for (auto &it : Prefetched)
+		takePrefetched(it.second)->drop();
+	Prefetched.clear();
+}
+
+const SPrefetchStats &CFileSystem::getPrefetchStats() const
+{
+	return PrefetchStats;
+}
+
+void CFileSystem::prefetch(SPrefetchEntry *entry)
+{
+	IReadFile *file = entry->File;
+	const EREAD_FILE_TYPE type = file->getType();
+
+	if (type == ERFT_MAPPED_READ_FILE) {
+		// fault in the pages, the mapping itself is handed out later
+		const u8 *data = static_cast<const u8 *>(static_cast<IMemoryReadFile *>(file)->getBuffer());
+		u8 sum = 0;
+		for (long i = 0; i < entry->Size; i += 4096)
+			sum += data[i];
+		volatile u8 keep = sum;
+		(void)keep;
+	} else if (type != ERFT_MEMORY_READ_FILE) {
+		u8 *data = new u8[entry->Size];
+		if (file->read(data, entry->Size) == (size_t)entry->Size) {
+			entry->Data = data;
+		} else {
+			// hand out the file itself, reading it again
+			delete[] data;
+			file->seek(0);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(PrefetchMutex);
+		entry->Done = true;
+	}
+	PrefetchDone.notify_all();
+}
+
+IReadFile *CFileSystem::takePrefetched(SPrefetchEntry *entry)
+{
+	{
+		std::unique_lock<std::mutex> lock(PrefetchMutex);
+		PrefetchDone.wait(lock, [entry] { return entry->Done; });
+	}
+
+	IReadFile *file = entry->File;
+	if (entry->Data) {
+		file = new CMemoryReadFile(entry->Data, entry->Size, entry->File->getFileName(), true);
+		entry->File->drop();
+	}
+
+	--PrefetchStats.CachedFiles;
+	PrefetchStats.CachedBytes -= entry->Size;
+	delete entry;
+	return file;
+}
+
 } // end namespace irr
 } // end namespace io
@@ -7,8 +7,15 @@
 #include "IFileSystem.h"
 #include "irrArray.h"
 
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
 namespace irr
 {
+class CThreadPool;
+
 namespace io
 {
 
@@ -123,7 +130,64 @@ public:
 	//! determines if a file exists and would be able to be opened.
 	bool existFile(const io::path &filename) const override;
 
+	//! Reads files in the background, so opening them later is faster
+	u32 prefetchFiles(const core::array<path> &filenames) override;
+
+	//! Sets how many bytes the prefetched files may occupy at once
+	void setPrefetchBudget(u64 bytes) override;
+
+	//! Drops all prefetched files which were not opened yet
+	void clearPrefetchCache() override;
+
+	//! Returns counters of the prefetch cache
+	const SPrefetchStats &getPrefetchStats() const override;
+
+	//! Returns true if reading the file doesn't touch anything shared
+	/** Files sharing a handle with their archive must be read on the
+	thread using the archive. Everything else reads from memory or its
+	own handle and can be handed to another thread. */
+	static bool isReadableOnAnyThread(IReadFile *file);
+
 private:
+	//! Opens a file from the archives or the disk
+	/** \param streaming Open compressed files in zip archives without
+	decompressing them, they are decompressed while being read. */
+	IReadFile *openFile(const io::path &filename, bool streaming = false);
+
+	//! Finds the first archive with a file of this name in the index
+	/** \return Index of the archive, or the archive count if none has it */
+	u32 findIndexedFile(const io::path &filename, u32 &entry) const;
+
+	//! Collects the files of all archives, called after archives changed
+	void buildArchiveIndex() const;
+
+	struct SIndexedFile
+	{
+		u32 Archive;
+		u32 Entry;
+	};
+
+	struct SPathHash
+	{
+		size_t operator()(const io::path &path) const;
+	};
+
+	struct SPrefetchEntry
+	{
+		//! the opened file, only touched by the worker until Done is set
+		IReadFile *File;
+		//! content read by the worker, 0 if File can be handed out itself
+		u8 *Data;
+		long Size;
+		bool Done;
+	};
+
+	//! Reads the content of a file, called on a worker thread
+	void prefetch(SPrefetchEntry *entry);
+
+	//! Waits for the worker and returns the file for the entry
+	IReadFile *takePrefetched(SPrefetchEntry *entry);
+
 	//! Currently used FileSystemType
 	EFileSystemType FileSystemType;
 	//! WorkingDirectory for Native and Virtual filesystems
@@ -132,6 +196,23 @@ private:
 	core::array<IArchiveLoader *> ArchiveLoader;
 	//! currently attached Archives
 	core::array<IFileArchive *> FileArchives;
+
+	//! First archive with a file of that lower case name, for archives
+	//! comparing the full path and for archives ignoring paths
+	mutable std::unordered_map<io::path, SIndexedFile, SPathHash> FullPathIndex;
+	mutable std::unordered_map<io::path, SIndexedFile, SPathHash> FileNameIndex;
+	//! archives of other types, they are asked one by one
+	mutable core::array<u32> UnindexedArchives;
+	mutable bool ArchiveIndexDirty;
+
+	//! prefetched files by absolute path
+	std::map<io::path, SPrefetchEntry *> Prefetched;
+	CThreadPool *PrefetchThreads;
+	u64 PrefetchBudget;
+	SPrefetchStats PrefetchStats;
+	//! guards the Done flags of the entries
+	std::mutex PrefetchMutex;
+	std::condition_variable PrefetchDone;
 };
 
 } // end namespace irr
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "IImage.h"
+#include "IImageLoader.h"
 #include "rect.h"
 
 namespace irr
@@ -70,5 +71,23 @@ private:
 	inline SColor getPixelBox(s32 x, s32 y, s32 fx, s32 fy, s32 bias) const;
 };
 
+//! Creates the image an image loader decodes rows into
+class CImageRowTarget : public IImageRowTarget
+{
+public:
+	CImageRowTarget() :
+			Image(0) {}
+
+	void *getRows(const core::dimension2du &size, ECOLOR_FORMAT format, u32 &pitch) override
+	{
+		Image = new CImage(format, size);
+		pitch = Image->getPitch();
+		return Image->getData();
+	}
+
+	//! the created image, 0 if the loader didn't get that far
+	CImage *Image;
+};
+
 } // end namespace video
 } // end namespace irr
@@ -0,0 +1,183 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CImageCache.h"
+#include "CImageLoaderIRI.h"
+#include "CMappedReadFile.h"
+#include "CReadFile.h"
+#include "CWriteFile.h"
+#include "IImage.h"
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <sys/stat.h>
+#include <thread>
+#if defined(_MSC_VER)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef _IRR_COMPILE_WITH_LZ4_
+#include <lz4.h>
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+CImageCache::CImageCache(const io::path &directory, bool compress) :
+		Directory(directory), Compress(compress), Loader(new CImageLoaderIRI())
+{
+	if (Directory.size() && Directory.lastChar() != '/' && Directory.lastChar() != '\\')
+		Directory.append('/');
+}
+
+CImageCache::~CImageCache()
+{
+	Loader->drop();
+}
+
+IImage *CImageCache::load(const io::path &source, ECOLOR_FORMAT format) const
+{
+	u64 size, time;
+	if (!getSourceInfo(source, size, time))
+		return 0;
+
+	const io::path name = getCacheFileName(source, format);
+	io::IReadFile *file = io::CMappedReadFile::createMappedReadFile(name);
+	if (!file)
+		file = io::CReadFile::createReadFile(name);
+	if (!file)
+		return 0;
+
+	IImage *image = 0;
+	SIRIHeader header;
+	io::path path;
+	if (CImageLoaderIRI::readHeader(file, header, path) && path == source &&
+			header.RequestedFormat == (u32)format &&
+			header.SourceSize == size && header.SourceTime == time) {
+		file->seek(0);
+		image = Loader->loadImage(file);
+	}
+	file->drop();
+	return image;
+}
+
+void CImageCache::store(const io::path &source, ECOLOR_FORMAT format, IImage *image) const
+{
+	// longer paths could not be loaded again
+	if (source.size() > IRI_MAX_SOURCE_PATH)
+		return;
+
+	u64 size, time;
+	const ECOLOR_FORMAT imageFormat = image->getColorFormat();
+	if (!IImage::getBitsPerPixelFromFormat(imageFormat) || !getSourceInfo(source, size, time))
+		return;
+
+	SIRIHeader header;
+	memset(&header, 0, sizeof(SIRIHeader));
+	memcpy(header.Magic, IRI_MAGIC, 4);
+	header.Version = IRI_VERSION;
+	header.ColorFormat = imageFormat;
+	header.Width = image->getDimension().Width;
+	header.Height = image->getDimension().Height;
+	header.Pitch = image->getPitch();
+	header.SourceSize = size;
+	header.SourceTime = time;
+	header.SourcePathSize = source.size();
+	header.DataOffset = (sizeof(SIRIHeader) + source.size() + 63) & ~63u;
+	header.RequestedFormat = format;
+
+	const c8 *data = (const c8 *)image->getData();
+	header.DataSize = image->getImageDataSizeInBytes();
+	c8 *compressed = 0;
+#ifdef _IRR_COMPILE_WITH_LZ4_
+	if (Compress) {
+		const int bound = LZ4_compressBound((int)header.DataSize);
+		compressed = new c8[bound];
+		const int compressedSize = LZ4_compress_default(data, compressed, (int)header.DataSize, bound);
+		if (compressedSize > 0 && (u64)compressedSize < header.DataSize) {
+			header.Compression = 1;
+			header.DataSize = compressedSize;
+			data = compressed;
+		}
+	}
+#endif
+
+	// Written under a name of its own first, so nobody loads a half
+	// written file. Threads and processes may store the same image.
+	const io::path name = getCacheFileName(source, format);
+#if defined(_MSC_VER)
+	const unsigned long process = (unsigned long)_getpid();
+#else
+	const unsigned long process = (unsigned long)getpid();
+#endif
+	c8 suffix[48];
+	snprintf(suffix, sizeof(suffix), ".%lx.%zx.tmp", process, std::hash<std::thread::id>()(std::this_thread::get_id()));
+	const io::path temporary = name + suffix;
+
+	bool written = false;
+	io::IWriteFile *file = io::CWriteFile::createWriteFile(temporary, false);
+	if (file) {
+		const c8 padding[64] = {0};
+		const u32 paddingSize = header.DataOffset - sizeof(SIRIHeader) - source.size();
+		written = file->write(&header, sizeof(SIRIHeader)) == sizeof(SIRIHeader) &&
+				  file->write(source.c_str(), source.size()) == source.size() &&
+				  file->write(padding, paddingSize) == paddingSize &&
+				  file->write(data, (size_t)header.DataSize) == header.DataSize;
+		file->drop();
+	}
+	delete[] compressed;
+
+	if (written && rename(temporary.c_str(), name.c_str()) != 0) {
+		// renaming doesn't replace files on all platforms
+		remove(name.c_str());
+		written = rename(temporary.c_str(), name.c_str()) == 0;
+	}
+	if (!written)
+		remove(temporary.c_str());
+}
+
+bool CImageCache::getSourceInfo(const io::path &source, u64 &size, u64 &time)
+{
+#if defined(_MSC_VER)
+	struct _stat64 info;
+	if (_stat64(source.c_str(), &info) != 0 || !(info.st_mode & _S_IFREG))
+		return false;
+#else
+	struct stat info;
+	if (stat(source.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+		return false;
+#endif
+	size = (u64)info.st_size;
+
+	// in nanoseconds where the file system has them, so that a file
+	// rewritten within the same second is noticed
+	time = (u64)info.st_mtime * 1000000000ull;
+#if defined(__APPLE__)
+	time += (u64)info.st_mtimespec.tv_nsec;
+#elif !defined(_WIN32)
+	time += (u64)info.st_mtim.tv_nsec;
+#endif
+	return true;
+}
+
+io::path CImageCache::getCacheFileName(const io::path &source, ECOLOR_FORMAT format) const
+{
+	// FNV-1a of the path and the format, both are in the file for checking
+	u64 hash = 14695981039346656037ull;
+	for (u32 i = 0; i < source.size(); ++i) {
+		hash ^= (u8)source[i];
+		hash *= 1099511628211ull;
+	}
+	hash ^= (u8)format;
+	hash *= 1099511628211ull;
+
+	c8 name[32];
+	snprintf(name, sizeof(name), "%016llx.iri", (unsigned long long)hash);
+	return Directory + name;
+}
+
+} // end namespace video
+} // end namespace irr
@@ -0,0 +1,59 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "path.h"
+#include "SColor.h"
+
+namespace irr
+{
+namespace video
+{
+class IImage;
+class CImageLoaderIRI;
+
+/*!
+	Stores decoded images in a directory, so the image files don't have to
+	be decoded again on the next start. The entries are keyed by the
+	absolute path of the source file and the color format it was decoded
+	to, and checked against the size and modification time of the file.
+	The cache keeps no state besides its settings, so images can be loaded
+	and stored from several threads and processes at once.
+*/
+class CImageCache
+{
+public:
+	//! Constructor
+	/** \param directory Existing directory for the cache files
+	\param compress Compress the pixels with LZ4, if the engine was built with it */
+	CImageCache(const io::path &directory, bool compress);
+
+	~CImageCache();
+
+	//! Loads the decoded image of a source file
+	/** \param source Absolute path of the source file
+	\param format Format the image was decoded to, ECF_UNKNOWN for the
+	format of the source
+	\return The image, or 0 if it isn't cached or the source changed */
+	IImage *load(const io::path &source, ECOLOR_FORMAT format) const;
+
+	//! Stores the decoded image of a source file
+	/** \param source Absolute path of the source file
+	\param format Format the image was decoded to, like for load() */
+	void store(const io::path &source, ECOLOR_FORMAT format, IImage *image) const;
+
+private:
+	//! Gets size and modification time of a file on disk
+	static bool getSourceInfo(const io::path &source, u64 &size, u64 &time);
+
+	//! Name of the cache file for a source file decoded to a format
+	io::path getCacheFileName(const io::path &source, ECOLOR_FORMAT format) const;
+
+	io::path Directory;
+	bool Compress;
+	CImageLoaderIRI *Loader;
+};
+
+} // end namespace video
+} // end namespace irr
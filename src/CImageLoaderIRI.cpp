@@ -0,0 +1,126 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CImageLoaderIRI.h"
+
+#include "IMemoryReadFile.h"
+#include "CImage.h"
+#include "os.h"
+#include "irrString.h"
+#include <cstring>
+#ifdef _IRR_COMPILE_WITH_LZ4_
+#include <lz4.h>
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+//! returns true if the file maybe is able to be loaded by this class
+//! based on the file extension (e.g. ".iri")
+bool CImageLoaderIRI::isALoadableFileExtension(const io::path &filename) const
+{
+	return core::hasFileExtension(filename, "iri");
+}
+
+//! returns true if the file maybe is able to be loaded by this class
+bool CImageLoaderIRI::isALoadableFileFormat(io::IReadFile *file) const
+{
+	c8 magic[4];
+	return file && file->read(magic, 4) == 4 && memcmp(magic, IRI_MAGIC, 4) == 0;
+}
+
+//! Reads and checks the header and the path of the source file
+bool CImageLoaderIRI::readHeader(io::IReadFile *file, SIRIHeader &header, io::path &sourcePath)
+{
+	// the files are only read on the machine which wrote them, a different
+	// byte order fails on the version
+	if (file->read(&header, sizeof(SIRIHeader)) != sizeof(SIRIHeader) ||
+			memcmp(header.Magic, IRI_MAGIC, 4) != 0 || header.Version != IRI_VERSION)
+		return false;
+
+	if (header.SourcePathSize > IRI_MAX_SOURCE_PATH || header.DataOffset < sizeof(SIRIHeader) + header.SourcePathSize)
+		return false;
+
+	c8 path[IRI_MAX_SOURCE_PATH + 1];
+	if (file->read(path, header.SourcePathSize) != header.SourcePathSize)
+		return false;
+	path[header.SourcePathSize] = 0;
+	sourcePath = path;
+	return true;
+}
+
+//! creates a surface from the file
+IImage *CImageLoaderIRI::loadImage(io::IReadFile *file) const
+{
+	SIRIHeader header;
+	io::path sourcePath;
+	if (!readHeader(file, header, sourcePath)) {
+		os::Printer::log("Invalid decoded image file", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	const ECOLOR_FORMAT format = (ECOLOR_FORMAT)header.ColorFormat;
+	if (format >= ECF_UNKNOWN || !IImage::getBitsPerPixelFromFormat(format) ||
+			!checkImageDimensions(header.Width, header.Height) ||
+			header.Pitch != IImage::getBitsPerPixelFromFormat(format) / 8 * header.Width) {
+		os::Printer::log("Unsupported image in decoded image file", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	const core::dimension2d<u32> dim(header.Width, header.Height);
+	const u32 size = IImage::getDataSizeFromFormat(format, header.Width, header.Height);
+
+	// pixels of files in memory are used from there
+	const c8 *mapped = 0;
+	const io::EREAD_FILE_TYPE type = file->getType();
+	if ((type == io::ERFT_MEMORY_READ_FILE || type == io::ERFT_MAPPED_READ_FILE) &&
+			header.DataOffset + header.DataSize <= (u64)file->getSize())
+		mapped = static_cast<const c8 *>(static_cast<io::IMemoryReadFile *>(file)->getBuffer()) + header.DataOffset;
+
+	IImage *image = 0;
+	bool complete = false;
+	if (header.Compression == 0 && header.DataSize == size) {
+		if (mapped) {
+			// copied, mappings are read only but images may be changed
+			image = new CImage(format, dim, const_cast<c8 *>(mapped), false);
+			complete = true;
+		} else {
+			image = new CImage(format, dim);
+			complete = file->seek(header.DataOffset) && file->read(image->getData(), size) == size;
+		}
+	}
+#ifdef _IRR_COMPILE_WITH_LZ4_
+	else if (header.Compression == 1 && header.DataSize <= (u64)LZ4_compressBound(size)) {
+		image = new CImage(format, dim);
+		const u32 compressedSize = (u32)header.DataSize;
+		if (mapped) {
+			complete = LZ4_decompress_safe(mapped, (c8 *)image->getData(), compressedSize, size) == (int)size;
+		} else if (file->seek(header.DataOffset)) {
+			c8 *compressed = new c8[compressedSize];
+			complete = file->read(compressed, compressedSize) == compressedSize &&
+					   LZ4_decompress_safe(compressed, (c8 *)image->getData(), compressedSize, size) == (int)size;
+			delete[] compressed;
+		}
+	}
+#endif
+
+	if (!complete) {
+		os::Printer::log("Could not read pixels of decoded image file", file->getFileName(), ELL_ERROR);
+		if (image)
+			image->drop();
+		return 0;
+	}
+
+	return image;
+}
+
+//! creates a loader which is able to load decoded images of the image cache
+IImageLoader *createImageLoaderIRI()
+{
+	return new CImageLoaderIRI();
+}
+
+} // end namespace video
+} // end namespace irr
@@ -0,0 +1,73 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "IImageLoader.h"
+
+namespace irr
+{
+namespace video
+{
+
+// byte-align structures
+#include "irrpack.h"
+
+//! Header of a decoded image as written by the image cache
+/** The header is followed by the path of the source file and the pixels,
+which start at DataOffset, a multiple of 64. Pixels of memory mapped
+files are copied or decompressed right from the mapping. The struct is
+also used by CImageCache for writing. */
+struct SIRIHeader
+{
+	c8 Magic[4];
+	u32 Version;
+	u32 ColorFormat;
+	u32 Width;
+	u32 Height;
+	u32 Pitch;
+	//! size and modification time of the source file, the time in
+	//! nanoseconds where the file system has them
+	u64 SourceSize;
+	u64 SourceTime;
+	u32 SourcePathSize;
+	u32 DataOffset;
+	//! size of the pixels in the file
+	u64 DataSize;
+	//! 0 for uncompressed pixels, 1 for LZ4
+	u32 Compression;
+	//! format the image was decoded to, ECF_UNKNOWN for the format of
+	//! the source
+	u32 RequestedFormat;
+} PACK_STRUCT;
+
+// Default alignment
+#include "irrunpack.h"
+
+const c8 IRI_MAGIC[4] = {'I', 'R', 'I', 'C'};
+const u32 IRI_VERSION = 2;
+//! longest path of a source file the header may hold
+const u32 IRI_MAX_SOURCE_PATH = 4096;
+
+/*!
+	Surface Loader for decoded images stored by the image cache
+*/
+class CImageLoaderIRI : public IImageLoader
+{
+public:
+	//! returns true if the file maybe is able to be loaded by this class
+	//! based on the file extension (e.g. ".iri")
+	bool isALoadableFileExtension(const io::path &filename) const override;
+
+	//! returns true if the file maybe is able to be loaded by this class
+	bool isALoadableFileFormat(io::IReadFile *file) const override;
+
+	//! creates a surface from the file
+	IImage *loadImage(io::IReadFile *file) const override;
+
+	//! Reads and checks the header and the path of the source file
+	static bool readHeader(io::IReadFile *file, SIRIHeader &header, io::path &sourcePath);
+};
+
+} // end namespace video
+} // end namespace irr
@@ -111,6 +111,31 @@ bool CImageLoaderJPG::isALoadableFileFormat(io::IReadFile *file) const
 
 //! creates a surface from the file
 IImage *CImageLoaderJPG::loadImage(io::IReadFile *file) const
+{
+	return loadScaledImage(file, core::dimension2du(0, 0));
+}
+
+//! largest power of two up to 8 the image can be reduced by, while it still
+//! covers maxSize when scaled to fit into it
+static u32 getScaleDenominator(u32 width, u32 height, const core::dimension2du &maxSize)
+{
+	f64 fit = 1.0;
+	if (maxSize.Width)
+		fit = core::min_(fit, (f64)maxSize.Width / width);
+	if (maxSize.Height)
+		fit = core::min_(fit, (f64)maxSize.Height / height);
+
+	for (u32 denom = 8; denom > 1; denom /= 2) {
+		if ((width + denom - 1) / denom >= width * fit &&
+				(height + denom - 1) / denom >= height * fit)
+			return denom;
+	}
+	return 1;
+}
+
+//! creates a surface decoded at 1/2, 1/4 or 1/8 of the size if that
+//! still covers maxSize
+IImage *CImageLoaderJPG::loadScaledImage(io::IReadFile *file, const core::dimension2du &maxSize) const
 {
 	if (!file)
 		return 0;
@@ -192,13 +217,18 @@ IImage *CImageLoaderJPG::loadImage(io::IReadFile *file) const
 	if (!checkImageDimensions(cinfo.image_width, cinfo.image_height))
 		longjmp(jerr.setjmp_buffer, 1);
 
+	// libjpeg scales in the DCT, skipping most of the work for the pixels
+	// which aren't needed
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = getScaleDenominator(cinfo.image_width, cinfo.image_height, maxSize);
+
 	// Start decompressor
 	jpeg_start_decompress(&cinfo);
 
 	// Get image data
-	u32 rowspan = cinfo.image_width * cinfo.out_color_components;
-	u32 width = cinfo.image_width;
-	u32 height = cinfo.image_height;
+	u32 rowspan = cinfo.output_width * cinfo.out_color_components;
+	u32 width = cinfo.output_width;
+	u32 height = cinfo.output_height;
 
 	// Allocate memory for buffer
 	u8 *output = new u8[rowspan * height];
@@ -35,6 +35,10 @@ public:
 	//! creates a surface from the file
 	IImage *loadImage(io::IReadFile *file) const override;
 
+	//! creates a surface decoded at 1/2, 1/4 or 1/8 of the size if that
+	//! still covers maxSize
+	IImage *loadScaledImage(io::IReadFile *file, const core::dimension2du &maxSize) const override;
+
 private:
 	// several methods used via function pointers by jpeglib
 
@@ -7,6 +7,7 @@
 #include <png.h> // use system lib png
 
 #include "CImage.h"
+#include "CColorConverter.h"
 #include "CReadFile.h"
 #include "os.h"
 
@@ -67,23 +68,40 @@ bool CImageLoaderPng::isALoadableFileFormat(io::IReadFile *file) const
 // load in the image data
 IImage *CImageLoaderPng::loadImage(io::IReadFile *file) const
 {
-	if (!file)
-		return 0;
+	CImageRowTarget target;
+	if (loadImageRows(file, ECF_UNKNOWN, false, &target))
+		return target.Image;
+
+	if (target.Image)
+		target.Image->drop();
+	return 0;
+}
+
+//! decodes the file row by row into memory of the caller
+bool CImageLoaderPng::loadImageRows(io::IReadFile *file, ECOLOR_FORMAT format, bool swapRedBlue, IImageRowTarget *target) const
+{
+	if (!file || !target)
+		return false;
 
-	// Used to point to image rows
-	u8 **RowPointers = 0;
+	if (format != ECF_UNKNOWN && format != ECF_A8R8G8B8 && format != ECF_R8G8B8) {
+		os::Printer::log("LOAD PNG: can't decode into color format", ColorFormatNames[format < ECF_UNKNOWN ? format : ECF_UNKNOWN], ELL_ERROR);
+		return false;
+	}
+
+	// Used for converting rows, volatile as it changes after setjmp()
+	u8 *volatile Row = 0;
 
 	png_byte buffer[8];
 	// Read the first few bytes of the PNG file
 	if (file->read(buffer, 8) != 8) {
 		os::Printer::log("LOAD PNG: can't read file (filesize < 8)", file->getFileName(), ELL_ERROR);
-		return 0;
+		return false;
 	}
 
 	// Check if it really is a PNG file
 	if (png_sig_cmp(buffer, 0, 8)) {
 		os::Printer::log("LOAD PNG: not really a png (wrong signature)", file->getFileName(), ELL_ERROR);
-		return 0;
+		return false;
 	}
 
 	// Allocate the png read struct
@@ -91,7 +109,7 @@ IImage *CImageLoaderPng::loadImage(io::IReadFile *file) const
 			NULL, (png_error_ptr)png_cpexcept_error, (png_error_ptr)png_cpexcept_warn);
 	if (!png_ptr) {
 		os::Printer::log("LOAD PNG: Internal PNG create read struct failure", file->getFileName(), ELL_ERROR);
-		return 0;
+		return false;
 	}
 
 	// Allocate the png info struct
@@ -99,14 +117,15 @@ IImage *CImageLoaderPng::loadImage(io::IReadFile *file) const
 	if (!info_ptr) {
 		os::Printer::log("LOAD PNG: Internal PNG create info struct failure", file->getFileName(), ELL_ERROR);
 		png_destroy_read_struct(&png_ptr, NULL, NULL);
-		return 0;
+		return false;
 	}
 
 	// for proper error handling
 	if (setjmp(png_jmpbuf(png_ptr))) {
 		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-		delete[] RowPointers;
-		return 0;
+		delete[] Row;
+		Row = 0;
+		return false;
 	}
 
 	// changed by zola so we don't need to have public FILE pointers
@@ -146,7 +165,8 @@ IImage *CImageLoaderPng::loadImage(io::IReadFile *file) const
 			png_set_packing(png_ptr);
 	}
 
-	if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
+	const bool hasTransparency = png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS);
+	if (hasTransparency)
 		png_set_tRNS_to_alpha(png_ptr);
 
 	// Convert high bit colors to 8 bit colors
@@ -170,73 +190,77 @@ IImage *CImageLoaderPng::loadImage(io::IReadFile *file) const
 			png_set_gamma(png_ptr, screen_gamma, 0.45455);
 	}
 
-	// Update the changes in between, as we need to get the new color type
-	// for proper processing of the RGBA type
-	png_read_update_info(png_ptr, info_ptr);
-	{
-		// Use temporary variables to avoid passing cast pointers
-		png_uint_32 w, h;
-		// Extract info
-		png_get_IHDR(png_ptr, info_ptr,
-				&w, &h,
-				&BitDepth, &ColorType, NULL, NULL, NULL);
-		Width = w;
-		Height = h;
-	}
-
-	// Convert RGBA to BGRA
-	if (ColorType == PNG_COLOR_TYPE_RGB_ALPHA) {
+	// The rows are RGB or RGBA now, libpng converts them to the requested
+	// format while decoding. ECF_A8R8G8B8 is BGRA in memory on little
+	// endian machines.
+	const bool hasAlpha = (ColorType & PNG_COLOR_MASK_ALPHA) || hasTransparency;
+	if (format == ECF_UNKNOWN)
+		format = hasAlpha ? ECF_A8R8G8B8 : ECF_R8G8B8;
+
+	// Opaque rows are expanded by the color converter, which is quicker than
+	// libpng's filler. The passes of interlaced images have to be combined
+	// in the rows of the target though.
+	const bool interlaced = png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE;
+	void (*expand)(const void *, s32, void *) = 0;
+	if (format == ECF_A8R8G8B8 && !hasAlpha && !interlaced)
+		expand = swapRedBlue ? CColorConverter::convert_B8G8R8toA8R8G8B8 : CColorConverter::convert_R8G8B8toA8R8G8B8;
+
+	if (expand) {
+		// RGB rows as they are
+	} else if (format == ECF_A8R8G8B8) {
 #ifdef __BIG_ENDIAN__
-		png_set_swap_alpha(png_ptr);
+		if (hasAlpha)
+			png_set_swap_alpha(png_ptr);
+		else
+			png_set_filler(png_ptr, 0xFF, PNG_FILLER_BEFORE);
+		if (swapRedBlue)
+			png_set_bgr(png_ptr);
 #else
-		png_set_bgr(png_ptr);
+		if (!hasAlpha)
+			png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+		if (!swapRedBlue)
+			png_set_bgr(png_ptr);
 #endif
+	} else {
+		if (hasAlpha)
+			png_set_strip_alpha(png_ptr);
+		if (swapRedBlue)
+			png_set_bgr(png_ptr);
 	}
 
-	// Create the image structure to be filled by png data
-	video::IImage *image = 0;
-	if (ColorType == PNG_COLOR_TYPE_RGB_ALPHA)
-		image = new CImage(ECF_A8R8G8B8, core::dimension2d<u32>(Width, Height));
-	else
-		image = new CImage(ECF_R8G8B8, core::dimension2d<u32>(Width, Height));
-	if (!image) {
-		os::Printer::log("LOAD PNG: Internal PNG create image struct failure", file->getFileName(), ELL_ERROR);
-		png_destroy_read_struct(&png_ptr, NULL, NULL);
-		return 0;
-	}
-
-	// Create array of pointers to rows in image data
-	RowPointers = new png_bytep[Height];
-	if (!RowPointers) {
-		os::Printer::log("LOAD PNG: Internal PNG create row pointers failure", file->getFileName(), ELL_ERROR);
-		png_destroy_read_struct(&png_ptr, NULL, NULL);
-		delete image;
-		return 0;
-	}
-
-	// Fill array of pointers to rows in image data
-	unsigned char *data = (unsigned char *)image->getData();
-	for (u32 i = 0; i < Height; ++i) {
-		RowPointers[i] = data;
-		data += image->getPitch();
-	}
+	// the transformations of interlaced images work on the rows of all passes
+	const int passes = png_set_interlace_handling(png_ptr);
+	png_read_update_info(png_ptr, info_ptr);
 
-	// for proper error handling
-	if (setjmp(png_jmpbuf(png_ptr))) {
+	u32 pitch = 0;
+	u8 *rows = (u8 *)target->getRows(core::dimension2du(Width, Height), format, pitch);
+	if (!rows) {
 		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-		delete[] RowPointers;
-		delete image;
-		return 0;
+		return false;
 	}
 
-	// Read data using the library function that handles all transformations including interlacing
-	png_read_image(png_ptr, RowPointers);
+	if (expand) {
+		// one row in between, which stays in the cache
+		Row = new u8[Width * 3];
+		for (u32 y = 0; y < Height; ++y) {
+			png_read_row(png_ptr, Row, NULL);
+			expand(Row, Width, rows + y * pitch);
+		}
+		delete[] Row;
+		Row = 0;
+	} else {
+		// Each row goes straight to the memory of the target, passes of
+		// interlaced images add their pixels to the rows decoded before.
+		for (int pass = 0; pass < passes; ++pass) {
+			for (u32 y = 0; y < Height; ++y)
+				png_read_row(png_ptr, rows + y * pitch, NULL);
+		}
+	}
 
 	png_read_end(png_ptr, NULL);
-	delete[] RowPointers;
 	png_destroy_read_struct(&png_ptr, &info_ptr, 0); // Clean up memory
 
-	return image;
+	return true;
 }
 
 IImageLoader *createImageLoaderPNG()
@@ -28,6 +28,9 @@ public:
 
 	//! creates a surface from the file
 	IImage *loadImage(io::IReadFile *file) const override;
+
+	//! decodes the file row by row into memory of the caller
+	bool loadImageRows(io::IReadFile *file, ECOLOR_FORMAT format, bool swapRedBlue, IImageRowTarget *target) const override;
 };
 
 } // end namespace video
@@ -0,0 +1,443 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInflateReadFile.h"
+#include "IMemoryReadFile.h"
+#include "irrMath.h"
+#include "os.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace irr
+{
+namespace io
+{
+
+namespace
+{
+// deflated bytes read from the file at once
+const long INPUT_SIZE = 16 * 1024;
+// inflated bytes kept in memory
+const long WINDOW_SIZE = 64 * 1024;
+// how far seeking back stays cheap
+const long REWIND_SIZE = 16 * 1024;
+}
+
+bool CInflateReadFile::isMethodSupported(u16 method)
+{
+	switch (method) {
+	case 8: // deflate
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	case 14: // LZMA
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+	case 93: // zstd
+#endif
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool CInflateReadFile::inflateBuffer(const u8 *in, long inSize, u8 *out, long outSize)
+{
+#ifdef _IRR_COMPILE_WITH_LIBDEFLATE_
+	libdeflate_decompressor *decompressor = libdeflate_alloc_decompressor();
+	if (!decompressor)
+		return false;
+
+	size_t written = 0;
+	const libdeflate_result result = libdeflate_deflate_decompress(decompressor,
+			in, (size_t)inSize, out, (size_t)outSize, &written);
+	libdeflate_free_decompressor(decompressor);
+	return result == LIBDEFLATE_SUCCESS && written == (size_t)outSize;
+#else
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	stream.next_in = (Bytef *)in;
+	stream.avail_in = (uInt)inSize;
+	stream.next_out = out;
+	stream.avail_out = (uInt)outSize;
+
+	// wbits < 0 indicates no zlib header inside the data
+	if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+		return false;
+	const int err = inflate(&stream, Z_FINISH);
+	inflateEnd(&stream);
+	return (err == Z_STREAM_END || err == Z_BUF_ERROR) && !stream.avail_out;
+#endif
+}
+
+CInflateReadFile::CInflateReadFile(IReadFile *alreadyOpenedFile, long pos, long compressedSize,
+		long size, const io::path &name, u16 method) :
+		Filename(name), File(alreadyOpenedFile), CompressedStart(pos), CompressedSize(compressedSize),
+		CompressedPos(0), Size(size), Pos(0), Method(method), NextIn(0), AvailIn(0),
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+		Zstd(0),
+#endif
+		StreamOpen(false), StreamEnded(false), Failed(false),
+		Input(0), MappedInput(0), Window(0), WindowStart(0), WindowFill(0), Data(0)
+{
+#ifdef _DEBUG
+	setDebugName("CInflateReadFile");
+#endif
+
+	File->grab();
+
+	// files in memory are inflated in place
+	const EREAD_FILE_TYPE type = File->getType();
+	if ((type == ERFT_MEMORY_READ_FILE || type == ERFT_MAPPED_READ_FILE) &&
+			pos >= 0 && pos + compressedSize <= File->getSize())
+		MappedInput = static_cast<const u8 *>(static_cast<IMemoryReadFile *>(File)->getBuffer()) + pos;
+	else
+		Input = new u8[INPUT_SIZE];
+
+	Window = new u8[WINDOW_SIZE];
+	restart();
+}
+
+CInflateReadFile::~CInflateReadFile()
+{
+	closeStream();
+
+	delete[] Input;
+	delete[] Window;
+	delete[] Data;
+	File->drop();
+}
+
+//! returns how much was read
+size_t CInflateReadFile::read(void *buffer, size_t sizeToRead)
+{
+	if (Pos >= Size)
+		return 0;
+
+	u8 *out = static_cast<u8 *>(buffer);
+	const long toRead = (long)core::min_(sizeToRead, (size_t)(Size - Pos));
+
+	if (!Data && Pos < WindowStart && !inflateAll())
+		return 0;
+
+	if (Data) {
+		memcpy(out, Data + Pos, toRead);
+		Pos += toRead;
+		return toRead;
+	}
+
+	// reading everything before the stream was touched is done at once,
+	// the stream stays at the start for reading again
+	if (Method == 8 && toRead == Size && !WindowStart && !WindowFill && inflateWhole(out)) {
+		Pos = Size;
+		return Size;
+	}
+
+	long done = 0;
+	while (done < toRead) {
+		const long windowEnd = WindowStart + WindowFill;
+		if (Pos < windowEnd) {
+			const long amount = core::min_(toRead - done, windowEnd - Pos);
+			memcpy(out + done, Window + (Pos - WindowStart), amount);
+			done += amount;
+			Pos += amount;
+			continue;
+		}
+
+		if (Pos == windowEnd && toRead - done >= WINDOW_SIZE) {
+			// large reads are inflated into the destination right away
+			const long amount = inflateInto(out + done, toRead - done);
+			if (!amount)
+				break;
+
+			const long keep = core::min_(amount, REWIND_SIZE);
+			memcpy(Window, out + done + amount - keep, keep);
+			WindowStart = Pos + amount - keep;
+			WindowFill = keep;
+
+			done += amount;
+			Pos += amount;
+			continue;
+		}
+
+		// fill the window, this also skips data after seeking forward
+		if (WindowFill == WINDOW_SIZE)
+			slideWindow();
+
+		const long amount = inflateInto(Window + WindowFill, WINDOW_SIZE - WindowFill);
+		if (!amount)
+			break;
+		WindowFill += amount;
+	}
+
+	return done;
+}
+
+//! changes position in file, returns true if successful
+bool CInflateReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+		finalPos += Pos;
+
+	if (finalPos < 0 || finalPos > Size)
+		return false;
+
+	Pos = finalPos;
+	return true;
+}
+
+//! returns size of file
+long CInflateReadFile::getSize() const
+{
+	return Size;
+}
+
+//! returns where in the file we are.
+long CInflateReadFile::getPos() const
+{
+	return Pos;
+}
+
+//! returns name of file
+const io::path &CInflateReadFile::getFileName() const
+{
+	return Filename;
+}
+
+long CInflateReadFile::inflateInto(u8 *buffer, long size)
+{
+	long done = 0;
+	while (done < size && !StreamEnded && !Failed) {
+		if (!AvailIn)
+			readInput();
+
+		const long availBefore = AvailIn;
+		long written = 0;
+		const s32 result = decode(buffer + done, size - done, written);
+		done += written;
+
+		if (result < 0) {
+			os::Printer::log("Error decompressing", Filename, ELL_ERROR);
+			Failed = true;
+		} else if (result == 0) {
+			StreamEnded = true;
+		} else if (!written && AvailIn == availBefore) {
+			// the data ends early
+			break;
+		}
+	}
+
+	return done;
+}
+
+bool CInflateReadFile::readInput()
+{
+	if (MappedInput || CompressedPos >= CompressedSize)
+		return false;
+
+	const long chunk = core::min_(INPUT_SIZE, CompressedSize - CompressedPos);
+	File->seek(CompressedStart + CompressedPos);
+	const long amount = (long)File->read(Input, chunk);
+	if (amount <= 0)
+		return false;
+
+	CompressedPos += amount;
+	NextIn = Input;
+	AvailIn = amount;
+	return true;
+}
+
+s32 CInflateReadFile::decode(u8 *buffer, long size, long &written)
+{
+	switch (Method) {
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	case 14: {
+		Lzma.next_in = NextIn;
+		Lzma.avail_in = AvailIn;
+		Lzma.next_out = buffer;
+		Lzma.avail_out = size;
+		const lzma_ret ret = lzma_code(&Lzma, LZMA_RUN);
+		written = size - (long)Lzma.avail_out;
+		NextIn = Lzma.next_in;
+		AvailIn = (long)Lzma.avail_in;
+
+		if (ret == LZMA_STREAM_END)
+			return 0;
+		return (ret == LZMA_OK || ret == LZMA_BUF_ERROR) ? 1 : -1;
+	}
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+	case 93: {
+		ZSTD_inBuffer in = {NextIn, (size_t)AvailIn, 0};
+		ZSTD_outBuffer out = {buffer, (size_t)size, 0};
+		const size_t ret = ZSTD_decompressStream(Zstd, &out, &in);
+		if (ZSTD_isError(ret))
+			return -1;
+
+		written = (long)out.pos;
+		NextIn += in.pos;
+		AvailIn -= (long)in.pos;
+
+		// another frame might follow in the remaining input
+		if (ret == 0 && !AvailIn && (MappedInput || CompressedPos >= CompressedSize))
+			return 0;
+		return 1;
+	}
+#endif
+	default: {
+		Stream.next_in = (Bytef *)NextIn;
+		Stream.avail_in = (uInt)AvailIn;
+		Stream.next_out = buffer;
+		Stream.avail_out = (uInt)size;
+		const int err = inflate(&Stream, Z_NO_FLUSH);
+		written = size - (long)Stream.avail_out;
+		NextIn = Stream.next_in;
+		AvailIn = (long)Stream.avail_in;
+
+		if (err == Z_STREAM_END)
+			return 0;
+		// Z_BUF_ERROR only means no progress was possible
+		return (err == Z_OK || err == Z_BUF_ERROR) ? 1 : -1;
+	}
+	}
+}
+
+void CInflateReadFile::slideWindow()
+{
+	const long keep = core::min_(WindowFill, REWIND_SIZE);
+	memmove(Window, Window + WindowFill - keep, keep);
+	WindowStart += WindowFill - keep;
+	WindowFill = keep;
+}
+
+bool CInflateReadFile::inflateAll()
+{
+	Data = new u8[Size];
+	if (!(Method == 8 && inflateWhole(Data)) &&
+			(!restart() || inflateInto(Data, Size) != Size)) {
+		delete[] Data;
+		Data = 0;
+		restart();
+		return false;
+	}
+
+	// everything needed from now on is in Data
+	closeStream();
+	delete[] Input;
+	Input = 0;
+	delete[] Window;
+	Window = 0;
+	return true;
+}
+
+bool CInflateReadFile::inflateWhole(u8 *buffer)
+{
+	if (MappedInput)
+		return inflateBuffer(MappedInput, CompressedSize, buffer, Size);
+
+	u8 *input = new u8[CompressedSize];
+	File->seek(CompressedStart);
+	const bool inflated = (long)File->read(input, CompressedSize) == CompressedSize &&
+						  inflateBuffer(input, CompressedSize, buffer, Size);
+	delete[] input;
+	return inflated;
+}
+
+bool CInflateReadFile::restart()
+{
+	closeStream();
+
+	CompressedPos = 0;
+	WindowStart = 0;
+	WindowFill = 0;
+	NextIn = 0;
+	AvailIn = 0;
+
+	if (MappedInput) {
+		NextIn = MappedInput;
+		AvailIn = CompressedSize;
+		CompressedPos = CompressedSize;
+	} else {
+		readInput();
+	}
+
+	StreamOpen = openStream();
+	StreamEnded = false;
+	Failed = !StreamOpen;
+	if (Failed)
+		os::Printer::log("Could not initialize decompression for", Filename, ELL_ERROR);
+	return StreamOpen;
+}
+
+bool CInflateReadFile::openStream()
+{
+	switch (Method) {
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	case 14: {
+		// zip stores the LZMA SDK version and the size of the properties
+		// in front of the properties and the raw LZMA stream
+		if (AvailIn < 4)
+			return false;
+		const u32 propertiesSize = NextIn[2] | (NextIn[3] << 8);
+		if (AvailIn < 4 + (long)propertiesSize)
+			return false;
+
+		lzma_filter filters[2];
+		filters[0].id = LZMA_FILTER_LZMA1;
+		filters[0].options = 0;
+		filters[1].id = LZMA_VLI_UNKNOWN;
+		filters[1].options = 0;
+		if (lzma_properties_decode(&filters[0], 0, NextIn + 4, propertiesSize) != LZMA_OK)
+			return false;
+
+		NextIn += 4 + propertiesSize;
+		AvailIn -= 4 + propertiesSize;
+
+		memset(&Lzma, 0, sizeof(Lzma));
+		const lzma_ret ret = lzma_raw_decoder(&Lzma, filters);
+		free(filters[0].options);
+		return ret == LZMA_OK;
+	}
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+	case 93:
+		Zstd = ZSTD_createDStream();
+		if (Zstd && !ZSTD_isError(ZSTD_initDStream(Zstd)))
+			return true;
+		ZSTD_freeDStream(Zstd);
+		Zstd = 0;
+		return false;
+#endif
+	case 8:
+		// wbits < 0 indicates no zlib header inside the data
+		memset(&Stream, 0, sizeof(Stream));
+		return inflateInit2(&Stream, -MAX_WBITS) == Z_OK;
+	default:
+		return false;
+	}
+}
+
+void CInflateReadFile::closeStream()
+{
+	if (!StreamOpen)
+		return;
+
+	switch (Method) {
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	case 14:
+		lzma_end(&Lzma);
+		break;
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+	case 93:
+		ZSTD_freeDStream(Zstd);
+		Zstd = 0;
+		break;
+#endif
+	default:
+		inflateEnd(&Stream);
+		break;
+	}
+	StreamOpen = false;
+}
+
+} // end namespace io
+} // end namespace irr
@@ -0,0 +1,153 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "IReadFile.h"
+#include "irrString.h"
+#include <zlib.h>
+#ifdef _IRR_COMPILE_WITH_LZMA_
+#include <lzma.h>
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+#include <zstd.h>
+#endif
+#ifdef _IRR_COMPILE_WITH_LIBDEFLATE_
+#include <libdeflate.h>
+#endif
+
+namespace irr
+{
+
+namespace io
+{
+
+/*!
+	Class for reading compressed data inside of another file, like a zip
+	archive entry. The data is inflated in chunks while reading, so looking
+	at the header of a large file doesn't decompress all of it. Reading
+	forward and seeking back a little are cheap. Seeking back further
+	inflates the whole file into memory once and serves it from there.
+	Besides deflate, LZMA and zstd are supported if they were enabled when
+	building the engine.
+*/
+class CInflateReadFile : public IReadFile
+{
+public:
+	//! Constructor
+	/** \param alreadyOpenedFile File containing the deflated data without zlib header
+	\param pos Start of the deflated data
+	\param compressedSize Size of the deflated data
+	\param size Size of the inflated data
+	\param method Zip compression method of the data, 8 for deflate,
+	14 for LZMA or 93 for zstd */
+	CInflateReadFile(IReadFile *alreadyOpenedFile, long pos, long compressedSize,
+			long size, const io::path &name, u16 method = 8);
+
+	virtual ~CInflateReadFile();
+
+	//! returns how much was read
+	size_t read(void *buffer, size_t sizeToRead) override;
+
+	//! changes position in file, returns true if successful
+	bool seek(long finalPos, bool relativeMovement = false) override;
+
+	//! returns size of file
+	long getSize() const override;
+
+	//! returns where in the file we are.
+	long getPos() const override;
+
+	//! returns name of file
+	const io::path &getFileName() const override;
+
+	//! Get the type of the class implementing this interface
+	EREAD_FILE_TYPE getType() const override
+	{
+		return ERFT_INFLATE_READ_FILE;
+	}
+
+	//! Returns true if reading doesn't touch the file containing the deflated data
+	bool isInputInMemory() const
+	{
+		return MappedInput != 0;
+	}
+
+	//! Returns true if data of this zip compression method can be inflated
+	static bool isMethodSupported(u16 method);
+
+	//! Inflates deflated data without zlib header at once
+	/** Uses libdeflate if the engine was built with it.
+	\return True if exactly outSize bytes were inflated */
+	static bool inflateBuffer(const u8 *in, long inSize, u8 *out, long outSize);
+
+private:
+	//! Inflates up to size bytes into buffer, returns how much was inflated
+	long inflateInto(u8 *buffer, long size);
+
+	//! Reads the next chunk of compressed data, returns false at the end
+	bool readInput();
+
+	//! Runs the decoder once on the available input
+	/** \return 1 if there is more to come, 0 at the end of the data, -1 on errors */
+	s32 decode(u8 *buffer, long size, long &written);
+
+	//! Starts the decoder, the input has to be set up already
+	bool openStream();
+
+	//! Releases the decoder
+	void closeStream();
+
+	//! Makes room in the window, keeping the last bytes for seeking back
+	void slideWindow();
+
+	//! Inflates the whole file into Data, when seeking back out of the window
+	bool inflateAll();
+
+	//! Inflates the whole file into buffer at once, bypassing the stream
+	bool inflateWhole(u8 *buffer);
+
+	//! Starts inflating from the beginning
+	bool restart();
+
+	io::path Filename;
+	IReadFile *File;
+	long CompressedStart;
+	long CompressedSize;
+	//! how much of the deflated data was handed to zlib
+	long CompressedPos;
+	long Size;
+	long Pos;
+	u16 Method;
+
+	//! compressed data the decoder didn't take yet
+	const u8 *NextIn;
+	long AvailIn;
+
+	z_stream Stream;
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	lzma_stream Lzma;
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+	ZSTD_DStream *Zstd;
+#endif
+	bool StreamOpen;
+	bool StreamEnded;
+	bool Failed;
+
+	//! deflated data when the file isn't in memory
+	u8 *Input;
+	//! deflated data when the file is in memory
+	const u8 *MappedInput;
+
+	//! the latest inflated bytes, starting at WindowStart
+	u8 *Window;
+	long WindowStart;
+	long WindowFill;
+
+	//! all of the inflated data, after seeking back out of the window
+	u8 *Data;
+};
+
+} // end namespace io
+} // end namespace irr
@@ -153,7 +153,7 @@ CIrrDeviceLinux::CIrrDeviceLinux(const SIrrlichtCreationParameters &param) :
 	XInitThreads();
 
 	// create window
-	if (CreationParams.DriverType != video::EDT_NULL) {
+	if (!isWindowlessDriver()) {
 		// create the window, only if we do not use the null device
 		if (!createWindow())
 			return;
@@ -165,7 +165,7 @@ CIrrDeviceLinux::CIrrDeviceLinux(const SIrrlichtCreationParameters &param) :
 	}
 
 	// create cursor control
-	CursorControl = new CCursorControl(this, CreationParams.DriverType == video::EDT_NULL);
+	CursorControl = new CCursorControl(this, isWindowlessDriver());
 
 	// create driver
 	createDriver();
@@ -280,7 +280,7 @@ bool CIrrDeviceLinux::switchToFullscreen()
 void CIrrDeviceLinux::setupTopLevelXorgWindow()
 {
 #ifdef _IRR_COMPILE_WITH_X11_
-	if (CreationParams.DriverType == video::EDT_NULL)
+	if (isWindowlessDriver())
 		return; // no display and window
 
 	os::Printer::log("Configuring X11-specific top level window properties", ELL_DEBUG);
@@ -604,6 +604,9 @@ void CIrrDeviceLinux::createDriver()
 	case video::EDT_NULL:
 		VideoDriver = video::createNullDriver(FileSystem, CreationParams.WindowSize);
 		break;
+	case video::EDT_SOFTWARE:
+		VideoDriver = video::createSoftwareDriver(FileSystem, CreationParams.WindowSize);
+		break;
 	default:
 		os::Printer::log("Unable to create video driver of unknown type.", ELL_ERROR);
 		break;
@@ -611,6 +614,9 @@ void CIrrDeviceLinux::createDriver()
 	case video::EDT_NULL:
 		VideoDriver = video::createNullDriver(FileSystem, CreationParams.WindowSize);
 		break;
+	case video::EDT_SOFTWARE:
+		VideoDriver = video::createSoftwareDriver(FileSystem, CreationParams.WindowSize);
+		break;
 	default:
 		os::Printer::log("No X11 support compiled in. Only Null driver available.", ELL_ERROR);
 		break;
@@ -732,7 +738,7 @@ bool CIrrDeviceLinux::run()
 	if (CursorControl)
 		static_cast<CCursorControl *>(CursorControl)->update();
 
-	if ((CreationParams.DriverType != video::EDT_NULL) && XDisplay) {
+	if (!isWindowlessDriver() && XDisplay) {
 		SEvent irrevent;
 		irrevent.MouseInput.ButtonStates = 0xffffffff;
 
@@ -1135,7 +1141,7 @@ void CIrrDeviceLinux::sleep(u32 timeMs, bool pauseTimer = false)
 void CIrrDeviceLinux::setWindowCaption(const wchar_t *text)
 {
 #ifdef _IRR_COMPILE_WITH_X11_
-	if (CreationParams.DriverType == video::EDT_NULL)
+	if (isWindowlessDriver())
 		return;
 
 	XTextProperty txt;
@@ -1151,7 +1157,7 @@ void CIrrDeviceLinux::setWindowCaption(const wchar_t *text)
 //! Sets the window icon.
 bool CIrrDeviceLinux::setWindowIcon(const video::IImage *img)
 {
-	if (CreationParams.DriverType == video::EDT_NULL)
+	if (isWindowlessDriver())
 		return false; // no display and window
 
 	u32 height = img->getDimension().Height;
@@ -1236,7 +1242,7 @@ video::ECOLOR_FORMAT CIrrDeviceLinux::getColorFormat() const
 void CIrrDeviceLinux::setResizable(bool resize)
 {
 #ifdef _IRR_COMPILE_WITH_X11_
-	if (CreationParams.DriverType == video::EDT_NULL || CreationParams.Fullscreen)
+	if (isWindowlessDriver() || CreationParams.Fullscreen)
 		return;
 
 	if (!resize) {
@@ -1258,7 +1264,7 @@ void CIrrDeviceLinux::setResizable(bool resize)
 void CIrrDeviceLinux::setWindowSize(const irr::core::dimension2d<u32> &size)
 {
 #ifdef _IRR_COMPILE_WITH_X11_
-	if (CreationParams.DriverType == video::EDT_NULL || CreationParams.Fullscreen)
+	if (isWindowlessDriver() || CreationParams.Fullscreen)
 		return;
 
 	XWindowChanges values;
@@ -1839,7 +1845,7 @@ Bool PredicateIsEventType(Display *display, XEvent *event, XPointer arg)
 void CIrrDeviceLinux::clearSystemMessages()
 {
 #ifdef _IRR_COMPILE_WITH_X11_
-	if (CreationParams.DriverType != video::EDT_NULL) {
+	if (!isWindowlessDriver()) {
 		XEvent event;
 		int usrArg = ButtonPress;
 		while (XCheckIfEvent(XDisplay, &event, PredicateIsEventType, XPointer(&usrArg)) == True) {
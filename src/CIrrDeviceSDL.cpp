@@ -260,7 +260,7 @@ CIrrDeviceSDL::CIrrDeviceSDL(const SIrrlichtCreationParameters &param) :
 
 	if (++SDLDeviceInstances == 1) {
 		u32 flags = SDL_INIT_TIMER | SDL_INIT_EVENTS;
-		if (CreationParams.DriverType != video::EDT_NULL)
+		if (!isWindowlessDriver())
 			flags |= SDL_INIT_VIDEO;
 #if defined(_IRR_COMPILE_WITH_JOYSTICK_EVENTS_)
 		flags |= SDL_INIT_JOYSTICK;
@@ -282,7 +282,7 @@ CIrrDeviceSDL::CIrrDeviceSDL(const SIrrlichtCreationParameters &param) :
 	createKeyMap();
 
 	// create window
-	if (CreationParams.DriverType != video::EDT_NULL) {
+	if (!isWindowlessDriver()) {
 		if (!createWindow()) {
 			Close = true;
 			return;
@@ -519,6 +519,10 @@ void CIrrDeviceSDL::createDriver()
 		VideoDriver = video::createNullDriver(FileSystem, CreationParams.WindowSize);
 		return;
 	}
+	if (CreationParams.DriverType == video::EDT_SOFTWARE) {
+		VideoDriver = video::createSoftwareDriver(FileSystem, CreationParams.WindowSize);
+		return;
+	}
 
 	ContextManager = new video::CSDLManager(this);
 	switch (CreationParams.DriverType) {
@@ -34,6 +34,7 @@ IFileSystem *createFileSystem();
 namespace video
 {
 IVideoDriver *createNullDriver(io::IFileSystem *io, const core::dimension2d<u32> &screenSize);
+IVideoDriver *createSoftwareDriver(io::IFileSystem *io, const core::dimension2d<u32> &screenSize);
 }
 
 //! Stub for an Irrlicht Device implementation
@@ -171,6 +172,12 @@ protected:
 	//! Checks whether the input device should take input from the IME
 	bool acceptsIME();
 
+	//! Checks whether the driver renders without a window, like the null and software drivers
+	bool isWindowlessDriver() const
+	{
+		return CreationParams.DriverType == video::EDT_NULL || CreationParams.DriverType == video::EDT_SOFTWARE;
+	}
+
 	video::IVideoDriver *VideoDriver;
 	gui::IGUIEnvironment *GUIEnvironment;
 	scene::ISceneManager *SceneManager;
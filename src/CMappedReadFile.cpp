@@ -0,0 +1,146 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMappedReadFile.h"
+#include <cstring>
+#include <climits>
+
+#if (defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_) || defined(_IRR_ANDROID_PLATFORM_))
+#define _IRR_MAPPED_READ_FILE_POSIX_
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+CMappedReadFile::CMappedReadFile(const c8 *buffer, long size, const io::path &fileName, CMappedReadFile *parent) :
+		Buffer(buffer), Size(size), Pos(0), Filename(fileName), Parent(parent), Mapping(0), MappingSize(0)
+{
+#ifdef _DEBUG
+	setDebugName("CMappedReadFile");
+#endif
+
+	if (Parent)
+		Parent->grab();
+}
+
+CMappedReadFile::~CMappedReadFile()
+{
+	if (Parent)
+		Parent->drop();
+#ifdef _IRR_MAPPED_READ_FILE_POSIX_
+	else if (Mapping)
+		munmap(Mapping, MappingSize);
+#endif
+}
+
+//! returns how much was read
+size_t CMappedReadFile::read(void *buffer, size_t sizeToRead)
+{
+	long amount = static_cast<long>(sizeToRead);
+	if (Pos + amount > Size)
+		amount -= Pos + amount - Size;
+
+	if (amount <= 0)
+		return 0;
+
+	memcpy(buffer, Buffer + Pos, amount);
+	Pos += amount;
+	return static_cast<size_t>(amount);
+}
+
+//! changes position in file, returns true if successful
+//! if relativeMovement==true, the pos is changed relative to current pos,
+//! otherwise from begin of file
+bool CMappedReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+		finalPos += Pos;
+
+	if (finalPos < 0 || finalPos > Size)
+		return false;
+
+	Pos = finalPos;
+	return true;
+}
+
+//! returns size of file
+long CMappedReadFile::getSize() const
+{
+	return Size;
+}
+
+//! returns where in the file we are.
+long CMappedReadFile::getPos() const
+{
+	return Pos;
+}
+
+//! returns name of file
+const io::path &CMappedReadFile::getFileName() const
+{
+	return Filename;
+}
+
+IReadFile *CMappedReadFile::createView(long pos, long areaSize, const io::path &fileName)
+{
+	if (pos < 0 || areaSize < 0 || pos + areaSize > Size)
+		return 0;
+
+	// views of views share the file owning the mapping
+	CMappedReadFile *owner = Parent ? Parent : this;
+	return new CMappedReadFile(Buffer + pos, areaSize, fileName, owner);
+}
+
+IReadFile *CMappedReadFile::createMappedReadFile(const io::path &fileName)
+{
+#ifdef _IRR_MAPPED_READ_FILE_POSIX_
+	if (fileName.empty())
+		return 0;
+
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+			info.st_size <= 0 || info.st_size > LONG_MAX) {
+		close(fd);
+		return 0;
+	}
+
+	// Reserve the file size rounded up to full pages plus one page. The
+	// file is mapped over the start of it, the rest stays zero filled.
+	const size_t size = static_cast<size_t>(info.st_size);
+	const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t mappingSize = (size / pageSize + 1) * pageSize;
+
+	void *mapping = mmap(0, mappingSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapping == MAP_FAILED) {
+		close(fd);
+		return 0;
+	}
+
+	void *data = mmap(mapping, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		munmap(mapping, mappingSize);
+		return 0;
+	}
+
+	CMappedReadFile *file = new CMappedReadFile(static_cast<const c8 *>(mapping), static_cast<long>(size), fileName, 0);
+	file->Mapping = mapping;
+	file->MappingSize = mappingSize;
+	return file;
+#else
+	return 0;
+#endif
+}
+
+} // end namespace io
+} // end namespace irr
@@ -0,0 +1,86 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "IMemoryReadFile.h"
+#include "irrString.h"
+
+namespace irr
+{
+
+namespace io
+{
+
+/*!
+	Class for reading a file from disk which is mapped into memory.
+	The buffer returned by getBuffer() stays valid as long as the file
+	exists. A mapped file is followed by readable zero bytes, so parsers
+	which look a few bytes ahead can't run off the mapping. Views are not,
+	they are followed by the rest of the file they are part of.
+*/
+class CMappedReadFile : public IMemoryReadFile
+{
+public:
+	virtual ~CMappedReadFile();
+
+	//! returns how much was read
+	size_t read(void *buffer, size_t sizeToRead) override;
+
+	//! changes position in file, returns true if successful
+	bool seek(long finalPos, bool relativeMovement = false) override;
+
+	//! returns size of file
+	long getSize() const override;
+
+	//! returns where in the file we are.
+	long getPos() const override;
+
+	//! returns name of file
+	const io::path &getFileName() const override;
+
+	//! Get the type of the class implementing this interface
+	EREAD_FILE_TYPE getType() const override
+	{
+		return ERFT_MAPPED_READ_FILE;
+	}
+
+	//! Get direct access to the mapped memory
+	const void *getBuffer() const override
+	{
+		return Buffer;
+	}
+
+	//! Creates a file for a part of this one, which shares the mapping
+	/** Used for files stored uncompressed in archives. The buffer of the
+	view isn't zero terminated, parsers relying on that have to copy it. */
+	IReadFile *createView(long pos, long areaSize, const io::path &fileName);
+
+	//! Returns true for a part of another file, false for a file on disk
+	bool isView() const
+	{
+		return Parent != 0;
+	}
+
+	//! maps a file from disk
+	/** \return 0 if the file can't be mapped, like empty files, pipes or
+	when the platform has no support for it. */
+	static IReadFile *createMappedReadFile(const io::path &fileName);
+
+private:
+	CMappedReadFile(const c8 *buffer, long size, const io::path &fileName, CMappedReadFile *parent);
+
+	const c8 *Buffer;
+	long Size;
+	long Pos;
+	io::path Filename;
+
+	//! file owning the mapping, 0 if this is the file
+	CMappedReadFile *Parent;
+	//! address and length of the mapping, only set when Parent is 0
+	void *Mapping;
+	size_t MappingSize;
+};
+
+} // end namespace io
+} // end namespace irr
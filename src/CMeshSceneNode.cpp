@@ -80,6 +80,12 @@ void CMeshSceneNode::OnRegisterSceneNode()
 	}
 }
 
+void CMeshSceneNode::prepareDirectSolidDraw()
+{
+	++PassCount;
+	Box = Mesh->getBoundingBox();
+}
+
 //! renders the node.
 void CMeshSceneNode::render()
 {
@@ -167,6 +173,12 @@ const core::aabbox3d<f32> &CMeshSceneNode::getBoundingBox() const
 	return Mesh ? Mesh->getBoundingBox() : Box;
 }
 
+//! Returns the material mesh buffer nr is drawn with
+const video::SMaterial &CMeshSceneNode::getBufferMaterial(u32 nr) const
+{
+	return ReadOnlyMaterials ? Mesh->getMeshBuffer(nr)->getMaterial() : Materials[nr];
+}
+
 //! returns the material based on the zero based index i. To get the amount
 //! of materials used by this scene node, use getMaterialCount().
 //! This function is needed for inserting the node into the scene hierarchy on a
@@ -204,6 +216,7 @@ void CMeshSceneNode::setMesh(IMesh *mesh)
 
 		Mesh = mesh;
 		copyMaterials();
+		notifyChange();
 	}
 }
 
@@ -68,6 +68,15 @@ public:
 	//! or to remove attached child.
 	bool removeChild(ISceneNode *child) override;
 
+	//! Returns the material mesh buffer nr is drawn with
+	/** Unlike getMaterial() this doesn't copy read only materials. */
+	const video::SMaterial &getBufferMaterial(u32 nr) const;
+
+	//! Counts the pass and updates the box as render() would, without drawing
+	/** Called by the scene manager instead of render() when it draws the
+	solid mesh buffers of this node itself. */
+	void prepareDirectSolidDraw();
+
 protected:
 	void copyMaterials();
 
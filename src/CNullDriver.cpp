@@ -16,6 +16,11 @@
 #include "CColorConverter.h"
 #include "IReferenceCounted.h"
 #include "IRenderTarget.h"
+#include "CFileSystem.h"
+#include "CImageCache.h"
+#include "CMappedReadFile.h"
+#include "CThreadPool.h"
+#include <map>
 
 namespace irr
 {
@@ -25,6 +30,9 @@ namespace video
 //! creates a loader which is able to load windows bitmaps
 IImageLoader *createImageLoaderBMP();
 
+//! creates a loader which is able to load decoded images of the image cache
+IImageLoader *createImageLoaderIRI();
+
 //! creates a loader which is able to load jpeg images
 IImageLoader *createImageLoaderJPG();
 
@@ -54,7 +62,7 @@ public:
 CNullDriver::CNullDriver(io::IFileSystem *io, const core::dimension2d<u32> &screenSize) :
 		SharedRenderTarget(0), CurrentRenderTarget(0), CurrentRenderTargetSize(0, 0), FileSystem(io), MeshManipulator(0),
 		ViewPort(0, 0, 0, 0), ScreenSize(screenSize), PrimitivesDrawn(0), MinVertexCountForVBO(500),
-		TextureCreationFlags(0), OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
+		ImageThreads(0), ImageCache(0), TextureCreationFlags(0), OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
 {
 #ifdef _DEBUG
 	setDebugName("CNullDriver");
@@ -95,6 +103,7 @@ CNullDriver::CNullDriver(io::IFileSystem *io, const core::dimension2d<u32> &scre
 	SurfaceLoader.push_back(video::createImageLoaderPNG());
 	SurfaceLoader.push_back(video::createImageLoaderJPG());
 	SurfaceLoader.push_back(video::createImageLoaderBMP());
+	SurfaceLoader.push_back(video::createImageLoaderIRI());
 
 	SurfaceWriter.push_back(video::createImageWriterJPG());
 	SurfaceWriter.push_back(video::createImageWriterPNG());
@@ -149,6 +158,9 @@ CNullDriver::~CNullDriver()
 
 	// delete hardware mesh buffers
 	removeAllHardwareBuffers();
+
+	delete ImageThreads;
+	delete ImageCache;
 }
 
 //! Adds an external surface loader to the engine.
@@ -224,12 +236,14 @@ void CNullDriver::deleteAllTextures()
 bool CNullDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil, const SExposedVideoData &videoData, core::rect<s32> *sourceRect)
 {
 	PrimitivesDrawn = 0;
+	FrameStats = SFrameStats();
 	return true;
 }
 
 bool CNullDriver::endScene()
 {
 	FPSCounter.registerFrame(os::Timer::getRealTime(), PrimitivesDrawn);
+	LastFrameStats = FrameStats;
 	updateAllHardwareBuffers();
 	updateAllOcclusionQueries();
 	return true;
@@ -267,6 +281,19 @@ const core::matrix4 &CNullDriver::getTransform(E_TRANSFORMATION_STATE state) con
 //! sets a material
 void CNullDriver::setMaterial(const SMaterial &material)
 {
+	// Nothing is applied here, so count like a driver which only
+	// changes what differs from the last material
+	if (material == LastStatsMaterial)
+		return;
+
+	++FrameStats.MaterialChanges;
+	if (material.MaterialType != LastStatsMaterial.MaterialType)
+		++FrameStats.ShaderChanges;
+	for (u32 i = 0; i < MATERIAL_MAX_TEXTURES; ++i) {
+		if (material.getTexture(i) != LastStatsMaterial.getTexture(i))
+			++FrameStats.TextureChanges;
+	}
+	LastStatsMaterial = material;
 }
 
 //! Removes a texture from the texture cache and deletes it, freeing lot of
@@ -413,21 +440,41 @@ ITexture *CNullDriver::addTextureCubemap(const irr::u32 sideLen, const io::path
 
 //! loads a Texture
 ITexture *CNullDriver::getTexture(const io::path &filename)
+{
+	ITexture *texture = 0;
+	io::IReadFile *file = openTextureFile(filename, texture);
+	if (!file)
+		return texture;
+
+	texture = loadTextureFromFile(file);
+	file->drop();
+
+	if (texture) {
+		texture->updateSource(ETS_FROM_FILE);
+		addTexture(texture);
+		texture->drop(); // drop it because we created it, one grab too much
+	} else
+		os::Printer::log("Could not load texture", filename, ELL_ERROR);
+	return texture;
+}
+
+//! looks for a loaded texture of that name, or opens the file to load it from
+io::IReadFile *CNullDriver::openTextureFile(const io::path &filename, ITexture *&texture)
 {
 	// Identify textures by their absolute filenames if possible.
 	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
 
-	ITexture *texture = findTexture(absolutePath);
+	texture = findTexture(absolutePath);
 	if (texture) {
 		texture->updateSource(ETS_FROM_CACHE);
-		return texture;
+		return 0;
 	}
 
 	// Then try the raw filename, which might be in an Archive
 	texture = findTexture(filename);
 	if (texture) {
 		texture->updateSource(ETS_FROM_CACHE);
-		return texture;
+		return 0;
 	}
 
 	// Now try to open the file using the complete path.
@@ -438,29 +485,20 @@ ITexture *CNullDriver::getTexture(const io::path &filename)
 		file = FileSystem->createAndOpenFile(filename);
 	}
 
-	if (file) {
-		// Re-check name for actual archive names
-		texture = findTexture(file->getFileName());
-		if (texture) {
-			texture->updateSource(ETS_FROM_CACHE);
-			file->drop();
-			return texture;
-		}
+	if (!file) {
+		os::Printer::log("Could not open file of texture", filename, ELL_WARNING);
+		return 0;
+	}
 
-		texture = loadTextureFromFile(file);
+	// Re-check name for actual archive names
+	texture = findTexture(file->getFileName());
+	if (texture) {
+		texture->updateSource(ETS_FROM_CACHE);
 		file->drop();
-
-		if (texture) {
-			texture->updateSource(ETS_FROM_FILE);
-			addTexture(texture);
-			texture->drop(); // drop it because we created it, one grab too much
-		} else
-			os::Printer::log("Could not load texture", filename, ELL_ERROR);
-		return texture;
-	} else {
-		os::Printer::log("Could not open file of texture", filename, ELL_WARNING);
 		return 0;
 	}
+
+	return file;
 }
 
 //! loads a Texture
@@ -491,12 +529,71 @@ ITexture *CNullDriver::getTexture(io::IReadFile *file)
 	return texture;
 }
 
+//! loads several textures, decoding their images in parallel
+void CNullDriver::getTextures(const core::array<io::path> &filenames, core::array<ITexture *> &textures)
+{
+	textures.set_used(filenames.size());
+
+	// look up the loaded textures and open the files of the others
+	core::array<io::IReadFile *> files;
+	core::array<u32> fileTextures;
+	core::array<u32> duplicates;
+	std::map<io::path, u32> opened;
+	for (u32 i = 0; i < filenames.size(); ++i) {
+		io::IReadFile *file = openTextureFile(filenames[i], textures[i]);
+		if (!file)
+			continue;
+
+		// a file listed twice is loaded once
+		auto it = opened.find(file->getFileName());
+		if (it != opened.end()) {
+			file->drop();
+			duplicates.push_back(i);
+			duplicates.push_back(it->second);
+			continue;
+		}
+
+		opened[file->getFileName()] = files.size();
+		files.push_back(file);
+		fileTextures.push_back(i);
+	}
+
+	core::array<IImage *> images;
+	loadImagesFromFiles(files, images, getTextureUploadFormat());
+
+	// the driver creates the textures on this thread
+	for (u32 i = 0; i < files.size(); ++i) {
+		ITexture *texture = 0;
+		if (images[i]) {
+			if (checkImage(images[i])) {
+				texture = createDeviceDependentTexture(files[i]->getFileName(), images[i]);
+				if (texture)
+					os::Printer::log("Loaded texture", files[i]->getFileName(), ELL_DEBUG);
+			}
+			images[i]->drop();
+		}
+
+		if (texture) {
+			texture->updateSource(ETS_FROM_FILE);
+			addTexture(texture);
+			texture->drop(); // drop it because we created it, one grab too much
+		} else
+			os::Printer::log("Could not load texture", filenames[fileTextures[i]], ELL_ERROR);
+
+		textures[fileTextures[i]] = texture;
+		files[i]->drop();
+	}
+
+	for (u32 i = 0; i < duplicates.size(); i += 2)
+		textures[duplicates[i]] = textures[fileTextures[duplicates[i + 1]]];
+}
+
 //! opens the file and loads it into the surface
 video::ITexture *CNullDriver::loadTextureFromFile(io::IReadFile *file, const io::path &hashName)
 {
 	ITexture *texture = nullptr;
 
-	IImage *image = createImageFromFile(file);
+	IImage *image = loadImageFromFile(file, getTextureUploadFormat());
 	if (!image)
 		return nullptr;
 
@@ -607,6 +704,7 @@ void CNullDriver::drawVertexPrimitiveList(const void *vertices, u32 vertexCount,
 	if ((iType == EIT_16BIT) && (vertexCount > 65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
 	PrimitivesDrawn += primitiveCount;
+	++FrameStats.DrawCalls;
 }
 
 //! draws a vertex primitive list in 2d
@@ -615,6 +713,7 @@ void CNullDriver::draw2DVertexPrimitiveList(const void *vertices, u32 vertexCoun
 	if ((iType == EIT_16BIT) && (vertexCount > 65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
 	PrimitivesDrawn += primitiveCount;
+	++FrameStats.DrawCalls;
 }
 
 //! Draws a 3d line.
@@ -752,6 +851,12 @@ u32 CNullDriver::getPrimitiveCountDrawn(u32 param) const
 																   : FPSCounter.getPrimitiveTotal();
 }
 
+//! Returns draw calls and render state changes of the last frame
+const SFrameStats &CNullDriver::getFrameStats() const
+{
+	return LastFrameStats;
+}
+
 //! Sets the dynamic ambient light color. The default color is
 //! (0,0,0,0) which means it is dark.
 //! \param color: New color of the ambient light.
@@ -973,17 +1078,70 @@ IImage *CNullDriver::createImageFromFile(const io::path &filename)
 }
 
 IImage *CNullDriver::createImageFromFile(io::IReadFile *file)
+{
+	return loadImageFromFile(file, ECF_UNKNOWN);
+}
+
+IImage *CNullDriver::loadImageFromFile(io::IReadFile *file, ECOLOR_FORMAT format)
 {
 	if (!file)
 		return nullptr;
 
+	// only files on disk can be checked for changes
+	io::path cachedSource;
+	const io::EREAD_FILE_TYPE type = file->getType();
+	if (ImageCache && (type == io::ERFT_READ_FILE ||
+			(type == io::ERFT_MAPPED_READ_FILE && !static_cast<io::CMappedReadFile *>(file)->isView()))) {
+		cachedSource = FileSystem->getAbsolutePath(file->getFileName());
+		if (IImage *image = ImageCache->load(cachedSource, format))
+			return image;
+	}
+
+	IImage *image = decodeImage(file, core::dimension2du(0, 0), format);
+	if (image && cachedSource.size())
+		ImageCache->store(cachedSource, format, image);
+	return image;
+}
+
+IImage *CNullDriver::createScaledImageFromFile(const io::path &filename, const core::dimension2du &maxSize)
+{
+	if (!filename.size())
+		return nullptr;
+
+	io::IReadFile *file = FileSystem->createAndOpenFile(filename);
+	if (!file) {
+		os::Printer::log("Could not open file of image", filename, ELL_WARNING);
+		return nullptr;
+	}
+
+	IImage *image = createScaledImageFromFile(file, maxSize);
+	file->drop();
+	return image;
+}
+
+IImage *CNullDriver::createScaledImageFromFile(io::IReadFile *file, const core::dimension2du &maxSize)
+{
+	if (!file)
+		return nullptr;
+
+	return decodeImage(file, maxSize, ECF_UNKNOWN);
+}
+
+void CNullDriver::setImageCache(const io::path &directory, bool compress)
+{
+	delete ImageCache;
+	ImageCache = directory.size() ? new CImageCache(directory, compress) : 0;
+}
+
+IImage *CNullDriver::decodeImage(io::IReadFile *file, const core::dimension2du &maxSize, ECOLOR_FORMAT format)
+{
 	// try to load file based on file extension
 	for (int i = SurfaceLoader.size() - 1; i >= 0; --i) {
 		if (!SurfaceLoader[i]->isALoadableFileExtension(file->getFileName()))
 			continue;
 
 		file->seek(0); // reset file position which might have changed due to previous loadImage calls
-		if (IImage *image = SurfaceLoader[i]->loadImage(file))
+		if (IImage *image = decodeImage(SurfaceLoader[i], file, maxSize, format))
 			return image;
 	}
 
@@ -996,13 +1154,112 @@ IImage *CNullDriver::createImageFromFile(io::IReadFile *file)
 			continue;
 
 		file->seek(0);
-		if (IImage *image = SurfaceLoader[i]->loadImage(file))
+		if (IImage *image = decodeImage(SurfaceLoader[i], file, maxSize, format))
 			return image;
 	}
 
 	return nullptr;
 }
 
+IImage *CNullDriver::decodeImage(IImageLoader *loader, io::IReadFile *file, const core::dimension2du &maxSize, ECOLOR_FORMAT format)
+{
+	if (format == ECF_UNKNOWN)
+		return loader->loadScaledImage(file, maxSize);
+
+	// the rows go straight into an image of that format, without a
+	// conversion afterwards
+	CImageRowTarget target;
+	if (loader->loadImageRows(file, format, false, &target))
+		return target.Image;
+
+	// loaders which can't decode rows haven't touched the file
+	if (!target.Image)
+		return loader->loadScaledImage(file, maxSize);
+
+	target.Image->drop();
+	return nullptr;
+}
+
+ECOLOR_FORMAT CNullDriver::getTextureUploadFormat() const
+{
+	// the format COpenGLCoreTexture converts 8 bit images to
+	if (getTextureCreationFlag(ETCF_ALWAYS_16_BIT) || getTextureCreationFlag(ETCF_OPTIMIZED_FOR_SPEED))
+		return ECF_UNKNOWN;
+	return getTextureCreationFlag(ETCF_NO_ALPHA_CHANNEL) ? ECF_R8G8B8 : ECF_A8R8G8B8;
+}
+
+void CNullDriver::createImagesFromFiles(const core::array<io::path> &filenames, core::array<IImage *> &images)
+{
+	core::array<io::IReadFile *> files(filenames.size());
+	for (u32 i = 0; i < filenames.size(); ++i) {
+		io::IReadFile *file = 0;
+		if (filenames[i].size()) {
+			file = FileSystem->createAndOpenFile(filenames[i]);
+			if (!file)
+				os::Printer::log("Could not open file of image", filenames[i], ELL_WARNING);
+		}
+		files.push_back(file);
+	}
+
+	createImagesFromFiles(files, images);
+
+	for (u32 i = 0; i < files.size(); ++i) {
+		if (files[i])
+			files[i]->drop();
+	}
+}
+
+void CNullDriver::createImagesFromFiles(const core::array<io::IReadFile *> &files, core::array<IImage *> &images)
+{
+	loadImagesFromFiles(files, images, ECF_UNKNOWN);
+}
+
+void CNullDriver::loadImagesFromFiles(const core::array<io::IReadFile *> &files, core::array<IImage *> &images, ECOLOR_FORMAT format)
+{
+	images.set_used(files.size());
+
+	// The loaders keep no state between calls, but files sharing a handle
+	// with their archive have to be read into memory on this thread first.
+	core::array<io::IReadFile *> inputs(files.size());
+	for (u32 i = 0; i < files.size(); ++i) {
+		images[i] = 0;
+
+		io::IReadFile *file = files[i];
+		if (file && !io::CFileSystem::isReadableOnAnyThread(file)) {
+			const long size = file->getSize();
+			c8 *data = new c8[size];
+			file->seek(0);
+			if (file->read(data, size) == (size_t)size) {
+				file = FileSystem->createMemoryReadFile(data, size, file->getFileName(), true);
+			} else {
+				delete[] data;
+				file = 0;
+			}
+		} else if (file) {
+			file->grab();
+		}
+		inputs.push_back(file);
+	}
+
+	const u32 threadCount = std::thread::hardware_concurrency();
+	if (threadCount > 1 && inputs.size() > 1) {
+		// the calling thread takes part in the work as well
+		if (!ImageThreads)
+			ImageThreads = new CThreadPool(threadCount - 1);
+		ImageThreads->parallelFor(inputs.size(), [this, &inputs, &images, format](u32 i) {
+			images[i] = loadImageFromFile(inputs[i], format);
+		});
+	} else {
+		for (u32 i = 0; i < inputs.size(); ++i)
+			images[i] = loadImageFromFile(inputs[i], format);
+	}
+
+	for (u32 i = 0; i < inputs.size(); ++i) {
+		if (inputs[i])
+			inputs[i]->drop();
+	}
+}
+
 //! Writes the provided image to disk file
 bool CNullDriver::writeImageToFile(IImage *image, const io::path &filename, u32 param)
 {
@@ -1123,6 +1380,22 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer *mb)
 		drawVertexPrimitiveList(mb->getVertices(), mb->getVertexCount(), mb->getIndices(), mb->getPrimitiveCount(), mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType());
 }
 
+//! Draws a list of mesh buffers, each with its own material and world transformation
+void CNullDriver::drawMeshBufferList(const SMeshBufferDraw *draws, u32 count)
+{
+	const core::matrix4 *transform = 0;
+
+	for (u32 i = 0; i < count; ++i) {
+		if (draws[i].Transform != transform) {
+			transform = draws[i].Transform;
+			setTransform(ETS_WORLD, *transform);
+		}
+
+		setMaterial(*draws[i].Material);
+		drawMeshBuffer(draws[i].MeshBuffer);
+	}
+}
+
 //! Draws the normals of a mesh buffer
 void CNullDriver::drawMeshBufferNormals(const scene::IMeshBuffer *mb, f32 length, SColor color)
 {
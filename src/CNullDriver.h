@@ -21,6 +21,8 @@
 
 namespace irr
 {
+class CThreadPool;
+
 namespace io
 {
 class IWriteFile;
@@ -30,6 +32,7 @@ namespace video
 {
 class IImageLoader;
 class IImageWriter;
+class CImageCache;
 
 class CNullDriver : public IVideoDriver, public IGPUProgrammingServices
 {
@@ -78,6 +81,9 @@ public:
 	//! loads a Texture
 	ITexture *getTexture(io::IReadFile *file) override;
 
+	//! loads several textures, decoding their images in parallel
+	void getTextures(const core::array<io::path> &filenames, core::array<ITexture *> &textures) override;
+
 	//! Returns amount of textures currently loaded
 	u32 getTextureCount() const override;
 
@@ -199,6 +205,9 @@ public:
 	//! very useful method for statistics.
 	u32 getPrimitiveCountDrawn(u32 param = 0) const override;
 
+	//! Returns draw calls and render state changes of the last frame
+	const SFrameStats &getFrameStats() const override;
+
 	//! \return Returns the name of the video driver. Example: In case of the DIRECT3D8
 	//! driver, it would return "Direct3D8.1".
 	const char *getName() const override;
@@ -255,6 +264,17 @@ public:
 
 	IImage *createImageFromFile(io::IReadFile *file) override;
 
+	IImage *createScaledImageFromFile(const io::path &filename, const core::dimension2du &maxSize) override;
+
+	IImage *createScaledImageFromFile(io::IReadFile *file, const core::dimension2du &maxSize) override;
+
+	void createImagesFromFiles(const core::array<io::path> &filenames, core::array<IImage *> &images) override;
+
+	void createImagesFromFiles(const core::array<io::IReadFile *> &files, core::array<IImage *> &images) override;
+
+	//! Keeps decoded images of files on disk in a directory
+	void setImageCache(const io::path &directory, bool compress) override;
+
 	//! Creates a software image from a byte array.
 	/** \param useForeignMemory: If true, the image will use the data pointer
 	directly and own it from now on, which means it will also try to delete [] the
@@ -274,6 +294,9 @@ public:
 	//! Draws a mesh buffer
 	void drawMeshBuffer(const scene::IMeshBuffer *mb) override;
 
+	//! Draws a list of mesh buffers, each with its own material and world transformation
+	void drawMeshBufferList(const SMeshBufferDraw *draws, u32 count) override;
+
 	//! Draws the normals of a mesh buffer
 	virtual void drawMeshBufferNormals(const scene::IMeshBuffer *mb, f32 length = 10.f,
 			SColor color = 0xffffffff) override;
@@ -560,6 +583,30 @@ protected:
 	//! opens the file and loads it into the surface
 	ITexture *loadTextureFromFile(io::IReadFile *file, const io::path &hashName = "");
 
+	//! creates an image from the file, checking the image cache first
+	//! \param format Format the image is decoded in where the loader
+	//! supports it, ECF_UNKNOWN for the format of the file
+	IImage *loadImageFromFile(io::IReadFile *file, ECOLOR_FORMAT format);
+
+	//! creates images from several files on worker threads
+	void loadImagesFromFiles(const core::array<io::IReadFile *> &files, core::array<IImage *> &images, ECOLOR_FORMAT format);
+
+	//! decodes an image with the first loader able to, reduced for maxSize
+	//! and in the given format where the loader supports it
+	IImage *decodeImage(io::IReadFile *file, const core::dimension2du &maxSize, ECOLOR_FORMAT format);
+
+	//! decodes an image with this loader
+	IImage *decodeImage(IImageLoader *loader, io::IReadFile *file, const core::dimension2du &maxSize, ECOLOR_FORMAT format);
+
+	//! the format images of textures are decoded in, so that creating the
+	//! texture doesn't convert them again, ECF_UNKNOWN if there's none
+	ECOLOR_FORMAT getTextureUploadFormat() const;
+
+	//! looks for a loaded texture of that name, or opens the file to load it from
+	/** \return The opened file, or 0 if the texture was found or the file
+	could not be opened. */
+	io::IReadFile *openTextureFile(const io::path &filename, ITexture *&texture);
+
 	//! adds a surface, not loaded or created by the Irrlicht Engine
 	void addTexture(ITexture *surface);
 
@@ -711,8 +758,19 @@ protected:
 	CFPSCounter FPSCounter;
 
 	u32 PrimitivesDrawn;
+
+	//! Counters of the current and the last finished frame
+	SFrameStats FrameStats;
+	SFrameStats LastFrameStats;
+	//! Last material passed to setMaterial(), the null driver counts changes with it
+	SMaterial LastStatsMaterial;
 	u32 MinVertexCountForVBO;
 
+	//! decodes images for createImagesFromFiles(), created when first needed
+	CThreadPool *ImageThreads;
+	//! decoded images of files on disk, if enabled
+	CImageCache *ImageCache;
+
 	u32 TextureCreationFlags;
 
 	f32 FogStart;
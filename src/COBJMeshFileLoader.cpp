@@ -8,7 +8,7 @@
 #include "SMesh.h"
 #include "SMeshBuffer.h"
 #include "SAnimatedMesh.h"
-#include "IReadFile.h"
+#include "IMemoryReadFile.h"
 #include "IAttributes.h"
 #include "fast_atof.h"
 #include "coreutil.h"
@@ -69,9 +69,18 @@ IAnimatedMesh *COBJMeshFileLoader::createMesh(io::IReadFile *file)
 
 	const io::path fullName = file->getFileName();
 
-	c8 *buf = new c8[filesize + 1]; // plus null-terminator
-	memset(buf, 0, filesize + 1);
-	file->read((void *)buf, filesize);
+	// the parser stays within bufEnd, so memory files are read in place
+	// without the null-terminator of the copy
+	c8 *bufCopy = 0;
+	const c8 *buf;
+	if (file->getType() == io::ERFT_MEMORY_READ_FILE || file->getType() == io::ERFT_MAPPED_READ_FILE) {
+		buf = static_cast<const c8 *>(static_cast<io::IMemoryReadFile *>(file)->getBuffer());
+	} else {
+		bufCopy = new c8[filesize + 1]; // plus null-terminator
+		memset(bufCopy, 0, filesize + 1);
+		file->read((void *)bufCopy, filesize);
+		buf = bufCopy;
+	}
 	const c8 *const bufEnd = buf + filesize;
 
 	// Process obj information
@@ -100,7 +109,7 @@ IAnimatedMesh *COBJMeshFileLoader::createMesh(io::IReadFile *file)
 		} break;
 
 		case 'v': // v, vn, vt
-			switch (bufPtr[1]) {
+			switch (bufPtr + 1 != bufEnd ? bufPtr[1] : 0) {
 			case ' ': // vertex
 			{
 				core::vector3df vec;
@@ -208,7 +217,7 @@ IAnimatedMesh *COBJMeshFileLoader::createMesh(io::IReadFile *file)
 					v.Pos = vertexBuffer[Idx[0]];
 				else {
 					os::Printer::log("Invalid vertex index in this line", wordBuffer.c_str(), ELL_ERROR);
-					delete[] buf;
+					delete[] bufCopy;
 					cleanUp();
 					return 0;
 				}
@@ -241,7 +250,7 @@ IAnimatedMesh *COBJMeshFileLoader::createMesh(io::IReadFile *file)
 
 			if (faceCorners.size() < 3) {
 				os::Printer::log("Too few vertices in this line", wordBuffer.c_str(), ELL_ERROR);
-				delete[] buf;
+				delete[] bufCopy;
 				cleanUp();
 				return 0;
 			}
@@ -301,7 +310,7 @@ IAnimatedMesh *COBJMeshFileLoader::createMesh(io::IReadFile *file)
 	}
 
 	// Clean up the allocate obj file contents
-	delete[] buf;
+	delete[] bufCopy;
 	// more cleaning up
 	cleanUp();
 	mesh->drop();
@@ -438,8 +447,8 @@ u32 COBJMeshFileLoader::copyWord(c8 *outBuf, const c8 *const inBuf, u32 outBufLe
 	}
 
 	u32 i = 0;
-	while (inBuf[i]) {
-		if (core::isspace(inBuf[i]) || &(inBuf[i]) == bufEnd)
+	while (&(inBuf[i]) != bufEnd && inBuf[i]) {
+		if (core::isspace(inBuf[i]))
 			break;
 		++i;
 	}
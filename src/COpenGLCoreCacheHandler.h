@@ -68,6 +68,8 @@ class COpenGLCoreCacheHandler
 				const TOpenGLTexture *prevTexture = Texture[index];
 
 				if (texture != prevTexture) {
+					++CacheHandler.TextureChangeCount;
+
 					if (esa == EST_ACTIVE_ON_CHANGE)
 						CacheHandler.setActiveTexture(GL_TEXTURE0 + index);
 
@@ -176,7 +178,8 @@ public:
 			FrameBufferCount(0), BlendEquation(0), BlendSourceRGB(0),
 			BlendDestinationRGB(0), BlendSourceAlpha(0), BlendDestinationAlpha(0), Blend(0), BlendEquationInvalid(false), BlendFuncInvalid(false), BlendInvalid(false),
 			ColorMask(0), ColorMaskInvalid(false), CullFaceMode(GL_BACK), CullFace(false), DepthFunc(GL_LESS), DepthMask(true), DepthTest(false), FrameBufferID(0),
-			ProgramID(0), ActiveTexture(GL_TEXTURE0), ViewportX(0), ViewportY(0)
+			ProgramID(0), ActiveTexture(GL_TEXTURE0), ViewportX(0), ViewportY(0),
+			TextureChangeCount(0), ProgramChangeCount(0)
 	{
 		const COpenGLCoreFeature &feature = Driver->getFeature();
 
@@ -500,6 +503,7 @@ public:
 		if (ProgramID != programID) {
 			Driver->irrGlUseProgram(programID);
 			ProgramID = programID;
+			++ProgramChangeCount;
 		}
 	}
 
@@ -539,6 +543,17 @@ public:
 		}
 	}
 
+	// Statistics.
+
+	//! Returns texture and program changes since the last call and resets them
+	void takeStats(u32 &textureChanges, u32 &programChanges)
+	{
+		textureChanges = TextureChangeCount;
+		programChanges = ProgramChangeCount;
+		TextureChangeCount = 0;
+		ProgramChangeCount = 0;
+	}
+
 	//! Compare material to current cache and update it when there are differences
 	// Some material renderers do change the cache beyond the original material settings
 	// This corrects the material to represent the current cache state again.
@@ -589,6 +604,9 @@ protected:
 	GLint ViewportY;
 	GLsizei ViewportWidth;
 	GLsizei ViewportHeight;
+
+	u32 TextureChangeCount;
+	u32 ProgramChangeCount;
 };
 
 }
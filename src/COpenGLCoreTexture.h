@@ -237,6 +237,9 @@ public:
 			if (LockImage && mode != ETLM_WRITE_ONLY) {
 				bool passed = true;
 
+				// queued draws into the texture
+				Driver->flush2DBatch();
+
 #ifdef IRR_COMPILE_GL_COMMON
 				IImage *tmpImage = LockImage; // not sure yet if the size required by glGetTexImage is always correct, if not we might have to allocate a different tmpImage and convert colors later on.
 
@@ -346,6 +349,9 @@ public:
 			return;
 
 		if (!LockReadOnly) {
+			// queued draws still see the old content
+			Driver->flush2DBatch();
+
 			const COpenGLCoreTexture *prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
 			Driver->getCacheHandler()->getTextureCache().set(0, this);
 
@@ -366,6 +372,8 @@ public:
 		if (!HasMipMaps || LegacyAutoGenerateMipMaps || (Size.Width <= 1 && Size.Height <= 1))
 			return;
 
+		Driver->flush2DBatch();
+
 		const COpenGLCoreTexture *prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
 		Driver->getCacheHandler()->getTextureCache().set(0, this);
 
@@ -199,6 +199,10 @@ bool COpenGLDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth,
 {
 	CNullDriver::beginScene(clearFlag, clearColor, clearDepth, clearStencil, videoData, sourceRect);
 
+	// changes between frames don't count for this frame
+	u32 unused;
+	CacheHandler->takeStats(unused, unused);
+
 	if (ContextManager)
 		ContextManager->activateContext(videoData, true);
 
@@ -209,6 +213,7 @@ bool COpenGLDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth,
 
 bool COpenGLDriver::endScene()
 {
+	CacheHandler->takeStats(FrameStats.TextureChanges, FrameStats.ShaderChanges);
 	CNullDriver::endScene();
 
 	glFlush();
@@ -1707,6 +1712,8 @@ void COpenGLDriver::setRenderStates3DMode()
 	}
 
 	if (ResetRenderStates || LastMaterial != Material) {
+		++FrameStats.MaterialChanges;
+
 		// unset old material
 
 		if (LastMaterial.MaterialType != Material.MaterialType &&
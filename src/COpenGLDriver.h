@@ -339,6 +339,9 @@ public:
 
 	COpenGLCacheHandler *getCacheHandler() const;
 
+	//! Nothing to do, 2D draw calls aren't queued by this driver
+	void flush2DBatch() {}
+
 private:
 	bool updateVertexHardwareBuffer(SHWBufferLink_opengl *HWBuffer);
 	bool updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffer);
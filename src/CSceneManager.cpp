@@ -26,19 +26,105 @@
 #include "CEmptySceneNode.h"
 
 #include "CSceneCollisionManager.h"
+#include "CSceneNodeOctree.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
 namespace scene
 {
 
+namespace
+{
+// Folds a hash to the given number of bits
+u64 foldBits(u64 hash, u32 bits)
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	return hash & ((1ULL << bits) - 1);
+}
+
+// Sort key of a draw with this material. From high to low bits:
+// material type (8), textures (24), other render states (16), mesh
+// buffer (8), depth (8). Draws sharing the expensive states end up next to
+// each other, followed by draws of the same buffer which the driver can
+// draw instanced. Equal draws are drawn front to back.
+u64 makeSolidSortKey(const video::SMaterial &material, const scene::IMeshBuffer *mb, u8 depth)
+{
+	u64 textures = 0;
+	for (u32 i = 0; i < video::MATERIAL_MAX_TEXTURES; ++i)
+		textures = textures * 31 + (u64)(size_t)material.getTexture(i);
+
+	u64 states = material.ZBuffer;
+	states = (states << 2) | material.ZWriteEnable;
+	states = (states << 4) | material.BlendOperation;
+	states = (states << 32) | (u32)material.MaterialTypeParam;
+	states = (states << 1) | material.BackfaceCulling;
+	states = (states << 1) | material.FrontfaceCulling;
+	states = (states << 1) | material.Wireframe;
+	states = (states << 1) | material.PointCloud;
+	states = (states << 1) | material.Lighting;
+	states = (states << 1) | material.FogEnable;
+	states = (states << 4) | material.ColorMask;
+
+	return ((u64)(material.MaterialType & 0xff) << 56) |
+		   ((textures ? foldBits(textures, 24) : 0) << 32) |
+		   (foldBits(states, 16) << 16) |
+		   ((mb ? foldBits((u64)(size_t)mb, 8) : 0) << 8) |
+		   depth;
+}
+
+// Stable least significant digit radix sort of the draws by key.
+// Passes over bytes which are the same for all keys are skipped.
+template <class T>
+void radixSortByKey(core::array<T> &list, core::array<T> &buffer)
+{
+	const u32 count = list.size();
+	if (count < 2)
+		return;
+
+	u32 histogram[8][256] = {};
+	for (u32 i = 0; i < count; ++i) {
+		const u64 key = list[i].Key;
+		for (u32 b = 0; b < 8; ++b)
+			++histogram[b][(key >> (b * 8)) & 0xff];
+	}
+
+	buffer.set_used(count);
+	T *src = list.pointer();
+	T *dst = buffer.pointer();
+	for (u32 b = 0; b < 8; ++b) {
+		u32 *h = histogram[b];
+		if (h[(src[0].Key >> (b * 8)) & 0xff] == count)
+			continue;
+
+		u32 offset = 0;
+		for (u32 d = 0; d < 256; ++d) {
+			const u32 n = h[d];
+			h[d] = offset;
+			offset += n;
+		}
+		for (u32 i = 0; i < count; ++i)
+			dst[h[(src[i].Key >> (b * 8)) & 0xff]++] = src[i];
+
+		T *t = src;
+		src = dst;
+		dst = t;
+	}
+
+	if (src != list.pointer())
+		list.swap(buffer);
+}
+} // end anonymous namespace
+
 //! constructor
 CSceneManager::CSceneManager(video::IVideoDriver *driver,
 		gui::ICursorControl *cursorControl, IMeshCache *cache) :
 		ISceneNode(0, 0),
 		Driver(driver),
 		CursorControl(cursorControl),
-		ActiveCamera(0), ShadowColor(150, 0, 0, 0), AmbientLight(0, 0, 0, 0), Parameters(0),
+		AnimationThreads(0), SpatialIndex(0), ActiveCamera(0), ShadowColor(150, 0, 0, 0), AmbientLight(0, 0, 0, 0), Parameters(0),
 		MeshCache(cache), CurrentRenderPass(ESNRP_NONE)
 {
 #ifdef _DEBUG
@@ -109,10 +195,13 @@ CSceneManager::~CSceneManager()
 	if (Parameters)
 		Parameters->drop();
 
+	delete AnimationThreads;
+
 	// remove all nodes before dropping the driver
 	// as render targets may be destroyed twice
 
 	removeAll();
+	delete SpatialIndex;
 
 	if (Driver)
 		Driver->drop();
@@ -504,6 +593,9 @@ void CSceneManager::drawAll()
 	// let all nodes register themselves
 	OnRegisterSceneNode();
 
+	// skin animated meshes in parallel if enabled
+	prepareAnimatedMeshes();
+
 	// render camera scenes
 	{
 		CurrentRenderPass = ESNRP_CAMERA;
@@ -531,10 +623,9 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_SOLID;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		SolidNodeList.sort(); // sort by textures
-
-		for (i = 0; i < SolidNodeList.size(); ++i)
-			SolidNodeList[i].Node->render();
+		// sort mesh buffers by render state to keep state changes low
+		sortSolidDraws();
+		renderSolidDraws();
 
 		SolidNodeList.set_used(0);
 	}
@@ -574,11 +665,155 @@ void CSceneManager::drawAll()
 
 		GuiNodeList.set_used(0);
 	}
+
+	for (i = 0; i < AnimatedNodeList.size(); ++i)
+		AnimatedNodeList[i].Node->discardPreparedMesh();
+	AnimatedNodeList.set_used(0);
+
 	clearDeletionList();
 
 	CurrentRenderPass = ESNRP_NONE;
 }
 
+void CSceneManager::sortSolidDraws()
+{
+	SolidDrawList.set_used(0);
+
+	// The buckets are spread over the square root of the distance, so near
+	// nodes, where front to back order saves the most overdraw, don't all
+	// share the first bucket.
+	const f32 farValue = ActiveCamera ? ActiveCamera->getFarValue() : 0.f;
+	const f32 depthScale = farValue > 0.f ? 255.f / sqrtf(farValue) : 0.f;
+
+	for (u32 i = 0; i < SolidNodeList.size(); ++i) {
+		ISceneNode *node = SolidNodeList[i];
+
+		const f32 distance = node->getAbsolutePosition().getDistanceFrom(camWorldPos);
+		const u8 depth = (u8)core::clamp(sqrtf(distance) * depthScale, 0.f, 255.f);
+
+		SolidDrawEntry entry;
+		entry.Node = node;
+
+		// Draw the buffers of plain mesh nodes directly, anything else
+		// renders itself. Debug data is drawn by the node only.
+		CMeshSceneNode *meshNode = 0;
+		if (node->getType() == ESNT_MESH && !node->isDebugDataVisible())
+			meshNode = dynamic_cast<CMeshSceneNode *>(node);
+
+		if (meshNode && meshNode->getMesh()) {
+			meshNode->prepareDirectSolidDraw();
+
+			IMesh *mesh = meshNode->getMesh();
+			for (u32 b = 0; b < mesh->getMeshBufferCount(); ++b) {
+				const video::SMaterial &material = meshNode->getBufferMaterial(b);
+				if (!mesh->getMeshBuffer(b) || Driver->needsTransparentRenderPass(material))
+					continue;
+
+				entry.Key = makeSolidSortKey(material, mesh->getMeshBuffer(b), depth);
+				entry.MeshBuffer = b;
+				SolidDrawList.push_back(entry);
+			}
+		} else {
+			entry.Key = node->getMaterialCount() ? makeSolidSortKey(node->getMaterial(0), 0, depth) : depth;
+			entry.MeshBuffer = SolidDrawEntry::NodeRender;
+			SolidDrawList.push_back(entry);
+		}
+	}
+
+	radixSortByKey(SolidDrawList, SolidDrawSortBuffer);
+}
+
+void CSceneManager::renderSolidDraws()
+{
+	// mesh buffers are collected into a draw list, so that the driver can
+	// merge draws of the same buffer. Nodes rendering themselves end a list.
+	for (u32 i = 0; i <= SolidDrawList.size(); ++i) {
+		if (i < SolidDrawList.size() && SolidDrawList[i].MeshBuffer != SolidDrawEntry::NodeRender) {
+			CMeshSceneNode *node = static_cast<CMeshSceneNode *>(SolidDrawList[i].Node);
+			const u32 b = SolidDrawList[i].MeshBuffer;
+			MeshBufferDraws.push_back(video::SMeshBufferDraw(node->getMesh()->getMeshBuffer(b),
+					&node->getBufferMaterial(b), &node->getAbsoluteTransformation()));
+			continue;
+		}
+
+		if (MeshBufferDraws.size()) {
+			Driver->drawMeshBufferList(MeshBufferDraws.const_pointer(), MeshBufferDraws.size());
+			MeshBufferDraws.set_used(0);
+		}
+
+		if (i < SolidDrawList.size())
+			SolidDrawList[i].Node->render();
+	}
+
+	SolidDrawList.set_used(0);
+}
+
+void CSceneManager::prepareAnimatedMeshes()
+{
+	const s32 threadCount = Parameters->getAttributeAsInt(ANIMATION_THREADS);
+	if (threadCount <= 0) {
+		delete AnimationThreads;
+		AnimationThreads = 0;
+		return;
+	}
+
+	// the calling thread takes part in the work as well
+	if (!AnimationThreads || AnimationThreads->getThreadCount() != (u32)threadCount - 1) {
+		delete AnimationThreads;
+		AnimationThreads = new CThreadPool(threadCount - 1);
+	}
+
+	// a node with solid and transparent materials is in two lists
+	u32 i;
+	for (i = 0; i < SolidNodeList.size() + TransparentNodeList.size() + TransparentEffectNodeList.size(); ++i) {
+		ISceneNode *node;
+		if (i < SolidNodeList.size())
+			node = SolidNodeList[i];
+		else if (i < SolidNodeList.size() + TransparentNodeList.size())
+			node = TransparentNodeList[i - SolidNodeList.size()].Node;
+		else
+			node = TransparentEffectNodeList[i - SolidNodeList.size() - TransparentNodeList.size()].Node;
+
+		if (node->getType() != ESNT_ANIMATED_MESH)
+			continue;
+
+		// custom nodes may report the same type
+		CAnimatedMeshSceneNode *animated = dynamic_cast<CAnimatedMeshSceneNode *>(node);
+		if (animated && animated->getMesh() && animated->getMesh()->getMeshType() == EAMT_SKINNED)
+			AnimatedNodeList.push_back(AnimatedNodeEntry(animated, animated->getMesh()));
+	}
+
+	if (AnimatedNodeList.empty())
+		return;
+
+	AnimatedNodeList.sort();
+
+	// remove duplicates and find the nodes sharing a mesh
+	u32 used = 0;
+	AnimatedMeshGroups.set_used(0);
+	for (i = 0; i < AnimatedNodeList.size(); ++i) {
+		if (used && AnimatedNodeList[i].Node == AnimatedNodeList[used - 1].Node)
+			continue;
+		if (!used || AnimatedNodeList[i].Mesh != AnimatedNodeList[used - 1].Mesh)
+			AnimatedMeshGroups.push_back(used);
+		AnimatedNodeList[used++] = AnimatedNodeList[i];
+	}
+	AnimatedNodeList.set_used(used);
+	AnimatedMeshGroups.push_back(used);
+
+	// meshes are animated in place, so each one belongs to a single thread
+	AnimationThreads->parallelFor(AnimatedMeshGroups.size() - 1, [this](u32 group) {
+		const u32 begin = AnimatedMeshGroups[group];
+		const u32 end = AnimatedMeshGroups[group + 1];
+		for (u32 n = begin; n < end; ++n)
+			AnimatedNodeList[n].Node->prepareMeshForCurrentFrame(end - begin);
+	});
+
+	// scene nodes are only moved by the main thread
+	for (i = 0; i < AnimatedNodeList.size(); ++i)
+		AnimatedNodeList[i].Node->finishPreparedMesh();
+}
+
 //! Adds an external mesh loader.
 void CSceneManager::addExternalMeshLoader(IMeshLoader *externalLoader)
 {
@@ -739,6 +974,12 @@ bool CSceneManager::postEventFromUser(const SEvent &event)
 //! Removes all children of this scene node
 void CSceneManager::removeAll()
 {
+	if (SpatialIndex)
+		SpatialIndex->clear();
+	AnimatedNodes.clear();
+	StaticNodes.clear();
+	UnindexedNodes.clear();
+
 	ISceneNode::removeAll();
 	setActiveCamera(0);
 	// Make sure the driver is reset, might need a more complex method at some point
@@ -746,6 +987,146 @@ void CSceneManager::removeAll()
 		Driver->setMaterial(video::SMaterial());
 }
 
+//! Adds a child to the root node
+void CSceneManager::addChild(ISceneNode *child)
+{
+	ISceneNode::addChild(child);
+
+	// new children are animated and indexed in the next frame
+	if (SpatialIndex && child && child->getParent() == this)
+		AnimatedNodes.push_back(child);
+}
+
+//! Removes a child of the root node
+bool CSceneManager::removeChild(ISceneNode *child)
+{
+	if (SpatialIndex && child->getParent() == this) {
+		SpatialIndex->remove(child);
+		if (!StaticNodes.erase(child)) {
+			for (u32 i = 0; i < AnimatedNodes.size(); ++i) {
+				if (AnimatedNodes[i] == child) {
+					AnimatedNodes.erase(i);
+					break;
+				}
+			}
+		}
+		for (u32 i = 0; i < UnindexedNodes.size(); ++i) {
+			if (UnindexedNodes[i] == child) {
+				UnindexedNodes.erase(i);
+				break;
+			}
+		}
+	}
+
+	return ISceneNode::removeChild(child);
+}
+
+//! Animates a static indexed child again in the next frame
+void CSceneManager::OnChildChanged(ISceneNode *child)
+{
+	if (SpatialIndex && StaticNodes.erase(child))
+		AnimatedNodes.push_back(child);
+}
+
+//! Animates all scene nodes and updates the spatial index
+void CSceneManager::OnAnimate(u32 timeMs)
+{
+	if (!Parameters->getAttributeAsBool(SPATIAL_INDEX)) {
+		delete SpatialIndex;
+		SpatialIndex = 0;
+		AnimatedNodes.clear();
+		StaticNodes.clear();
+		UnindexedNodes.clear();
+
+		ISceneNode::OnAnimate(timeMs);
+		return;
+	}
+
+	if (!SpatialIndex) {
+		SpatialIndex = new CSceneNodeOctree();
+		for (ISceneNode *child : Children)
+			AnimatedNodes.push_back(child);
+	}
+
+	if (!IsVisible)
+		return;
+
+	updateAbsolutePosition();
+
+	// static nodes are indexed relative to the root node
+	if (AbsoluteTransformation != IndexedTransformation) {
+		for (ISceneNode *node : StaticNodes)
+			AnimatedNodes.push_back(node);
+		StaticNodes.clear();
+		IndexedTransformation = AbsoluteTransformation;
+	}
+
+	// Nodes are indexed after they moved, and leave the index as soon as
+	// they can't be skipped during registration anymore. Static nodes are
+	// left alone until they tell the root node that they changed, so only
+	// the nodes which may have changed are animated and tested here.
+	UnindexedNodes.set_used(0);
+	u32 kept = 0;
+	for (u32 i = 0; i < AnimatedNodes.size(); ++i) {
+		ISceneNode *node = AnimatedNodes[i];
+		node->OnAnimate(timeMs);
+
+		if (!isSpatiallyIndexable(node)) {
+			SpatialIndex->remove(node);
+			UnindexedNodes.push_back(node);
+		} else {
+			SpatialIndex->update(node);
+			if (isSpatiallyStatic(node)) {
+				StaticNodes.insert(node);
+				continue;
+			}
+		}
+		AnimatedNodes[kept++] = node;
+	}
+	AnimatedNodes.set_used(kept);
+}
+
+//! Lets all scene nodes register, skipping indexed nodes outside of the view
+void CSceneManager::OnRegisterSceneNode()
+{
+	if (!SpatialIndex) {
+		ISceneNode::OnRegisterSceneNode();
+		return;
+	}
+
+	if (!IsVisible)
+		return;
+
+	for (u32 i = 0; i < UnindexedNodes.size(); ++i)
+		UnindexedNodes[i]->OnRegisterSceneNode();
+
+	// the nodes still cull themselves, the index only rejects nodes
+	// which are certainly outside of the view
+	IndexedNodesInView.set_used(0);
+	if (ActiveCamera)
+		SpatialIndex->getVisibleNodes(*ActiveCamera->getViewFrustum(), IndexedNodesInView);
+	else
+		SpatialIndex->getAllNodes(IndexedNodesInView);
+
+	for (u32 i = 0; i < IndexedNodesInView.size(); ++i)
+		IndexedNodesInView[i]->OnRegisterSceneNode();
+}
+
+bool CSceneManager::isSpatiallyIndexable(ISceneNode *node) const
+{
+	// only nodes which do nothing but register themselves when in view
+	const ESCENE_NODE_TYPE type = node->getType();
+	return (type == ESNT_MESH || type == ESNT_ANIMATED_MESH) &&
+		   node->getChildren().empty() && node->getAutomaticCulling() != EAC_OFF;
+}
+
+bool CSceneManager::isSpatiallyStatic(ISceneNode *node) const
+{
+	// mesh nodes only move or change their box through the setters, nodes
+	// of other classes with the same type may animate themselves
+	return dynamic_cast<CMeshSceneNode *>(node) != 0;
+}
+
 //! Clears the whole scene. All scene nodes are removed.
 void CSceneManager::clear()
 {
@@ -11,9 +11,14 @@
 #include "irrArray.h"
 #include "IMeshLoader.h"
 #include "CAttributes.h"
+#include "SMeshBufferDraw.h"
+
+#include <unordered_set>
 
 namespace irr
 {
+class CThreadPool;
+
 namespace io
 {
 class IFileSystem;
@@ -21,6 +26,8 @@ class IFileSystem;
 namespace scene
 {
 class IMeshCache;
+class CAnimatedMeshSceneNode;
+class CSceneNodeOctree;
 
 /*!
 	The Scene Manager manages scene nodes, mesh resources, cameras and all the other stuff.
@@ -155,6 +162,18 @@ public:
 	//! Removes all children of this scene node
 	void removeAll() override;
 
+	//! Adds a child to the root node
+	void addChild(ISceneNode *child) override;
+
+	//! Removes a child of the root node
+	bool removeChild(ISceneNode *child) override;
+
+	//! Animates all scene nodes and updates the spatial index
+	void OnAnimate(u32 timeMs) override;
+
+	//! Lets all scene nodes register, skipping indexed nodes outside of the view
+	void OnRegisterSceneNode() override;
+
 	//! Returns interface to the parameters set in this scene.
 	io::IAttributes *getParameters() override;
 
@@ -192,30 +211,63 @@ private:
 	//! clears the deletion list
 	void clearDeletionList();
 
-	struct DefaultNodeEntry
+	//! skins the meshes of registered animated mesh nodes on the animation threads
+	void prepareAnimatedMeshes();
+
+	//! returns if a child of the root node may be kept in the spatial index
+	bool isSpatiallyIndexable(ISceneNode *node) const;
+
+	//! returns if an indexed node only changes through the setters which
+	//! notify its parent, so it doesn't need to be animated every frame
+	bool isSpatiallyStatic(ISceneNode *node) const;
+
+protected:
+	//! Animates a static indexed child again in the next frame
+	void OnChildChanged(ISceneNode *child) override;
+
+private:
+	//! animated mesh node of a render list, sorted by mesh
+	struct AnimatedNodeEntry
 	{
-		DefaultNodeEntry()
+		AnimatedNodeEntry()
 		{
 		}
 
-		DefaultNodeEntry(ISceneNode *n) :
-				Node(n), TextureValue(0)
+		AnimatedNodeEntry(CAnimatedMeshSceneNode *n, IAnimatedMesh *m) :
+				Node(n), Mesh(m)
 		{
-			if (n->getMaterialCount())
-				TextureValue = (n->getMaterial(0).getTexture(0));
 		}
 
-		bool operator<(const DefaultNodeEntry &other) const
+		bool operator<(const AnimatedNodeEntry &other) const
 		{
-			return (TextureValue < other.TextureValue);
+			if (Mesh != other.Mesh)
+				return Mesh < other.Mesh;
+			return Node < other.Node;
 		}
 
+		CAnimatedMeshSceneNode *Node;
+		IAnimatedMesh *Mesh;
+	};
+
+	//! one draw of the solid pass, sorted by render state
+	struct SolidDrawEntry
+	{
+		//! material type (8 bits), textures (24), other states (16), mesh
+		//! buffer (8) and depth (8), from high to low bits
+		u64 Key;
 		ISceneNode *Node;
+		//! mesh buffer of a CMeshSceneNode to draw, or NodeRender to call render()
+		u32 MeshBuffer;
 
-	private:
-		void *TextureValue;
+		static const u32 NodeRender = 0xffffffff;
 	};
 
+	//! builds the draws of the solid pass and sorts them
+	void sortSolidDraws();
+
+	//! renders the sorted draws of the solid pass
+	void renderSolidDraws();
+
 	//! sort on distance (center) to camera
 	struct TransparentNodeEntry
 	{
@@ -279,11 +331,38 @@ private:
 	//! render pass lists
 	core::array<ISceneNode *> CameraList;
 	core::array<ISceneNode *> SkyBoxList;
-	core::array<DefaultNodeEntry> SolidNodeList;
+	core::array<ISceneNode *> SolidNodeList;
 	core::array<TransparentNodeEntry> TransparentNodeList;
 	core::array<TransparentNodeEntry> TransparentEffectNodeList;
 	core::array<ISceneNode *> GuiNodeList;
 
+	//! draws of the solid pass and scratch space for sorting them
+	core::array<SolidDrawEntry> SolidDrawList;
+	core::array<SolidDrawEntry> SolidDrawSortBuffer;
+	//! mesh buffers of the solid pass passed to the driver at once
+	core::array<video::SMeshBufferDraw> MeshBufferDraws;
+
+	//! nodes prepared by prepareAnimatedMeshes() in this frame
+	core::array<AnimatedNodeEntry> AnimatedNodeList;
+	//! start of each group of nodes sharing a mesh in AnimatedNodeList
+	core::array<u32> AnimatedMeshGroups;
+	CThreadPool *AnimationThreads;
+
+	//! children of the root node sorted into a loose octree, null if disabled
+	CSceneNodeOctree *SpatialIndex;
+	//! children of the root node animated every frame, which includes
+	//! all nodes not in SpatialIndex and the static nodes which changed
+	core::array<ISceneNode *> AnimatedNodes;
+	//! children of the root node in SpatialIndex which are only animated
+	//! after they changed
+	std::unordered_set<ISceneNode *> StaticNodes;
+	//! transformation of the root node the static nodes were indexed with
+	core::matrix4 IndexedTransformation;
+	//! children of the root node which are not in SpatialIndex
+	core::array<ISceneNode *> UnindexedNodes;
+	//! scratch space for the indexed nodes in view
+	core::array<ISceneNode *> IndexedNodesInView;
+
 	core::array<IMeshLoader *> MeshLoaderList;
 	core::array<ISceneNode *> DeletionList;
 
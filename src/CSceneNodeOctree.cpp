@@ -0,0 +1,356 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeOctree.h"
+#include "ISceneNode.h"
+#include "FrustumBoxes.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+// Limits the depth for tiny boxes, counted from the cell a box starts in
+const u32 MAX_DEPTH = 20;
+
+u32 getOctant(const core::vector3df &center, const core::vector3df &point)
+{
+	return (point.X >= center.X ? 1 : 0) |
+		   (point.Y >= center.Y ? 2 : 0) |
+		   (point.Z >= center.Z ? 4 : 0);
+}
+
+core::vector3df getOctantCenter(const core::vector3df &center, f32 quarterSize, u32 octant)
+{
+	return core::vector3df(
+			center.X + ((octant & 1) ? quarterSize : -quarterSize),
+			center.Y + ((octant & 2) ? quarterSize : -quarterSize),
+			center.Z + ((octant & 4) ? quarterSize : -quarterSize));
+}
+} // end anonymous namespace
+
+CSceneNodeOctree::CSceneNodeOctree() :
+		Root(-1)
+{
+}
+
+void CSceneNodeOctree::update(ISceneNode *node)
+{
+	const core::matrix4 &transform = node->getAbsoluteTransformation();
+	const core::aabbox3df &localBox = node->getBoundingBox();
+
+	auto it = EntryIndex.find(node);
+	if (it != EntryIndex.end()) {
+		const SEntry &entry = Entries[it->second];
+		if (entry.LocalBox == localBox && entry.Transform == transform)
+			return;
+	}
+
+	core::aabbox3df box = localBox;
+	transform.transformBoxEx(box);
+	const u32 cell = findCell(box);
+
+	const bool added = it == EntryIndex.end();
+	u32 index;
+	if (added) {
+		index = Entries.size();
+		Entries.push_back(SEntry());
+		Entries[index].Node = node;
+		EntryIndex[node] = index;
+	} else {
+		index = it->second;
+	}
+
+	SEntry &entry = Entries[index];
+	entry.Transform = transform;
+	entry.LocalBox = localBox;
+	entry.Box = box;
+
+	if (added) {
+		insertIntoCell(index, cell);
+	} else if (entry.Cell != cell) {
+		// release after inserting, the new cell may still be empty
+		const u32 oldCell = entry.Cell;
+		removeFromCell(index);
+		insertIntoCell(index, cell);
+		releaseCells(oldCell);
+	} else {
+		storeBox(index);
+	}
+}
+
+void CSceneNodeOctree::remove(ISceneNode *node)
+{
+	auto it = EntryIndex.find(node);
+	if (it == EntryIndex.end())
+		return;
+
+	const u32 index = it->second;
+	const u32 cell = Entries[index].Cell;
+	EntryIndex.erase(it);
+	removeFromCell(index);
+
+	// move the last entry into the gap
+	const u32 last = Entries.size() - 1;
+	if (index != last) {
+		Entries[index] = Entries[last];
+		EntryIndex[Entries[index].Node] = index;
+		Cells[Entries[index].Cell].Entries[Entries[index].Slot] = index;
+	}
+	Entries.set_used(last);
+
+	releaseCells(cell);
+}
+
+void CSceneNodeOctree::clear()
+{
+	Entries.clear();
+	Cells.clear();
+	EntryIndex.clear();
+	FreeCells.clear();
+	Root = -1;
+}
+
+void CSceneNodeOctree::getVisibleNodes(const SViewFrustum &frustum, core::array<ISceneNode *> &outNodes) const
+{
+	if (Root >= 0)
+		collectVisible(Root, frustum, (1 << SViewFrustum::VF_PLANE_COUNT) - 1, outNodes);
+}
+
+void CSceneNodeOctree::getAllNodes(core::array<ISceneNode *> &outNodes) const
+{
+	for (u32 i = 0; i < Entries.size(); ++i)
+		outNodes.push_back(Entries[i].Node);
+}
+
+u32 CSceneNodeOctree::addCell(const core::vector3df &center, f32 halfSize, s32 parent)
+{
+	u32 index;
+	if (FreeCells.empty()) {
+		index = Cells.size();
+		Cells.push_back(SCell());
+	} else {
+		// the arrays of a released cell are empty, but keep their memory
+		index = FreeCells.getLast();
+		FreeCells.erase(FreeCells.size() - 1);
+	}
+
+	SCell &cell = Cells[index];
+	cell.Center = center;
+	cell.HalfSize = halfSize;
+	cell.Parent = parent;
+	for (u32 i = 0; i < 8; ++i)
+		cell.Children[i] = -1;
+	cell.SubtreeCount = 0;
+	return index;
+}
+
+u32 CSceneNodeOctree::findCell(const core::aabbox3df &box)
+{
+	const core::vector3df center = box.getCenter();
+	const core::vector3df extent = box.getExtent();
+	const f32 halfExtent = core::max_(extent.X, extent.Y, extent.Z) * 0.5f;
+
+	if (Root < 0)
+		Root = addCell(center, core::max_(halfExtent, 1.f), -1);
+
+	// Grow the root towards the box until it fits. Boxes with invalid
+	// coordinates never fit, they end up in the largest root.
+	for (u32 i = 0; i < 64; ++i) {
+		const core::vector3df rootCenter = Cells[Root].Center;
+		const f32 rootHalf = Cells[Root].HalfSize;
+		const core::vector3df offset = center - rootCenter;
+		if (halfExtent <= rootHalf && fabsf(offset.X) <= rootHalf &&
+				fabsf(offset.Y) <= rootHalf && fabsf(offset.Z) <= rootHalf)
+			break;
+
+		const u32 octant = getOctant(rootCenter, center);
+		const u32 grown = addCell(getOctantCenter(rootCenter, rootHalf, octant), rootHalf * 2.f, -1);
+
+		// the old root is the octant opposite to the growth direction
+		Cells[grown].Children[octant ^ 7] = Root;
+		Cells[grown].SubtreeCount = Cells[Root].SubtreeCount;
+		Cells[Root].Parent = grown;
+		Root = grown;
+	}
+
+	// descend while the box fits into the next smaller cells
+	u32 cell = Root;
+	for (u32 depth = 0; depth < MAX_DEPTH && Cells[cell].HalfSize * 0.5f >= halfExtent; ++depth) {
+		const u32 octant = getOctant(Cells[cell].Center, center);
+		s32 child = Cells[cell].Children[octant];
+		if (child < 0) {
+			const f32 childHalf = Cells[cell].HalfSize * 0.5f;
+			child = addCell(getOctantCenter(Cells[cell].Center, childHalf, octant), childHalf, cell);
+			Cells[cell].Children[octant] = child;
+		}
+		cell = child;
+	}
+
+	return cell;
+}
+
+void CSceneNodeOctree::insertIntoCell(u32 entry, u32 cell)
+{
+	SCell &c = Cells[cell];
+	Entries[entry].Cell = cell;
+	Entries[entry].Slot = c.Entries.size();
+	c.Entries.push_back(entry);
+	c.MinX.push_back(0.f);
+	c.MinY.push_back(0.f);
+	c.MinZ.push_back(0.f);
+	c.MaxX.push_back(0.f);
+	c.MaxY.push_back(0.f);
+	c.MaxZ.push_back(0.f);
+	storeBox(entry);
+
+	for (s32 i = cell; i >= 0; i = Cells[i].Parent)
+		++Cells[i].SubtreeCount;
+}
+
+void CSceneNodeOctree::removeFromCell(u32 entry)
+{
+	const u32 cell = Entries[entry].Cell;
+	SCell &c = Cells[cell];
+
+	// move the last entry of the cell into the gap
+	const u32 slot = Entries[entry].Slot;
+	const u32 last = c.Entries.size() - 1;
+	if (slot != last) {
+		c.Entries[slot] = c.Entries[last];
+		c.MinX[slot] = c.MinX[last];
+		c.MinY[slot] = c.MinY[last];
+		c.MinZ[slot] = c.MinZ[last];
+		c.MaxX[slot] = c.MaxX[last];
+		c.MaxY[slot] = c.MaxY[last];
+		c.MaxZ[slot] = c.MaxZ[last];
+		Entries[c.Entries[slot]].Slot = slot;
+	}
+	c.Entries.set_used(last);
+	c.MinX.set_used(last);
+	c.MinY.set_used(last);
+	c.MinZ.set_used(last);
+	c.MaxX.set_used(last);
+	c.MaxY.set_used(last);
+	c.MaxZ.set_used(last);
+
+	for (s32 i = cell; i >= 0; i = Cells[i].Parent)
+		--Cells[i].SubtreeCount;
+}
+
+void CSceneNodeOctree::releaseCells(u32 cell)
+{
+	if (!Cells[Root].SubtreeCount) {
+		// nothing left, start over with the next node
+		Cells.clear();
+		FreeCells.clear();
+		Root = -1;
+		return;
+	}
+
+	// Cells only hold nodes in their subtree while they are linked, so an
+	// empty cell has no children left: they were released before it.
+	s32 i = cell;
+	while (i != Root && !Cells[i].SubtreeCount) {
+		const s32 parent = Cells[i].Parent;
+		for (u32 octant = 0; octant < 8; ++octant) {
+			if (Cells[parent].Children[octant] == i)
+				Cells[parent].Children[octant] = -1;
+		}
+		FreeCells.push_back(i);
+		i = parent;
+	}
+
+	// a root without nodes of its own and a single child is replaced by it
+	while (Cells[Root].Entries.empty()) {
+		s32 child = -1;
+		u32 count = 0;
+		for (u32 octant = 0; octant < 8; ++octant) {
+			if (Cells[Root].Children[octant] >= 0) {
+				child = Cells[Root].Children[octant];
+				++count;
+			}
+		}
+		if (count != 1)
+			break;
+
+		FreeCells.push_back(Root);
+		Root = child;
+		Cells[Root].Parent = -1;
+	}
+}
+
+void CSceneNodeOctree::storeBox(u32 entry)
+{
+	const SEntry &e = Entries[entry];
+	SCell &c = Cells[e.Cell];
+	c.MinX[e.Slot] = e.Box.MinEdge.X;
+	c.MinY[e.Slot] = e.Box.MinEdge.Y;
+	c.MinZ[e.Slot] = e.Box.MinEdge.Z;
+	c.MaxX[e.Slot] = e.Box.MaxEdge.X;
+	c.MaxY[e.Slot] = e.Box.MaxEdge.Y;
+	c.MaxZ[e.Slot] = e.Box.MaxEdge.Z;
+}
+
+void CSceneNodeOctree::collectAll(u32 cell, core::array<ISceneNode *> &outNodes) const
+{
+	const SCell &c = Cells[cell];
+	for (u32 i = 0; i < c.Entries.size(); ++i)
+		outNodes.push_back(Entries[c.Entries[i]].Node);
+
+	for (u32 i = 0; i < 8; ++i) {
+		if (c.Children[i] >= 0 && Cells[c.Children[i]].SubtreeCount)
+			collectAll(c.Children[i], outNodes);
+	}
+}
+
+void CSceneNodeOctree::collectVisible(u32 cell, const SViewFrustum &frustum, u32 planeMask, core::array<ISceneNode *> &outNodes) const
+{
+	const SCell &c = Cells[cell];
+	if (!c.SubtreeCount)
+		return;
+
+	// loose bounds, which contain all boxes stored in or below the cell
+	const core::vector3df loose(c.HalfSize * 2.f);
+	const core::aabbox3df bounds(c.Center - loose, c.Center + loose);
+
+	// planes the cell is completely behind don't need to be tested below
+	for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; ++p) {
+		if (!(planeMask & (1 << p)))
+			continue;
+
+		const core::EIntersectionRelation3D relation = bounds.classifyPlaneRelation(frustum.planes[p]);
+		if (relation == core::ISREL3D_FRONT)
+			return;
+		if (relation == core::ISREL3D_BACK)
+			planeMask &= ~(1 << p);
+	}
+
+	if (!planeMask) {
+		collectAll(cell, outNodes);
+		return;
+	}
+
+	const u32 count = c.Entries.size();
+	if (count) {
+		VisibleBits.set_used((count + 31) / 32);
+		testFrustumBoxes(frustum, c.MinX.const_pointer(), c.MinY.const_pointer(), c.MinZ.const_pointer(),
+				c.MaxX.const_pointer(), c.MaxY.const_pointer(), c.MaxZ.const_pointer(),
+				count, VisibleBits.pointer(), planeMask);
+
+		for (u32 i = 0; i < count; ++i) {
+			if (VisibleBits[i / 32] & (1u << (i % 32)))
+				outNodes.push_back(Entries[c.Entries[i]].Node);
+		}
+	}
+
+	for (u32 i = 0; i < 8; ++i) {
+		if (c.Children[i] >= 0)
+			collectVisible(c.Children[i], frustum, planeMask, outNodes);
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,116 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "irrArray.h"
+#include "aabbox3d.h"
+#include "matrix4.h"
+
+#include <unordered_map>
+
+namespace irr
+{
+namespace scene
+{
+class ISceneNode;
+struct SViewFrustum;
+
+//! Loose octree over the world space bounding boxes of scene nodes
+/** Each node is stored in exactly one cell, chosen by the center and size of
+its box. Cells are twice as large as their octant, so a box fits into the
+cell of its center as long as it isn't larger than the octant. Moving a
+node only touches the cells it leaves and enters. The tree grows when a box
+lies outside of the root, and cells are released again when their last
+node leaves. */
+class CSceneNodeOctree
+{
+public:
+	CSceneNodeOctree();
+
+	//! Inserts a node, or updates its box if the node moved or changed
+	/** The node is not grabbed, remove it before it is deleted. */
+	void update(ISceneNode *node);
+
+	//! Removes a node, does nothing if it isn't in the tree
+	void remove(ISceneNode *node);
+
+	//! Checks if a node is in the tree
+	bool contains(ISceneNode *node) const { return EntryIndex.count(node) != 0; }
+
+	//! Removes all nodes
+	void clear();
+
+	//! Returns the number of nodes in the tree
+	u32 size() const { return Entries.size(); }
+
+	//! Returns the number of cells in use
+	u32 getCellCount() const { return Cells.size() - FreeCells.size(); }
+
+	//! Appends all nodes whose boxes are not completely outside of the frustum
+	/** Cells outside of the frustum are skipped with all their children,
+	cells inside of it are taken without testing the nodes. */
+	void getVisibleNodes(const SViewFrustum &frustum, core::array<ISceneNode *> &outNodes) const;
+
+	//! Appends all nodes in the tree
+	void getAllNodes(core::array<ISceneNode *> &outNodes) const;
+
+private:
+	struct SEntry
+	{
+		ISceneNode *Node;
+		//! transformation and box the world box was computed from
+		core::matrix4 Transform;
+		core::aabbox3df LocalBox;
+		core::aabbox3df Box;
+		u32 Cell;
+		//! position in the arrays of the cell
+		u32 Slot;
+	};
+
+	struct SCell
+	{
+		core::vector3df Center;
+		f32 HalfSize;
+		s32 Parent;
+		s32 Children[8];
+		//! indices into Entries of the nodes stored in this cell
+		core::array<u32> Entries;
+		//! world space boxes of these nodes, one array per coordinate for
+		//! testFrustumBoxes()
+		core::array<f32> MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
+		//! number of nodes in this cell and all cells below
+		u32 SubtreeCount;
+	};
+
+	u32 addCell(const core::vector3df &center, f32 halfSize, s32 parent);
+
+	//! Returns the cell a box belongs in, creating cells and growing the root as needed
+	u32 findCell(const core::aabbox3df &box);
+
+	void insertIntoCell(u32 entry, u32 cell);
+	void removeFromCell(u32 entry);
+
+	//! Releases a cell which became empty and the empty cells above it,
+	//! and shrinks the root while it only has a single child
+	void releaseCells(u32 cell);
+
+	//! Copies the box of an entry into the arrays of its cell
+	void storeBox(u32 entry);
+
+	void collectAll(u32 cell, core::array<ISceneNode *> &outNodes) const;
+	void collectVisible(u32 cell, const SViewFrustum &frustum, u32 planeMask, core::array<ISceneNode *> &outNodes) const;
+
+	core::array<SEntry> Entries;
+	core::array<SCell> Cells;
+	std::unordered_map<ISceneNode *, u32> EntryIndex;
+	//! released cells, which are reused by addCell()
+	core::array<u32> FreeCells;
+	s32 Root;
+
+	//! results of the box tests in collectVisible()
+	mutable core::array<u32> VisibleBits;
+};
+
+} // end namespace scene
+} // end namespace irr
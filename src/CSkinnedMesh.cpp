@@ -4,10 +4,21 @@
 
 #include "CSkinnedMesh.h"
 #include <optional>
+#include "CSkinnedMeshInstance.h"
 #include "CBoneSceneNode.h"
 #include "IAnimatedMeshSceneNode.h"
 #include "os.h"
 
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define IRR_SKINNING_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define IRR_SKINNING_NEON
+#endif
+
 namespace
 {
 // Frames must always be increasing, so we remove objects where this isn't the case
@@ -62,6 +73,144 @@ irr::u32 dropMiddleKeys(irr::core::array<T> &array, Cmp &cmp)
 	return d;
 }
 
+// Number of values stored per joint and sample by bakeAnimation()
+const irr::u32 BAKED_JOINT_SIZE = 10;
+
+// IEEE 754 half precision float, rounded to nearest
+irr::u16 floatToHalf(irr::f32 value)
+{
+	irr::u32 bits;
+	memcpy(&bits, &value, 4);
+
+	const irr::u16 sign = (bits >> 16) & 0x8000;
+	const irr::s32 exponent = (irr::s32)((bits >> 23) & 0xff) - 127 + 15;
+	irr::u32 mantissa = bits & 0x7fffff;
+
+	if (exponent >= 31) // overflow, infinity or nan
+		return sign | 0x7c00 | (((bits >> 23) & 0xff) == 0xff && mantissa ? 0x200 : 0);
+	if (exponent <= 0) { // denormal or zero
+		if (exponent < -10)
+			return sign;
+		mantissa |= 0x800000;
+		const irr::u32 shift = 14 - exponent;
+		return sign | ((mantissa + (1 << (shift - 1))) >> shift);
+	}
+	// rounding may carry into the exponent, which is still correct
+	return sign + (((irr::u32)exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1);
+}
+
+irr::f32 halfToFloat(irr::u16 value)
+{
+	const irr::u32 sign = (irr::u32)(value & 0x8000) << 16;
+	const irr::u32 exponent = (value >> 10) & 0x1f;
+	const irr::u32 mantissa = value & 0x3ff;
+
+	irr::u32 bits;
+	if (exponent == 0) {
+		// zero or denormal
+		const irr::f32 f = mantissa * (1.f / 16777216.f);
+		return sign ? -f : f;
+	} else if (exponent == 31) {
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	} else {
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+
+	irr::f32 result;
+	memcpy(&result, &bits, 4);
+	return result;
+}
+
+// Tracks with fewer keys are searched with a binary search only
+const irr::u32 MIN_KEYS_FOR_INDEX = 16;
+
+// cell of the key index a frame falls into
+template <class I> // I = CSkinnedMesh::SKeyIndex
+irr::u32 keyIndexCell(const I &index, irr::f32 frame)
+{
+	const irr::f32 cell = (frame - index.FirstFrame) * index.CellsPerFrame;
+	if (cell <= 0.f)
+		return 0;
+	return irr::core::min_((irr::u32)cell, index.FirstKey.size() - 1);
+}
+
+// Builds a grid with one cell per key over the frames of a sorted track
+template <class T, class I> // T = objects containing a "frame" variable
+void buildKeyIndex(const irr::core::array<T> &array, I &index)
+{
+	index.FirstKey.clear();
+	index.KeyCount = 0;
+
+	if (array.size() < MIN_KEYS_FOR_INDEX)
+		return;
+
+	const irr::f32 length = array.getLast().frame - array[0].frame;
+	if (length <= 0.f)
+		return;
+
+	index.FirstFrame = array[0].frame;
+	index.CellsPerFrame = array.size() / length;
+	index.KeyCount = array.size();
+	index.FirstKey.set_used(array.size());
+
+	// use the same cell computation as the lookup, so rounding can't
+	// make a cell start after the key searched for
+	irr::u32 k = 0;
+	for (irr::u32 c = 0; c < index.FirstKey.size(); ++c) {
+		while (k < array.size() && keyIndexCell(index, array[k].frame) < c)
+			++k;
+		index.FirstKey[c] = k;
+	}
+}
+
+// Finds the first key with a frame >= frame, or -1 if there is none.
+// Keys edited in place after the index was built may make the indexed
+// search land behind the key, then the track is searched without it.
+template <class T, class I> // T = objects containing a "frame" variable
+irr::s32 findKey(const irr::core::array<T> &array, const I &index, irr::f32 frame, irr::s32 &hint)
+{
+	// Test the Hints...
+	if (hint >= 0 && (irr::u32)hint < array.size()) {
+		// check this hint
+		if (hint > 0 && array[hint].frame >= frame && array[hint - 1].frame < frame)
+			return hint;
+		// check the next index
+		if (hint + 1 < (irr::s32)array.size() && array[hint + 1].frame >= frame && array[hint].frame < frame)
+			return ++hint;
+	}
+
+	// The hint test failed, search the key...
+	if (!(array.getLast().frame >= frame))
+		return -1;
+
+	irr::u32 i;
+	if (index.KeyCount == array.size()) {
+		// Keys should be sorted by frame
+		i = index.FirstKey[keyIndexCell(index, frame)];
+		while (array[i].frame < frame)
+			++i;
+		if (i == 0 || array[i - 1].frame < frame) {
+			hint = i;
+			return i;
+		}
+	}
+
+	irr::u32 count = array.size();
+	i = 0;
+	while (count > 0) {
+		const irr::u32 step = count / 2;
+		if (array[i + step].frame < frame) {
+			i += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+
+	hint = i;
+	return i;
+}
+
 bool identicalPos(const irr::scene::ISkinnedMesh::SPositionKey &a, const irr::scene::ISkinnedMesh::SPositionKey &b)
 {
 	return a.position == b.position;
@@ -76,6 +225,109 @@ bool identicalRotation(const irr::scene::ISkinnedMesh::SRotationKey &a, const ir
 {
 	return a.rotation == b.rotation;
 }
+
+// Skins count vertices in one pass. The matrices of all influences of a vertex
+// are blended first, then position and normal are transformed once.
+// Since the blend is linear this gives the same result as summing
+// the weighted transformed vertices.
+// vertices points to the Pos member of the first vertex, Normal must follow it.
+void skinVertices(irr::u8 *vertices, irr::u32 pitch, irr::u32 count,
+		const irr::u32 *vertexIds, const irr::u32 *firstInfluence,
+		const irr::u32 *joints, const irr::f32 *strengths,
+		const irr::core::vector3df *staticPos, const irr::core::vector3df *staticNormal,
+		const irr::core::matrix4 *matrices, bool normals)
+{
+	using namespace irr;
+
+	for (u32 i = 0; i < count; ++i) {
+		u32 k = firstInfluence[i];
+		const u32 end = firstInfluence[i + 1];
+
+		core::vector3df *out = reinterpret_cast<core::vector3df *>(vertices + vertexIds[i] * pitch);
+		const core::vector3df &p = staticPos[i];
+		const core::vector3df &n = staticNormal[i];
+
+#if defined(IRR_SKINNING_SSE)
+		// matrix4 is column major, so each column goes into one register
+		const f32 *m = matrices[joints[k]].pointer();
+		__m128 w = _mm_set1_ps(strengths[k]);
+		__m128 c0 = _mm_mul_ps(w, _mm_loadu_ps(m));
+		__m128 c1 = _mm_mul_ps(w, _mm_loadu_ps(m + 4));
+		__m128 c2 = _mm_mul_ps(w, _mm_loadu_ps(m + 8));
+		__m128 c3 = _mm_mul_ps(w, _mm_loadu_ps(m + 12));
+		for (++k; k < end; ++k) {
+			m = matrices[joints[k]].pointer();
+			w = _mm_set1_ps(strengths[k]);
+			c0 = _mm_add_ps(c0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+			c1 = _mm_add_ps(c1, _mm_mul_ps(w, _mm_loadu_ps(m + 4)));
+			c2 = _mm_add_ps(c2, _mm_mul_ps(w, _mm_loadu_ps(m + 8)));
+			c3 = _mm_add_ps(c3, _mm_mul_ps(w, _mm_loadu_ps(m + 12)));
+		}
+
+		f32 result[4];
+		const __m128 pos = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p.X)), _mm_mul_ps(c1, _mm_set1_ps(p.Y))),
+				_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(p.Z)), c3));
+		_mm_storeu_ps(result, pos);
+		out[0].set(result[0], result[1], result[2]);
+
+		if (normals) {
+			const __m128 normal = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(n.X)), _mm_mul_ps(c1, _mm_set1_ps(n.Y))),
+					_mm_mul_ps(c2, _mm_set1_ps(n.Z)));
+			_mm_storeu_ps(result, normal);
+			out[1].set(result[0], result[1], result[2]);
+		}
+#elif defined(IRR_SKINNING_NEON)
+		const f32 *m = matrices[joints[k]].pointer();
+		f32 w = strengths[k];
+		float32x4_t c0 = vmulq_n_f32(vld1q_f32(m), w);
+		float32x4_t c1 = vmulq_n_f32(vld1q_f32(m + 4), w);
+		float32x4_t c2 = vmulq_n_f32(vld1q_f32(m + 8), w);
+		float32x4_t c3 = vmulq_n_f32(vld1q_f32(m + 12), w);
+		for (++k; k < end; ++k) {
+			m = matrices[joints[k]].pointer();
+			w = strengths[k];
+			c0 = vmlaq_n_f32(c0, vld1q_f32(m), w);
+			c1 = vmlaq_n_f32(c1, vld1q_f32(m + 4), w);
+			c2 = vmlaq_n_f32(c2, vld1q_f32(m + 8), w);
+			c3 = vmlaq_n_f32(c3, vld1q_f32(m + 12), w);
+		}
+
+		f32 result[4];
+		vst1q_f32(result, vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(c3, c0, p.X), c1, p.Y), c2, p.Z));
+		out[0].set(result[0], result[1], result[2]);
+
+		if (normals) {
+			vst1q_f32(result, vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(c0, n.X), c1, n.Y), c2, n.Z));
+			out[1].set(result[0], result[1], result[2]);
+		}
+#else
+		// only the upper 3x4 part is needed
+		f32 c[12];
+		const f32 *m = matrices[joints[k]].pointer();
+		f32 w = strengths[k];
+		for (u32 j = 0; j < 12; ++j)
+			c[j] = m[(j / 3) * 4 + j % 3] * w;
+		for (++k; k < end; ++k) {
+			m = matrices[joints[k]].pointer();
+			w = strengths[k];
+			for (u32 j = 0; j < 12; ++j)
+				c[j] += m[(j / 3) * 4 + j % 3] * w;
+		}
+
+		out[0].set(c[0] * p.X + c[3] * p.Y + c[6] * p.Z + c[9],
+				c[1] * p.X + c[4] * p.Y + c[7] * p.Z + c[10],
+				c[2] * p.X + c[5] * p.Y + c[8] * p.Z + c[11]);
+
+		if (normals) {
+			out[1].set(c[0] * n.X + c[3] * n.Y + c[6] * n.Z,
+					c[1] * n.X + c[4] * n.Y + c[7] * n.Z,
+					c[2] * n.X + c[5] * n.Y + c[8] * n.Z);
+		}
+#endif
+	}
+}
 }
 
 namespace irr
@@ -85,7 +337,9 @@ namespace scene
 
 //! constructor
 CSkinnedMesh::CSkinnedMesh() :
-		SkinningBuffers(0), EndFrame(0.f), FramesPerSecond(25.f),
+		SkinningBuffers(0), BakedStartFrame(0.f), BakedSamplesPerFrame(0.f), BakedSampleCount(0),
+		PoseCacheSize(0),
+		EndFrame(0.f), FramesPerSecond(25.f),
 		LastAnimatedFrame(-1), SkinnedLastFrame(false),
 		InterpolationMode(EIM_LINEAR),
 		HasAnimation(false), PreparedForSkinning(false),
@@ -101,6 +355,8 @@ CSkinnedMesh::CSkinnedMesh() :
 //! destructor
 CSkinnedMesh::~CSkinnedMesh()
 {
+	clearPoseCache();
+
 	for (u32 i = 0; i < AllJoints.size(); ++i)
 		delete AllJoints[i];
 
@@ -161,6 +417,8 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 	if (blend <= 0.f)
 		return; // No need to animate
 
+	const s32 bakedSample = getBakedSample(frame);
+
 	for (u32 i = 0; i < AllJoints.size(); ++i) {
 		// The joints can be animated here with no input from their
 		// parents, but for setAnimationMode extra checks are needed
@@ -175,10 +433,13 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 		core::vector3df scale = oldScale;
 		core::quaternion rotation = oldRotation;
 
-		getFrameData(frame, joint,
-				position, joint->positionHint,
-				scale, joint->scaleHint,
-				rotation, joint->rotationHint);
+		if (bakedSample >= 0)
+			getBakedFrameData(bakedSample, i, position, scale, rotation);
+		else
+			getFrameData(frame, i,
+					position, joint->positionHint,
+					scale, joint->scaleHint,
+					rotation, joint->rotationHint);
 
 		if (blend == 1.0f) {
 			// No blending needed
@@ -288,11 +549,17 @@ void CSkinnedMesh::buildAllGlobalAnimatedMatrices(SJoint *joint, SJoint *parentJ
 		buildAllGlobalAnimatedMatrices(joint->Children[j], joint);
 }
 
-void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
+void CSkinnedMesh::getFrameData(f32 frame, u32 jointNr,
 		core::vector3df &position, s32 &positionHint,
 		core::vector3df &scale, s32 &scaleHint,
 		core::quaternion &rotation, s32 &rotationHint)
 {
+	const SJoint *joint = AllJoints[jointNr];
+
+	// joints added after finalize() have no index yet
+	static const SJointKeyIndex noIndex;
+	const SJointKeyIndex &index = jointNr < KeyIndices.size() ? KeyIndices[jointNr] : noIndex;
+
 	s32 foundPositionIndex = -1;
 	s32 foundScaleIndex = -1;
 	s32 foundRotationIndex = -1;
@@ -303,33 +570,7 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 		const core::array<SRotationKey> &RotationKeys = joint->UseAnimationFrom->RotationKeys;
 
 		if (PositionKeys.size()) {
-			foundPositionIndex = -1;
-
-			// Test the Hints...
-			if (positionHint >= 0 && (u32)positionHint < PositionKeys.size()) {
-				// check this hint
-				if (positionHint > 0 && PositionKeys[positionHint].frame >= frame && PositionKeys[positionHint - 1].frame < frame)
-					foundPositionIndex = positionHint;
-				else if (positionHint + 1 < (s32)PositionKeys.size()) {
-					// check the next index
-					if (PositionKeys[positionHint + 1].frame >= frame &&
-							PositionKeys[positionHint + 0].frame < frame) {
-						positionHint++;
-						foundPositionIndex = positionHint;
-					}
-				}
-			}
-
-			// The hint test failed, do a full scan...
-			if (foundPositionIndex == -1) {
-				for (u32 i = 0; i < PositionKeys.size(); ++i) {
-					if (PositionKeys[i].frame >= frame) { // Keys should to be sorted by frame
-						foundPositionIndex = i;
-						positionHint = i;
-						break;
-					}
-				}
-			}
+			foundPositionIndex = findKey(PositionKeys, index.Position, frame, positionHint);
 
 			// Do interpolation...
 			if (foundPositionIndex != -1) {
@@ -349,33 +590,7 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 		//------------------------------------------------------------
 
 		if (ScaleKeys.size()) {
-			foundScaleIndex = -1;
-
-			// Test the Hints...
-			if (scaleHint >= 0 && (u32)scaleHint < ScaleKeys.size()) {
-				// check this hint
-				if (scaleHint > 0 && ScaleKeys[scaleHint].frame >= frame && ScaleKeys[scaleHint - 1].frame < frame)
-					foundScaleIndex = scaleHint;
-				else if (scaleHint + 1 < (s32)ScaleKeys.size()) {
-					// check the next index
-					if (ScaleKeys[scaleHint + 1].frame >= frame &&
-							ScaleKeys[scaleHint + 0].frame < frame) {
-						scaleHint++;
-						foundScaleIndex = scaleHint;
-					}
-				}
-			}
-
-			// The hint test failed, do a full scan...
-			if (foundScaleIndex == -1) {
-				for (u32 i = 0; i < ScaleKeys.size(); ++i) {
-					if (ScaleKeys[i].frame >= frame) { // Keys should to be sorted by frame
-						foundScaleIndex = i;
-						scaleHint = i;
-						break;
-					}
-				}
-			}
+			foundScaleIndex = findKey(ScaleKeys, index.Scale, frame, scaleHint);
 
 			// Do interpolation...
 			if (foundScaleIndex != -1) {
@@ -395,33 +610,7 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 		//-------------------------------------------------------------
 
 		if (RotationKeys.size()) {
-			foundRotationIndex = -1;
-
-			// Test the Hints...
-			if (rotationHint >= 0 && (u32)rotationHint < RotationKeys.size()) {
-				// check this hint
-				if (rotationHint > 0 && RotationKeys[rotationHint].frame >= frame && RotationKeys[rotationHint - 1].frame < frame)
-					foundRotationIndex = rotationHint;
-				else if (rotationHint + 1 < (s32)RotationKeys.size()) {
-					// check the next index
-					if (RotationKeys[rotationHint + 1].frame >= frame &&
-							RotationKeys[rotationHint + 0].frame < frame) {
-						rotationHint++;
-						foundRotationIndex = rotationHint;
-					}
-				}
-			}
-
-			// The hint test failed, do a full scan...
-			if (foundRotationIndex == -1) {
-				for (u32 i = 0; i < RotationKeys.size(); ++i) {
-					if (RotationKeys[i].frame >= frame) { // Keys should be sorted by frame
-						foundRotationIndex = i;
-						rotationHint = i;
-						break;
-					}
-				}
-			}
+			foundRotationIndex = findKey(RotationKeys, index.Rotation, frame, rotationHint);
 
 			// Do interpolation...
 			if (foundRotationIndex != -1) {
@@ -448,6 +637,107 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 	}
 }
 
+bool CSkinnedMesh::bakeAnimation(f32 startFrame, f32 endFrame, f32 samplesPerFrame, bool halfPrecision)
+{
+	clearBakedAnimation();
+
+	if (!HasAnimation || !(endFrame >= startFrame) || !(samplesPerFrame > 0.f))
+		return false;
+
+	const u32 sampleCount = core::floor32((endFrame - startFrame) * samplesPerFrame) + 1;
+	core::array<f32> poses;
+	poses.set_used(sampleCount * AllJoints.size() * BAKED_JOINT_SIZE);
+
+	f32 *out = poses.pointer();
+	for (u32 s = 0; s < sampleCount; ++s) {
+		const f32 frame = core::min_(startFrame + s / samplesPerFrame, endFrame);
+		for (u32 i = 0; i < AllJoints.size(); ++i) {
+			SJoint *joint = AllJoints[i];
+
+			// tracks without keys keep their current value
+			core::vector3df position = joint->Animatedposition;
+			core::vector3df scale = joint->Animatedscale;
+			core::quaternion rotation = joint->Animatedrotation;
+			getFrameData(frame, i,
+					position, joint->positionHint,
+					scale, joint->scaleHint,
+					rotation, joint->rotationHint);
+
+			*out++ = rotation.X;
+			*out++ = rotation.Y;
+			*out++ = rotation.Z;
+			*out++ = rotation.W;
+			*out++ = position.X;
+			*out++ = position.Y;
+			*out++ = position.Z;
+			*out++ = scale.X;
+			*out++ = scale.Y;
+			*out++ = scale.Z;
+		}
+	}
+
+	if (halfPrecision) {
+		BakedPosesHalf.set_used(poses.size());
+		for (u32 i = 0; i < poses.size(); ++i)
+			BakedPosesHalf[i] = floatToHalf(poses[i]);
+	} else {
+		BakedPoses.swap(poses);
+	}
+
+	BakedStartFrame = startFrame;
+	BakedSamplesPerFrame = samplesPerFrame;
+	BakedSampleCount = sampleCount;
+
+	// make sure the next animateMesh() and pose use the table
+	LastAnimatedFrame = -1;
+	clearPoseCache();
+
+	const u32 bytes = halfPrecision ? BakedPosesHalf.size() * sizeof(u16) : BakedPoses.size() * sizeof(f32);
+	os::Printer::log("Skinned Mesh - baked animation bytes", core::stringc(bytes).c_str(), ELL_DEBUG);
+	return true;
+}
+
+void CSkinnedMesh::clearBakedAnimation()
+{
+	if (BakedSampleCount)
+		clearPoseCache();
+	BakedPoses.clear();
+	BakedPosesHalf.clear();
+	BakedSampleCount = 0;
+	LastAnimatedFrame = -1;
+}
+
+s32 CSkinnedMesh::getBakedSample(f32 frame) const
+{
+	if (!BakedSampleCount)
+		return -1;
+
+	const f32 sample = (frame - BakedStartFrame) * BakedSamplesPerFrame + 0.5f;
+	if (!(sample >= 0.f) || sample >= BakedSampleCount + 0.5f)
+		return -1;
+
+	return core::min_((u32)sample, BakedSampleCount - 1);
+}
+
+void CSkinnedMesh::getBakedFrameData(u32 sample, u32 jointNr,
+		core::vector3df &position, core::vector3df &scale, core::quaternion &rotation) const
+{
+	const u32 offset = (sample * AllJoints.size() + jointNr) * BAKED_JOINT_SIZE;
+
+	if (BakedPosesHalf.size()) {
+		const u16 *in = &BakedPosesHalf[offset];
+		rotation.set(halfToFloat(in[0]), halfToFloat(in[1]), halfToFloat(in[2]), halfToFloat(in[3]));
+		rotation.normalize();
+		position.set(halfToFloat(in[4]), halfToFloat(in[5]), halfToFloat(in[6]));
+		scale.set(halfToFloat(in[7]), halfToFloat(in[8]), halfToFloat(in[9]));
+	} else {
+		const f32 *in = &BakedPoses[offset];
+		rotation.set(in[0], in[1], in[2], in[3]);
+		position.set(in[4], in[5], in[6]);
+		scale.set(in[7], in[8], in[9]);
+	}
+}
+
 //--------------------------------------------------------------------------
 //				Software Skinning
 //--------------------------------------------------------------------------
@@ -476,14 +766,29 @@ void CSkinnedMesh::skinMesh()
 			}
 		}
 
-		// clear skinning helper array
-		for (i = 0; i < Vertices_Moved.size(); ++i)
-			for (u32 j = 0; j < Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j] = false;
+		// Find each joints pull on vertices...
+		SkinningMatrices.set_used(AllJoints.size());
+		for (i = 0; i < AllJoints.size(); ++i) {
+			if (AllJoints[i]->Weights.size())
+				SkinningMatrices[i].setbyproduct(AllJoints[i]->GlobalAnimatedMatrix, AllJoints[i]->GlobalInversedMatrix);
+		}
 
-		// skin starting with the root joints
-		for (i = 0; i < RootJoints.size(); ++i)
-			skinJoint(RootJoints[i], 0);
+		// Skin Vertices Positions and Normals...
+		for (i = 0; i < SkinningTables.size(); ++i) {
+			const SSkinningTable &table = SkinningTables[i];
+			SSkinMeshBuffer *buffer = (*SkinningBuffers)[i];
+
+			if (!table.VertexIds.empty()) {
+				skinVertices(static_cast<u8 *>(buffer->getVertices()),
+						video::getVertexPitchFromType(buffer->getVertexType()),
+						table.VertexIds.size(), table.VertexIds.const_pointer(),
+						table.FirstInfluence.const_pointer(), table.Joints.const_pointer(),
+						table.Strengths.const_pointer(), table.StaticPos.const_pointer(),
+						table.StaticNormal.const_pointer(), SkinningMatrices.const_pointer(),
+						AnimateNormals);
+				buffer->boundingBoxNeedsRecalculated();
+			}
+		}
 
 		for (i = 0; i < SkinningBuffers->size(); ++i)
 			(*SkinningBuffers)[i]->setDirty(EBT_VERTEX);
@@ -491,52 +796,83 @@ void CSkinnedMesh::skinMesh()
 	updateBoundingBox();
 }
 
-void CSkinnedMesh::skinJoint(SJoint *joint, SJoint *parentJoint)
+//! Sets how many skinned poses may be kept for animated mesh scene nodes
+void CSkinnedMesh::setPoseCacheSize(u32 size)
 {
-	if (joint->Weights.size()) {
-		// Find this joints pull on vertices...
-		core::matrix4 jointVertexPull(core::matrix4::EM4CONST_NOTHING);
-		jointVertexPull.setbyproduct(joint->GlobalAnimatedMatrix, joint->GlobalInversedMatrix);
-
-		core::vector3df thisVertexMove, thisNormalMove;
-
-		core::array<scene::SSkinMeshBuffer *> &buffersUsed = *SkinningBuffers;
-
-		// Skin Vertices Positions and Normals...
-		for (u32 i = 0; i < joint->Weights.size(); ++i) {
-			SWeight &weight = joint->Weights[i];
-
-			// Pull this vertex...
-			jointVertexPull.transformVect(thisVertexMove, weight.StaticPos);
+	PoseCacheSize = size;
+	if (PoseCache.size() > size)
+		clearPoseCache();
+}
 
-			if (AnimateNormals)
-				jointVertexPull.rotateVect(thisNormalMove, weight.StaticNormal);
+IMesh *CSkinnedMesh::getSkinnedPose(f32 frame, f32 blend, u32 timeMs)
+{
+	if (!PoseCacheSize || !HasAnimation || HardwareSkinning) {
+		animateMesh(frame, blend);
+		skinMesh();
+		return this;
+	}
 
-			if (!(*(weight.Moved))) {
-				*(weight.Moved) = true;
+	CSkinnedMeshInstance *instance = 0;
+	for (u32 i = 0; i < PoseCache.size(); ++i) {
+		CSkinnedMeshInstance *cached = PoseCache[i];
+		if (cached->Frame == frame && cached->Blend == blend) {
+			instance = cached;
+			if (instance->isInSync(LocalBuffers)) {
+				instance->LastUsedMs = timeMs;
+				return instance;
+			}
+			break; // buffers changed, skin again
+		}
+		// a pose nobody asked for during this frame can be replaced
+		if (!instance && cached->LastUsedMs != timeMs)
+			instance = cached;
+	}
 
-				buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Pos = thisVertexMove * weight.strength;
+	if (!instance) {
+		if (PoseCache.size() == PoseCacheSize) {
+			// every pose is still shown by a node, don't take one away
+			animateMesh(frame, blend);
+			skinMesh();
+			return this;
+		}
+		instance = new CSkinnedMeshInstance();
+		PoseCache.push_back(instance);
+	}
 
-				if (AnimateNormals)
-					buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Normal = thisNormalMove * weight.strength;
+	animateMesh(frame, blend);
 
-				//*(weight._Pos) = thisVertexMove * weight.strength;
-			} else {
-				buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Pos += thisVertexMove * weight.strength;
+	instance->sync(LocalBuffers);
+	skinInstance(instance);
+	instance->Frame = frame;
+	instance->Blend = blend;
+	instance->LastUsedMs = timeMs;
+	return instance;
+}
 
-				if (AnimateNormals)
-					buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Normal += thisNormalMove * weight.strength;
+//! Skins the current joint pose into the buffers of an instance
+void CSkinnedMesh::skinInstance(CSkinnedMeshInstance *instance)
+{
+	// skinMesh() works on SkinningBuffers, redirect it to the instance.
+	// This leaves LocalBuffers untouched, so their state and the box of
+	// the mesh are restored afterwards.
+	const bool skinnedLastFrame = SkinnedLastFrame;
+	const core::aabbox3df boundingBox = BoundingBox;
+	SkinningBuffers = &instance->Buffers;
+	SkinnedLastFrame = false;
 
-				//*(weight._Pos) += thisVertexMove * weight.strength;
-			}
+	skinMesh();
+	instance->BoundingBox = BoundingBox;
 
-			buffersUsed[weight.buffer_id]->boundingBoxNeedsRecalculated();
-		}
-	}
+	SkinningBuffers = &LocalBuffers;
+	SkinnedLastFrame = skinnedLastFrame;
+	BoundingBox = boundingBox;
+}
 
-	// Skin all children
-	for (u32 j = 0; j < joint->Children.size(); ++j)
-		skinJoint(joint->Children[j], joint);
+void CSkinnedMesh::clearPoseCache()
+{
+	for (u32 i = 0; i < PoseCache.size(); ++i)
+		PoseCache[i]->drop();
+	PoseCache.clear();
 }
 
 E_ANIMATED_MESH_TYPE CSkinnedMesh::getMeshType() const
@@ -646,7 +982,10 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 		}
 	}
 
+	clearBakedAnimation();
+	clearPoseCache();
 	checkForAnimation();
+	buildKeyIndices();
 
 	return !unmatched;
 }
@@ -656,12 +995,18 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 //! True= Update normals (default)
 void CSkinnedMesh::updateNormalsWhenAnimating(bool on)
 {
+	if (on != AnimateNormals)
+		clearPoseCache();
 	AnimateNormals = on;
 }
 
 //! Sets Interpolation Mode
 void CSkinnedMesh::setInterpolationMode(E_INTERPOLATION_MODE mode)
 {
+	if (mode != InterpolationMode) {
+		clearBakedAnimation();
+		clearPoseCache();
+	}
 	InterpolationMode = mode;
 }
 
@@ -716,6 +1061,7 @@ void CSkinnedMesh::refreshJointCache()
 			joint->Weights[j].StaticNormal = LocalBuffers[buffer_id]->getVertex(vertex_id)->Normal;
 		}
 	}
+	buildSkinningTables();
 }
 
 void CSkinnedMesh::resetAnimation()
@@ -764,6 +1110,25 @@ void CSkinnedMesh::calculateGlobalMatrices(SJoint *joint, SJoint *parentJoint)
 	SkinnedLastFrame = false;
 }
 
+//! Builds the key indices for the tracks the joints are animated with
+void CSkinnedMesh::buildKeyIndices()
+{
+	KeyIndices.set_used(AllJoints.size());
+	for (u32 i = 0; i < AllJoints.size(); ++i) {
+		SJointKeyIndex &index = KeyIndices[i];
+		const SJoint *joint = AllJoints[i]->UseAnimationFrom;
+		if (!joint) {
+			index = SJointKeyIndex();
+			continue;
+		}
+
+		// For long tracks: make key lookup independent of the track length
+		buildKeyIndex(joint->PositionKeys, index.Position);
+		buildKeyIndex(joint->ScaleKeys, index.Scale);
+		buildKeyIndex(joint->RotationKeys, index.Rotation);
+	}
+}
+
 void CSkinnedMesh::checkForAnimation()
 {
 	u32 i, j;
@@ -828,12 +1193,6 @@ void CSkinnedMesh::checkForAnimation()
 			}
 		}
 
-		// An array used in skinning
-
-		for (i = 0; i < Vertices_Moved.size(); ++i)
-			for (j = 0; j < Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j] = false;
-
 		// For skinning: cache weight values for speed
 
 		for (i = 0; i < AllJoints.size(); ++i) {
@@ -842,7 +1201,6 @@ void CSkinnedMesh::checkForAnimation()
 				const u16 buffer_id = joint->Weights[j].buffer_id;
 				const u32 vertex_id = joint->Weights[j].vertex_id;
 
-				joint->Weights[j].Moved = &Vertices_Moved[buffer_id][vertex_id];
 				joint->Weights[j].StaticPos = LocalBuffers[buffer_id]->getVertex(vertex_id)->Pos;
 				joint->Weights[j].StaticNormal = LocalBuffers[buffer_id]->getVertex(vertex_id)->Normal;
 
@@ -852,10 +1210,68 @@ void CSkinnedMesh::checkForAnimation()
 
 		// normalize weights
 		normalizeWeights();
+
+		buildSkinningTables();
 	}
 	SkinnedLastFrame = false;
 }
 
+//! Sorts the weights of all joints by buffer and vertex
+void CSkinnedMesh::buildSkinningTables()
+{
+	struct SInfluence
+	{
+		u32 vertex;
+		u32 joint;
+		f32 strength;
+		const SWeight *weight;
+
+		bool operator<(const SInfluence &other) const
+		{
+			if (vertex != other.vertex)
+				return vertex < other.vertex;
+			return joint < other.joint;
+		}
+	};
+
+	core::array<core::array<SInfluence>> influences;
+	influences.set_used(LocalBuffers.size());
+
+	for (u32 i = 0; i < AllJoints.size(); ++i) {
+		const SJoint *joint = AllJoints[i];
+		for (u32 j = 0; j < joint->Weights.size(); ++j) {
+			const SWeight &weight = joint->Weights[j];
+			influences[weight.buffer_id].push_back({weight.vertex_id, i, weight.strength, &weight});
+		}
+	}
+
+	SkinningTables.set_used(LocalBuffers.size());
+	for (u32 b = 0; b < influences.size(); ++b) {
+		core::array<SInfluence> &list = influences[b];
+		SSkinningTable &table = SkinningTables[b];
+		list.sort();
+
+		table.VertexIds.clear();
+		table.FirstInfluence.clear();
+		table.Joints.set_used(list.size());
+		table.Strengths.set_used(list.size());
+		table.StaticPos.clear();
+		table.StaticNormal.clear();
+
+		for (u32 i = 0; i < list.size(); ++i) {
+			if (i == 0 || list[i].vertex != list[i - 1].vertex) {
+				table.VertexIds.push_back(list[i].vertex);
+				table.FirstInfluence.push_back(i);
+				table.StaticPos.push_back(list[i].weight->StaticPos);
+				table.StaticNormal.push_back(list[i].weight->StaticNormal);
+			}
+			table.Joints[i] = list[i].joint;
+			table.Strengths[i] = list[i].strength;
+		}
+		table.FirstInfluence.push_back(list.size());
+	}
+}
+
 //! called by loader after populating with mesh and bone data
 void CSkinnedMesh::finalize()
 {
@@ -897,13 +1313,6 @@ void CSkinnedMesh::finalize()
 		AllJoints[i]->UseAnimationFrom = AllJoints[i];
 	}
 
-	// Set array sizes...
-
-	for (i = 0; i < LocalBuffers.size(); ++i) {
-		Vertices_Moved.push_back(core::array<char>());
-		Vertices_Moved[i].set_used(LocalBuffers[i]->getVertexCount());
-	}
-
 	checkForAnimation();
 
 	if (HasAnimation) {
@@ -980,6 +1389,7 @@ void CSkinnedMesh::finalize()
 					Key->frame = EndFrame;
 				}
 			}
+
 		}
 
 		if (redundantPosKeys > 0) {
@@ -1002,6 +1412,8 @@ void CSkinnedMesh::finalize()
 		}
 	}
 
+	buildKeyIndices();
+
 	// Needed for animation and skinning...
 
 	calculateGlobalMatrices(0, 0);
@@ -17,6 +17,7 @@ namespace scene
 
 class IAnimatedMeshSceneNode;
 class IBoneSceneNode;
+class CSkinnedMeshInstance;
 
 class CSkinnedMesh : public ISkinnedMesh
 {
@@ -49,6 +50,28 @@ public:
 	//! Preforms a software skin on this mesh based of joint positions
 	void skinMesh() override;
 
+	//! Sets how many skinned poses may be kept for animated mesh scene nodes
+	void setPoseCacheSize(u32 size) override;
+
+	//! Returns how many skinned poses may be kept
+	u32 getPoseCacheSize() const { return PoseCacheSize; }
+
+	//! Samples the joint transforms of a frame range into a table
+	bool bakeAnimation(f32 startFrame, f32 endFrame, f32 samplesPerFrame = 1.f, bool halfPrecision = false) override;
+
+	//! Removes the table created by bakeAnimation()
+	void clearBakedAnimation() override;
+
+	//! Returns a mesh skinned at the given pose
+	/** Uses the pose cache if enabled, otherwise animates and skins this mesh
+	itself and returns it. The mesh is skinned in place as well when every
+	cached pose was handed out during this frame already.
+	\param timeMs Time of the current scene frame. Cached poses handed out
+	during this frame are not recycled for other poses.
+	\return A cached pose, which stays valid for the rest of the frame, or
+	this mesh, which stays valid until the next call. */
+	IMesh *getSkinnedPose(f32 frame, f32 blend, u32 timeMs);
+
 	//! returns amount of mesh buffers.
 	u32 getMeshBufferCount() const override;
 
@@ -167,14 +190,27 @@ private:
 
 	void buildAllGlobalAnimatedMatrices(SJoint *Joint = 0, SJoint *ParentJoint = 0);
 
-	void getFrameData(f32 frame, SJoint *Node,
+	void getFrameData(f32 frame, u32 jointNr,
 			core::vector3df &position, s32 &positionHint,
 			core::vector3df &scale, s32 &scaleHint,
 			core::quaternion &rotation, s32 &rotationHint);
 
 	void calculateGlobalMatrices(SJoint *Joint, SJoint *ParentJoint);
 
-	void skinJoint(SJoint *Joint, SJoint *ParentJoint);
+	//! Returns the baked sample for a frame or -1 if it isn't baked
+	s32 getBakedSample(f32 frame) const;
+
+	void getBakedFrameData(u32 sample, u32 jointNr,
+			core::vector3df &position, core::vector3df &scale, core::quaternion &rotation) const;
+
+	void buildSkinningTables();
+
+	//! Builds the key indices for the tracks the joints are animated with
+	void buildKeyIndices();
+
+	void skinInstance(CSkinnedMeshInstance *instance);
+
+	void clearPoseCache();
 
 	void calculateTangents(core::vector3df &normal,
 			core::vector3df &tangent, core::vector3df &binormal,
@@ -188,12 +224,65 @@ private:
 	core::array<SJoint *> AllJoints;
 	core::array<SJoint *> RootJoints;
 
-	// bool can't be used here because std::vector<bool>
-	// doesn't allow taking a reference to individual elements.
-	core::array<core::array<char>> Vertices_Moved;
+	//! Weights of one mesh buffer, sorted by vertex for skinning
+	struct SSkinningTable
+	{
+		//! Skinned vertices in ascending order
+		core::array<u32> VertexIds;
+		//! Start of the influences of each vertex, plus the end of the last one
+		core::array<u32> FirstInfluence;
+		//! Index into AllJoints and strength of each influence
+		core::array<u32> Joints;
+		core::array<f32> Strengths;
+		//! Unskinned position and normal of each vertex
+		core::array<core::vector3df> StaticPos;
+		core::array<core::vector3df> StaticNormal;
+	};
+
+	core::array<SSkinningTable> SkinningTables;
+
+	//! Uniform grid over the frames of a key track for constant time lookup
+	struct SKeyIndex
+	{
+		SKeyIndex() :
+				FirstFrame(0.f), CellsPerFrame(0.f), KeyCount(0) {}
+
+		f32 FirstFrame;
+		f32 CellsPerFrame;
+		//! Size of the track the index was built for
+		u32 KeyCount;
+		//! First key in or after each cell
+		core::array<u32> FirstKey;
+	};
+
+	//! Indices of the position, scale and rotation tracks of a joint's
+	//! UseAnimationFrom joint, which may belong to another mesh
+	struct SJointKeyIndex
+	{
+		SKeyIndex Position;
+		SKeyIndex Scale;
+		SKeyIndex Rotation;
+	};
+
+	//! Key indices by joint number
+	core::array<SJointKeyIndex> KeyIndices;
+
+	//! Per joint transformation from static pose to animated pose
+	core::array<core::matrix4> SkinningMatrices;
 
 	core::aabbox3d<f32> BoundingBox;
 
+	//! Joint transforms written by bakeAnimation(), either as f32 or as
+	//! 16 bit floats. Rotation, position and scale of each joint per sample.
+	core::array<f32> BakedPoses;
+	core::array<u16> BakedPosesHalf;
+	f32 BakedStartFrame;
+	f32 BakedSamplesPerFrame;
+	u32 BakedSampleCount;
+
+	core::array<CSkinnedMeshInstance *> PoseCache;
+	u32 PoseCacheSize;
+
 	f32 EndFrame;
 	f32 FramesPerSecond;
 
@@ -0,0 +1,142 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSkinnedMeshInstance.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+CSkinnedMeshInstance::CSkinnedMeshInstance() :
+		Frame(-1.f), Blend(0.f), LastUsedMs(0)
+{
+#ifdef _DEBUG
+	setDebugName("CSkinnedMeshInstance");
+#endif
+}
+
+//! destructor
+CSkinnedMeshInstance::~CSkinnedMeshInstance()
+{
+	for (u32 i = 0; i < Buffers.size(); ++i)
+		Buffers[i]->drop();
+}
+
+//! returns amount of mesh buffers.
+u32 CSkinnedMeshInstance::getMeshBufferCount() const
+{
+	return Buffers.size();
+}
+
+//! returns pointer to a mesh buffer
+IMeshBuffer *CSkinnedMeshInstance::getMeshBuffer(u32 nr) const
+{
+	if (nr < Buffers.size())
+		return Buffers[nr];
+	else
+		return 0;
+}
+
+//! Returns pointer to a mesh buffer which fits a material
+IMeshBuffer *CSkinnedMeshInstance::getMeshBuffer(const video::SMaterial &material) const
+{
+	for (u32 i = 0; i < Buffers.size(); ++i) {
+		if (Buffers[i]->getMaterial() == material)
+			return Buffers[i];
+	}
+	return 0;
+}
+
+//! returns an axis aligned bounding box
+const core::aabbox3d<f32> &CSkinnedMeshInstance::getBoundingBox() const
+{
+	return BoundingBox;
+}
+
+//! set user axis aligned bounding box
+void CSkinnedMeshInstance::setBoundingBox(const core::aabbox3df &box)
+{
+	BoundingBox = box;
+}
+
+//! set the hardware mapping hint, for driver
+void CSkinnedMeshInstance::setHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint,
+		E_BUFFER_TYPE buffer)
+{
+	for (u32 i = 0; i < Buffers.size(); ++i)
+		Buffers[i]->setHardwareMappingHint(newMappingHint, buffer);
+}
+
+//! flags the meshbuffer as changed, reloads hardware buffers
+void CSkinnedMeshInstance::setDirty(E_BUFFER_TYPE buffer)
+{
+	for (u32 i = 0; i < Buffers.size(); ++i)
+		Buffers[i]->setDirty(buffer);
+}
+
+bool CSkinnedMeshInstance::isInSync(const core::array<SSkinMeshBuffer *> &source) const
+{
+	if (source.size() != Buffers.size())
+		return false;
+
+	for (u32 i = 0; i < source.size(); ++i) {
+		if (source[i]->getChangedID_Vertex() != SourceChangedID_Vertex[i] ||
+				source[i]->getChangedID_Index() != SourceChangedID_Index[i])
+			return false;
+	}
+	return true;
+}
+
+void CSkinnedMeshInstance::sync(const core::array<SSkinMeshBuffer *> &source)
+{
+	// the skinned mesh doesn't add or remove buffers after finalize(),
+	// so a changed count only happens for a fresh instance
+	if (source.size() != Buffers.size()) {
+		for (u32 i = 0; i < Buffers.size(); ++i)
+			Buffers[i]->drop();
+		Buffers.set_used(source.size());
+		for (u32 i = 0; i < Buffers.size(); ++i)
+			Buffers[i] = new SSkinMeshBuffer(source[i]->VertexType);
+
+		// make sure all buffers are copied below
+		SourceChangedID_Vertex.set_used(source.size());
+		SourceChangedID_Index.set_used(source.size());
+		for (u32 i = 0; i < source.size(); ++i) {
+			SourceChangedID_Vertex[i] = source[i]->getChangedID_Vertex() - 1;
+			SourceChangedID_Index[i] = source[i]->getChangedID_Index() - 1;
+		}
+	}
+
+	for (u32 i = 0; i < source.size(); ++i) {
+		const SSkinMeshBuffer *src = source[i];
+		SSkinMeshBuffer *dst = Buffers[i];
+
+		dst->Material = src->Material;
+		dst->PrimitiveType = src->PrimitiveType;
+		dst->Transformation = src->Transformation;
+		dst->MappingHint_Vertex = src->MappingHint_Vertex;
+		dst->MappingHint_Index = src->MappingHint_Index;
+
+		if (src->getChangedID_Vertex() != SourceChangedID_Vertex[i]) {
+			dst->VertexType = src->VertexType;
+			dst->Vertices_Standard = src->Vertices_Standard;
+			dst->Vertices_2TCoords = src->Vertices_2TCoords;
+			dst->Vertices_Tangents = src->Vertices_Tangents;
+			dst->BoundingBox = src->BoundingBox;
+			dst->boundingBoxNeedsRecalculated();
+			dst->setDirty(EBT_VERTEX);
+			SourceChangedID_Vertex[i] = src->getChangedID_Vertex();
+		}
+
+		if (src->getChangedID_Index() != SourceChangedID_Index[i]) {
+			dst->Indices = src->Indices;
+			dst->setDirty(EBT_INDEX);
+			SourceChangedID_Index[i] = src->getChangedID_Index();
+		}
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,77 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "IMesh.h"
+#include "SSkinMeshBuffer.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class CSkinnedMesh;
+
+//! Skinned copy of a CSkinnedMesh at one pose
+/** Holds its own vertex buffers so that several poses of the same mesh can
+exist at once. Instances are owned and recycled by the pose cache of their
+CSkinnedMesh, see ISkinnedMesh::setPoseCacheSize(). They are plain static
+meshes, not an ISkinnedMesh. */
+class CSkinnedMeshInstance : public IMesh
+{
+public:
+	//! constructor
+	CSkinnedMeshInstance();
+
+	//! destructor
+	virtual ~CSkinnedMeshInstance();
+
+	//! returns amount of mesh buffers.
+	u32 getMeshBufferCount() const override;
+
+	//! returns pointer to a mesh buffer
+	IMeshBuffer *getMeshBuffer(u32 nr) const override;
+
+	//! Returns pointer to a mesh buffer which fits a material
+	IMeshBuffer *getMeshBuffer(const video::SMaterial &material) const override;
+
+	//! returns an axis aligned bounding box
+	const core::aabbox3d<f32> &getBoundingBox() const override;
+
+	//! set user axis aligned bounding box
+	void setBoundingBox(const core::aabbox3df &box) override;
+
+	//! set the hardware mapping hint, for driver
+	void setHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint, E_BUFFER_TYPE buffer = EBT_VERTEX_AND_INDEX) override;
+
+	//! flags the meshbuffer as changed, reloads hardware buffers
+	void setDirty(E_BUFFER_TYPE buffer = EBT_VERTEX_AND_INDEX) override;
+
+private:
+	friend class CSkinnedMesh;
+
+	//! Checks whether the copied buffers still match the source buffers
+	bool isInSync(const core::array<SSkinMeshBuffer *> &source) const;
+
+	//! Copies vertices, indices and materials of source buffers which changed
+	void sync(const core::array<SSkinMeshBuffer *> &source);
+
+	core::array<SSkinMeshBuffer *> Buffers;
+
+	// ChangedID_Vertex/Index of the source buffers at the time of the last copy
+	core::array<u32> SourceChangedID_Vertex;
+	core::array<u32> SourceChangedID_Index;
+
+	core::aabbox3d<f32> BoundingBox;
+
+	//! Pose the buffers are skinned at
+	f32 Frame;
+	f32 Blend;
+
+	//! Time stamp of the last frame this instance was handed out
+	u32 LastUsedMs;
+};
+
+} // end namespace scene
+} // end namespace irr
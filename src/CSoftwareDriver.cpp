@@ -0,0 +1,1033 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSoftwareDriver.h"
+#include "CColorConverter.h"
+#include "CImage.h"
+#include "CThreadPool.h"
+#include "IMaterialRenderer.h"
+#include "os.h"
+
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IRR_RASTER_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define IRR_RASTER_NEON
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+//! Width and height of the screen tiles which are rasterized in parallel
+const s32 TILE_SIZE = 64;
+
+//! Material renderer which only tells the scene manager about transparency
+class CSoftwareMaterialRenderer : public IMaterialRenderer
+{
+public:
+	CSoftwareMaterialRenderer(bool transparent) :
+			Transparent(transparent) {}
+
+	bool isTransparent() const override { return Transparent; }
+
+private:
+	bool Transparent;
+};
+
+//! Vertex in clip space, before the perspective division
+struct SClipVertex
+{
+	f32 Pos[4];
+	f32 R, G, B, A;
+	f32 U, V;
+};
+
+SClipVertex interpolate(const SClipVertex &a, const SClipVertex &b, f32 t)
+{
+	SClipVertex v;
+	for (u32 i = 0; i < 4; ++i)
+		v.Pos[i] = a.Pos[i] + (b.Pos[i] - a.Pos[i]) * t;
+	v.R = a.R + (b.R - a.R) * t;
+	v.G = a.G + (b.G - a.G) * t;
+	v.B = a.B + (b.B - a.B) * t;
+	v.A = a.A + (b.A - a.A) * t;
+	v.U = a.U + (b.U - a.U) * t;
+	v.V = a.V + (b.V - a.V) * t;
+	return v;
+}
+
+s32 wrapTexel(s32 i, s32 size, E_TEXTURE_CLAMP mode)
+{
+	switch (mode) {
+	case ETC_REPEAT:
+		i %= size;
+		return i < 0 ? i + size : i;
+	case ETC_MIRROR: {
+		const s32 period = size * 2;
+		i %= period;
+		if (i < 0)
+			i += period;
+		return i < size ? i : period - 1 - i;
+	}
+	default:
+		return core::clamp(i, 0, size - 1);
+	}
+}
+
+bool depthTest(E_COMPARISON_FUNC func, f32 z, f32 stored)
+{
+	switch (func) {
+	case ECFN_LESSEQUAL:
+		return z <= stored;
+	case ECFN_EQUAL:
+		return z == stored;
+	case ECFN_LESS:
+		return z < stored;
+	case ECFN_NOTEQUAL:
+		return z != stored;
+	case ECFN_GREATEREQUAL:
+		return z >= stored;
+	case ECFN_GREATER:
+		return z > stored;
+	case ECFN_NEVER:
+		return false;
+	default:
+		return true;
+	}
+}
+
+//! Factor of a blend function for one channel, colors range from 0 to 255
+f32 blendFactor(E_BLEND_FACTOR factor, f32 src, f32 dst, f32 srcAlpha, f32 dstAlpha)
+{
+	const f32 scale = 1.f / 255.f;
+	switch (factor) {
+	case EBF_ZERO:
+		return 0.f;
+	case EBF_ONE:
+		return 1.f;
+	case EBF_DST_COLOR:
+		return dst * scale;
+	case EBF_ONE_MINUS_DST_COLOR:
+		return 1.f - dst * scale;
+	case EBF_SRC_COLOR:
+		return src * scale;
+	case EBF_ONE_MINUS_SRC_COLOR:
+		return 1.f - src * scale;
+	case EBF_SRC_ALPHA:
+		return srcAlpha * scale;
+	case EBF_ONE_MINUS_SRC_ALPHA:
+		return 1.f - srcAlpha * scale;
+	case EBF_DST_ALPHA:
+		return dstAlpha * scale;
+	case EBF_ONE_MINUS_DST_ALPHA:
+		return 1.f - dstAlpha * scale;
+	case EBF_SRC_ALPHA_SATURATE:
+		return core::min_(srcAlpha, 255.f - dstAlpha) * scale;
+	default:
+		return 1.f;
+	}
+}
+
+u32 toChannel(f32 value)
+{
+	return (u32)core::clamp(value + 0.5f, 0.f, 255.f);
+}
+
+#if defined(IRR_RASTER_SSE2) || defined(IRR_RASTER_NEON)
+#define IRR_RASTER_SIMD
+
+// four pixels of a span, one per lane
+#ifdef IRR_RASTER_SSE2
+typedef __m128 f32x4;
+typedef __m128 mask4;
+
+inline f32x4 splat4(f32 v) { return _mm_set1_ps(v); }
+inline f32x4 load4(const f32 *p) { return _mm_loadu_ps(p); }
+inline void store4(f32 *p, f32x4 v) { _mm_storeu_ps(p, v); }
+inline f32x4 add4(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+inline f32x4 sub4(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+inline f32x4 mul4(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+inline f32x4 div4(f32x4 a, f32x4 b) { return _mm_div_ps(a, b); }
+inline mask4 cmpeq4(f32x4 a, f32x4 b) { return _mm_cmpeq_ps(a, b); }
+inline mask4 cmplt4(f32x4 a, f32x4 b) { return _mm_cmplt_ps(a, b); }
+inline mask4 cmple4(f32x4 a, f32x4 b) { return _mm_cmple_ps(a, b); }
+inline mask4 cmpgt4(f32x4 a, f32x4 b) { return _mm_cmpgt_ps(a, b); }
+inline mask4 cmpge4(f32x4 a, f32x4 b) { return _mm_cmpge_ps(a, b); }
+inline mask4 and4(mask4 a, mask4 b) { return _mm_and_ps(a, b); }
+inline mask4 not4(mask4 a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+inline mask4 none4() { return _mm_setzero_ps(); }
+//! one bit per lane
+inline u32 maskBits4(mask4 m) { return (u32)_mm_movemask_ps(m); }
+#else
+typedef float32x4_t f32x4;
+typedef uint32x4_t mask4;
+
+inline f32x4 splat4(f32 v) { return vdupq_n_f32(v); }
+inline f32x4 load4(const f32 *p) { return vld1q_f32(p); }
+inline void store4(f32 *p, f32x4 v) { vst1q_f32(p, v); }
+inline f32x4 add4(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+inline f32x4 sub4(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+inline f32x4 mul4(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+inline f32x4 div4(f32x4 a, f32x4 b) { return vdivq_f32(a, b); }
+inline mask4 cmpeq4(f32x4 a, f32x4 b) { return vceqq_f32(a, b); }
+inline mask4 cmplt4(f32x4 a, f32x4 b) { return vcltq_f32(a, b); }
+inline mask4 cmple4(f32x4 a, f32x4 b) { return vcleq_f32(a, b); }
+inline mask4 cmpgt4(f32x4 a, f32x4 b) { return vcgtq_f32(a, b); }
+inline mask4 cmpge4(f32x4 a, f32x4 b) { return vcgeq_f32(a, b); }
+inline mask4 and4(mask4 a, mask4 b) { return vandq_u32(a, b); }
+inline mask4 not4(mask4 a) { return vmvnq_u32(a); }
+inline mask4 none4() { return vdupq_n_u32(0); }
+//! one bit per lane
+inline u32 maskBits4(mask4 m)
+{
+	static const u32 bits[4] = {1, 2, 4, 8};
+	return vaddvq_u32(vandq_u32(m, vld1q_u32(bits)));
+}
+#endif
+
+//! depthTest() for four pixels
+mask4 depthTest4(E_COMPARISON_FUNC func, f32x4 z, f32x4 stored)
+{
+	switch (func) {
+	case ECFN_LESSEQUAL:
+		return cmple4(z, stored);
+	case ECFN_EQUAL:
+		return cmpeq4(z, stored);
+	case ECFN_LESS:
+		return cmplt4(z, stored);
+	case ECFN_NOTEQUAL:
+		return not4(cmpeq4(z, stored));
+	case ECFN_GREATEREQUAL:
+		return cmpge4(z, stored);
+	case ECFN_GREATER:
+		return cmpgt4(z, stored);
+	case ECFN_NEVER:
+		return none4();
+	default:
+		return not4(none4());
+	}
+}
+#endif
+} // end anonymous namespace
+
+CSoftwareTexture::CSoftwareTexture(const io::path &name, IImage *image) :
+		ITexture(name, ETT_2D)
+{
+	DriverType = EDT_SOFTWARE;
+	OriginalSize = Size = image->getDimension();
+	OriginalColorFormat = image->getColorFormat();
+	ColorFormat = ECF_A8R8G8B8;
+	Pitch = Size.Width * 4;
+
+	Image = new CImage(ECF_A8R8G8B8, Size);
+	CColorConverter::convert_viaFormat(image->getData(), image->getColorFormat(),
+			Size.getArea(), Image->getData(), ECF_A8R8G8B8);
+}
+
+CSoftwareTexture::~CSoftwareTexture()
+{
+	Image->drop();
+}
+
+void *CSoftwareTexture::lock(E_TEXTURE_LOCK_MODE mode, u32 mipmapLevel, u32 layer, E_TEXTURE_LOCK_FLAGS lockFlags)
+{
+	return mipmapLevel == 0 ? Image->getData() : 0;
+}
+
+bool CSoftwareDriver::SRasterState::operator==(const SRasterState &other) const
+{
+	return Texture == other.Texture && WrapU == other.WrapU && WrapV == other.WrapV &&
+		   Bilinear == other.Bilinear && DepthFunc == other.DepthFunc &&
+		   DepthWrite == other.DepthWrite && AlphaRef == other.AlphaRef &&
+		   Blend == other.Blend && SrcRGB == other.SrcRGB && DstRGB == other.DstRGB &&
+		   SrcAlpha == other.SrcAlpha && DstAlpha == other.DstAlpha &&
+		   ColorScale == other.ColorScale && AlphaSource == other.AlphaSource &&
+		   Clip == other.Clip;
+}
+
+CSoftwareDriver::CSoftwareDriver(io::IFileSystem *io, const core::dimension2d<u32> &screenSize) :
+		CNullDriver(io, screenSize), WorldViewProjectionDirty(true), TilesX(0), TilesY(0), Workers(0)
+{
+#ifdef _DEBUG
+	setDebugName("CSoftwareDriver");
+#endif
+
+	const u32 threadCount = std::thread::hardware_concurrency();
+	if (threadCount > 1)
+		Workers = new CThreadPool(threadCount - 1);
+
+	// the buffers are allocated in beginScene()
+	DriverAttributes->setAttribute("MaxTextures", 1);
+	DriverAttributes->setAttribute("MaxSupportedTextures", 1);
+}
+
+CSoftwareDriver::~CSoftwareDriver()
+{
+	delete Workers;
+}
+
+bool CSoftwareDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil,
+		const SExposedVideoData &videoData, core::rect<s32> *sourceRect)
+{
+	CNullDriver::beginScene(clearFlag, clearColor, clearDepth, clearStencil, videoData, sourceRect);
+
+	// the first frame allocates the buffers
+	if (allocateBuffers())
+		clearFlag |= ECBF_COLOR | ECBF_DEPTH;
+
+	clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
+	return true;
+}
+
+bool CSoftwareDriver::allocateBuffers()
+{
+	const u32 pixelCount = ScreenSize.getArea();
+	const u32 tilesX = (ScreenSize.Width + TILE_SIZE - 1) / TILE_SIZE;
+	const u32 tilesY = (ScreenSize.Height + TILE_SIZE - 1) / TILE_SIZE;
+	if (ColorBuffer.size() == pixelCount && TilesX == tilesX && TilesY == tilesY)
+		return false;
+
+	Triangles.set_used(0);
+	RasterStates.set_used(0);
+	ColorBuffer.set_used(pixelCount);
+	DepthBuffer.set_used(pixelCount);
+	TilesX = tilesX;
+	TilesY = tilesY;
+	TileBins.clear();
+	TileBins.reallocate(TilesX * TilesY);
+	for (u32 i = 0; i < TilesX * TilesY; ++i)
+		TileBins.push_back(core::array<u32>());
+	return true;
+}
+
+bool CSoftwareDriver::endScene()
+{
+	flush();
+	return CNullDriver::endScene();
+}
+
+void CSoftwareDriver::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4 &mat)
+{
+	Matrices[state] = mat;
+	WorldViewProjectionDirty = true;
+}
+
+const core::matrix4 &CSoftwareDriver::getTransform(E_TRANSFORMATION_STATE state) const
+{
+	return Matrices[state];
+}
+
+void CSoftwareDriver::setMaterial(const SMaterial &material)
+{
+	CNullDriver::setMaterial(material);
+	Material = material;
+}
+
+void CSoftwareDriver::setViewPort(const core::rect<s32> &area)
+{
+	core::rect<s32> vp = area;
+	vp.clipAgainst(core::rect<s32>(core::position2d<s32>(0, 0), core::dimension2di(ScreenSize)));
+	if (vp.getHeight() > 0 && vp.getWidth() > 0)
+		ViewPort = vp;
+}
+
+void CSoftwareDriver::drawVertexPrimitiveList(const void *vertices, u32 vertexCount,
+		const void *indexList, u32 primitiveCount,
+		E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+{
+	CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
+
+	if (!vertices || !indexList || !primitiveCount || ColorBuffer.empty())
+		return;
+	if (pType != scene::EPT_TRIANGLES && pType != scene::EPT_TRIANGLE_STRIP && pType != scene::EPT_TRIANGLE_FAN)
+		return;
+
+	if (WorldViewProjectionDirty) {
+		WorldViewProjection = Matrices[ETS_PROJECTION] * Matrices[ETS_VIEW] * Matrices[ETS_WORLD];
+		WorldViewProjectionDirty = false;
+	}
+
+	SRasterState state;
+	ITexture *texture = Material.getTexture(0);
+	state.Texture = texture && texture->getDriverType() == EDT_SOFTWARE ? static_cast<const CSoftwareTexture *>(texture) : 0;
+	state.WrapU = (E_TEXTURE_CLAMP)Material.TextureLayers[0].TextureWrapU;
+	state.WrapV = (E_TEXTURE_CLAMP)Material.TextureLayers[0].TextureWrapV;
+	state.Bilinear = Material.TextureLayers[0].MagFilter == ETMAGF_LINEAR;
+	state.DepthFunc = (E_COMPARISON_FUNC)Material.ZBuffer;
+	state.DepthWrite = getWriteZBuffer(Material);
+	state.AlphaRef = 0.f;
+	state.Blend = false;
+	state.SrcRGB = state.SrcAlpha = EBF_SRC_ALPHA;
+	state.DstRGB = state.DstAlpha = EBF_ONE_MINUS_SRC_ALPHA;
+	state.ColorScale = 1.f;
+	state.AlphaSource = EAS_VERTEX_COLOR | EAS_TEXTURE;
+	switch (Material.MaterialType) {
+	case EMT_TRANSPARENT_ALPHA_CHANNEL_REF:
+		state.AlphaRef = Material.MaterialTypeParam;
+		break;
+	case EMT_TRANSPARENT_ALPHA_CHANNEL:
+		state.AlphaRef = Material.MaterialTypeParam;
+		state.Blend = true;
+		break;
+	case EMT_TRANSPARENT_VERTEX_ALPHA:
+		state.Blend = true;
+		break;
+	case EMT_ONETEXTURE_BLEND: {
+		// same as the GL drivers: the parameter packs the blend functions,
+		// the color modulation and where the alpha comes from
+		E_MODULATE_FUNC modulate;
+		u32 alphaSource;
+		unpack_textureBlendFuncSeparate(state.SrcRGB, state.DstRGB, state.SrcAlpha, state.DstAlpha,
+				modulate, alphaSource, Material.MaterialTypeParam);
+		state.Blend = true;
+		state.ColorScale = (f32)modulate;
+		if ((alphaSource == EAS_VERTEX_COLOR || alphaSource == EAS_TEXTURE) &&
+				(textureBlendFunc_hasAlpha(state.SrcRGB) || textureBlendFunc_hasAlpha(state.DstRGB) ||
+						textureBlendFunc_hasAlpha(state.SrcAlpha) || textureBlendFunc_hasAlpha(state.DstAlpha)))
+			state.AlphaSource = alphaSource;
+		break;
+	}
+	default:
+		break;
+	}
+	state.Clip = ViewPort;
+	setRasterState(state);
+
+	const core::matrix4 &textureMatrix = Material.getTextureMatrix(0);
+	const bool transformTCoords = !textureMatrix.isIdentity();
+
+	const u32 pitch = getVertexPitchFromType(vType);
+	const u8 *vertexData = static_cast<const u8 *>(vertices);
+	auto vertex = [&](u32 i) -> S3DVertex {
+		const u32 index = iType == EIT_16BIT ? static_cast<const u16 *>(indexList)[i] : static_cast<const u32 *>(indexList)[i];
+		S3DVertex v = *reinterpret_cast<const S3DVertex *>(vertexData + index * pitch);
+		if (transformTCoords) {
+			const core::vector2df tc = v.TCoords;
+			v.TCoords.X = textureMatrix[0] * tc.X + textureMatrix[4] * tc.Y + textureMatrix[8];
+			v.TCoords.Y = textureMatrix[1] * tc.X + textureMatrix[5] * tc.Y + textureMatrix[9];
+		}
+		return v;
+	};
+
+	for (u32 p = 0; p < primitiveCount; ++p) {
+		switch (pType) {
+		case scene::EPT_TRIANGLE_STRIP:
+			// every other triangle of a strip is flipped to keep the winding
+			if (p & 1)
+				addTriangle(vertex(p + 1), vertex(p), vertex(p + 2));
+			else
+				addTriangle(vertex(p), vertex(p + 1), vertex(p + 2));
+			break;
+		case scene::EPT_TRIANGLE_FAN:
+			addTriangle(vertex(0), vertex(p + 1), vertex(p + 2));
+			break;
+		default:
+			addTriangle(vertex(p * 3), vertex(p * 3 + 1), vertex(p * 3 + 2));
+			break;
+		}
+	}
+}
+
+void CSoftwareDriver::draw2DImage(const video::ITexture *texture, const core::position2d<s32> &destPos,
+		const core::rect<s32> &sourceRect, const core::rect<s32> *clipRect,
+		SColor color, bool useAlphaChannelOfTexture)
+{
+	if (!texture || !sourceRect.isValid())
+		return;
+
+	const SColor colors[4] = {color, color, color, color};
+	draw2DImage(texture, core::rect<s32>(destPos, sourceRect.getSize()), sourceRect, clipRect, colors, useAlphaChannelOfTexture);
+}
+
+void CSoftwareDriver::draw2DImage(const video::ITexture *texture, const core::rect<s32> &destRect,
+		const core::rect<s32> &sourceRect, const core::rect<s32> *clipRect,
+		const video::SColor *const colors, bool useAlphaChannelOfTexture)
+{
+	if (!texture || ColorBuffer.empty())
+		return;
+
+	const SColor white[4] = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
+	const SColor *const useColor = colors ? colors : white;
+
+	const bool alpha = useAlphaChannelOfTexture ||
+					   useColor[0].getAlpha() < 255 || useColor[1].getAlpha() < 255 ||
+					   useColor[2].getAlpha() < 255 || useColor[3].getAlpha() < 255;
+	if (!set2DState(texture, clipRect, alpha))
+		return;
+
+	const core::dimension2du &ss = texture->getOriginalSize();
+	const f32 invW = 1.f / static_cast<f32>(ss.Width);
+	const f32 invH = 1.f / static_cast<f32>(ss.Height);
+	const core::rect<f32> tcoords(
+			sourceRect.UpperLeftCorner.X * invW,
+			sourceRect.UpperLeftCorner.Y * invH,
+			sourceRect.LowerRightCorner.X * invW,
+			sourceRect.LowerRightCorner.Y * invH);
+
+	const core::rect<f32> pos(
+			(f32)destRect.UpperLeftCorner.X, (f32)destRect.UpperLeftCorner.Y,
+			(f32)destRect.LowerRightCorner.X, (f32)destRect.LowerRightCorner.Y);
+
+	addQuad2D(pos, tcoords, useColor);
+}
+
+void CSoftwareDriver::draw2DRectangle(const core::rect<s32> &position,
+		SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
+		const core::rect<s32> *clip)
+{
+	if (ColorBuffer.empty())
+		return;
+
+	const bool alpha = colorLeftUp.getAlpha() < 255 || colorRightUp.getAlpha() < 255 ||
+					   colorLeftDown.getAlpha() < 255 || colorRightDown.getAlpha() < 255;
+	if (!set2DState(0, clip, alpha))
+		return;
+
+	const core::rect<f32> pos(
+			(f32)position.UpperLeftCorner.X, (f32)position.UpperLeftCorner.Y,
+			(f32)position.LowerRightCorner.X, (f32)position.LowerRightCorner.Y);
+	const SColor colors[4] = {colorLeftUp, colorLeftDown, colorRightDown, colorRightUp};
+
+	addQuad2D(pos, core::rect<f32>(0.f, 0.f, 0.f, 0.f), colors);
+}
+
+void CSoftwareDriver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
+{
+	flush();
+
+	if (flag & ECBF_COLOR) {
+		const u32 value = color.color;
+		for (u32 i = 0; i < ColorBuffer.size(); ++i)
+			ColorBuffer[i] = value;
+	}
+
+	if (flag & ECBF_DEPTH) {
+		for (u32 i = 0; i < DepthBuffer.size(); ++i)
+			DepthBuffer[i] = depth;
+	}
+}
+
+IImage *CSoftwareDriver::createScreenShot(video::ECOLOR_FORMAT format, video::E_RENDER_TARGET target)
+{
+	if (target != ERT_FRAME_BUFFER || ColorBuffer.empty())
+		return 0;
+
+	flush();
+
+	if (format == ECF_UNKNOWN)
+		format = ECF_A8R8G8B8;
+	if (IImage::isCompressedFormat(format) || IImage::isDepthFormat(format) || IImage::isFloatingPointFormat(format))
+		return 0;
+
+	IImage *image = createImage(format, ScreenSize);
+	CColorConverter::convert_viaFormat(ColorBuffer.const_pointer(), ECF_A8R8G8B8,
+			ColorBuffer.size(), image->getData(), format);
+	return image;
+}
+
+ECOLOR_FORMAT CSoftwareDriver::getColorFormat() const
+{
+	return ECF_A8R8G8B8;
+}
+
+E_DRIVER_TYPE CSoftwareDriver::getDriverType() const
+{
+	return EDT_SOFTWARE;
+}
+
+const char *CSoftwareDriver::getName() const
+{
+	return "Irrlicht Software Driver";
+}
+
+bool CSoftwareDriver::queryTextureFormat(ECOLOR_FORMAT format) const
+{
+	return format == ECF_A1R5G5B5 || format == ECF_R5G6B5 ||
+		   format == ECF_R8G8B8 || format == ECF_A8R8G8B8;
+}
+
+ITexture *CSoftwareDriver::createDeviceDependentTexture(const io::path &name, IImage *image)
+{
+	if (!queryTextureFormat(image->getColorFormat())) {
+		os::Printer::log("Software driver can't create texture from this color format", name, ELL_ERROR);
+		return CNullDriver::createDeviceDependentTexture(name, image);
+	}
+	return new CSoftwareTexture(name, image);
+}
+
+void CSoftwareDriver::removeTexture(ITexture *texture)
+{
+	// binned triangles and the kept raster state point to the texture
+	flush();
+	RasterStates.set_used(0);
+	CNullDriver::removeTexture(texture);
+}
+
+void CSoftwareDriver::removeAllTextures()
+{
+	flush();
+	RasterStates.set_used(0);
+	CNullDriver::removeAllTextures();
+}
+
+void CSoftwareDriver::OnResize(const core::dimension2d<u32> &size)
+{
+	// the binned triangles were set up for the old size
+	flush();
+	CNullDriver::OnResize(size);
+
+	// nothing rendered so far fits the new size, so only buffers which
+	// were in use already are cleared
+	if (!ColorBuffer.empty() && allocateBuffers())
+		clearBuffers(ECBF_COLOR | ECBF_DEPTH);
+}
+
+void CSoftwareDriver::flush()
+{
+	if (Triangles.empty())
+		return;
+
+	if (Workers) {
+		Workers->parallelFor(TileBins.size(), [this](u32 tile) {
+			rasterizeTile(tile);
+		});
+	} else {
+		for (u32 tile = 0; tile < TileBins.size(); ++tile)
+			rasterizeTile(tile);
+	}
+
+	Triangles.set_used(0);
+	for (u32 i = 0; i < TileBins.size(); ++i)
+		TileBins[i].set_used(0);
+
+	// keep the current state for the triangles that follow
+	if (!RasterStates.empty()) {
+		const SRasterState state = RasterStates.getLast();
+		RasterStates.set_used(0);
+		RasterStates.push_back(state);
+	}
+}
+
+void CSoftwareDriver::addTriangle(const S3DVertex &v0, const S3DVertex &v1, const S3DVertex &v2)
+{
+	const S3DVertex *in[3] = {&v0, &v1, &v2};
+
+	SClipVertex clip[4];
+	for (u32 i = 0; i < 3; ++i) {
+		SClipVertex &c = clip[i];
+		WorldViewProjection.transformVect(c.Pos, in[i]->Pos);
+		c.R = (f32)in[i]->Color.getRed();
+		c.G = (f32)in[i]->Color.getGreen();
+		c.B = (f32)in[i]->Color.getBlue();
+		c.A = (f32)in[i]->Color.getAlpha();
+		c.U = in[i]->TCoords.X;
+		c.V = in[i]->TCoords.Y;
+	}
+
+	// clip against the near plane z = -w, which also removes everything
+	// behind the camera. The far plane and the sides are handled per pixel
+	// and by the bounds of the triangle.
+	f32 dist[3];
+	u32 inside = 0;
+	for (u32 i = 0; i < 3; ++i) {
+		dist[i] = clip[i].Pos[2] + clip[i].Pos[3];
+		inside += dist[i] >= 0.f;
+	}
+	if (inside == 0)
+		return;
+
+	u32 count = 3;
+	SClipVertex clipped[4];
+	if (inside == 3) {
+		for (u32 i = 0; i < 3; ++i)
+			clipped[i] = clip[i];
+	} else {
+		count = 0;
+		for (u32 i = 0; i < 3; ++i) {
+			const u32 next = (i + 1) % 3;
+			if (dist[i] >= 0.f)
+				clipped[count++] = clip[i];
+			if ((dist[i] >= 0.f) != (dist[next] >= 0.f))
+				clipped[count++] = interpolate(clip[i], clip[next], dist[i] / (dist[i] - dist[next]));
+		}
+	}
+
+	const f32 halfWidth = ViewPort.getWidth() * 0.5f;
+	const f32 halfHeight = ViewPort.getHeight() * 0.5f;
+
+	SRasterVertex screen[4];
+	for (u32 i = 0; i < count; ++i) {
+		const SClipVertex &c = clipped[i];
+		SRasterVertex &s = screen[i];
+		const f32 invW = c.Pos[3] > 0.f ? 1.f / c.Pos[3] : 0.f;
+		s.X = ViewPort.UpperLeftCorner.X + (c.Pos[0] * invW + 1.f) * halfWidth;
+		s.Y = ViewPort.UpperLeftCorner.Y + (1.f - c.Pos[1] * invW) * halfHeight;
+		s.Z = c.Pos[2] * invW * 0.5f + 0.5f;
+		s.InvW = invW;
+		s.R = c.R * invW;
+		s.G = c.G * invW;
+		s.B = c.B * invW;
+		s.A = c.A * invW;
+		s.U = c.U * invW;
+		s.V = c.V * invW;
+	}
+
+	for (u32 i = 2; i < count; ++i)
+		binTriangle(screen[0], screen[i - 1], screen[i], Material.BackfaceCulling, Material.FrontfaceCulling);
+}
+
+void CSoftwareDriver::binTriangle(const SRasterVertex &v0, const SRasterVertex &v1, const SRasterVertex &v2, bool cullBack, bool cullFront)
+{
+	// Front faces are clockwise on screen, which gives a positive area
+	// with y pointing down.
+	const f32 area = (v1.X - v0.X) * (v2.Y - v0.Y) - (v2.X - v0.X) * (v1.Y - v0.Y);
+	if (area == 0.f || !std::isfinite(area))
+		return;
+	if ((area < 0.f && cullBack) || (area > 0.f && cullFront))
+		return;
+
+	STriangle tri;
+	tri.V[0] = v0;
+	tri.V[1] = area > 0.f ? v1 : v2;
+	tri.V[2] = area > 0.f ? v2 : v1;
+	tri.InvArea = 1.f / fabsf(area);
+	tri.State = RasterStates.size() - 1;
+
+	for (u32 i = 0; i < 3; ++i) {
+		const SRasterVertex &a = tri.V[(i + 1) % 3];
+		const SRasterVertex &b = tri.V[(i + 2) % 3];
+		tri.EdgeA[i] = a.Y - b.Y;
+		tri.EdgeB[i] = b.X - a.X;
+		tri.EdgeC[i] = -(tri.EdgeA[i] * a.X + tri.EdgeB[i] * a.Y);
+
+		// A pixel center exactly on an edge belongs to only one of the two
+		// triangles sharing the edge, the edge runs in opposite directions
+		// in them.
+		const bool owned = tri.EdgeA[i] < 0.f || (tri.EdgeA[i] == 0.f && tri.EdgeB[i] < 0.f);
+		tri.EdgeMin[i] = owned ? 0.f : std::numeric_limits<f32>::denorm_min();
+	}
+
+	const f32 minX = core::min_(v0.X, v1.X, v2.X);
+	const f32 maxX = core::max_(v0.X, v1.X, v2.X);
+	const f32 minY = core::min_(v0.Y, v1.Y, v2.Y);
+	const f32 maxY = core::max_(v0.Y, v1.Y, v2.Y);
+
+	// limit the bounds before converting them to integers
+	const core::rect<s32> &clip = RasterStates[tri.State].Clip;
+	tri.Bounds.UpperLeftCorner.X = (s32)floorf(core::max_(minX, (f32)clip.UpperLeftCorner.X));
+	tri.Bounds.UpperLeftCorner.Y = (s32)floorf(core::max_(minY, (f32)clip.UpperLeftCorner.Y));
+	tri.Bounds.LowerRightCorner.X = (s32)ceilf(core::min_(maxX, (f32)clip.LowerRightCorner.X));
+	tri.Bounds.LowerRightCorner.Y = (s32)ceilf(core::min_(maxY, (f32)clip.LowerRightCorner.Y));
+	if (tri.Bounds.UpperLeftCorner.X >= tri.Bounds.LowerRightCorner.X ||
+			tri.Bounds.UpperLeftCorner.Y >= tri.Bounds.LowerRightCorner.Y)
+		return;
+
+	const u32 index = Triangles.size();
+	Triangles.push_back(tri);
+
+	const s32 firstTileX = tri.Bounds.UpperLeftCorner.X / TILE_SIZE;
+	const s32 lastTileX = (tri.Bounds.LowerRightCorner.X - 1) / TILE_SIZE;
+	const s32 firstTileY = tri.Bounds.UpperLeftCorner.Y / TILE_SIZE;
+	const s32 lastTileY = (tri.Bounds.LowerRightCorner.Y - 1) / TILE_SIZE;
+	for (s32 y = firstTileY; y <= lastTileY; ++y) {
+		for (s32 x = firstTileX; x <= lastTileX; ++x)
+			TileBins[y * TilesX + x].push_back(index);
+	}
+}
+
+void CSoftwareDriver::setRasterState(const SRasterState &state)
+{
+	if (RasterStates.empty() || !(RasterStates.getLast() == state))
+		RasterStates.push_back(state);
+}
+
+bool CSoftwareDriver::set2DState(const video::ITexture *texture, const core::rect<s32> *clipRect, bool alphaBlend)
+{
+	const SMaterial &material = OverrideMaterial2DEnabled ? OverrideMaterial2D : InitMaterial2D;
+
+	SRasterState state;
+	state.Texture = texture && texture->getDriverType() == EDT_SOFTWARE ? static_cast<const CSoftwareTexture *>(texture) : 0;
+	state.WrapU = (E_TEXTURE_CLAMP)material.TextureLayers[0].TextureWrapU;
+	state.WrapV = (E_TEXTURE_CLAMP)material.TextureLayers[0].TextureWrapV;
+	state.Bilinear = material.TextureLayers[0].MagFilter == ETMAGF_LINEAR;
+	state.DepthFunc = ECFN_DISABLED;
+	state.DepthWrite = false;
+	state.AlphaRef = 0.f;
+	state.Blend = alphaBlend;
+	state.SrcRGB = state.SrcAlpha = EBF_SRC_ALPHA;
+	state.DstRGB = state.DstAlpha = EBF_ONE_MINUS_SRC_ALPHA;
+	state.ColorScale = 1.f;
+	state.AlphaSource = EAS_VERTEX_COLOR | EAS_TEXTURE;
+	state.Clip = core::rect<s32>(core::position2d<s32>(0, 0), core::dimension2di(ScreenSize));
+	if (clipRect) {
+		if (!clipRect->isValid())
+			return false;
+		state.Clip.clipAgainst(*clipRect);
+	}
+
+	if (texture && !state.Texture)
+		return false;
+
+	setRasterState(state);
+	return true;
+}
+
+void CSoftwareDriver::addQuad2D(const core::rect<f32> &pos, const core::rect<f32> &tcoords, const SColor *colors)
+{
+	// corners in the order upper left, lower left, lower right, upper right
+	const f32 x[4] = {pos.UpperLeftCorner.X, pos.UpperLeftCorner.X, pos.LowerRightCorner.X, pos.LowerRightCorner.X};
+	const f32 y[4] = {pos.UpperLeftCorner.Y, pos.LowerRightCorner.Y, pos.LowerRightCorner.Y, pos.UpperLeftCorner.Y};
+	const f32 u[4] = {tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.X};
+	const f32 v[4] = {tcoords.UpperLeftCorner.Y, tcoords.LowerRightCorner.Y, tcoords.LowerRightCorner.Y, tcoords.UpperLeftCorner.Y};
+
+	SRasterVertex corners[4];
+	for (u32 i = 0; i < 4; ++i) {
+		SRasterVertex &c = corners[i];
+		c.X = x[i];
+		c.Y = y[i];
+		c.Z = 0.f;
+		c.InvW = 1.f;
+		c.R = (f32)colors[i].getRed();
+		c.G = (f32)colors[i].getGreen();
+		c.B = (f32)colors[i].getBlue();
+		c.A = (f32)colors[i].getAlpha();
+		c.U = u[i];
+		c.V = v[i];
+	}
+
+	binTriangle(corners[0], corners[3], corners[2], false, false);
+	binTriangle(corners[0], corners[2], corners[1], false, false);
+}
+
+void CSoftwareDriver::rasterizeTile(u32 tile)
+{
+	const core::array<u32> &bin = TileBins[tile];
+	if (bin.empty())
+		return;
+
+	const s32 x = (tile % TilesX) * TILE_SIZE;
+	const s32 y = (tile / TilesX) * TILE_SIZE;
+	const core::rect<s32> area(x, y,
+			core::min_(x + TILE_SIZE, (s32)ScreenSize.Width),
+			core::min_(y + TILE_SIZE, (s32)ScreenSize.Height));
+
+	for (u32 i = 0; i < bin.size(); ++i)
+		rasterizeTriangle(Triangles[bin[i]], area);
+}
+
+void CSoftwareDriver::rasterizeTriangle(const STriangle &tri, const core::rect<s32> &area)
+{
+	const SRasterState &state = RasterStates[tri.State];
+
+	core::rect<s32> bounds = tri.Bounds;
+	bounds.clipAgainst(area);
+	if (bounds.getWidth() <= 0 || bounds.getHeight() <= 0)
+		return;
+
+	const bool depthEnabled = state.DepthFunc != ECFN_DISABLED;
+	const f32 texWidth = state.Texture ? (f32)state.Texture->getSize().Width : 0.f;
+	const f32 texHeight = state.Texture ? (f32)state.Texture->getSize().Height : 0.f;
+	const SRasterVertex &v0 = tri.V[0];
+	const SRasterVertex &v1 = tri.V[1];
+	const SRasterVertex &v2 = tri.V[2];
+
+#ifdef IRR_RASTER_SIMD
+	// coverage, depth test and the attributes are computed for four pixels
+	// at once, only the covered pixels are textured and blended one by one
+	static const f32 lanes[4] = {0.f, 1.f, 2.f, 3.f};
+	const f32x4 lane = load4(lanes);
+	f32x4 edgeOffset[3], edgeMin[3];
+	for (u32 i = 0; i < 3; ++i) {
+		edgeOffset[i] = mul4(lane, splat4(tri.EdgeA[i]));
+		edgeMin[i] = splat4(tri.EdgeMin[i]);
+	}
+	const f32x4 invArea = splat4(tri.InvArea);
+	const f32x4 zero = splat4(0.f);
+	const f32x4 one = splat4(1.f);
+	auto interpolate4 = [](f32 a0, f32 a1, f32 a2, f32x4 b0, f32x4 b1, f32x4 b2) {
+		return add4(add4(mul4(splat4(a0), b0), mul4(splat4(a1), b1)), mul4(splat4(a2), b2));
+	};
+#endif
+
+	for (s32 py = bounds.UpperLeftCorner.Y; py < bounds.LowerRightCorner.Y; ++py) {
+		const f32 centerX = bounds.UpperLeftCorner.X + 0.5f;
+		const f32 centerY = py + 0.5f;
+		f32 w[3];
+		for (u32 i = 0; i < 3; ++i)
+			w[i] = tri.EdgeA[i] * centerX + tri.EdgeB[i] * centerY + tri.EdgeC[i];
+
+		const u32 rowStart = py * ScreenSize.Width;
+		s32 px = bounds.UpperLeftCorner.X;
+
+#ifdef IRR_RASTER_SIMD
+		for (; px + 4 <= bounds.LowerRightCorner.X;
+				px += 4, w[0] += tri.EdgeA[0] * 4.f, w[1] += tri.EdgeA[1] * 4.f, w[2] += tri.EdgeA[2] * 4.f) {
+			const f32x4 e0 = add4(splat4(w[0]), edgeOffset[0]);
+			const f32x4 e1 = add4(splat4(w[1]), edgeOffset[1]);
+			const f32x4 e2 = add4(splat4(w[2]), edgeOffset[2]);
+			mask4 inside = and4(and4(cmpge4(e0, edgeMin[0]), cmpge4(e1, edgeMin[1])), cmpge4(e2, edgeMin[2]));
+			if (!maskBits4(inside))
+				continue;
+
+			const f32x4 b0 = mul4(e0, invArea);
+			const f32x4 b1 = mul4(e1, invArea);
+			const f32x4 b2 = sub4(sub4(one, b0), b1);
+
+			const f32x4 z = interpolate4(v0.Z, v1.Z, v2.Z, b0, b1, b2);
+			if (depthEnabled) {
+				inside = and4(inside, and4(cmpge4(z, zero), cmple4(z, one)));
+				inside = and4(inside, depthTest4(state.DepthFunc, z, load4(&DepthBuffer[rowStart + px])));
+			}
+			const u32 covered = maskBits4(inside);
+			if (!covered)
+				continue;
+
+			const f32x4 w1 = div4(one, interpolate4(v0.InvW, v1.InvW, v2.InvW, b0, b1, b2));
+			f32 zs[4], r[4], g[4], b[4], a[4], u[4], v[4];
+			store4(zs, z);
+			store4(r, mul4(interpolate4(v0.R, v1.R, v2.R, b0, b1, b2), w1));
+			store4(g, mul4(interpolate4(v0.G, v1.G, v2.G, b0, b1, b2), w1));
+			store4(b, mul4(interpolate4(v0.B, v1.B, v2.B, b0, b1, b2), w1));
+			store4(a, mul4(interpolate4(v0.A, v1.A, v2.A, b0, b1, b2), w1));
+			store4(u, mul4(mul4(interpolate4(v0.U, v1.U, v2.U, b0, b1, b2), w1), splat4(texWidth)));
+			store4(v, mul4(mul4(interpolate4(v0.V, v1.V, v2.V, b0, b1, b2), w1), splat4(texHeight)));
+
+			for (u32 i = 0; i < 4; ++i) {
+				if (covered & (1 << i))
+					shadePixel(state, rowStart + px + i, zs[i], r[i], g[i], b[i], a[i], u[i], v[i]);
+			}
+		}
+#endif
+
+		for (; px < bounds.LowerRightCorner.X;
+				++px, w[0] += tri.EdgeA[0], w[1] += tri.EdgeA[1], w[2] += tri.EdgeA[2]) {
+			if (w[0] < tri.EdgeMin[0] || w[1] < tri.EdgeMin[1] || w[2] < tri.EdgeMin[2])
+				continue;
+
+			const f32 b0 = w[0] * tri.InvArea;
+			const f32 b1 = w[1] * tri.InvArea;
+			const f32 b2 = 1.f - b0 - b1;
+
+			// depth is linear in screen space, the far plane is clipped here
+			const f32 z = v0.Z * b0 + v1.Z * b1 + v2.Z * b2;
+			if (depthEnabled && (z < 0.f || z > 1.f))
+				continue;
+			if (depthEnabled && !depthTest(state.DepthFunc, z, DepthBuffer[rowStart + px]))
+				continue;
+
+			// perspective correct attributes
+			const f32 w1 = 1.f / (v0.InvW * b0 + v1.InvW * b1 + v2.InvW * b2);
+			shadePixel(state, rowStart + px, z,
+					(v0.R * b0 + v1.R * b1 + v2.R * b2) * w1,
+					(v0.G * b0 + v1.G * b1 + v2.G * b2) * w1,
+					(v0.B * b0 + v1.B * b1 + v2.B * b2) * w1,
+					(v0.A * b0 + v1.A * b1 + v2.A * b2) * w1,
+					(v0.U * b0 + v1.U * b1 + v2.U * b2) * w1 * texWidth,
+					(v0.V * b0 + v1.V * b1 + v2.V * b2) * w1 * texHeight);
+		}
+	}
+}
+
+void CSoftwareDriver::shadePixel(const SRasterState &state, u32 offset, f32 z, f32 r, f32 g, f32 b, f32 a, f32 u, f32 v)
+{
+	if (state.Texture) {
+		const u32 *texels = state.Texture->getPixels();
+		const s32 texWidth = (s32)state.Texture->getSize().Width;
+		const s32 texHeight = (s32)state.Texture->getSize().Height;
+
+		SColor texel;
+		if (state.Bilinear) {
+			const f32 fx = u - 0.5f;
+			const f32 fy = v - 0.5f;
+			const f32 x0f = floorf(fx);
+			const f32 y0f = floorf(fy);
+			const f32 tx = fx - x0f;
+			const f32 ty = fy - y0f;
+			const s32 x0 = wrapTexel((s32)x0f, texWidth, state.WrapU);
+			const s32 x1 = wrapTexel((s32)x0f + 1, texWidth, state.WrapU);
+			const s32 y0 = wrapTexel((s32)y0f, texHeight, state.WrapV);
+			const s32 y1 = wrapTexel((s32)y0f + 1, texHeight, state.WrapV);
+			const SColor c00(texels[y0 * texWidth + x0]);
+			const SColor c10(texels[y0 * texWidth + x1]);
+			const SColor c01(texels[y1 * texWidth + x0]);
+			const SColor c11(texels[y1 * texWidth + x1]);
+			texel.set(
+					toChannel(core::lerp(core::lerp((f32)c00.getAlpha(), (f32)c10.getAlpha(), tx), core::lerp((f32)c01.getAlpha(), (f32)c11.getAlpha(), tx), ty)),
+					toChannel(core::lerp(core::lerp((f32)c00.getRed(), (f32)c10.getRed(), tx), core::lerp((f32)c01.getRed(), (f32)c11.getRed(), tx), ty)),
+					toChannel(core::lerp(core::lerp((f32)c00.getGreen(), (f32)c10.getGreen(), tx), core::lerp((f32)c01.getGreen(), (f32)c11.getGreen(), tx), ty)),
+					toChannel(core::lerp(core::lerp((f32)c00.getBlue(), (f32)c10.getBlue(), tx), core::lerp((f32)c01.getBlue(), (f32)c11.getBlue(), tx), ty)));
+		} else {
+			const s32 x = wrapTexel((s32)floorf(u), texWidth, state.WrapU);
+			const s32 y = wrapTexel((s32)floorf(v), texHeight, state.WrapV);
+			texel.color = texels[y * texWidth + x];
+		}
+
+		const f32 scale = 1.f / 255.f;
+		r *= texel.getRed() * scale;
+		g *= texel.getGreen() * scale;
+		b *= texel.getBlue() * scale;
+		if (state.AlphaSource == EAS_TEXTURE)
+			a = texel.getAlpha();
+		else if (state.AlphaSource != EAS_VERTEX_COLOR)
+			a *= texel.getAlpha() * scale;
+	} else if (state.AlphaSource == EAS_TEXTURE) {
+		a = 255.f;
+	}
+
+	if (state.ColorScale != 1.f) {
+		r = core::min_(r * state.ColorScale, 255.f);
+		g = core::min_(g * state.ColorScale, 255.f);
+		b = core::min_(b * state.ColorScale, 255.f);
+	}
+
+	if (a < state.AlphaRef * 255.f)
+		return;
+
+	u32 &color = ColorBuffer[offset];
+	if (state.Blend) {
+		const SColor dst(color);
+		const f32 dr = dst.getRed();
+		const f32 dg = dst.getGreen();
+		const f32 db = dst.getBlue();
+		const f32 da = dst.getAlpha();
+		const f32 sa = a;
+		r = r * blendFactor(state.SrcRGB, r, dr, sa, da) + dr * blendFactor(state.DstRGB, r, dr, sa, da);
+		g = g * blendFactor(state.SrcRGB, g, dg, sa, da) + dg * blendFactor(state.DstRGB, g, dg, sa, da);
+		b = b * blendFactor(state.SrcRGB, b, db, sa, da) + db * blendFactor(state.DstRGB, b, db, sa, da);
+		a = a * blendFactor(state.SrcAlpha, sa, da, sa, da) + da * blendFactor(state.DstAlpha, sa, da, sa, da);
+	}
+
+	color = (toChannel(a) << 24) | (toChannel(r) << 16) | (toChannel(g) << 8) | toChannel(b);
+	if (state.DepthWrite && state.DepthFunc != ECFN_DISABLED)
+		DepthBuffer[offset] = z;
+}
+
+//! creates a software video driver
+IVideoDriver *createSoftwareDriver(io::IFileSystem *io, const core::dimension2d<u32> &screenSize)
+{
+	CSoftwareDriver *driver = new CSoftwareDriver(io, screenSize);
+
+	// the material renderers only report which built-in materials are
+	// transparent, the rasterizer reads the material itself
+	for (u32 i = 0; sBuiltInMaterialTypeNames[i]; ++i) {
+		const bool transparent = i == EMT_TRANSPARENT_ALPHA_CHANNEL ||
+								 i == EMT_TRANSPARENT_VERTEX_ALPHA || i == EMT_ONETEXTURE_BLEND;
+		IMaterialRenderer *imr = new CSoftwareMaterialRenderer(transparent);
+		driver->addMaterialRenderer(imr);
+		imr->drop();
+	}
+
+	return driver;
+}
+
+} // end namespace video
+} // end namespace irr
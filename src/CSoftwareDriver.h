@@ -0,0 +1,225 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "CNullDriver.h"
+#include "IImage.h"
+
+namespace irr
+{
+class CThreadPool;
+
+namespace video
+{
+
+//! Texture of the software driver, keeps its pixels as an A8R8G8B8 image
+class CSoftwareTexture : public ITexture
+{
+public:
+	CSoftwareTexture(const io::path &name, IImage *image);
+
+	virtual ~CSoftwareTexture();
+
+	void *lock(E_TEXTURE_LOCK_MODE mode = ETLM_READ_WRITE, u32 mipmapLevel = 0, u32 layer = 0, E_TEXTURE_LOCK_FLAGS lockFlags = ETLF_FLIP_Y_UP_RTT) override;
+
+	void unlock() override {}
+
+	void regenerateMipMapLevels(void *data = 0, u32 layer = 0) override {}
+
+	//! Returns the pixels the rasterizer samples from
+	const u32 *getPixels() const { return static_cast<const u32 *>(Image->getData()); }
+
+private:
+	IImage *Image;
+};
+
+//! Video driver which rasterizes on the CPU
+/** Meant for headless rendering, like thumbnails or image comparison tests
+on machines without a GPU. Draw calls are transformed and set up right away
+but only binned into screen tiles. The tiles are rasterized in parallel when
+the frame is finished, the buffers are cleared or a screenshot is taken.
+
+Supported are triangle lists, strips and fans with depth test, one texture
+with nearest or bilinear filtering, vertex colors, alpha test, alpha
+blending and the blend functions of EMT_ONETEXTURE_BLEND, and the 2d image
+and rectangle functions. Lighting, fog, lines, points and rendering to
+textures are not. */
+class CSoftwareDriver : public CNullDriver
+{
+public:
+	//! constructor
+	CSoftwareDriver(io::IFileSystem *io, const core::dimension2d<u32> &screenSize);
+
+	//! destructor
+	virtual ~CSoftwareDriver();
+
+	virtual bool beginScene(u16 clearFlag, SColor clearColor = SColor(255, 0, 0, 0), f32 clearDepth = 1.f, u8 clearStencil = 0,
+			const SExposedVideoData &videoData = SExposedVideoData(), core::rect<s32> *sourceRect = 0) override;
+
+	bool endScene() override;
+
+	//! sets transformation
+	void setTransform(E_TRANSFORMATION_STATE state, const core::matrix4 &mat) override;
+
+	//! Returns the transformation set by setTransform
+	const core::matrix4 &getTransform(E_TRANSFORMATION_STATE state) const override;
+
+	//! sets a material
+	void setMaterial(const SMaterial &material) override;
+
+	//! sets a viewport
+	void setViewPort(const core::rect<s32> &area) override;
+
+	//! draws a vertex primitive list
+	virtual void drawVertexPrimitiveList(const void *vertices, u32 vertexCount,
+			const void *indexList, u32 primitiveCount,
+			E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType) override;
+
+	//! Draws a 2d image, using a color and the alpha channel of the texture if desired.
+	virtual void draw2DImage(const video::ITexture *texture, const core::position2d<s32> &destPos,
+			const core::rect<s32> &sourceRect, const core::rect<s32> *clipRect = 0,
+			SColor color = SColor(255, 255, 255, 255), bool useAlphaChannelOfTexture = false) override;
+
+	//! Draws a part of the texture into the rectangle.
+	virtual void draw2DImage(const video::ITexture *texture, const core::rect<s32> &destRect,
+			const core::rect<s32> &sourceRect, const core::rect<s32> *clipRect = 0,
+			const video::SColor *const colors = 0, bool useAlphaChannelOfTexture = false) override;
+
+	//! Draws a 2d rectangle with a gradient.
+	virtual void draw2DRectangle(const core::rect<s32> &pos,
+			SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
+			const core::rect<s32> *clip = 0) override;
+
+	//! Clears the color, depth and/or stencil buffers.
+	void clearBuffers(u16 flag, SColor color = SColor(255, 0, 0, 0), f32 depth = 1.f, u8 stencil = 0) override;
+
+	//! Returns an image created from the last rendered frame.
+	IImage *createScreenShot(video::ECOLOR_FORMAT format = video::ECF_UNKNOWN, video::E_RENDER_TARGET target = video::ERT_FRAME_BUFFER) override;
+
+	//! get color format of the current color buffer
+	ECOLOR_FORMAT getColorFormat() const override;
+
+	//! Returns type of video driver
+	E_DRIVER_TYPE getDriverType() const override;
+
+	//! return the name of the driver
+	const char *getName() const override;
+
+	//! Check if the driver supports creating textures with the given color format
+	bool queryTextureFormat(ECOLOR_FORMAT format) const override;
+
+	//! Removes a texture, rasterizes the triangles which may sample it first
+	void removeTexture(ITexture *texture) override;
+
+	//! Removes all textures, rasterizes the binned triangles first
+	void removeAllTextures() override;
+
+	//! Rasterizes the binned triangles and resizes the buffers
+	void OnResize(const core::dimension2d<u32> &size) override;
+
+	//! Rasterizes all binned triangles
+	void flush();
+
+protected:
+	ITexture *createDeviceDependentTexture(const io::path &name, IImage *image) override;
+
+private:
+	//! Vertex after the viewport transformation, attributes are divided by w
+	struct SRasterVertex
+	{
+		f32 X, Y, Z, InvW;
+		f32 R, G, B, A;
+		f32 U, V;
+	};
+
+	//! Everything a triangle needs from the material
+	struct SRasterState
+	{
+		const CSoftwareTexture *Texture;
+		E_TEXTURE_CLAMP WrapU;
+		E_TEXTURE_CLAMP WrapV;
+		bool Bilinear;
+		E_COMPARISON_FUNC DepthFunc;
+		bool DepthWrite;
+		//! pixels with a lower alpha value are discarded, from 0 to 1
+		f32 AlphaRef;
+		//! mix the pixels into the color buffer with the factors below
+		bool Blend;
+		E_BLEND_FACTOR SrcRGB;
+		E_BLEND_FACTOR DstRGB;
+		E_BLEND_FACTOR SrcAlpha;
+		E_BLEND_FACTOR DstAlpha;
+		//! multiplies the color, 1, 2 or 4 for EMT_ONETEXTURE_BLEND
+		f32 ColorScale;
+		//! E_ALPHA_SOURCE values the pixel alpha is taken from
+		u32 AlphaSource;
+		//! pixels outside of this rectangle are not touched
+		core::rect<s32> Clip;
+
+		bool operator==(const SRasterState &other) const;
+	};
+
+	struct STriangle
+	{
+		SRasterVertex V[3];
+		//! edge function coefficients, edge i is opposite of vertex i
+		f32 EdgeA[3], EdgeB[3], EdgeC[3];
+		//! smallest edge function value inside, decides which triangle
+		//! gets the pixels on a shared edge
+		f32 EdgeMin[3];
+		f32 InvArea;
+		//! pixel bounds clipped to the state's clip rectangle
+		core::rect<s32> Bounds;
+		u32 State;
+	};
+
+	//! Sizes the buffers and tiles for the screen, returns true if they changed
+	bool allocateBuffers();
+
+	//! Transforms, clips and bins one triangle of a 3d draw call
+	void addTriangle(const S3DVertex &v0, const S3DVertex &v1, const S3DVertex &v2);
+
+	//! Sets up and bins a triangle in screen space
+	void binTriangle(const SRasterVertex &v0, const SRasterVertex &v1, const SRasterVertex &v2, bool cullBack, bool cullFront);
+
+	//! Makes the triangles binned next use this state
+	void setRasterState(const SRasterState &state);
+
+	//! Sets the raster state for a 2d draw, returns false if nothing can be drawn
+	bool set2DState(const video::ITexture *texture, const core::rect<s32> *clipRect, bool alphaBlend);
+
+	//! Bins two screen space triangles covering a rectangle
+	void addQuad2D(const core::rect<f32> &pos, const core::rect<f32> &tcoords, const SColor *colors);
+
+	void rasterizeTile(u32 tile);
+	void rasterizeTriangle(const STriangle &tri, const core::rect<s32> &area);
+
+	//! Textures, alpha tests and blends a covered pixel which passed the depth test
+	/** The color and texture coordinates are perspective correct, u and v
+	are in texels. */
+	void shadePixel(const SRasterState &state, u32 offset, f32 z, f32 r, f32 g, f32 b, f32 a, f32 u, f32 v);
+
+	core::array<u32> ColorBuffer;
+	core::array<f32> DepthBuffer;
+
+	core::matrix4 Matrices[ETS_COUNT];
+	//! projection * view * world
+	core::matrix4 WorldViewProjection;
+	bool WorldViewProjectionDirty;
+
+	SMaterial Material;
+
+	core::array<SRasterState> RasterStates;
+	core::array<STriangle> Triangles;
+
+	//! indices into Triangles for each tile, in submission order
+	core::array<core::array<u32>> TileBins;
+	u32 TilesX;
+	u32 TilesY;
+
+	CThreadPool *Workers;
+};
+
+} // end namespace video
+} // end namespace irr
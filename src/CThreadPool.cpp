@@ -0,0 +1,98 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CThreadPool.h"
+#include "irrMath.h"
+
+#include <atomic>
+#include <memory>
+
+namespace irr
+{
+
+CThreadPool::CThreadPool(u32 threadCount) :
+		Stopping(false)
+{
+	Workers.reserve(threadCount);
+	for (u32 i = 0; i < threadCount; ++i)
+		Workers.emplace_back(&CThreadPool::workerMain, this);
+}
+
+CThreadPool::~CThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Stopping = true;
+	}
+	JobAvailable.notify_all();
+
+	for (std::thread &worker : Workers)
+		worker.join();
+}
+
+void CThreadPool::enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Jobs.push_back(std::move(job));
+	}
+	JobAvailable.notify_one();
+}
+
+void CThreadPool::parallelFor(u32 count, const std::function<void(u32)> &job)
+{
+	if (count == 0)
+		return;
+
+	// Shared between the caller and the helping workers. Helpers may still
+	// hold it after the last index finished, so it is reference counted.
+	struct SState
+	{
+		std::atomic<u32> Next{0};
+		std::atomic<u32> Done{0};
+		std::mutex Mutex;
+		std::condition_variable Finished;
+	};
+	auto state = std::make_shared<SState>();
+
+	auto run = [state, count, &job]() {
+		u32 done = 0;
+		for (u32 i = state->Next++; i < count; i = state->Next++) {
+			job(i);
+			++done;
+		}
+		if (done && state->Done.fetch_add(done) + done == count) {
+			std::lock_guard<std::mutex> lock(state->Mutex);
+			state->Finished.notify_all();
+		}
+	};
+
+	const u32 helpers = core::min_(count - 1, (u32)Workers.size());
+	for (u32 i = 0; i < helpers; ++i)
+		enqueue(run);
+
+	run();
+
+	// job is only referenced by helpers which took an index, so it
+	// stays valid until all of them are done
+	std::unique_lock<std::mutex> lock(state->Mutex);
+	state->Finished.wait(lock, [&state, count]() { return state->Done == count; });
+}
+
+void CThreadPool::workerMain()
+{
+	for (;;) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(Mutex);
+			JobAvailable.wait(lock, [this]() { return Stopping || !Jobs.empty(); });
+			if (Jobs.empty())
+				return;
+			job = std::move(Jobs.front());
+			Jobs.pop_front();
+		}
+		job();
+	}
+}
+
+} // end namespace irr
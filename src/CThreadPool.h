@@ -0,0 +1,52 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "irrTypes.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace irr
+{
+
+//! Fixed set of worker threads executing queued jobs
+/** Used internally for work which can be split up into independent parts,
+like animating many meshes or decoding many files. */
+class CThreadPool
+{
+public:
+	//! constructor
+	/** \param threadCount Number of worker threads to start. */
+	explicit CThreadPool(u32 threadCount);
+
+	//! destructor, finishes all queued jobs before returning
+	~CThreadPool();
+
+	//! Returns the number of worker threads
+	u32 getThreadCount() const { return (u32)Workers.size(); }
+
+	//! Queues a job for execution on one of the worker threads
+	void enqueue(std::function<void()> job);
+
+	//! Calls job(i) for all i in [0, count) and waits until all calls are done
+	/** The calling thread helps out, so this works even if all workers are
+	busy. The order of the calls is undefined. */
+	void parallelFor(u32 count, const std::function<void(u32)> &job);
+
+private:
+	void workerMain();
+
+	std::vector<std::thread> Workers;
+	std::deque<std::function<void()>> Jobs;
+	std::mutex Mutex;
+	std::condition_variable JobAvailable;
+	bool Stopping;
+};
+
+} // end namespace irr
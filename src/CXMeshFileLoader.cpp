@@ -9,7 +9,7 @@
 #include "coreutil.h"
 #include "ISceneManager.h"
 #include "IVideoDriver.h"
-#include "IReadFile.h"
+#include "CMappedReadFile.h"
 
 #ifdef _DEBUG
 #define _XREADER_DEBUG
@@ -29,7 +29,7 @@ namespace scene
 
 //! Constructor
 CXMeshFileLoader::CXMeshFileLoader(scene::ISceneManager *smgr) :
-		AnimatedMesh(0), Buffer(0), P(0), End(0), BinaryNumCount(0), Line(0), ErrorState(false),
+		AnimatedMesh(0), Buffer(0), BufferCopy(0), P(0), End(0), BinaryNumCount(0), Line(0), ErrorState(false),
 		CurFrame(0), MajorVersion(0), MinorVersion(0), BinaryFormat(false), FloatSize(0)
 {
 #ifdef _DEBUG
@@ -85,7 +85,8 @@ IAnimatedMesh *CXMeshFileLoader::createMesh(io::IReadFile *file)
 	End = 0;
 	CurFrame = 0;
 
-	delete[] Buffer;
+	delete[] BufferCopy;
+	BufferCopy = 0;
 	Buffer = 0;
 
 	for (u32 i = 0; i < Meshes.size(); ++i)
@@ -347,13 +348,21 @@ bool CXMeshFileLoader::readFileIntoMemory(io::IReadFile *file)
 		return false;
 	}
 
-	Buffer = new c8[size + 1];
-	Buffer[size] = 0x0; // null-terminate
+	// The number parsers stop at the first byte which doesn't belong to
+	// the number, so only files followed by zero bytes are parsed in place.
+	// Views into archives are followed by the next entry.
+	if (file->getType() == io::ERFT_MAPPED_READ_FILE && !static_cast<io::CMappedReadFile *>(file)->isView()) {
+		Buffer = static_cast<const c8 *>(static_cast<io::IMemoryReadFile *>(file)->getBuffer());
+	} else {
+		BufferCopy = new c8[size + 1];
+		BufferCopy[size] = 0x0; // null-terminate
+		Buffer = BufferCopy;
 
-	//! read all into memory
-	if (file->read(Buffer, size) != static_cast<size_t>(size)) {
-		os::Printer::log("Could not read from x file.", ELL_WARNING);
-		return false;
+		//! read all into memory
+		if (file->read(BufferCopy, size) != static_cast<size_t>(size)) {
+			os::Printer::log("Could not read from x file.", ELL_WARNING);
+			return false;
+		}
 	}
 
 	Line = 1;
@@ -157,9 +157,11 @@ private:
 
 	CSkinnedMesh *AnimatedMesh;
 
-	c8 *Buffer;
+	const c8 *Buffer;
+	//! owned copy of the file, unless it was parsed in place
+	c8 *BufferCopy;
 	const c8 *P;
-	c8 *End;
+	const c8 *End;
 	// counter for number arrays in binary format
 	u32 BinaryNumCount;
 	u32 Line;
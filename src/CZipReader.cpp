@@ -8,6 +8,8 @@
 
 #include "CFileList.h"
 #include "CReadFile.h"
+#include "CMappedReadFile.h"
+#include "CInflateReadFile.h"
 #include "coreutil.h"
 
 #include <zlib.h> // use system lib
@@ -17,6 +19,9 @@ namespace irr
 namespace io
 {
 
+// deflated files larger than this are inflated while reading them
+const u32 ZIP_INFLATE_STREAM_SIZE = 64 * 1024;
+
 // -----------------------------------------------------------------------------
 // zip loader
 // -----------------------------------------------------------------------------
@@ -399,10 +404,27 @@ IReadFile *CZipReader::createAndOpenFile(const io::path &filename)
 	return 0;
 }
 
+//! Opens a file by index without decompressing it up front
+IReadFile *CZipReader::createStreamingFile(u32 index)
+{
+	if (index >= Files.size())
+		return 0;
+
+	const SZipFileEntry &e = FileInfo[Files[index].ID];
+	const u16 method = e.header.CompressionMethod;
+	if (method != 8 && method != 14 && method != 93)
+		return createAndOpenFile(index);
+	if (!CInflateReadFile::isMethodSupported(method))
+		return createAndOpenFile(index);
+
+	return new CInflateReadFile(File, e.Offset, e.header.DataDescriptor.CompressedSize,
+			e.header.DataDescriptor.UncompressedSize, Files[index].FullName, method);
+}
+
 //! opens a file by index
 IReadFile *CZipReader::createAndOpenFile(u32 index)
 {
-	// Irrlicht supports 0, 8, 12, 14, 99
+	// Irrlicht supports 0, 8, 12, 14, 93, 99
 	// 0 - The file is stored (no compression)
 	// 1 - The file is Shrunk
 	// 2 - The file is Reduced with compression factor 1
@@ -416,6 +438,7 @@ IReadFile *CZipReader::createAndOpenFile(u32 index)
 	// 10 - PKWARE Date Compression Library Imploding
 	// 12 - bzip2 - Compression Method from libbz2, WinZip 10
 	// 14 - LZMA - Compression Method, WinZip 12
+	// 93 - Zstandard - Compression Method, WinZip 24
 	// 96 - Jpeg compression - Compression Method, WinZip 12
 	// 97 - WavPack - Compression Method, WinZip 11
 	// 98 - PPMd - Compression Method, WinZip 10
@@ -432,11 +455,16 @@ IReadFile *CZipReader::createAndOpenFile(u32 index)
 	{
 		if (decrypted)
 			return decrypted;
+		else if (File->getType() == ERFT_MAPPED_READ_FILE) // zero-copy view into the archive
+			return static_cast<CMappedReadFile *>(File)->createView(e.Offset, decryptedSize, Files[index].FullName);
 		else
 			return createLimitReadFile(Files[index].FullName, File, e.Offset, decryptedSize);
 	}
 	case 8: {
 		const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
+		if (!decrypted && uncompressedSize > ZIP_INFLATE_STREAM_SIZE)
+			return new CInflateReadFile(File, e.Offset, decryptedSize, uncompressedSize, Files[index].FullName);
+
 		c8 *pBuf = new c8[uncompressedSize];
 		if (!pBuf) {
 			snprintf_irr(buf, 64, "Not enough memory for decompressing %s", Files[index].FullName.c_str());
@@ -447,7 +475,13 @@ IReadFile *CZipReader::createAndOpenFile(u32 index)
 		}
 
 		u8 *pcData = decryptedBuf;
-		if (!pcData) {
+		const u8 *mappedData = 0;
+		if (!pcData && File->getType() == ERFT_MAPPED_READ_FILE) {
+			// inflate straight from the mapped archive
+			if (e.Offset >= 0 && (long)e.Offset + (long)decryptedSize <= File->getSize())
+				mappedData = static_cast<const u8 *>(static_cast<IMemoryReadFile *>(File)->getBuffer()) + e.Offset;
+		}
+		if (!pcData && !mappedData) {
 			pcData = new u8[decryptedSize];
 			if (!pcData) {
 				snprintf_irr(buf, 64, "Not enough memory for decompressing %s", Files[index].FullName.c_str());
@@ -461,34 +495,16 @@ IReadFile *CZipReader::createAndOpenFile(u32 index)
 			File->read(pcData, decryptedSize);
 		}
 
-		// Setup the inflate stream.
-		z_stream stream;
-		s32 err;
-
-		stream.next_in = (Bytef *)pcData;
-		stream.avail_in = (uInt)decryptedSize;
-		stream.next_out = (Bytef *)pBuf;
-		stream.avail_out = uncompressedSize;
-		stream.zalloc = (alloc_func)0;
-		stream.zfree = (free_func)0;
-
-		// Perform inflation. wbits < 0 indicates no zlib header inside the data.
-		err = inflateInit2(&stream, -MAX_WBITS);
-		if (err == Z_OK) {
-			err = inflate(&stream, Z_FINISH);
-			inflateEnd(&stream);
-			if (err == Z_STREAM_END)
-				err = Z_OK;
-			err = Z_OK;
-			inflateEnd(&stream);
-		}
+		// the size is known, so everything is inflated at once
+		const bool inflated = CInflateReadFile::inflateBuffer(mappedData ? mappedData : pcData,
+				decryptedSize, (u8 *)pBuf, uncompressedSize);
 
 		if (decrypted)
 			decrypted->drop();
 		else
 			delete[] pcData;
 
-		if (err != Z_OK) {
+		if (!inflated) {
 			snprintf_irr(buf, 64, "Error decompressing %s", Files[index].FullName.c_str());
 			os::Printer::log(buf, ELL_ERROR);
 			delete[] pBuf;
@@ -500,9 +516,33 @@ IReadFile *CZipReader::createAndOpenFile(u32 index)
 		os::Printer::log("bzip2 decompression not supported. File cannot be read.", ELL_ERROR);
 		return 0;
 	}
-	case 14: {
-		os::Printer::log("lzma decompression not supported. File cannot be read.", ELL_ERROR);
-		return 0;
+	case 14:
+	case 93: {
+		if (!CInflateReadFile::isMethodSupported(actualCompressionMethod)) {
+			os::Printer::log(actualCompressionMethod == 14 ?
+							"lzma decompression not supported. File cannot be read." :
+							"zstd decompression not supported. File cannot be read.",
+					ELL_ERROR);
+			return 0;
+		}
+
+		const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
+		IReadFile *file = new CInflateReadFile(File, e.Offset, decryptedSize, uncompressedSize,
+				Files[index].FullName, actualCompressionMethod);
+		if (uncompressedSize > ZIP_INFLATE_STREAM_SIZE)
+			return file;
+
+		// small files are decompressed at once, like deflated ones
+		c8 *pBuf = new c8[uncompressedSize];
+		const bool complete = file->read(pBuf, uncompressedSize) == uncompressedSize;
+		file->drop();
+		if (!complete) {
+			snprintf_irr(buf, 64, "Error decompressing %s", Files[index].FullName.c_str());
+			os::Printer::log(buf, ELL_ERROR);
+			delete[] pBuf;
+			return 0;
+		}
+		return FileSystem->createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
 	}
 	case 99:
 		// If we come here with an encrypted file, decryption support is missing
@@ -184,6 +184,11 @@ public:
 	//! opens a file by index
 	IReadFile *createAndOpenFile(u32 index) override;
 
+	//! Opens a file by index without decompressing it up front
+	/** Compressed files are decompressed while they are read, so the
+	work happens on the thread reading them. */
+	IReadFile *createStreamingFile(u32 index);
+
 	//! returns the list of files
 	const IFileList *getFileList() const override;
 
@@ -193,6 +198,9 @@ public:
 	//! return the id of the file Archive
 	const io::path &getArchiveName() const override { return Path; }
 
+	//! Returns true if files are found by their name without the path
+	bool isIgnoringPaths() const { return IgnorePaths; }
+
 protected:
 	//! reads the next file header from a ZIP file, returns false if there are no more headers.
 	/* if ignoreGPBits is set, the item will be read despite missing
@@ -0,0 +1,126 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "SViewFrustum.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define IRR_FRUSTUM_BOXES_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define IRR_FRUSTUM_BOXES_NEON
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+//! Tests many axis aligned boxes against the planes of a frustum
+/** The boxes are passed as one array per coordinate of their edges. A box
+is visible unless it is completely in front of one of the tested planes,
+like aabbox3d::classifyPlaneRelation() returning ISREL3D_FRONT. Four boxes
+are tested at once with SSE or NEON where available.
+\param minX, minY, minZ, maxX, maxY, maxZ Edges of the boxes in world space.
+\param count Number of boxes.
+\param outVisible Receives one bit per box, bit (i % 32) of word (i / 32)
+is set if box i is visible. Must hold (count + 31) / 32 words.
+\param planeMask Bit p is set if plane p should be tested. */
+inline void testFrustumBoxes(const SViewFrustum &frustum,
+		const f32 *minX, const f32 *minY, const f32 *minZ,
+		const f32 *maxX, const f32 *maxY, const f32 *maxZ,
+		u32 count, u32 *outVisible, u32 planeMask = (1 << SViewFrustum::VF_PLANE_COUNT) - 1)
+{
+	// For each plane only the box corner furthest behind it needs to be
+	// tested. Its coordinates come from the min or max arrays depending on
+	// the sign of the normal, which is the same for all boxes.
+	const f32 *cornerX[SViewFrustum::VF_PLANE_COUNT];
+	const f32 *cornerY[SViewFrustum::VF_PLANE_COUNT];
+	const f32 *cornerZ[SViewFrustum::VF_PLANE_COUNT];
+	const core::plane3df *tested[SViewFrustum::VF_PLANE_COUNT];
+	u32 planeCount = 0;
+	for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; ++p) {
+		if (!(planeMask & (1 << p)))
+			continue;
+		const core::vector3df &n = frustum.planes[p].Normal;
+		cornerX[planeCount] = n.X > 0.f ? minX : maxX;
+		cornerY[planeCount] = n.Y > 0.f ? minY : maxY;
+		cornerZ[planeCount] = n.Z > 0.f ? minZ : maxZ;
+		tested[planeCount] = &frustum.planes[p];
+		++planeCount;
+	}
+
+#if defined(IRR_FRUSTUM_BOXES_SSE)
+	__m128 normalX[SViewFrustum::VF_PLANE_COUNT], normalY[SViewFrustum::VF_PLANE_COUNT], normalZ[SViewFrustum::VF_PLANE_COUNT], distance[SViewFrustum::VF_PLANE_COUNT];
+	for (u32 p = 0; p < planeCount; ++p) {
+		normalX[p] = _mm_set1_ps(tested[p]->Normal.X);
+		normalY[p] = _mm_set1_ps(tested[p]->Normal.Y);
+		normalZ[p] = _mm_set1_ps(tested[p]->Normal.Z);
+		distance[p] = _mm_set1_ps(tested[p]->D);
+	}
+	const __m128 zero = _mm_setzero_ps();
+#elif defined(IRR_FRUSTUM_BOXES_NEON)
+	float32x4_t normalX[SViewFrustum::VF_PLANE_COUNT], normalY[SViewFrustum::VF_PLANE_COUNT], normalZ[SViewFrustum::VF_PLANE_COUNT], distance[SViewFrustum::VF_PLANE_COUNT];
+	for (u32 p = 0; p < planeCount; ++p) {
+		normalX[p] = vdupq_n_f32(tested[p]->Normal.X);
+		normalY[p] = vdupq_n_f32(tested[p]->Normal.Y);
+		normalZ[p] = vdupq_n_f32(tested[p]->Normal.Z);
+		distance[p] = vdupq_n_f32(tested[p]->D);
+	}
+	const float32x4_t zero = vdupq_n_f32(0.f);
+	const u32 laneBitValues[4] = {1, 2, 4, 8};
+	const uint32x4_t laneBits = vld1q_u32(laneBitValues);
+#endif
+
+	for (u32 word = 0; word * 32 < count; ++word) {
+		const u32 first = word * 32;
+		const u32 end = core::min_(count, first + 32);
+		u32 bits = 0;
+		u32 i = first;
+
+#if defined(IRR_FRUSTUM_BOXES_SSE)
+		for (; i + 4 <= end; i += 4) {
+			__m128 outside = zero;
+			for (u32 p = 0; p < planeCount; ++p) {
+				__m128 d = _mm_mul_ps(_mm_loadu_ps(cornerX[p] + i), normalX[p]);
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(cornerY[p] + i), normalY[p]));
+				d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(cornerZ[p] + i), normalZ[p]));
+				d = _mm_add_ps(d, distance[p]);
+				outside = _mm_or_ps(outside, _mm_cmpgt_ps(d, zero));
+			}
+			bits |= (u32)(~_mm_movemask_ps(outside) & 0xf) << (i - first);
+		}
+#elif defined(IRR_FRUSTUM_BOXES_NEON)
+		for (; i + 4 <= end; i += 4) {
+			uint32x4_t outside = vdupq_n_u32(0);
+			for (u32 p = 0; p < planeCount; ++p) {
+				float32x4_t d = vmulq_f32(vld1q_f32(cornerX[p] + i), normalX[p]);
+				d = vmlaq_f32(d, vld1q_f32(cornerY[p] + i), normalY[p]);
+				d = vmlaq_f32(d, vld1q_f32(cornerZ[p] + i), normalZ[p]);
+				d = vaddq_f32(d, distance[p]);
+				outside = vorrq_u32(outside, vcgtq_f32(d, zero));
+			}
+			const uint32x4_t visible = vbicq_u32(laneBits, outside);
+			const uint32x2_t pairs = vorr_u32(vget_low_u32(visible), vget_high_u32(visible));
+			bits |= (vget_lane_u32(pairs, 0) | vget_lane_u32(pairs, 1)) << (i - first);
+		}
+#endif
+
+		for (; i < end; ++i) {
+			bool outside = false;
+			for (u32 p = 0; p < planeCount && !outside; ++p) {
+				const core::vector3df &n = tested[p]->Normal;
+				outside = n.X * cornerX[p][i] + n.Y * cornerY[p][i] + n.Z * cornerZ[p][i] + tested[p]->D > 0.f;
+			}
+			if (!outside)
+				bits |= 1u << (i - first);
+		}
+
+		outVisible[word] = bits;
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
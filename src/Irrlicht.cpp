@@ -108,6 +108,11 @@ extern "C" IRRLICHT_API bool IRRCALLCONV isDriverSupported(E_DRIVER_TYPE driver)
 	switch (driver) {
 	case EDT_NULL:
 		return true;
+#if defined(_IRR_COMPILE_WITH_X11_DEVICE_) || defined(_IRR_COMPILE_WITH_SDL_DEVICE_)
+	// the other devices don't create the software driver
+	case EDT_SOFTWARE:
+		return true;
+#endif
 #ifdef ENABLE_OPENGL3
 	case EDT_OPENGL3:
 		return true;
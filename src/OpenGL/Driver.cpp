@@ -15,6 +15,8 @@
 
 #include "MaterialRenderer.h"
 #include "FixedPipelineRenderer.h"
+#include "InstanceBuffer.h"
+#include "StreamBuffer.h"
 #include "Renderer2D.h"
 
 #include "EVertexAttributes.h"
@@ -27,6 +29,14 @@
 
 #include "mt_opengl.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IRR_2D_BATCH_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define IRR_2D_BATCH_NEON
+#endif
+
 namespace irr
 {
 namespace video
@@ -147,7 +157,9 @@ COpenGL3DriverBase::COpenGL3DriverBase(const SIrrlichtCreationParameters &params
 		MaterialRenderer2DActive(0), MaterialRenderer2DTexture(0), MaterialRenderer2DNoTexture(0),
 		CurrentRenderMode(ERM_NONE), Transformation3DChanged(true),
 		OGLES2ShaderPath(params.OGLES2ShaderPath),
-		ColorFormat(ECF_R8G8B8), ContextManager(contextManager)
+		ColorFormat(ECF_R8G8B8), ContextManager(contextManager),
+		InstanceBuffer(0), InstanceCount(1), InstanceDraws(0), VertexStream(0), IndexStream(0),
+		BoundVertexArray(0)
 {
 #ifdef _DEBUG
 	setDebugName("Driver");
@@ -163,7 +175,6 @@ COpenGL3DriverBase::COpenGL3DriverBase(const SIrrlichtCreationParameters &params
 	ContextManager->activateContext(ExposedData, false);
 	GL.LoadAllProcedures(ContextManager);
 	GL.DebugMessageCallback(debugCb, this);
-	initQuadsIndices();
 }
 
 COpenGL3DriverBase::~COpenGL3DriverBase()
@@ -177,6 +188,13 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 	removeAllOcclusionQueries();
 	removeAllHardwareBuffers();
 
+	delete InstanceBuffer;
+	for (auto &it : StreamVertexArrays)
+		GL.DeleteVertexArrays(1, &it.second.Name);
+	delete VertexStream;
+	delete IndexStream;
+	if (QuadIndexBuffer)
+		GL.DeleteBuffers(1, &QuadIndexBuffer);
 	delete MaterialRenderer2DTexture;
 	delete MaterialRenderer2DNoTexture;
 	delete CacheHandler;
@@ -189,24 +207,45 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 	}
 }
 
-void COpenGL3DriverBase::initQuadsIndices(int max_vertex_count)
+template <class T>
+static void uploadQuadIndices(u32 quadCount)
 {
-	int max_quad_count = max_vertex_count / 4;
-	std::vector<GLushort> QuadsIndices;
-	QuadsIndices.reserve(6 * max_quad_count);
-	for (int k = 0; k < max_quad_count; k++) {
-		QuadsIndices.push_back(4 * k + 0);
-		QuadsIndices.push_back(4 * k + 1);
-		QuadsIndices.push_back(4 * k + 2);
-		QuadsIndices.push_back(4 * k + 0);
-		QuadsIndices.push_back(4 * k + 2);
-		QuadsIndices.push_back(4 * k + 3);
+	std::vector<T> indices(6 * quadCount);
+	for (u32 k = 0; k < quadCount; k++) {
+		indices[6 * k + 0] = 4 * k + 0;
+		indices[6 * k + 1] = 4 * k + 1;
+		indices[6 * k + 2] = 4 * k + 2;
+		indices[6 * k + 3] = 4 * k + 0;
+		indices[6 * k + 4] = 4 * k + 2;
+		indices[6 * k + 5] = 4 * k + 3;
 	}
-	GL.GenBuffers(1, &QuadIndexBuffer);
+	// bound as vertex buffer, the index buffer binding belongs to the vertex array
+	GL.BufferData(GL_ARRAY_BUFFER, sizeof(T) * indices.size(), indices.data(), GL_STATIC_DRAW);
+}
+
+void COpenGL3DriverBase::reserveQuadIndices(u32 quadCount)
+{
+	if (6 * quadCount <= QuadIndexCount)
+		return;
+
+	// powers of two, so that a growing batch doesn't upload every frame
+	u32 count = 1024;
+	while (count < quadCount)
+		count *= 2;
+	count = core::min_(count, MaxQuadsPerDraw);
+
+	if (!QuadIndexBuffer)
+		GL.GenBuffers(1, &QuadIndexBuffer);
 	GL.BindBuffer(GL_ARRAY_BUFFER, QuadIndexBuffer);
-	GL.BufferData(GL_ARRAY_BUFFER, sizeof(QuadsIndices[0]) * QuadsIndices.size(), QuadsIndices.data(), GL_STATIC_DRAW);
+	if (4 * count > 65536) {
+		uploadQuadIndices<u32>(count);
+		QuadIndexType = GL_UNSIGNED_INT;
+	} else {
+		uploadQuadIndices<u16>(count);
+		QuadIndexType = GL_UNSIGNED_SHORT;
+	}
 	GL.BindBuffer(GL_ARRAY_BUFFER, 0);
-	QuadIndexCount = QuadsIndices.size();
+	QuadIndexCount = 6 * count;
 }
 
 void COpenGL3DriverBase::initVersion()
@@ -240,6 +279,25 @@ bool COpenGL3DriverBase::genericDriverInit(const core::dimension2d<u32> &screenS
 	delete CacheHandler;
 	CacheHandler = new COpenGL3CacheHandler(this);
 
+	delete InstanceBuffer;
+	InstanceBuffer = 0;
+	if (InstancingSupported && GL.DrawElementsInstanced && GL.VertexAttribDivisor)
+		InstanceBuffer = new COpenGL3InstanceBuffer();
+
+	delete VertexStream;
+	delete IndexStream;
+	const bool persistent = PersistentMappingSupported && GL.BufferStorage && GL.MapBufferRange &&
+							GL.FenceSync && GL.ClientWaitSync && GL.DeleteSync;
+	VertexStream = new COpenGL3StreamBuffer(GL_ARRAY_BUFFER, persistent);
+	IndexStream = new COpenGL3StreamBuffer(GL_ELEMENT_ARRAY_BUFFER, persistent);
+	os::Printer::log(persistent ? "Streaming geometry through persistently mapped buffers" : "Streaming geometry through orphaned buffers", ELL_DEBUG);
+
+	VertexArraysSupported = VertexArraysSupported && GL.GenVertexArrays && GL.BindVertexArray && GL.DeleteVertexArrays;
+	BaseVertexSupported = BaseVertexSupported && GL.DrawElementsBaseVertex && GL.DrawRangeElementsBaseVertex;
+
+	if (Params.QuadIndices32Bit && ElementIndexUintSupported)
+		MaxQuadsPerDraw = 1 << 18;
+
 	StencilBuffer = stencilBuffer;
 
 	DriverAttributes->setAttribute("MaxTextures", (s32)Feature.MaxTextureUnits);
@@ -439,6 +497,10 @@ bool COpenGL3DriverBase::beginScene(u16 clearFlag, SColor clearColor, f32 clearD
 {
 	CNullDriver::beginScene(clearFlag, clearColor, clearDepth, clearStencil, videoData, sourceRect);
 
+	// changes between frames don't count for this frame
+	u32 unused;
+	CacheHandler->takeStats(unused, unused);
+
 	if (ContextManager)
 		ContextManager->activateContext(videoData, true);
 
@@ -449,8 +511,13 @@ bool COpenGL3DriverBase::beginScene(u16 clearFlag, SColor clearColor, f32 clearD
 
 bool COpenGL3DriverBase::endScene()
 {
+	flush2DBatch();
+
+	CacheHandler->takeStats(FrameStats.TextureChanges, FrameStats.ShaderChanges);
 	CNullDriver::endScene();
 
+	VertexStream->endFrame();
+	IndexStream->endFrame();
 	GL.Flush();
 
 	if (ContextManager)
@@ -468,6 +535,8 @@ const core::matrix4 &COpenGL3DriverBase::getTransform(E_TRANSFORMATION_STATE sta
 //! sets transformation
 void COpenGL3DriverBase::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4 &mat)
 {
+	flush2DBatch();
+
 	Matrices[state] = mat;
 	Transformation3DChanged = true;
 }
@@ -543,9 +612,14 @@ bool COpenGL3DriverBase::updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffe
 	}
 	}
 
+	// the index buffer binding is part of the bound vertex array
+	if (VertexArraysSupported)
+		bindVertexArray(0);
+
 	// get or create buffer
 	bool newBuffer = false;
-	if (!HWBuffer->vbo_indicesID) {
+	const bool created = !HWBuffer->vbo_indicesID;
+	if (created) {
 		GL.GenBuffers(1, &HWBuffer->vbo_indicesID);
 		if (!HWBuffer->vbo_indicesID)
 			return false;
@@ -572,6 +646,12 @@ bool COpenGL3DriverBase::updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffe
 
 	GL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
+	// a vertex array set up while the indices were streamed needs the new buffer
+	if (created && HWBuffer->vaoID) {
+		bindVertexArray(HWBuffer->vaoID);
+		GL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
+	}
+
 	return (!testGLError(__LINE__));
 }
 
@@ -638,6 +718,13 @@ void COpenGL3DriverBase::deleteHardwareBuffer(SHWBufferLink *_HWBuffer)
 		return;
 
 	SHWBufferLink_opengl *HWBuffer = static_cast<SHWBufferLink_opengl *>(_HWBuffer);
+	if (HWBuffer->vaoID) {
+		// deleting the bound vertex array binds 0
+		if (BoundVertexArray == HWBuffer->vaoID)
+			BoundVertexArray = 0;
+		GL.DeleteVertexArrays(1, &HWBuffer->vaoID);
+		HWBuffer->vaoID = 0;
+	}
 	if (HWBuffer->vbo_verticesID) {
 		GL.DeleteBuffers(1, &HWBuffer->vbo_verticesID);
 		HWBuffer->vbo_verticesID = 0;
@@ -656,6 +743,9 @@ void COpenGL3DriverBase::drawHardwareBuffer(SHWBufferLink *_HWBuffer)
 	if (!_HWBuffer)
 		return;
 
+	// before binding the buffers
+	flush2DBatch();
+
 	SHWBufferLink_opengl *HWBuffer = static_cast<SHWBufferLink_opengl *>(_HWBuffer);
 
 	updateHardwareBuffer(HWBuffer); // check if update is needed
@@ -664,6 +754,23 @@ void COpenGL3DriverBase::drawHardwareBuffer(SHWBufferLink *_HWBuffer)
 	const void *vertices = mb->getVertices();
 	const void *indexList = mb->getIndices();
 
+	if (VertexArraysSupported) {
+		// the vertex array holds the bindings, without vertex buffer the
+		// indices are streamed along with the vertices
+		if (HWBuffer->Mapped_Vertex != scene::EHM_NEVER) {
+			bindHardwareVertexArray(HWBuffer, getVertexTypeDescription(mb->getVertexType()));
+			vertices = 0;
+			if (HWBuffer->Mapped_Index != scene::EHM_NEVER)
+				indexList = 0;
+		}
+
+		drawVertexPrimitiveList(vertices, mb->getVertexCount(),
+				indexList, mb->getPrimitiveCount(),
+				mb->getVertexType(), mb->getPrimitiveType(),
+				mb->getIndexType());
+		return;
+	}
+
 	if (HWBuffer->Mapped_Vertex != scene::EHM_NEVER) {
 		GL.BindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
 		vertices = 0;
@@ -686,6 +793,50 @@ void COpenGL3DriverBase::drawHardwareBuffer(SHWBufferLink *_HWBuffer)
 		GL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+//! Draws a list of mesh buffers, each with its own material and world transformation
+void COpenGL3DriverBase::drawMeshBufferList(const SMeshBufferDraw *draws, u32 count)
+{
+	if (!InstanceBuffer) {
+		CNullDriver::drawMeshBufferList(draws, count);
+		return;
+	}
+
+	const core::matrix4 *transform = 0;
+
+	for (u32 i = 0; i < count;) {
+		const u32 run = COpenGL3InstanceBuffer::getInstanceRun(draws + i, count - i);
+
+		if (run == 1) {
+			if (draws[i].Transform != transform) {
+				transform = draws[i].Transform;
+				setTransform(ETS_WORLD, *transform);
+			}
+
+			setMaterial(*draws[i].Material);
+			drawMeshBuffer(draws[i].MeshBuffer);
+			++i;
+			continue;
+		}
+
+		// the shader applies the world matrix of each instance
+		transform = 0;
+		setTransform(ETS_WORLD, core::IdentityMatrix);
+		setMaterial(*draws[i].Material);
+
+		// bound by the draw, after the vertex array the attributes go into
+		InstanceDraws = draws + i;
+		InstanceCount = run;
+		drawMeshBuffer(draws[i].MeshBuffer);
+		InstanceCount = 1;
+		InstanceDraws = 0;
+
+		i += run;
+	}
+
+	if (count && draws[count - 1].Transform != transform)
+		setTransform(ETS_WORLD, *draws[count - 1].Transform);
+}
+
 IRenderTarget *COpenGL3DriverBase::addRenderTarget()
 {
 	COpenGL3RenderTarget *renderTarget = new COpenGL3RenderTarget(this);
@@ -712,11 +863,11 @@ void COpenGL3DriverBase::drawVertexPrimitiveList(const void *vertices, u32 verte
 		return;
 
 	CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
+	PrimitivesDrawn += primitiveCount * (InstanceCount - 1);
 
 	setRenderStates3DMode();
 
 	auto &vTypeDesc = getVertexTypeDescription(vType);
-	beginDraw(vTypeDesc, reinterpret_cast<uintptr_t>(vertices));
 	GLenum indexSize = 0;
 
 	switch (iType) {
@@ -738,36 +889,225 @@ void COpenGL3DriverBase::drawVertexPrimitiveList(const void *vertices, u32 verte
 	}
 	}
 
+	GLenum mode;
+	GLsizei indexCount;
 	switch (pType) {
 	case scene::EPT_POINTS:
 	case scene::EPT_POINT_SPRITES:
-		GL.DrawArrays(GL_POINTS, 0, primitiveCount);
+		mode = GL_POINTS;
+		indexCount = 0;
 		break;
 	case scene::EPT_LINE_STRIP:
-		GL.DrawElements(GL_LINE_STRIP, primitiveCount + 1, indexSize, indexList);
+		mode = GL_LINE_STRIP;
+		indexCount = primitiveCount + 1;
 		break;
 	case scene::EPT_LINE_LOOP:
-		GL.DrawElements(GL_LINE_LOOP, primitiveCount, indexSize, indexList);
+		mode = GL_LINE_LOOP;
+		indexCount = primitiveCount;
 		break;
 	case scene::EPT_LINES:
-		GL.DrawElements(GL_LINES, primitiveCount * 2, indexSize, indexList);
+		mode = GL_LINES;
+		indexCount = primitiveCount * 2;
 		break;
 	case scene::EPT_TRIANGLE_STRIP:
-		GL.DrawElements(GL_TRIANGLE_STRIP, primitiveCount + 2, indexSize, indexList);
+		mode = GL_TRIANGLE_STRIP;
+		indexCount = primitiveCount + 2;
 		break;
 	case scene::EPT_TRIANGLE_FAN:
-		GL.DrawElements(GL_TRIANGLE_FAN, primitiveCount + 2, indexSize, indexList);
+		mode = GL_TRIANGLE_FAN;
+		indexCount = primitiveCount + 2;
 		break;
 	case scene::EPT_TRIANGLES:
-		GL.DrawElements((LastMaterial.Wireframe) ? GL_LINES : (LastMaterial.PointCloud) ? GL_POINTS
-																						: GL_TRIANGLES,
-				primitiveCount * 3, indexSize, indexList);
+		mode = (LastMaterial.Wireframe) ? GL_LINES : (LastMaterial.PointCloud) ? GL_POINTS
+																			  : GL_TRIANGLES;
+		indexCount = primitiveCount * 3;
 		break;
 	default:
-		break;
+		return;
+	}
+
+	// geometry in client memory goes through the stream buffers, the
+	// hardware buffer path passes null and has its buffers bound already
+	GLint firstVertex = 0;
+	if (vertices)
+		firstVertex = beginStreamDraw(vTypeDesc, vertices, vertexCount, !indexCount || (BaseVertexSupported && InstanceCount == 1));
+	else if (!VertexArraysSupported)
+		beginDraw(vTypeDesc, 0);
+
+	if (InstanceCount > 1)
+		InstanceBuffer->bind(InstanceDraws, InstanceCount);
+
+	if (!indexCount) {
+		GL.DrawArrays(mode, firstVertex, primitiveCount);
+	} else {
+		if (indexList) {
+			const u32 indexBytes = indexSize == GL_UNSIGNED_SHORT ? sizeof(u16) : sizeof(u32);
+			indexList = reinterpret_cast<const void *>(IndexStream->append(indexList, indexCount * indexBytes));
+		}
+		drawElements(mode, indexCount, indexSize, indexList, firstVertex);
 	}
 
-	endDraw(vTypeDesc);
+	if (InstanceCount > 1)
+		InstanceBuffer->unbind();
+
+	if (vertices)
+		endStreamDraw(vTypeDesc);
+	else if (!VertexArraysSupported)
+		endDraw(vTypeDesc);
+}
+
+void COpenGL3DriverBase::drawElements(GLenum primitiveType, GLsizei indexCount, GLenum indexType, const void *indices, GLint baseVertex)
+{
+	if (InstanceCount > 1)
+		GL.DrawElementsInstanced(primitiveType, indexCount, indexType, indices, InstanceCount);
+	else if (baseVertex)
+		GL.DrawElementsBaseVertex(primitiveType, indexCount, indexType, indices, baseVertex);
+	else
+		GL.DrawElements(primitiveType, indexCount, indexType, indices);
+}
+
+//! Converts a rectangle in pixels to normalized device coordinates
+static core::rect<f32> toNDC(const core::rect<s32> &rect, const core::dimension2d<u32> &renderTargetSize)
+{
+	return core::rect<f32>(
+			(f32)rect.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f,
+			2.f - (f32)rect.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f,
+			(f32)rect.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f,
+			2.f - (f32)rect.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f);
+}
+
+//! Clips a quad along with its texture coordinates
+//! \return False if nothing is left of it.
+static bool clip2DQuad(core::rect<s32> &pos, core::rect<f32> &tcoords, const core::rect<s32> &clip)
+{
+	core::rect<s32> clipped = pos;
+	clipped.clipAgainst(clip);
+	if (clipped.getWidth() <= 0 || clipped.getHeight() <= 0)
+		return false;
+	if (clipped == pos)
+		return true;
+
+	const f32 du = tcoords.getWidth() / pos.getWidth();
+	const f32 dv = tcoords.getHeight() / pos.getHeight();
+	tcoords = core::rect<f32>(
+			tcoords.UpperLeftCorner.X + (clipped.UpperLeftCorner.X - pos.UpperLeftCorner.X) * du,
+			tcoords.UpperLeftCorner.Y + (clipped.UpperLeftCorner.Y - pos.UpperLeftCorner.Y) * dv,
+			tcoords.LowerRightCorner.X + (clipped.LowerRightCorner.X - pos.LowerRightCorner.X) * du,
+			tcoords.LowerRightCorner.Y + (clipped.LowerRightCorner.Y - pos.LowerRightCorner.Y) * dv);
+	pos = clipped;
+	return true;
+}
+
+//! Writes the vertices of a quad, clockwise from the upper left corner
+static void write2DQuad(S3DVertex *vertices, const core::rect<f32> &pos, const core::rect<f32> &tcoords,
+		SColor upperLeft, SColor upperRight, SColor lowerRight, SColor lowerLeft)
+{
+	vertices[0] = S3DVertex(pos.UpperLeftCorner.X, pos.UpperLeftCorner.Y, 0, 0, 0, 1, upperLeft, tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
+	vertices[1] = S3DVertex(pos.LowerRightCorner.X, pos.UpperLeftCorner.Y, 0, 0, 0, 1, upperRight, tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
+	vertices[2] = S3DVertex(pos.LowerRightCorner.X, pos.LowerRightCorner.Y, 0, 0, 0, 1, lowerRight, tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
+	vertices[3] = S3DVertex(pos.UpperLeftCorner.X, pos.LowerRightCorner.Y, 0, 0, 0, 1, lowerLeft, tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
+}
+
+//! Writes the quads of draw2DImageBatch() and clips them
+/** The destination of a quad has the size of its source rectangle, so the
+texture coordinates of a clipped quad are its clipped destination moved
+back to the source, times the inverse texture size. Everything is done on
+one vector of left, top, right and bottom.
+\return Number of quads written, the ones clipped away are left out. */
+static u32 write2DImageBatch(S3DVertex *vertices, const core::position2d<s32> *positions,
+		const core::rect<s32> *sourceRects, u32 count, const core::rect<s32> *clip,
+		const core::dimension2du &textureSize, const core::dimension2du &renderTargetSize, SColor color)
+{
+	const f32 invW = 1.f / textureSize.Width;
+	const f32 invH = 1.f / textureSize.Height;
+	const f32 scaleX = 2.f / renderTargetSize.Width;
+	const f32 scaleY = 2.f / renderTargetSize.Height;
+	const f32 minX = clip ? (f32)clip->UpperLeftCorner.X : -FLT_MAX;
+	const f32 minY = clip ? (f32)clip->UpperLeftCorner.Y : -FLT_MAX;
+	const f32 maxX = clip ? (f32)clip->LowerRightCorner.X : FLT_MAX;
+	const f32 maxY = clip ? (f32)clip->LowerRightCorner.Y : FLT_MAX;
+
+#if defined(IRR_2D_BATCH_SSE2)
+	const __m128 lower = _mm_setr_ps(minX, minY, minX, minY);
+	const __m128 upper = _mm_setr_ps(maxX, maxY, maxX, maxY);
+	const __m128 inv = _mm_setr_ps(invW, invH, invW, invH);
+	const __m128 scale = _mm_setr_ps(scaleX, -scaleY, scaleX, -scaleY);
+	const __m128 offset = _mm_setr_ps(-1.f, 1.f, -1.f, 1.f);
+#elif defined(IRR_2D_BATCH_NEON)
+	const float32x4_t lower = {minX, minY, minX, minY};
+	const float32x4_t upper = {maxX, maxY, maxX, maxY};
+	const float32x4_t inv = {invW, invH, invW, invH};
+	const float32x4_t scale = {scaleX, -scaleY, scaleX, -scaleY};
+	const float32x4_t offset = {-1.f, 1.f, -1.f, 1.f};
+#endif
+
+	u32 written = 0;
+	for (u32 i = 0; i < count; ++i) {
+		f32 pos[4], tcoords[4];
+#if defined(IRR_2D_BATCH_SSE2)
+		const __m128 source = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&sourceRects[i])));
+		const __m128 position = _mm_cvtepi32_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&positions[i])));
+		// position, position + source size
+		const __m128 dest = _mm_add_ps(_mm_movelh_ps(position, position), _mm_sub_ps(source, _mm_movelh_ps(source, source)));
+		const __m128 clipped = _mm_min_ps(_mm_max_ps(dest, lower), upper);
+		if (clip && (_mm_movemask_ps(_mm_cmple_ps(_mm_movehl_ps(clipped, clipped), clipped)) & 3))
+			continue;
+		_mm_storeu_ps(tcoords, _mm_mul_ps(_mm_add_ps(source, _mm_sub_ps(clipped, dest)), inv));
+		_mm_storeu_ps(pos, _mm_add_ps(_mm_mul_ps(clipped, scale), offset));
+#elif defined(IRR_2D_BATCH_NEON)
+		const float32x4_t source = vcvtq_f32_s32(vld1q_s32(&sourceRects[i].UpperLeftCorner.X));
+		const float32x2_t position = vcvt_f32_s32(vld1_s32(&positions[i].X));
+		// position, position + source size
+		const float32x4_t dest = vaddq_f32(vcombine_f32(position, position),
+				vsubq_f32(source, vcombine_f32(vget_low_f32(source), vget_low_f32(source))));
+		const float32x4_t clipped = vminq_f32(vmaxq_f32(dest, lower), upper);
+		const uint32x2_t empty = vcle_f32(vget_high_f32(clipped), vget_low_f32(clipped));
+		if (clip && (vget_lane_u32(empty, 0) | vget_lane_u32(empty, 1)))
+			continue;
+		vst1q_f32(tcoords, vmulq_f32(vaddq_f32(source, vsubq_f32(clipped, dest)), inv));
+		vst1q_f32(pos, vmlaq_f32(offset, clipped, scale));
+#else
+		const core::rect<s32> &source = sourceRects[i];
+		const f32 dest[4] = {
+				(f32)positions[i].X,
+				(f32)positions[i].Y,
+				(f32)(positions[i].X + source.LowerRightCorner.X - source.UpperLeftCorner.X),
+				(f32)(positions[i].Y + source.LowerRightCorner.Y - source.UpperLeftCorner.Y),
+			};
+		const f32 clipped[4] = {
+				core::clamp(dest[0], minX, maxX),
+				core::clamp(dest[1], minY, maxY),
+				core::clamp(dest[2], minX, maxX),
+				core::clamp(dest[3], minY, maxY),
+			};
+		if (clip && (clipped[2] <= clipped[0] || clipped[3] <= clipped[1]))
+			continue;
+		tcoords[0] = (source.UpperLeftCorner.X + clipped[0] - dest[0]) * invW;
+		tcoords[1] = (source.UpperLeftCorner.Y + clipped[1] - dest[1]) * invH;
+		tcoords[2] = (source.LowerRightCorner.X + clipped[2] - dest[2]) * invW;
+		tcoords[3] = (source.LowerRightCorner.Y + clipped[3] - dest[3]) * invH;
+		pos[0] = clipped[0] * scaleX - 1.f;
+		pos[1] = 1.f - clipped[1] * scaleY;
+		pos[2] = clipped[2] * scaleX - 1.f;
+		pos[3] = 1.f - clipped[3] * scaleY;
+#endif
+
+		// the normal isn't used by the 2D shaders
+		S3DVertex *v = vertices + 4 * written++;
+		v[0].Pos.set(pos[0], pos[1], 0.f);
+		v[0].Color = color;
+		v[0].TCoords.set(tcoords[0], tcoords[1]);
+		v[1].Pos.set(pos[2], pos[1], 0.f);
+		v[1].Color = color;
+		v[1].TCoords.set(tcoords[2], tcoords[1]);
+		v[2].Pos.set(pos[2], pos[3], 0.f);
+		v[2].Color = color;
+		v[2].TCoords.set(tcoords[2], tcoords[3]);
+		v[3].Pos.set(pos[0], pos[3], 0.f);
+		v[3].Color = color;
+		v[3].TCoords.set(tcoords[0], tcoords[3]);
+	}
+	return written;
 }
 
 void COpenGL3DriverBase::draw2DImage(const video::ITexture *texture, const core::position2d<s32> &destPos,
@@ -796,7 +1136,7 @@ void COpenGL3DriverBase::draw2DImage(const video::ITexture *texture, const core:
 	const core::dimension2du &ss = texture->getOriginalSize();
 	const f32 invW = 1.f / static_cast<f32>(ss.Width);
 	const f32 invH = 1.f / static_cast<f32>(ss.Height);
-	const core::rect<f32> tcoords(
+	core::rect<f32> tcoords(
 			sourceRect.UpperLeftCorner.X * invW,
 			(isRTT ? sourceRect.LowerRightCorner.Y : sourceRect.UpperLeftCorner.Y) * invH,
 			sourceRect.LowerRightCorner.X * invW,
@@ -811,42 +1151,29 @@ void COpenGL3DriverBase::draw2DImage(const video::ITexture *texture, const core:
 
 	const video::SColor *const useColor = colors ? colors : temp;
 
-	chooseMaterial2D();
-	if (!setMaterialTexture(0, texture))
-		return;
-
-	setRenderStates2DMode(useColor[0].getAlpha() < 255 || useColor[1].getAlpha() < 255 ||
-								  useColor[2].getAlpha() < 255 || useColor[3].getAlpha() < 255,
-			true, useAlphaChannelOfTexture);
-
-	const core::dimension2d<u32> &renderTargetSize = getCurrentRenderTargetSize();
+	const bool blend = useColor[0].getAlpha() < 255 || useColor[1].getAlpha() < 255 ||
+					   useColor[2].getAlpha() < 255 || useColor[3].getAlpha() < 255 ||
+					   useAlphaChannelOfTexture;
 
+	core::rect<s32> pos = destRect;
+	const core::rect<s32> *scissor = 0;
 	if (clipRect) {
 		if (!clipRect->isValid())
 			return;
 
-		GL.Enable(GL_SCISSOR_TEST);
-		GL.Scissor(clipRect->UpperLeftCorner.X, renderTargetSize.Height - clipRect->LowerRightCorner.Y,
-				clipRect->getWidth(), clipRect->getHeight());
+		// a single color stays the same when clipped, gradients need the scissor test
+		if (useColor[0] == useColor[1] && useColor[0] == useColor[2] && useColor[0] == useColor[3] &&
+				destRect.isValid()) {
+			if (!clip2DQuad(pos, tcoords, *clipRect))
+				return;
+		} else {
+			scissor = clipRect;
+		}
 	}
 
-	f32 left = (f32)destRect.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-	f32 right = (f32)destRect.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-	f32 down = 2.f - (f32)destRect.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-	f32 top = 2.f - (f32)destRect.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-
-	S3DVertex vertices[4];
-	vertices[0] = S3DVertex(left, top, 0, 0, 0, 1, useColor[0], tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
-	vertices[1] = S3DVertex(right, top, 0, 0, 0, 1, useColor[3], tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
-	vertices[2] = S3DVertex(right, down, 0, 0, 0, 1, useColor[2], tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
-	vertices[3] = S3DVertex(left, down, 0, 0, 0, 1, useColor[1], tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
-
-	drawQuad(vt2DImage, vertices);
-
-	if (clipRect)
-		GL.Disable(GL_SCISSOR_TEST);
-
-	testGLError(__LINE__);
+	S3DVertex *vertices = queue2D(texture, blend, GL_TRIANGLES, 4, scissor);
+	write2DQuad(vertices, toNDC(pos, getCurrentRenderTargetSize()), tcoords,
+			useColor[0], useColor[3], useColor[2], useColor[1]);
 }
 
 void COpenGL3DriverBase::draw2DImage(const video::ITexture *texture, u32 layer, bool flip)
@@ -854,6 +1181,9 @@ void COpenGL3DriverBase::draw2DImage(const video::ITexture *texture, u32 layer,
 	if (!texture)
 		return;
 
+	// drawn right away, textures use this to read render targets
+	flush2DBatch();
+
 	chooseMaterial2D();
 	if (!setMaterialTexture(0, texture))
 		return;
@@ -891,69 +1221,21 @@ void COpenGL3DriverBase::draw2DImageBatch(const video::ITexture *texture,
 	if (!texture)
 		return;
 
-	chooseMaterial2D();
-	if (!setMaterialTexture(0, texture))
+	if (clipRect && !clipRect->isValid())
 		return;
 
-	setRenderStates2DMode(color.getAlpha() < 255, true, useAlphaChannelOfTexture);
-
-	const core::dimension2d<u32> &renderTargetSize = getCurrentRenderTargetSize();
-
-	if (clipRect) {
-		if (!clipRect->isValid())
-			return;
-
-		GL.Enable(GL_SCISSOR_TEST);
-		GL.Scissor(clipRect->UpperLeftCorner.X, renderTargetSize.Height - clipRect->LowerRightCorner.Y,
-				clipRect->getWidth(), clipRect->getHeight());
-	}
-
 	const irr::u32 drawCount = core::min_<u32>(positions.size(), sourceRects.size());
-	assert(6 * drawCount <= QuadIndexCount); // FIXME split the batch? or let it crash?
-
-	core::array<S3DVertex> vtx(drawCount * 4);
-
-	for (u32 i = 0; i < drawCount; i++) {
-		core::position2d<s32> targetPos = positions[i];
-		core::position2d<s32> sourcePos = sourceRects[i].UpperLeftCorner;
-		// This needs to be signed as it may go negative.
-		core::dimension2d<s32> sourceSize(sourceRects[i].getSize());
-
-		// now draw it.
-
-		core::rect<f32> tcoords;
-		tcoords.UpperLeftCorner.X = (((f32)sourcePos.X)) / texture->getOriginalSize().Width;
-		tcoords.UpperLeftCorner.Y = (((f32)sourcePos.Y)) / texture->getOriginalSize().Height;
-		tcoords.LowerRightCorner.X = tcoords.UpperLeftCorner.X + ((f32)(sourceSize.Width) / texture->getOriginalSize().Width);
-		tcoords.LowerRightCorner.Y = tcoords.UpperLeftCorner.Y + ((f32)(sourceSize.Height) / texture->getOriginalSize().Height);
-
-		const core::rect<s32> poss(targetPos, sourceSize);
-
-		f32 left = (f32)poss.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 right = (f32)poss.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 down = 2.f - (f32)poss.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-		f32 top = 2.f - (f32)poss.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-
-		vtx.push_back(S3DVertex(left, top, 0.0f,
-				0.0f, 0.0f, 0.0f, color,
-				tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y));
-		vtx.push_back(S3DVertex(right, top, 0.0f,
-				0.0f, 0.0f, 0.0f, color,
-				tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y));
-		vtx.push_back(S3DVertex(right, down, 0.0f,
-				0.0f, 0.0f, 0.0f, color,
-				tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y));
-		vtx.push_back(S3DVertex(left, down, 0.0f,
-				0.0f, 0.0f, 0.0f, color,
-				tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y));
-	}
-
-	GL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer);
-	drawElements(GL_TRIANGLES, vt2DImage, vtx.const_pointer(), vtx.size(), 0, 6 * drawCount);
-	GL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	if (!drawCount)
+		return;
 
-	if (clipRect)
-		GL.Disable(GL_SCISSOR_TEST);
+	// all quads have the same color, so they are clipped here
+	S3DVertex *vertices = queue2D(texture, color.getAlpha() < 255 || useAlphaChannelOfTexture,
+			GL_TRIANGLES, 4 * drawCount);
+	const u32 quadCount = write2DImageBatch(vertices, positions.const_pointer(), sourceRects.const_pointer(), drawCount,
+			clipRect, texture->getOriginalSize(), getCurrentRenderTargetSize(), color);
+
+	// give back the room of the clipped quads
+	Batch2D.VertexCount -= 4 * (drawCount - quadCount);
 }
 
 //! draw a 2d rectangle
@@ -961,11 +1243,6 @@ void COpenGL3DriverBase::draw2DRectangle(SColor color,
 		const core::rect<s32> &position,
 		const core::rect<s32> *clip)
 {
-	chooseMaterial2D();
-	setMaterialTexture(0, 0);
-
-	setRenderStates2DMode(color.getAlpha() < 255, false, false);
-
 	core::rect<s32> pos = position;
 
 	if (clip)
@@ -974,20 +1251,8 @@ void COpenGL3DriverBase::draw2DRectangle(SColor color,
 	if (!pos.isValid())
 		return;
 
-	const core::dimension2d<u32> &renderTargetSize = getCurrentRenderTargetSize();
-
-	f32 left = (f32)pos.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-	f32 right = (f32)pos.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-	f32 down = 2.f - (f32)pos.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-	f32 top = 2.f - (f32)pos.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-
-	S3DVertex vertices[4];
-	vertices[0] = S3DVertex(left, top, 0, 0, 0, 1, color, 0, 0);
-	vertices[1] = S3DVertex(right, top, 0, 0, 0, 1, color, 0, 0);
-	vertices[2] = S3DVertex(right, down, 0, 0, 0, 1, color, 0, 0);
-	vertices[3] = S3DVertex(left, down, 0, 0, 0, 1, color, 0, 0);
-
-	drawQuad(vtPrimitive, vertices);
+	S3DVertex *vertices = queue2D(0, color.getAlpha() < 255, GL_TRIANGLES, 4);
+	write2DQuad(vertices, toNDC(pos, getCurrentRenderTargetSize()), core::rect<f32>(), color, color, color, color);
 }
 
 //! draw an 2d rectangle
@@ -1004,54 +1269,96 @@ void COpenGL3DriverBase::draw2DRectangle(const core::rect<s32> &position,
 	if (!pos.isValid())
 		return;
 
-	chooseMaterial2D();
-	setMaterialTexture(0, 0);
-
-	setRenderStates2DMode(colorLeftUp.getAlpha() < 255 ||
-								  colorRightUp.getAlpha() < 255 ||
-								  colorLeftDown.getAlpha() < 255 ||
-								  colorRightDown.getAlpha() < 255,
-			false, false);
-
-	const core::dimension2d<u32> &renderTargetSize = getCurrentRenderTargetSize();
+	const bool blend = colorLeftUp.getAlpha() < 255 || colorRightUp.getAlpha() < 255 ||
+					   colorLeftDown.getAlpha() < 255 || colorRightDown.getAlpha() < 255;
 
-	f32 left = (f32)pos.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-	f32 right = (f32)pos.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-	f32 down = 2.f - (f32)pos.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-	f32 top = 2.f - (f32)pos.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-
-	S3DVertex vertices[4];
-	vertices[0] = S3DVertex(left, top, 0, 0, 0, 1, colorLeftUp, 0, 0);
-	vertices[1] = S3DVertex(right, top, 0, 0, 0, 1, colorRightUp, 0, 0);
-	vertices[2] = S3DVertex(right, down, 0, 0, 0, 1, colorRightDown, 0, 0);
-	vertices[3] = S3DVertex(left, down, 0, 0, 0, 1, colorLeftDown, 0, 0);
-
-	drawQuad(vtPrimitive, vertices);
+	S3DVertex *vertices = queue2D(0, blend, GL_TRIANGLES, 4);
+	write2DQuad(vertices, toNDC(pos, getCurrentRenderTargetSize()), core::rect<f32>(),
+			colorLeftUp, colorRightUp, colorRightDown, colorLeftDown);
 }
 
 //! Draws a 2d line.
 void COpenGL3DriverBase::draw2DLine(const core::position2d<s32> &start,
 		const core::position2d<s32> &end, SColor color)
 {
-	{
+	const core::rect<f32> pos = toNDC({start, end}, getCurrentRenderTargetSize());
+
+	S3DVertex *vertices = queue2D(0, color.getAlpha() < 255, GL_LINES, 2);
+	vertices[0] = S3DVertex(pos.UpperLeftCorner.X, pos.UpperLeftCorner.Y, 0, 0, 0, 1, color, 0, 0);
+	vertices[1] = S3DVertex(pos.LowerRightCorner.X, pos.LowerRightCorner.Y, 0, 0, 0, 1, color, 1, 1);
+}
+
+S3DVertex *COpenGL3DriverBase::queue2D(const ITexture *texture, bool blend, GLenum primitiveType, u32 vertexCount, const core::rect<s32> *scissor)
+{
+	chooseMaterial2D();
+
+	if (Batch2D.VertexCount && (texture != Batch2D.Texture || blend != Batch2D.Blend ||
+			primitiveType != Batch2D.PrimitiveType || (scissor != 0) != Batch2D.Scissor ||
+			(scissor && *scissor != Batch2D.ScissorRect) || Material != Batch2D.Material)) {
+		flush2DBatch();
+		// drawing set the texture of the material
 		chooseMaterial2D();
-		setMaterialTexture(0, 0);
+	}
 
-		setRenderStates2DMode(color.getAlpha() < 255, false, false);
+	if (!Batch2D.VertexCount) {
+		Batch2D.Texture = texture;
+		Batch2D.Blend = blend;
+		Batch2D.PrimitiveType = primitiveType;
+		Batch2D.Scissor = scissor != 0;
+		if (scissor)
+			Batch2D.ScissorRect = *scissor;
+		Batch2D.Material = Material;
+	}
 
-		const core::dimension2d<u32> &renderTargetSize = getCurrentRenderTargetSize();
+	if (Batch2D.Vertices.size() < Batch2D.VertexCount + vertexCount)
+		Batch2D.Vertices.resize(Batch2D.VertexCount + vertexCount);
+	S3DVertex *vertices = Batch2D.Vertices.data() + Batch2D.VertexCount;
+	Batch2D.VertexCount += vertexCount;
+	return vertices;
+}
+
+void COpenGL3DriverBase::flush2DBatch()
+{
+	const u32 vertexCount = Batch2D.VertexCount;
+	if (!vertexCount)
+		return;
+
+	// the state changes below may flush again
+	Batch2D.VertexCount = 0;
+
+	const bool texture = Batch2D.Texture != 0;
+	Material = Batch2D.Material;
+	if (!setMaterialTexture(0, Batch2D.Texture) && texture)
+		return;
+
+	setRenderStates2DMode(Batch2D.Blend, texture, Batch2D.Blend);
 
-		f32 startX = (f32)start.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 endX = (f32)end.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 startY = 2.f - (f32)start.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-		f32 endY = 2.f - (f32)end.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+	if (Batch2D.Scissor) {
+		const core::dimension2d<u32> &renderTargetSize = getCurrentRenderTargetSize();
+		const core::rect<s32> &clipRect = Batch2D.ScissorRect;
 
-		S3DVertex vertices[2];
-		vertices[0] = S3DVertex(startX, startY, 0, 0, 0, 1, color, 0, 0);
-		vertices[1] = S3DVertex(endX, endY, 0, 0, 0, 1, color, 1, 1);
+		GL.Enable(GL_SCISSOR_TEST);
+		GL.Scissor(clipRect.UpperLeftCorner.X, renderTargetSize.Height - clipRect.LowerRightCorner.Y,
+				clipRect.getWidth(), clipRect.getHeight());
+	}
 
-		drawArrays(GL_LINES, vtPrimitive, vertices, 2);
+	const VertexType &vertexType = texture ? vt2DImage : vtPrimitive;
+	if (Batch2D.PrimitiveType == GL_LINES) {
+		drawArrays(GL_LINES, vertexType, Batch2D.Vertices.data(), vertexCount);
+	} else {
+		// as many quads per draw as the quad indices can cover
+		reserveQuadIndices(core::min_(vertexCount / 4, MaxQuadsPerDraw));
+		const u32 chunk = QuadIndexCount / 6 * 4;
+		for (u32 first = 0; first < vertexCount; first += chunk) {
+			const u32 count = core::min_(chunk, vertexCount - first);
+			drawElements(GL_TRIANGLES, vertexType, Batch2D.Vertices.data() + first, count, 0, count / 4 * 6);
+		}
 	}
+
+	if (Batch2D.Scissor)
+		GL.Disable(GL_SCISSOR_TEST);
+
+	testGLError(__LINE__);
 }
 
 void COpenGL3DriverBase::drawQuad(const VertexType &vertexType, const S3DVertex (&vertices)[4])
@@ -1061,22 +1368,112 @@ void COpenGL3DriverBase::drawQuad(const VertexType &vertexType, const S3DVertex
 
 void COpenGL3DriverBase::drawArrays(GLenum primitiveType, const VertexType &vertexType, const void *vertices, int vertexCount)
 {
-	beginDraw(vertexType, reinterpret_cast<uintptr_t>(vertices));
-	GL.DrawArrays(primitiveType, 0, vertexCount);
-	endDraw(vertexType);
+	const GLint first = beginStreamDraw(vertexType, vertices, vertexCount, true);
+	GL.DrawArrays(primitiveType, first, vertexCount);
+	endStreamDraw(vertexType);
+	++FrameStats.DrawCalls;
 }
 
+//! indices may be null to draw quads with the shared quad index buffer
 void COpenGL3DriverBase::drawElements(GLenum primitiveType, const VertexType &vertexType, const void *vertices, int vertexCount, const u16 *indices, int indexCount)
 {
-	beginDraw(vertexType, reinterpret_cast<uintptr_t>(vertices));
-	GL.DrawRangeElements(primitiveType, 0, vertexCount - 1, indexCount, GL_UNSIGNED_SHORT, indices);
-	endDraw(vertexType);
+	const GLint first = beginStreamDraw(vertexType, vertices, vertexCount, BaseVertexSupported);
+	const void *indexOffset = 0;
+	GLenum indexType = GL_UNSIGNED_SHORT;
+	if (indices) {
+		indexOffset = reinterpret_cast<const void *>(IndexStream->append(indices, indexCount * sizeof(u16)));
+	} else {
+		GL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer);
+		indexType = QuadIndexType;
+	}
+	if (first)
+		GL.DrawRangeElementsBaseVertex(primitiveType, 0, vertexCount - 1, indexCount, indexType, indexOffset, first);
+	else
+		GL.DrawRangeElements(primitiveType, 0, vertexCount - 1, indexCount, indexType, indexOffset);
+	endStreamDraw(vertexType);
+	++FrameStats.DrawCalls;
+}
+
+GLint COpenGL3DriverBase::beginStreamDraw(const VertexType &vertexType, const void *vertices, u32 vertexCount, bool baseVertex)
+{
+	const u32 size = vertexCount * vertexType.VertexSize;
+	if (!VertexArraysSupported) {
+		beginDraw(vertexType, VertexStream->append(vertices, size));
+		return 0;
+	}
+
+	// whole vertices from the start of the buffer, so that a base vertex can address them
+	const uintptr_t offset = VertexStream->append(vertices, size, vertexType.VertexSize);
+
+	SStreamVertexArray &vertexArray = StreamVertexArrays[&vertexType];
+	if (!vertexArray.Name) {
+		GL.GenVertexArrays(1, &vertexArray.Name);
+		bindVertexArray(vertexArray.Name);
+		for (auto attr : vertexType)
+			GL.EnableVertexAttribArray(attr.Index);
+		FrameStats.VertexAttributeCalls += vertexType.Attributes.size();
+	} else {
+		bindVertexArray(vertexArray.Name);
+	}
+
+	if (vertexArray.Generation != VertexStream->getGeneration() || offset < vertexArray.Base ||
+			(!baseVertex && offset != vertexArray.Base)) {
+		setVertexAttributes(vertexType, offset);
+		vertexArray.Generation = VertexStream->getGeneration();
+		vertexArray.Base = offset;
+	}
+
+	return (offset - vertexArray.Base) / vertexType.VertexSize;
+}
+
+void COpenGL3DriverBase::endStreamDraw(const VertexType &vertexType)
+{
+	if (!VertexArraysSupported)
+		endDraw(vertexType);
+}
+
+void COpenGL3DriverBase::bindVertexArray(GLuint vertexArray)
+{
+	if (BoundVertexArray == vertexArray)
+		return;
+	GL.BindVertexArray(vertexArray);
+	BoundVertexArray = vertexArray;
+}
+
+void COpenGL3DriverBase::bindHardwareVertexArray(SHWBufferLink_opengl *HWBuffer, const VertexType &vertexType)
+{
+	if (HWBuffer->vaoID && HWBuffer->vaoType == &vertexType) {
+		bindVertexArray(HWBuffer->vaoID);
+		return;
+	}
+
+	if (!HWBuffer->vaoID)
+		GL.GenVertexArrays(1, &HWBuffer->vaoID);
+	bindVertexArray(HWBuffer->vaoID);
+
+	// the mesh buffer changed its vertex type
+	if (HWBuffer->vaoType)
+		endDraw(*HWBuffer->vaoType);
+
+	GL.BindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
+	beginDraw(vertexType, 0);
+	GL.BindBuffer(GL_ARRAY_BUFFER, 0);
+	GL.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->Mapped_Index != scene::EHM_NEVER ? HWBuffer->vbo_indicesID : 0);
+	HWBuffer->vaoType = &vertexType;
 }
 
 void COpenGL3DriverBase::beginDraw(const VertexType &vertexType, uintptr_t verticesBase)
 {
-	for (auto attr : vertexType) {
+	for (auto attr : vertexType)
 		GL.EnableVertexAttribArray(attr.Index);
+	FrameStats.VertexAttributeCalls += vertexType.Attributes.size();
+	setVertexAttributes(vertexType, verticesBase);
+}
+
+void COpenGL3DriverBase::setVertexAttributes(const VertexType &vertexType, uintptr_t verticesBase)
+{
+	FrameStats.VertexAttributeCalls += vertexType.Attributes.size();
+	for (auto attr : vertexType) {
 		switch (attr.mode) {
 		case VertexAttribute::Mode::Regular:
 			GL.VertexAttribPointer(attr.Index, attr.ComponentCount, attr.ComponentType, GL_FALSE, vertexType.VertexSize, reinterpret_cast<void *>(verticesBase + attr.Offset));
@@ -1095,6 +1492,7 @@ void COpenGL3DriverBase::endDraw(const VertexType &vertexType)
 {
 	for (auto attr : vertexType)
 		GL.DisableVertexAttribArray(attr.Index);
+	FrameStats.VertexAttributeCalls += vertexType.Attributes.size();
 }
 
 ITexture *COpenGL3DriverBase::createDeviceDependentTexture(const io::path &name, IImage *image)
@@ -1117,6 +1515,8 @@ ITexture *COpenGL3DriverBase::createDeviceDependentTextureCubemap(const io::path
 //! Sets a material.
 void COpenGL3DriverBase::setMaterial(const SMaterial &material)
 {
+	flush2DBatch();
+
 	Material = material;
 	OverrideMaterial.apply(Material);
 
@@ -1212,6 +1612,8 @@ bool COpenGL3DriverBase::testEGLError()
 
 void COpenGL3DriverBase::setRenderStates3DMode()
 {
+	flush2DBatch();
+
 	if (LockRenderStateMode)
 		return;
 
@@ -1224,6 +1626,8 @@ void COpenGL3DriverBase::setRenderStates3DMode()
 	}
 
 	if (ResetRenderStates || LastMaterial != Material) {
+		++FrameStats.MaterialChanges;
+
 		// unset old material
 
 		// unset last 3d material
@@ -1543,6 +1947,8 @@ const char *COpenGL3DriverBase::getName() const
 
 void COpenGL3DriverBase::setViewPort(const core::rect<s32> &area)
 {
+	flush2DBatch();
+
 	core::rect<s32> vp = area;
 	core::rect<s32> rendert(0, 0, getCurrentRenderTargetSize().Width, getCurrentRenderTargetSize().Height);
 	vp.clipAgainst(rendert);
@@ -1576,6 +1982,8 @@ void COpenGL3DriverBase::draw3DLine(const core::vector3df &start,
 //! the window was resized.
 void COpenGL3DriverBase::OnResize(const core::dimension2d<u32> &size)
 {
+	flush2DBatch();
+
 	CNullDriver::OnResize(size);
 	CacheHandler->setViewport(0, 0, size.Width, size.Height);
 	Transformation3DChanged = true;
@@ -1743,6 +2151,8 @@ bool COpenGL3DriverBase::setRenderTargetEx(IRenderTarget *target, u16 clearFlag,
 		return false;
 	}
 
+	flush2DBatch();
+
 	core::dimension2d<u32> destRenderTargetSize(0, 0);
 
 	if (target) {
@@ -1777,6 +2187,8 @@ bool COpenGL3DriverBase::setRenderTargetEx(IRenderTarget *target, u16 clearFlag,
 
 void COpenGL3DriverBase::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 {
+	flush2DBatch();
+
 	GLbitfield mask = 0;
 	u8 colorMask = 0;
 	bool depthMask = false;
@@ -1821,6 +2233,8 @@ IImage *COpenGL3DriverBase::createScreenShot(video::ECOLOR_FORMAT format, video:
 	if (target == video::ERT_MULTI_RENDER_TEXTURES || target == video::ERT_RENDER_TEXTURE || target == video::ERT_STEREO_BOTH_BUFFERS)
 		return 0;
 
+	flush2DBatch();
+
 	GLint internalformat = GL_RGBA;
 	GLint type = GL_UNSIGNED_BYTE;
 	{
@@ -1894,10 +2308,19 @@ IImage *COpenGL3DriverBase::createScreenShot(video::ECOLOR_FORMAT format, video:
 
 void COpenGL3DriverBase::removeTexture(ITexture *texture)
 {
+	flush2DBatch();
+
 	CacheHandler->getTextureCache().remove(texture);
 	CNullDriver::removeTexture(texture);
 }
 
+void COpenGL3DriverBase::removeAllTextures()
+{
+	flush2DBatch();
+
+	CNullDriver::removeAllTextures();
+}
+
 //! Set/unset a clipping plane.
 bool COpenGL3DriverBase::setClipPlane(u32 index, const core::plane3df &plane, bool enable)
 {
@@ -16,6 +16,9 @@
 #include "ExtensionHandler.h"
 #include "IContextManager.h"
 
+#include <unordered_map>
+#include <vector>
+
 namespace irr
 {
 namespace video
@@ -23,6 +26,8 @@ namespace video
 struct VertexType;
 
 class COpenGL3FixedPipelineRenderer;
+class COpenGL3InstanceBuffer;
+class COpenGL3StreamBuffer;
 class COpenGL3Renderer2D;
 
 class COpenGL3DriverBase : public CNullDriver, public IMaterialRendererServices, public COpenGL3ExtensionHandler
@@ -48,7 +53,8 @@ public:
 	struct SHWBufferLink_opengl : public SHWBufferLink
 	{
 		SHWBufferLink_opengl(const scene::IMeshBuffer *meshBuffer) :
-				SHWBufferLink(meshBuffer), vbo_verticesID(0), vbo_indicesID(0), vbo_verticesSize(0), vbo_indicesSize(0)
+				SHWBufferLink(meshBuffer), vbo_verticesID(0), vbo_indicesID(0), vbo_verticesSize(0), vbo_indicesSize(0),
+				vaoID(0), vaoType(0)
 		{
 		}
 
@@ -57,6 +63,11 @@ public:
 
 		u32 vbo_verticesSize; // tmp
 		u32 vbo_indicesSize;  // tmp
+
+		//! Vertex array object with the attributes of the vertex buffer
+		u32 vaoID;
+		//! Vertex type the attributes were set up for
+		const VertexType *vaoType;
 	};
 
 	bool updateVertexHardwareBuffer(SHWBufferLink_opengl *HWBuffer);
@@ -74,6 +85,14 @@ public:
 	//! Draw hardware buffer
 	void drawHardwareBuffer(SHWBufferLink *HWBuffer) override;
 
+	//! Draws a list of mesh buffers, each with its own material and world transformation
+	void drawMeshBufferList(const SMeshBufferDraw *draws, u32 count) override;
+
+	//! Number of instances drawn by the current draw call
+	/** Above 1 the world transformation is identity and the built-in shaders
+	read the world matrix of each instance from vertex attributes. */
+	u32 getInstanceCount() const { return InstanceCount; }
+
 	IRenderTarget *addRenderTarget() override;
 
 	//! draws a vertex primitive list
@@ -247,6 +266,14 @@ public:
 
 	void removeTexture(ITexture *texture) override;
 
+	void removeAllTextures() override;
+
+	//! Draws the queued 2D geometry
+	/** The 2D draw calls are queued and merged into one draw until the
+	state changes. The driver flushes before anything that depends on the
+	order, textures before changing or reading their content. */
+	void flush2DBatch();
+
 	//! Check if the driver supports creating textures with the given color format
 	bool queryTextureFormat(ECOLOR_FORMAT format) const override;
 
@@ -325,6 +352,14 @@ protected:
 
 	void beginDraw(const VertexType &vertexType, uintptr_t verticesBase);
 	void endDraw(const VertexType &vertexType);
+	void setVertexAttributes(const VertexType &vertexType, uintptr_t verticesBase);
+
+	//! Streams vertices from client memory and sets up their attributes
+	/** \param baseVertex The caller can draw with a base vertex, so the
+	attributes don't need to point at the new vertices.
+	\return Index of the first streamed vertex relative to the attributes. */
+	GLint beginStreamDraw(const VertexType &vertexType, const void *vertices, u32 vertexCount, bool baseVertex);
+	void endStreamDraw(const VertexType &vertexType);
 
 	COpenGL3CacheHandler *CacheHandler;
 	core::stringc Name;
@@ -387,9 +422,63 @@ private:
 
 	void addDummyMaterial(E_MATERIAL_TYPE type);
 
-	unsigned QuadIndexCount;
+	//! Null if instanced drawing isn't supported
+	COpenGL3InstanceBuffer *InstanceBuffer;
+	u32 InstanceCount;
+	const SMeshBufferDraw *InstanceDraws;
+
+	//! Geometry drawn from client memory is streamed through these
+	COpenGL3StreamBuffer *VertexStream;
+	COpenGL3StreamBuffer *IndexStream;
+
+	//! With vertex array objects the attributes of hardware buffers are set
+	//! up once, and streamed geometry uses one vertex array per vertex type.
+	struct SStreamVertexArray
+	{
+		GLuint Name = 0;
+		//! Generation of the stream buffer and offset the attributes point at
+		u32 Generation = 0;
+		uintptr_t Base = 0;
+	};
+	std::unordered_map<const VertexType *, SStreamVertexArray> StreamVertexArrays;
+	GLuint BoundVertexArray;
+
+	void bindVertexArray(GLuint vertexArray);
+	void bindHardwareVertexArray(SHWBufferLink_opengl *HWBuffer, const VertexType &vertexType);
+
+	void drawElements(GLenum primitiveType, GLsizei indexCount, GLenum indexType, const void *indices, GLint baseVertex = 0);
+
+	//! Quads and lines of the 2D draw calls, queued while the state stays the same
+	struct S2DBatch
+	{
+		const ITexture *Texture = 0;
+		bool Blend = false;
+		//! GL_TRIANGLES for quads or GL_LINES
+		GLenum PrimitiveType = GL_TRIANGLES;
+		//! Clip rectangle for the scissor test, for quads which can't be
+		//! clipped with their vertices
+		bool Scissor = false;
+		core::rect<s32> ScissorRect;
+		//! The 2D material, see chooseMaterial2D()
+		SMaterial Material;
+
+		std::vector<S3DVertex> Vertices;
+		u32 VertexCount = 0;
+	};
+	S2DBatch Batch2D;
+
+	//! Returns room for the vertices of a 2D draw call in the batch
+	/** The batch is drawn first if its state differs. */
+	S3DVertex *queue2D(const ITexture *texture, bool blend, GLenum primitiveType, u32 vertexCount, const core::rect<s32> *scissor = 0);
+
+	//! Indices drawing quads of 4 vertices as two triangles, shared by
+	//! the 2D draws and grown to the largest batch
 	GLuint QuadIndexBuffer = 0;
-	void initQuadsIndices(int max_vertex_count = 65536);
+	u32 QuadIndexCount = 0;
+	GLenum QuadIndexType = GL_UNSIGNED_SHORT;
+	//! Most quads one draw covers, limited by the index type
+	u32 MaxQuadsPerDraw = 65536 / 4;
+	void reserveQuadIndices(u32 quadCount);
 
 	void debugCb(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message);
 	static void APIENTRY debugCb(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam);
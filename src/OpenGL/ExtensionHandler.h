@@ -158,6 +158,11 @@ public:
 
 	bool AnisotropicFilterSupported = false;
 	bool BlendMinMaxSupported = false;
+	bool InstancingSupported = false;
+	bool PersistentMappingSupported = false;
+	bool VertexArraysSupported = false;
+	bool BaseVertexSupported = false;
+	bool ElementIndexUintSupported = false;
 
 private:
 	void addExtension(std::string &&name);
@@ -7,6 +7,8 @@
 
 #include "IVideoDriver.h"
 
+#include "Driver.h"
+
 namespace irr
 {
 namespace video
@@ -15,7 +17,7 @@ namespace video
 // Base callback
 
 COpenGL3MaterialBaseCB::COpenGL3MaterialBaseCB() :
-		FirstUpdateBase(true), WVPMatrixID(-1), WVMatrixID(-1), NMatrixID(-1),
+		FirstUpdateBase(true), WVPMatrixID(-1), WVMatrixID(-1), NMatrixID(-1), InstancingID(-1),
 		FogEnableID(-1), FogTypeID(-1), FogColorID(-1), FogStartID(-1),
 		FogEndID(-1), FogDensityID(-1), ThicknessID(-1), LightEnable(false), MaterialAmbient(SColorf(0.f, 0.f, 0.f)), MaterialDiffuse(SColorf(0.f, 0.f, 0.f)), MaterialEmissive(SColorf(0.f, 0.f, 0.f)), MaterialSpecular(SColorf(0.f, 0.f, 0.f)),
 		MaterialShininess(0.f), FogEnable(0), FogType(1), FogColor(SColorf(0.f, 0.f, 0.f, 1.f)), FogStart(0.f), FogEnd(0.f), FogDensity(0.f), Thickness(1.f)
@@ -44,6 +46,7 @@ void COpenGL3MaterialBaseCB::OnSetConstants(IMaterialRendererServices *services,
 		WVPMatrixID = services->getVertexShaderConstantID("uWVPMatrix");
 		WVMatrixID = services->getVertexShaderConstantID("uWVMatrix");
 		NMatrixID = services->getVertexShaderConstantID("uNMatrix");
+		InstancingID = services->getVertexShaderConstantID("uInstancing");
 
 		FogEnableID = services->getVertexShaderConstantID("uFogEnable");
 		FogTypeID = services->getVertexShaderConstantID("uFogType");
@@ -69,6 +72,10 @@ void COpenGL3MaterialBaseCB::OnSetConstants(IMaterialRendererServices *services,
 	Matrix.makeInverse();
 	services->setPixelShaderConstant(NMatrixID, Matrix.getTransposed().pointer(), 16);
 
+	// the built-in materials are only used by the OpenGL 3 drivers
+	s32 instancing = static_cast<COpenGL3DriverBase *>(driver)->getInstanceCount() > 1 ? 1 : 0;
+	services->setVertexShaderConstant(InstancingID, &instancing, 1);
+
 	services->setPixelShaderConstant(FogEnableID, &FogEnable, 1);
 
 	if (FogEnable) {
@@ -27,6 +27,7 @@ protected:
 	s32 WVPMatrixID;
 	s32 WVMatrixID;
 	s32 NMatrixID;
+	s32 InstancingID;
 
 	s32 FogEnableID;
 	s32 FogTypeID;
@@ -0,0 +1,106 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "InstanceBuffer.h"
+
+#include "IMeshBuffer.h"
+#include "SMaterial.h"
+
+#include "mt_opengl.h"
+
+#include <cstring>
+
+namespace irr
+{
+namespace video
+{
+
+const char *const COpenGL3InstanceBuffer::AttributeNames[4] = {
+		"inInstanceWorld0",
+		"inInstanceWorld1",
+		"inInstanceWorld2",
+		"inInstanceWorld3",
+	};
+
+COpenGL3InstanceBuffer::COpenGL3InstanceBuffer() :
+		Buffer(0), Capacity(0), Offset(0)
+{
+}
+
+COpenGL3InstanceBuffer::~COpenGL3InstanceBuffer()
+{
+	if (Buffer)
+		GL.DeleteBuffers(1, &Buffer);
+}
+
+bool COpenGL3InstanceBuffer::canDrawInstanced(const SMeshBufferDraw &draw)
+{
+	// custom shaders don't read the instance attributes
+	if (draw.Material->MaterialType < EMT_SOLID || draw.Material->MaterialType > EMT_ONETEXTURE_BLEND)
+		return false;
+
+	switch (draw.MeshBuffer->getPrimitiveType()) {
+	case scene::EPT_POINTS:
+	case scene::EPT_POINT_SPRITES:
+		return false;
+	default:
+		return draw.MeshBuffer->getIndexCount() > 0;
+	}
+}
+
+u32 COpenGL3InstanceBuffer::getInstanceRun(const SMeshBufferDraw *draws, u32 count)
+{
+	const SMeshBufferDraw &first = draws[0];
+	if (!canDrawInstanced(first))
+		return 1;
+
+	u32 run = 1;
+	while (run < count && draws[run].MeshBuffer == first.MeshBuffer &&
+			(draws[run].Material == first.Material || *draws[run].Material == *first.Material))
+		++run;
+
+	return run;
+}
+
+void COpenGL3InstanceBuffer::bind(const SMeshBufferDraw *draws, u32 count)
+{
+	// matrix4 may carry an identity flag, so copy the values only
+	Staging.set_used(count * 16);
+	for (u32 i = 0; i < count; ++i)
+		memcpy(&Staging[i * 16], draws[i].Transform->pointer(), 16 * sizeof(f32));
+
+	const u32 size = count * 16 * sizeof(f32);
+
+	if (!Buffer)
+		GL.GenBuffers(1, &Buffer);
+	GL.BindBuffer(GL_ARRAY_BUFFER, Buffer);
+
+	if (Offset + size > Capacity) {
+		Capacity = core::max_(Capacity, size, MinCapacity);
+		GL.BufferData(GL_ARRAY_BUFFER, Capacity, 0, GL_STREAM_DRAW);
+		Offset = 0;
+	}
+	GL.BufferSubData(GL_ARRAY_BUFFER, Offset, size, Staging.const_pointer());
+
+	// one column of the matrix per attribute, advancing once per instance
+	for (GLuint i = 0; i < 4; ++i) {
+		GL.EnableVertexAttribArray(FirstAttribute + i);
+		GL.VertexAttribPointer(FirstAttribute + i, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(f32),
+				reinterpret_cast<void *>((uintptr_t)Offset + i * 4 * sizeof(f32)));
+		GL.VertexAttribDivisor(FirstAttribute + i, 1);
+	}
+
+	GL.BindBuffer(GL_ARRAY_BUFFER, 0);
+	Offset += size;
+}
+
+void COpenGL3InstanceBuffer::unbind()
+{
+	for (GLuint i = 0; i < 4; ++i) {
+		GL.VertexAttribDivisor(FirstAttribute + i, 0);
+		GL.DisableVertexAttribArray(FirstAttribute + i);
+	}
+}
+
+} // end namespace video
+} // end namespace irr
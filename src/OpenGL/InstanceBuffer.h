@@ -0,0 +1,63 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "EVertexAttributes.h"
+#include "SMeshBufferDraw.h"
+#include "irrArray.h"
+
+#include "Common.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Streams the world matrices of instanced draws to the GPU
+/** Draws of a draw list which share mesh buffer and material are drawn
+with one instanced draw call. The built-in vertex shader reads the world
+matrix of each instance from four vertex attributes following the regular
+ones, which this class fills from a buffer object. */
+class COpenGL3InstanceBuffer
+{
+public:
+	//! Index of the first of the four attributes holding the matrix columns
+	static constexpr GLuint FirstAttribute = EVA_COUNT;
+
+	//! Names of the instance attributes in the shaders
+	static const char *const AttributeNames[4];
+
+	COpenGL3InstanceBuffer();
+	~COpenGL3InstanceBuffer();
+
+	//! Checks if a draw may be drawn instanced at all
+	/** Only the built-in materials use a shader which knows about instances.
+	Point lists are drawn without indices and aren't instanced either. */
+	static bool canDrawInstanced(const SMeshBufferDraw &draw);
+
+	//! Returns how many draws at the start of a list can be drawn with one call
+	/** \return Number of consecutive draws which share mesh buffer and
+	material with the first one, or 1 if it can't be drawn instanced. */
+	static u32 getInstanceRun(const SMeshBufferDraw *draws, u32 count);
+
+	//! Uploads the world matrices of the draws and enables the instance attributes
+	void bind(const SMeshBufferDraw *draws, u32 count);
+
+	//! Disables the instance attributes again
+	void unbind();
+
+private:
+	//! Orphaning the buffer when it is full lets the driver hand out new
+	//! storage instead of waiting for draws still reading the old data.
+	static constexpr u32 MinCapacity = 1024 * 16 * sizeof(f32);
+
+	GLuint Buffer;
+	u32 Capacity;
+	u32 Offset;
+
+	core::array<f32> Staging;
+};
+
+} // end namespace video
+} // end namespace irr
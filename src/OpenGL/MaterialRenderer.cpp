@@ -11,6 +11,7 @@
 #include "os.h"
 
 #include "Driver.h"
+#include "InstanceBuffer.h"
 
 #include "COpenGLCoreTexture.h"
 #include "COpenGLCoreCacheHandler.h"
@@ -122,6 +123,11 @@ void COpenGL3MaterialRenderer::init(s32 &outMaterialTypeNr,
 	for (size_t i = 0; i < EVA_COUNT; ++i)
 		GL.BindAttribLocation(Program, i, sBuiltInVertexAttributeNames[i]);
 
+	if (Driver->InstancingSupported) {
+		for (GLuint i = 0; i < 4; ++i)
+			GL.BindAttribLocation(Program, COpenGL3InstanceBuffer::FirstAttribute + i, COpenGL3InstanceBuffer::AttributeNames[i]);
+	}
+
 	if (!linkProgram())
 		return;
 
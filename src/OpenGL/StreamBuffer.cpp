@@ -0,0 +1,131 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "StreamBuffer.h"
+
+#include "irrMath.h"
+#include "os.h"
+
+#include "mt_opengl.h"
+
+#include <cstring>
+
+namespace irr
+{
+namespace video
+{
+
+static constexpr GLbitfield PersistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+COpenGL3StreamBuffer::COpenGL3StreamBuffer(GLenum target, bool persistent) :
+		Target(target), Persistent(persistent), Buffer(0), Generation(0), Capacity(0), Mapped(0),
+		Position(0), FencedPosition(0)
+{
+}
+
+COpenGL3StreamBuffer::~COpenGL3StreamBuffer()
+{
+	for (const SFence &fence : Fences)
+		GL.DeleteSync(fence.Sync);
+	if (Buffer)
+		GL.DeleteBuffers(1, &Buffer);
+}
+
+void COpenGL3StreamBuffer::allocate(u32 capacity)
+{
+	for (const SFence &fence : Fences)
+		GL.DeleteSync(fence.Sync);
+	Fences.clear();
+	Position = 0;
+	FencedPosition = 0;
+	++Generation;
+
+	// draws still reading the old buffer keep its storage alive
+	if (Buffer)
+		GL.DeleteBuffers(1, &Buffer);
+	GL.GenBuffers(1, &Buffer);
+	GL.BindBuffer(Target, Buffer);
+	Capacity = capacity;
+	Mapped = 0;
+
+	if (Persistent) {
+		GL.BufferStorage(Target, Capacity, 0, PersistentFlags);
+		Mapped = static_cast<u8 *>(GL.MapBufferRange(Target, 0, Capacity, PersistentFlags));
+		if (Mapped)
+			return;
+
+		os::Printer::log("Could not map the stream buffer, uploading instead", ELL_WARNING);
+		Persistent = false;
+		GL.DeleteBuffers(1, &Buffer);
+		GL.GenBuffers(1, &Buffer);
+		GL.BindBuffer(Target, Buffer);
+	}
+
+	GL.BufferData(Target, Capacity, 0, GL_STREAM_DRAW);
+}
+
+uintptr_t COpenGL3StreamBuffer::append(const void *data, u32 size, u32 alignment)
+{
+	if (!Buffer || size > Capacity) {
+		u32 capacity = core::max_(Capacity, MinCapacity);
+		while (capacity < size)
+			capacity *= 2;
+		allocate(capacity);
+	} else {
+		GL.BindBuffer(Target, Buffer);
+	}
+
+	// the offset is aligned, not the position, which may be larger than the ring
+	u32 offset = (u32)(Position % Capacity);
+	const u32 padding = (alignment - offset % alignment) % alignment;
+	Position += padding;
+	offset += padding;
+	if (offset + size > Capacity) {
+		Position += Capacity - offset;
+		offset = 0;
+
+		// new storage for the next round, the old one stays with the draws using it
+		if (!Persistent)
+			GL.BufferData(Target, Capacity, 0, GL_STREAM_DRAW);
+	}
+
+	if (Persistent) {
+		if (Position + size > Capacity)
+			waitFor(Position + size - Capacity);
+		memcpy(Mapped + offset, data, size);
+	} else {
+		GL.BufferSubData(Target, offset, size, data);
+	}
+
+	Position += size;
+	return offset;
+}
+
+void COpenGL3StreamBuffer::endFrame()
+{
+	if (!Persistent || Position == FencedPosition)
+		return;
+
+	Fences.push_back({GL.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), FencedPosition});
+	FencedPosition = Position;
+}
+
+void COpenGL3StreamBuffer::waitFor(u64 position)
+{
+	// a frame using more than the whole ring has to wait for itself
+	if (position > FencedPosition)
+		endFrame();
+
+	while (!Fences.empty() && Fences.front().Start < position) {
+		GLenum result;
+		do {
+			result = GL.ClientWaitSync(Fences.front().Sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+
+		GL.DeleteSync(Fences.front().Sync);
+		Fences.pop_front();
+	}
+}
+
+} // end namespace video
+} // end namespace irr
@@ -0,0 +1,83 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "irrTypes.h"
+
+#include <deque>
+
+#include "Common.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Ring buffer for geometry which isn't in a hardware buffer
+/** Vertices and indices drawn from client memory are appended to a buffer
+object and drawn with offsets into it, as attribute pointers into client
+memory are slow on core profiles and GLES and unsupported on WebGL.
+
+With persistent mapping the data is copied into the mapped storage, and a
+fence at the end of each frame keeps the ring from overwriting data the GPU
+may still read. Otherwise the data is uploaded with BufferSubData and the
+storage is orphaned whenever the ring wraps around. */
+class COpenGL3StreamBuffer
+{
+public:
+	//! \param target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+	//! \param persistent Use persistently mapped storage, needs
+	//! glBufferStorage, glMapBufferRange and sync objects.
+	COpenGL3StreamBuffer(GLenum target, bool persistent);
+	~COpenGL3StreamBuffer();
+
+	//! Appends the data and leaves the buffer bound to the target
+	/** \param alignment The offset of the data is a multiple of this,
+	for example the vertex size to draw with a base vertex.
+	\return Offset of the data in the buffer. */
+	uintptr_t append(const void *data, u32 size, u32 alignment = 16);
+
+	//! Fences the data appended since the last call
+	void endFrame();
+
+	bool isPersistent() const { return Persistent; }
+
+	//! Changes whenever the storage is replaced, as when the ring grows
+	/** GL may hand out the name of the deleted buffer again, so compare
+	this instead of the buffer name. */
+	u32 getGeneration() const { return Generation; }
+
+private:
+	static constexpr u32 MinCapacity = 1024 * 1024;
+
+	//! Replaces the storage, dropping the fences of the old one
+	void allocate(u32 capacity);
+
+	//! Waits until the GPU read everything appended before position
+	void waitFor(u64 position);
+
+	//! Fence guarding the data from Start up to the start of the next one
+	struct SFence
+	{
+		GLsync Sync;
+		u64 Start;
+	};
+
+	GLenum Target;
+	bool Persistent;
+
+	GLuint Buffer;
+	u32 Generation;
+	u32 Capacity;
+	u8 *Mapped;
+
+	//! Bytes appended since the storage was allocated, the offset in the
+	//! buffer is this modulo Capacity
+	u64 Position;
+	u64 FencedPosition;
+	std::deque<SFence> Fences;
+};
+
+} // end namespace video
+} // end namespace irr
@@ -5,6 +5,7 @@
 #include "Driver.h"
 #include <cassert>
 #include "mt_opengl.h"
+#include "EVertexAttributes.h"
 
 namespace irr
 {
@@ -58,6 +59,12 @@ void COpenGL3Driver::initFeatures()
 
 	AnisotropicFilterSupported = isVersionAtLeast(4, 6) || queryExtension("GL_ARB_texture_filter_anisotropic") || queryExtension("GL_EXT_texture_filter_anisotropic");
 	BlendMinMaxSupported = true;
+	InstancingSupported = (isVersionAtLeast(3, 3) || queryExtension("GL_ARB_instanced_arrays")) &&
+						   GetInteger(GL_MAX_VERTEX_ATTRIBS) >= EVA_COUNT + 4;
+	PersistentMappingSupported = isVersionAtLeast(4, 4) || queryExtension("GL_ARB_buffer_storage");
+	VertexArraysSupported = true;
+	BaseVertexSupported = true;
+	ElementIndexUintSupported = true;
 
 	// COGLESCoreExtensionHandler::Feature
 	static_assert(MATERIAL_MAX_TEXTURES <= 16, "Only up to 16 textures are guaranteed");
@@ -5,6 +5,7 @@
 #include "Driver.h"
 #include <cassert>
 #include <CColorConverter.h>
+#include "EVertexAttributes.h"
 
 namespace irr
 {
@@ -111,6 +112,11 @@ void COpenGLES2Driver::initFeatures()
 	const bool MRTSupported = Version.Major >= 3 || queryExtension("GL_EXT_draw_buffers");
 	AnisotropicFilterSupported = queryExtension("GL_EXT_texture_filter_anisotropic");
 	BlendMinMaxSupported = (Version.Major >= 3) || FeatureAvailable[IRR_GL_EXT_blend_minmax];
+	InstancingSupported = Version.Major >= 3 && GetInteger(GL_MAX_VERTEX_ATTRIBS) >= EVA_COUNT + 4;
+	PersistentMappingSupported = Version.Major >= 3 && queryExtension("GL_EXT_buffer_storage");
+	VertexArraysSupported = Version.Major >= 3;
+	BaseVertexSupported = isVersionAtLeast(3, 2);
+	ElementIndexUintSupported = Version.Major >= 3 || FeatureAvailable[IRR_GL_OES_element_index_uint];
 	const bool TextureLODBiasSupported = queryExtension("GL_EXT_texture_lod_bias");
 
 	// COGLESCoreExtensionHandler::Feature
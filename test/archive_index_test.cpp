@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+
+#include "test_check.h"
+#include "zip_writer.h"
+
+using namespace irr;
+
+// Looks up files in several archives with overlapping names. Run with
+// --benchmark to compare the lookup with searching each archive in turn.
+
+// each file of an archive contains the archive's tag
+static void writeArchive(io::IFileSystem *fs, const io::path &name, const core::array<io::path> &files, c8 tag)
+{
+	core::array<u8> zip;
+	for (u32 i = 0; i < files.size(); ++i)
+		zipwriter::addStoredEntry(zip, files[i], &tag, 1);
+	zipwriter::endArchive(zip);
+	zipwriter::writeFile(fs, name, zip);
+}
+
+// returns the tag of the archive the file was opened from
+static c8 openTag(io::IFileSystem *fs, const io::path &name)
+{
+	io::IReadFile *file = fs->createAndOpenFile(name);
+	if (!file)
+		return 0;
+
+	c8 tag = 0;
+	file->read(&tag, 1);
+	file->drop();
+	return tag;
+}
+
+static void testPrecedence(io::IFileSystem *fs)
+{
+	core::array<io::path> files;
+	files.push_back("textures/Wall.png");
+	files.push_back("common.txt");
+	writeArchive(fs, "archive_index_a.zip", files, 'a');
+
+	files.clear();
+	files.push_back("textures/wall.png");
+	files.push_back("models/common.txt");
+	files.push_back("only_b.txt");
+	writeArchive(fs, "archive_index_b.zip", files, 'b');
+
+	// a keeps the paths, b ignores them
+	check(fs->addFileArchive("archive_index_a.zip", false, false, io::EFAT_ZIP), "archive a added");
+	check(fs->addFileArchive("archive_index_b.zip", true, true, io::EFAT_ZIP), "archive b added");
+
+	check(openTag(fs, "textures/Wall.png") == 'a', "first archive wins");
+	check(openTag(fs, "TEXTURES\\WALL.PNG") == 'a', "case and separators are ignored");
+	check(openTag(fs, "wall.png") == 'b', "name without path in the archive ignoring paths");
+	check(openTag(fs, "common.txt") == 'a', "file in the root");
+	check(openTag(fs, "models/common.txt") == 'b', "path is ignored by b");
+	check(openTag(fs, "only_b.txt") == 'b', "file only in the second archive");
+	check(openTag(fs, "textures/") == 0, "folders are not opened");
+	check(openTag(fs, "missing.txt") == 0, "missing file");
+	check(fs->existFile("Common.txt") && fs->existFile("x/only_b.txt") && !fs->existFile("missing.txt"), "existFile");
+
+	// the index follows changes of the archive order
+	check(fs->moveFileArchive(1, -1), "archive moved");
+	check(openTag(fs, "textures/Wall.png") == 'b' && openTag(fs, "common.txt") == 'b', "moved archive wins");
+
+	check(fs->removeFileArchive((u32)0), "archive removed");
+	check(openTag(fs, "textures/wall.png") == 'a' && openTag(fs, "only_b.txt") == 0, "removed archive is gone");
+	fs->removeFileArchive((u32)0);
+
+	remove("archive_index_a.zip");
+	remove("archive_index_b.zip");
+}
+
+static void benchmark(io::IFileSystem *fs)
+{
+	const u32 archiveCount = 32;
+	const u32 fileCount = 500;
+
+	core::array<io::path> names;
+	for (u32 a = 0; a < archiveCount; ++a) {
+		core::array<io::path> files;
+		for (u32 f = 0; f < fileCount; ++f) {
+			c8 name[64];
+			snprintf(name, sizeof(name), "media/pack%02u/texture_%04u.png", a, f);
+			files.push_back(name);
+			names.push_back(name);
+		}
+
+		c8 archive[64];
+		snprintf(archive, sizeof(archive), "archive_index_%02u.zip", a);
+		writeArchive(fs, archive, files, 'x');
+		fs->addFileArchive(archive, true, false, io::EFAT_ZIP);
+		remove(archive);
+	}
+
+	const u32 rounds = 4;
+	u32 found = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (u32 r = 0; r < rounds; ++r) {
+		for (u32 i = 0; i < names.size(); ++i) {
+			for (u32 a = 0; a < fs->getFileArchiveCount(); ++a) {
+				if (fs->getFileArchive(a)->getFileList()->findFile(names[i]) >= 0) {
+					++found;
+					break;
+				}
+			}
+		}
+	}
+	const double sequential = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for (u32 r = 0; r < rounds; ++r) {
+		for (u32 i = 0; i < names.size(); ++i)
+			found += fs->existFile(names[i]) ? 1 : 0;
+	}
+	const double indexed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	const u32 lookups = rounds * names.size();
+	printf("%u lookups in %u archives: %.3f us each searching every archive, %.3f us each with the index (%u found)\n",
+			lookups, archiveCount, sequential * 1000.0 / lookups, indexed * 1000.0 / lookups, found);
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_ERROR;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	io::IFileSystem *fs = device->getFileSystem();
+	testPrecedence(fs);
+
+	if (isBenchmark(argc, argv))
+		benchmark(fs);
+
+	device->drop();
+
+	return testResult();
+}
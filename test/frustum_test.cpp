@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <irrlicht.h>
+
+#include "FrustumBoxes.h"
+#include "test_check.h"
+
+using namespace irr;
+using scene::SViewFrustum;
+
+static f32 random(f32 range)
+{
+	return (rand() / (f32)RAND_MAX - 0.5f) * range;
+}
+
+// Compares testFrustumBoxes() with aabbox3d::classifyPlaneRelation()
+static void testBoxes(const SViewFrustum &frustum, u32 planeMask)
+{
+	std::vector<core::aabbox3df> boxes;
+	for (u32 i = 0; i < 1003; ++i) {
+		core::aabbox3df box(core::vector3df(random(400.f), random(400.f), random(400.f)));
+		box.addInternalPoint(box.MinEdge + core::vector3df(random(40.f), random(40.f), random(40.f)));
+		boxes.push_back(box);
+	}
+
+	std::vector<f32> minX, minY, minZ, maxX, maxY, maxZ;
+	for (const core::aabbox3df &box : boxes) {
+		minX.push_back(box.MinEdge.X);
+		minY.push_back(box.MinEdge.Y);
+		minZ.push_back(box.MinEdge.Z);
+		maxX.push_back(box.MaxEdge.X);
+		maxY.push_back(box.MaxEdge.Y);
+		maxZ.push_back(box.MaxEdge.Z);
+	}
+
+	// odd counts exercise the scalar tail and partial words
+	for (u32 count : {0u, 1u, 3u, 4u, 31u, 32u, 33u, 1003u}) {
+		std::vector<u32> bits((count + 31) / 32 + 1, 0xdeadbeef);
+		testFrustumBoxes(frustum, minX.data(), minY.data(), minZ.data(),
+				maxX.data(), maxY.data(), maxZ.data(), count, bits.data(), planeMask);
+
+		u32 mismatches = 0;
+		for (u32 i = 0; i < count; ++i) {
+			bool visible = true;
+			for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; ++p) {
+				if ((planeMask & (1 << p)) && boxes[i].classifyPlaneRelation(frustum.planes[p]) == core::ISREL3D_FRONT)
+					visible = false;
+			}
+			mismatches += visible != ((bits[i / 32] >> (i % 32)) & 1);
+		}
+		check(mismatches == 0, "visibility matches the scalar test");
+
+		if (count % 32)
+			check((bits[count / 32] >> (count % 32)) == 0, "unused bits cleared");
+		check(bits[(count + 31) / 32] == 0xdeadbeef, "no write past the end");
+	}
+}
+
+// Times testFrustumBoxes() against testing each box on its own
+static void benchmark(const SViewFrustum &frustum)
+{
+	const u32 count = 100000;
+	const u32 passes = 100;
+	std::vector<core::aabbox3df> boxes;
+	std::vector<f32> minX, minY, minZ, maxX, maxY, maxZ;
+	for (u32 i = 0; i < count; ++i) {
+		core::aabbox3df box(core::vector3df(random(400.f), random(400.f), random(400.f)));
+		box.addInternalPoint(box.MinEdge + core::vector3df(random(40.f), random(40.f), random(40.f)));
+		boxes.push_back(box);
+		minX.push_back(box.MinEdge.X);
+		minY.push_back(box.MinEdge.Y);
+		minZ.push_back(box.MinEdge.Z);
+		maxX.push_back(box.MaxEdge.X);
+		maxY.push_back(box.MaxEdge.Y);
+		maxZ.push_back(box.MaxEdge.Z);
+	}
+
+	u32 visible = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (u32 pass = 0; pass < passes; ++pass) {
+		for (u32 i = 0; i < count; ++i) {
+			bool inside = true;
+			for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT && inside; ++p)
+				inside = boxes[i].classifyPlaneRelation(frustum.planes[p]) != core::ISREL3D_FRONT;
+			visible += inside;
+		}
+	}
+	const f64 single = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count() / passes;
+
+	std::vector<u32> bits((count + 31) / 32);
+	start = std::chrono::steady_clock::now();
+	for (u32 pass = 0; pass < passes; ++pass) {
+		testFrustumBoxes(frustum, minX.data(), minY.data(), minZ.data(),
+				maxX.data(), maxY.data(), maxZ.data(), count, bits.data());
+		for (u32 word : bits)
+			visible += word & 1;
+	}
+	const f64 batched = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count() / passes;
+
+	printf("%u boxes: %.3f ms testing each box, %.3f ms batched (%u visible)\n", count, single, batched, visible);
+}
+
+int main(int argc, char *argv[])
+{
+	core::matrix4 projection, view;
+	projection.buildProjectionMatrixPerspectiveFovLH(core::PI / 2.5f, 4.f / 3.f, 1.f, 150.f);
+	view.buildCameraLookAtMatrixLH(core::vector3df(10.f, 20.f, -30.f), core::vector3df(0.f, 0.f, 50.f), core::vector3df(0.f, 1.f, 0.f));
+
+	const SViewFrustum frustum(projection * view, false);
+	if (isBenchmark(argc, argv)) {
+		benchmark(frustum);
+		return 0;
+	}
+
+	testBoxes(frustum, (1 << SViewFrustum::VF_PLANE_COUNT) - 1);
+	testBoxes(frustum, (1 << SViewFrustum::VF_LEFT_PLANE) | (1 << SViewFrustum::VF_FAR_PLANE));
+	testBoxes(frustum, 0);
+
+	return testResult();
+}
@@ -0,0 +1,536 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <irrlicht.h>
+
+#include "mock_gl.h"
+#include "test_check.h"
+
+using namespace irr;
+
+// Runs the OpenGL driver against the recording mock GL and checks what it
+// sends per frame: draw calls, uploads and state changes. Run with
+// --benchmark to measure the CPU time the driver spends per draw call.
+
+namespace irr
+{
+namespace video
+{
+#if defined(_IRR_COMPILE_WITH_OGLES2_)
+IVideoDriver *createOGLES2Driver(const SIrrlichtCreationParameters &params, io::IFileSystem *io, IContextManager *contextManager);
+#else
+IVideoDriver *createOpenGL3Driver(const SIrrlichtCreationParameters &params, io::IFileSystem *io, IContextManager *contextManager);
+#endif
+}
+}
+
+// the buffer storage context is an OpenGL ES 3.2 one, with base vertex draws
+static video::IVideoDriver *createDriver(const SIrrlichtCreationParameters &params, io::IFileSystem *fs, bool bufferStorage = false)
+{
+	std::vector<std::string> extensions;
+#if defined(_IRR_COMPILE_WITH_OGLES2_)
+	if (bufferStorage)
+		extensions.push_back("GL_EXT_buffer_storage");
+	video::IContextManager *contextManager = new mockgl::HeadlessContextManager(true, extensions, bufferStorage ? 2 : 0);
+	video::IVideoDriver *driver = video::createOGLES2Driver(params, fs, contextManager);
+#else
+	if (bufferStorage)
+		extensions.push_back("GL_ARB_buffer_storage");
+	video::IContextManager *contextManager = new mockgl::HeadlessContextManager(false, extensions);
+	video::IVideoDriver *driver = video::createOpenGL3Driver(params, fs, contextManager);
+#endif
+	contextManager->drop();
+	return driver;
+}
+
+static scene::SMeshBuffer *createGrid(u32 size)
+{
+	scene::SMeshBuffer *buffer = new scene::SMeshBuffer();
+	for (u32 y = 0; y <= size; ++y)
+		for (u32 x = 0; x <= size; ++x)
+			buffer->Vertices.push_back(video::S3DVertex((f32)x, 0.f, (f32)y, 0.f, 1.f, 0.f,
+					video::SColor(255, 255, 255, 255), (f32)x / size, (f32)y / size));
+	for (u32 y = 0; y < size; ++y) {
+		for (u32 x = 0; x < size; ++x) {
+			const u16 i = y * (size + 1) + x;
+			buffer->Indices.push_back(i);
+			buffer->Indices.push_back(i + size + 1);
+			buffer->Indices.push_back(i + 1);
+			buffer->Indices.push_back(i + 1);
+			buffer->Indices.push_back(i + size + 1);
+			buffer->Indices.push_back(i + size + 2);
+		}
+	}
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+// draws the buffer count times with the same material
+static void drawFrame(video::IVideoDriver *driver, scene::IMeshBuffer *buffer, const video::SMaterial &material, u32 count)
+{
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	driver->setMaterial(material);
+	for (u32 i = 0; i < count; ++i) {
+		core::matrix4 world;
+		world.setTranslation(core::vector3df((f32)i, 0.f, 0.f));
+		driver->setTransform(video::ETS_WORLD, world);
+		driver->drawMeshBuffer(buffer);
+	}
+	driver->endScene();
+}
+
+static void testFrames(video::IVideoDriver *driver)
+{
+	video::IImage *image = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(64, 64));
+	image->fill(video::SColor(255, 128, 64, 32));
+	video::ITexture *texture = driver->addTexture("grid", image);
+	image->drop();
+
+	scene::SMeshBuffer *buffer = createGrid(32);
+	buffer->setHardwareMappingHint(scene::EHM_STATIC);
+
+	video::SMaterial material;
+	material.setTexture(0, texture);
+
+	mockgl::clearFrames();
+	mockgl::clearCommands();
+	drawFrame(driver, buffer, material, 10);
+	drawFrame(driver, buffer, material, 10);
+
+	const std::vector<mockgl::FrameCounters> &frames = mockgl::getFrames();
+	check(frames.size() == 2, "one set of counters per frame");
+	if (frames.size() != 2)
+		return;
+
+	check(frames[1].DrawCalls == 10, "draw calls reach GL");
+	check(frames[1].DrawCalls == driver->getFrameStats().DrawCalls, "frame stats count the draw calls");
+	check(frames[1].ClientDraws == 0, "static mesh drawn from buffers");
+	check(frames[0].BufferBytes >= buffer->getVertexCount() * sizeof(video::S3DVertex) + buffer->getIndexCount() * sizeof(u16),
+			"static mesh uploaded in the first frame");
+	check(frames[1].BufferBytes == 0, "static mesh uploaded only once");
+	check(frames[1].TextureBytes == 0, "texture uploaded only once");
+	check(frames[1].UniformUploads > 0, "transformations uploaded");
+
+	// the material stays the same, so the program and texture stay bound
+	const std::vector<mockgl::Command> recorded = mockgl::getCommands();
+	u32 i = 0;
+	while (i < recorded.size() && recorded[i].Func != mockgl::Flush)
+		++i;
+	u32 commands[mockgl::FunctionCount] = {0};
+	for (++i; i < recorded.size(); ++i)
+		++commands[recorded[i].Func];
+	check(commands[mockgl::UseProgram] <= 1, "program bound once per frame");
+	check(commands[mockgl::BindTexture] <= 1, "texture bound once per frame");
+
+	// the vertex array of the buffer keeps the attributes
+	check(driver->getFrameStats().VertexAttributeCalls == 0, "no vertex attribute calls for a drawn buffer");
+	check(commands[mockgl::EnableVertexAttribArray] + commands[mockgl::DisableVertexAttribArray] +
+					commands[mockgl::VertexAttribPointer] == 0,
+			"vertex attributes set up once");
+	check(commands[mockgl::BindVertexArray] <= 1, "vertex array bound once for the same buffer");
+
+	mockgl::clearCommands();
+	drawFrame(driver, buffer, material, 10);
+	check(mockgl::countCommands(mockgl::DrawElements) + mockgl::countCommands(mockgl::DrawRangeElements) == 10,
+			"command stream decodes");
+	const std::vector<u32> &stream = mockgl::getCommandStream();
+	check(stream.size() && (stream[0] >> 8) < mockgl::FunctionCount, "stream starts with a command header");
+
+	driver->removeHardwareBuffer(buffer);
+	buffer->drop();
+	driver->removeTexture(texture);
+}
+
+// draws enough geometry from client memory to wrap the stream buffers
+static void drawClientFrame(video::IVideoDriver *driver, scene::IMeshBuffer *buffer, u32 rectangles)
+{
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	driver->setMaterial(video::SMaterial());
+	driver->drawMeshBuffer(buffer);
+	driver->drawMeshBuffer(buffer);
+	for (u32 i = 0; i < rectangles; ++i)
+		driver->draw2DRectangle(video::SColor(255, i & 255, 0, 0), core::rect<s32>(i % 100, 0, i % 100 + 10, 10));
+	driver->endScene();
+}
+
+static void testStreaming(video::IVideoDriver *driver, bool persistent, bool baseVertex)
+{
+	// without hardware mapping hint the grid is drawn from client memory
+	scene::SMeshBuffer *buffer = createGrid(8);
+
+	const u32 rectangles = 10000;
+	mockgl::clearFrames();
+	mockgl::clearCommands();
+	for (u32 frame = 0; frame < 3; ++frame)
+		drawClientFrame(driver, buffer, rectangles);
+
+	const u64 vertexBytes = rectangles * 4 * sizeof(video::S3DVertex);
+	for (const mockgl::FrameCounters &frame : mockgl::getFrames()) {
+		check(frame.DrawCalls == 3, "rectangles drawn in one batch");
+		check(frame.ClientDraws == 0, "client geometry drawn from the stream buffers");
+		if (!persistent)
+			check(frame.BufferBytes >= vertexBytes, "client geometry uploaded");
+	}
+
+	if (persistent) {
+		check(mockgl::countCommands(mockgl::BufferSubData) == 0, "persistent stream written through the mapping");
+		check(mockgl::countCommands(mockgl::FenceSync) >= 3, "one fence per frame");
+		check(mockgl::countCommands(mockgl::ClientWaitSync) > 0, "reused storage waited for");
+	} else {
+		check(mockgl::countCommands(mockgl::FenceSync) == 0, "no fences without persistent mapping");
+	}
+
+	// the vertex array of the stream buffer stays, the grid moves by its base vertex
+	if (baseVertex)
+		check(mockgl::countCommands(mockgl::DrawElementsBaseVertex) > 0, "streamed mesh drawn with a base vertex");
+
+	buffer->drop();
+}
+
+// a triangle from a vertex array of the given size in bytes, streamed as a whole
+static void drawLargeVertices(video::IVideoDriver *driver, u32 bytes)
+{
+	std::vector<video::S3DVertex> vertices(bytes / sizeof(video::S3DVertex) + 1);
+	const u16 indices[3] = {0, 1, 2};
+	driver->drawVertexPrimitiveList(vertices.data(), vertices.size(), indices, 1,
+			video::EVT_STANDARD, scene::EPT_TRIANGLES, video::EIT_16BIT);
+}
+
+static void testStreamGrowth(video::IVideoDriver *driver)
+{
+	// both draws start at offset 0 of a grown stream buffer, the second one
+	// in a buffer which gets the name of the deleted one back
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	driver->setMaterial(video::SMaterial());
+	drawLargeVertices(driver, 4 * 1024 * 1024);
+	mockgl::clearCommands();
+	drawLargeVertices(driver, 8 * 1024 * 1024);
+	driver->endScene();
+
+	u32 deleted = 0, generated = 0;
+	for (const mockgl::Command &command : mockgl::getCommands()) {
+		if (command.Func == mockgl::DeleteBuffers && !deleted)
+			deleted = command.Args[1];
+		else if (command.Func == mockgl::GenBuffers && !generated)
+			generated = command.Args[1];
+	}
+	check(deleted && generated == deleted, "grown stream buffer reuses the deleted name");
+	check(mockgl::countCommands(mockgl::VertexAttribPointer) > 0, "vertex attributes set for the grown stream buffer");
+}
+
+// GUI like frame: slot backgrounds, clipped item icons from an atlas and text
+static void drawGUIFrame(video::IVideoDriver *driver, video::ITexture *atlas, video::ITexture *font, u32 slots)
+{
+	const core::rect<s32> clip(0, 0, 600, 400);
+	core::array<core::position2d<s32>> positions;
+	core::array<core::rect<s32>> glyphs;
+	for (u32 i = 0; i < 40; ++i) {
+		positions.push_back(core::position2d<s32>(i * 8, 0));
+		glyphs.push_back(core::rect<s32>((i % 16) * 8, (i / 16) * 16, (i % 16) * 8 + 8, (i / 16) * 16 + 16));
+	}
+
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	for (u32 i = 0; i < slots; ++i) {
+		const core::rect<s32> slot((i % 20) * 32, (i / 20) * 32, (i % 20) * 32 + 30, (i / 20) * 32 + 30);
+		driver->draw2DRectangle(video::SColor(128, 64, 64, 64), slot, &clip);
+	}
+	for (u32 i = 0; i < slots; ++i) {
+		const core::position2d<s32> pos((i % 20) * 32 + 7, (i / 20) * 32 + 7);
+		const core::rect<s32> icon((i % 4) * 16, (i / 4 % 4) * 16, (i % 4) * 16 + 16, (i / 4 % 4) * 16 + 16);
+		driver->draw2DImage(atlas, pos, icon, &clip, video::SColor(255, 255, 255, 255), true);
+	}
+	for (u32 i = 0; i < slots / 20; ++i) {
+		for (u32 j = 0; j < positions.size(); ++j)
+			positions[j].Y = 420 + i * 16;
+		driver->draw2DImageBatch(font, positions, glyphs, 0, video::SColor(255, 255, 255, 255), true);
+	}
+	driver->endScene();
+}
+
+static void testBatch2D(video::IVideoDriver *driver)
+{
+	video::IImage *image = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(64, 64));
+	image->fill(video::SColor(255, 128, 64, 32));
+	video::ITexture *atlas = driver->addTexture("atlas", image);
+	video::ITexture *font = driver->addTexture("font", image);
+	image->drop();
+
+	// quads of one kind are merged until the texture or blending changes
+	mockgl::clearFrames();
+	mockgl::clearCommands();
+	drawGUIFrame(driver, atlas, font, 200);
+	check(mockgl::getFrames().back().DrawCalls == 3, "GUI frame drawn in three batches");
+	check(driver->getFrameStats().DrawCalls == 3, "frame stats count the batches");
+	check(mockgl::countCommands(mockgl::Scissor) == 0, "clipped without the scissor test");
+
+	const core::rect<s32> clip(10, 10, 50, 50);
+	const video::SColor gradient[4] = {0xFFFFFFFF, 0xFF000000, 0xFFFFFFFF, 0xFF000000};
+	mockgl::clearFrames();
+	mockgl::clearCommands();
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	// nothing left after clipping
+	driver->draw2DImage(atlas, core::position2d<s32>(100, 100), core::rect<s32>(0, 0, 16, 16), &clip);
+	// gradients are clipped by the scissor test, lines are batched too
+	driver->draw2DImage(atlas, core::rect<s32>(0, 0, 64, 64), core::rect<s32>(0, 0, 64, 64), &clip, gradient);
+	driver->draw2DImage(atlas, core::rect<s32>(0, 0, 64, 64), core::rect<s32>(0, 0, 64, 64), &clip, gradient);
+	for (u32 i = 0; i < 10; ++i)
+		driver->draw2DLine(core::position2d<s32>(0, i), core::position2d<s32>(100, i));
+	driver->endScene();
+	check(mockgl::getFrames().back().DrawCalls == 2, "clipped images and lines batched");
+	check(mockgl::countCommands(mockgl::Scissor) == 1, "scissor test for gradients");
+
+	// queued 2D quads are drawn before 3D geometry
+	scene::SMeshBuffer *buffer = createGrid(2);
+	mockgl::clearCommands();
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	driver->draw2DRectangle(video::SColor(255, 255, 0, 0), core::rect<s32>(0, 0, 10, 10));
+	driver->setMaterial(video::SMaterial());
+	driver->drawMeshBuffer(buffer);
+	driver->endScene();
+	std::vector<mockgl::Function> draws;
+	for (const mockgl::Command &command : mockgl::getCommands())
+		if (command.Func == mockgl::DrawElements || command.Func == mockgl::DrawElementsBaseVertex ||
+				command.Func == mockgl::DrawRangeElements || command.Func == mockgl::DrawRangeElementsBaseVertex)
+			draws.push_back(command.Func);
+	check(draws.size() == 2 && (draws[0] == mockgl::DrawRangeElements || draws[0] == mockgl::DrawRangeElementsBaseVertex),
+			"2D drawn in order with 3D");
+	buffer->drop();
+
+	driver->removeTexture(atlas);
+	driver->removeTexture(font);
+}
+
+// lines of text, 100 glyphs each
+struct Text
+{
+	core::array<core::position2d<s32>> Positions;
+	core::array<core::rect<s32>> Glyphs;
+
+	Text(u32 glyphCount)
+	{
+		Positions.reallocate(glyphCount);
+		Glyphs.reallocate(glyphCount);
+		for (u32 i = 0; i < glyphCount; ++i) {
+			Positions.push_back(core::position2d<s32>(i % 100 * 8, i / 100 % 50 * 16));
+			Glyphs.push_back(core::rect<s32>((i % 8) * 8, (i / 8 % 4) * 16, (i % 8) * 8 + 8, (i / 8 % 4) * 16 + 16));
+		}
+	}
+
+	void draw(video::IVideoDriver *driver, video::ITexture *font, const core::rect<s32> *clip = 0) const
+	{
+		driver->draw2DImageBatch(font, Positions, Glyphs, clip, video::SColor(255, 255, 255, 255), true);
+	}
+};
+
+// the frame stats count what reaches GL, 2D and instanced draws included
+static void testDrawCallStats(video::IVideoDriver *driver)
+{
+	video::IImage *image = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(16, 16));
+	image->fill(video::SColor(255, 128, 64, 32));
+	video::ITexture *texture = driver->addTexture("stats", image);
+	image->drop();
+
+	scene::SMeshBuffer *buffer = createGrid(4);
+	buffer->setHardwareMappingHint(scene::EHM_STATIC);
+	video::SMaterial material;
+	core::matrix4 transforms[10];
+	core::array<video::SMeshBufferDraw> draws;
+	for (u32 i = 0; i < 10; ++i) {
+		transforms[i].setTranslation(core::vector3df((f32)i, 0.f, 0.f));
+		draws.push_back(video::SMeshBufferDraw(buffer, &material, &transforms[i]));
+	}
+
+	mockgl::clearFrames();
+	mockgl::clearCommands();
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	driver->drawMeshBufferList(draws.const_pointer(), draws.size());
+	driver->draw2DRectangle(video::SColor(255, 255, 0, 0), core::rect<s32>(0, 0, 10, 10));
+	driver->draw2DImage(texture, core::position2d<s32>(20, 20));
+	driver->draw2DLine(core::position2d<s32>(0, 0), core::position2d<s32>(100, 0));
+	driver->endScene();
+
+	check(mockgl::countCommands(mockgl::DrawElementsInstanced) == 1, "mesh buffers drawn instanced");
+	check(mockgl::getFrames().back().DrawCalls == driver->getFrameStats().DrawCalls,
+			"frame stats count 2D and instanced draws");
+
+	driver->removeHardwareBuffer(buffer);
+	buffer->drop();
+	driver->removeTexture(texture);
+}
+
+// index counts of the indexed draws in the command stream
+static std::vector<u32> getIndexCounts()
+{
+	std::vector<u32> counts;
+	for (const mockgl::Command &command : mockgl::getCommands())
+		if (command.Func == mockgl::DrawRangeElements || command.Func == mockgl::DrawRangeElementsBaseVertex)
+			counts.push_back(command.Args[3]);
+	return counts;
+}
+
+// large batches are split at the size of the quad index buffer
+static void testLongText(video::IVideoDriver *driver, bool indices32Bit)
+{
+	video::IImage *image = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(64, 64));
+	video::ITexture *font = driver->addTexture("font", image);
+	image->drop();
+
+	mockgl::clearCommands();
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	Text(20000).draw(driver, font);
+	driver->endScene();
+	std::vector<u32> counts = getIndexCounts();
+	if (indices32Bit) {
+		check(counts.size() == 1 && counts[0] == 20000 * 6, "long text drawn at once with 32 bit indices");
+	} else {
+		check(counts.size() == 2 && counts[0] + counts[1] == 20000 * 6 && counts[0] == 16384 * 6,
+				"long text split at the 16 bit index limit");
+	}
+
+	// the clipped away half of the glyphs isn't drawn
+	const core::rect<s32> clip(0, 0, 400, 800);
+	mockgl::clearCommands();
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	Text(1000).draw(driver, font, &clip);
+	driver->endScene();
+	counts = getIndexCounts();
+	check(counts.size() == 1 && counts[0] == 500 * 6, "clipped glyphs left out");
+
+	const core::rect<s32> outside(1000, 1000, 1100, 1100);
+	mockgl::clearCommands();
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	Text(1000).draw(driver, font, &outside);
+	driver->endScene();
+	check(getIndexCounts().empty(), "fully clipped text not drawn");
+
+	driver->removeTexture(font);
+}
+
+static void benchmark(video::IVideoDriver *driver)
+{
+	scene::SMeshBuffer *buffer = createGrid(32);
+	buffer->setHardwareMappingHint(scene::EHM_STATIC);
+
+	video::SMaterial material;
+	drawFrame(driver, buffer, material, 1);
+
+	const u32 frames = 200, draws = 500;
+	mockgl::clearFrames();
+	mockgl::clearCommands();
+	auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < frames; ++i) {
+		drawFrame(driver, buffer, material, draws);
+		mockgl::clearCommands();
+	}
+	const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	const mockgl::FrameCounters &last = mockgl::getFrames().back();
+	printf("%u frames of %u draws: %.0f ns CPU time per draw, %.1f GL calls, %.1f uniform uploads per draw, %u redundant state changes per frame\n",
+			frames, draws, ns / (frames * draws), (f32)last.Calls / draws, (f32)last.UniformUploads / draws,
+			last.RedundantStateChanges);
+
+	const u32 rectangles = 5000;
+	mockgl::clearFrames();
+	start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < frames / 10; ++i) {
+		drawClientFrame(driver, buffer, rectangles);
+		mockgl::clearCommands();
+	}
+	const double ns2D = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	printf("%u frames of %u rectangles: %.0f ns CPU time per rectangle, %.1f GL calls per rectangle\n",
+			frames / 10, rectangles, ns2D / (frames / 10 * rectangles), (f32)mockgl::getFrames().back().Calls / rectangles);
+
+	video::IImage *image = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(64, 64));
+	video::ITexture *atlas = driver->addTexture("atlas", image);
+	image->drop();
+	const u32 slots = 1000;
+	mockgl::clearFrames();
+	start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < frames; ++i) {
+		drawGUIFrame(driver, atlas, atlas, slots);
+		mockgl::clearCommands();
+	}
+	const double nsGUI = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	printf("%u GUI frames of %u slots: %.0f us CPU time per frame, %u draw calls, %u GL calls per frame\n",
+			frames, slots, nsGUI / frames / 1000, mockgl::getFrames().back().DrawCalls, mockgl::getFrames().back().Calls);
+
+	const u32 glyphs = 50000;
+	const Text text(glyphs);
+	mockgl::clearFrames();
+	start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < frames / 10; ++i) {
+		driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		text.draw(driver, atlas);
+		driver->endScene();
+		mockgl::clearCommands();
+	}
+	const double nsText = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	printf("%u frames of %u glyphs: %.1f ns CPU time per glyph, %u draw calls per frame\n",
+			frames / 10, glyphs, nsText / (frames / 10 * glyphs), mockgl::getFrames().back().DrawCalls);
+	driver->removeTexture(atlas);
+
+	driver->removeHardwareBuffer(buffer);
+	buffer->drop();
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_WARNING;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	bool bench = false;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark") == 0)
+			bench = true;
+		else
+			p.OGLES2ShaderPath = argv[i];
+	}
+
+	video::IVideoDriver *driver = createDriver(p, device->getFileSystem());
+	check(driver != 0, "driver initialized on the mock");
+	if (driver) {
+		check(mockgl::countCommands(mockgl::LinkProgram) > 0, "shaders linked");
+		testFrames(driver);
+		testStreaming(driver, false, false);
+		testStreamGrowth(driver);
+		testBatch2D(driver);
+		testDrawCallStats(driver);
+		testLongText(driver, false);
+		if (bench)
+			benchmark(driver);
+		driver->drop();
+	}
+
+	p.QuadIndices32Bit = true;
+	driver = createDriver(p, device->getFileSystem());
+	check(driver != 0, "driver initialized with 32 bit quad indices");
+	if (driver) {
+		testLongText(driver, true);
+		if (bench)
+			benchmark(driver);
+		driver->drop();
+	}
+	p.QuadIndices32Bit = false;
+
+	driver = createDriver(p, device->getFileSystem(), true);
+	check(driver != 0, "driver initialized with buffer storage");
+	if (driver) {
+		testFrames(driver);
+		testStreaming(driver, true, true);
+		testStreamGrowth(driver);
+		if (bench)
+			benchmark(driver);
+		driver->drop();
+	}
+	device->drop();
+
+	return testResult();
+}
@@ -0,0 +1,158 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+
+#include "test_check.h"
+
+using namespace irr;
+
+// Decodes several images and textures at once. Run with --benchmark to
+// compare with loading them one after another.
+
+static video::SColor expected(u32 seed, u32 x, u32 y)
+{
+	return video::SColor(255, (x * seed) & 255, (y + seed) & 255, (x ^ y) & 255);
+}
+
+// image i is (i + 1) * 4 pixels wide
+static void writeImages(video::IVideoDriver *driver, const char *pattern, u32 count, u32 height)
+{
+	for (u32 i = 0; i < count; ++i) {
+		const u32 width = (i + 1) * 4;
+		video::IImage *image = driver->createImage(video::ECF_R8G8B8, core::dimension2du(width, height));
+		for (u32 y = 0; y < height; ++y)
+			for (u32 x = 0; x < width; ++x)
+				image->setPixel(x, y, expected(i, x, y));
+
+		c8 name[64];
+		snprintf(name, sizeof(name), pattern, i);
+		driver->writeImageToFile(image, name);
+		image->drop();
+	}
+}
+
+static bool checkImage(video::IImage *image, u32 seed, u32 height)
+{
+	if (!image || image->getDimension() != core::dimension2du((seed + 1) * 4, height))
+		return false;
+
+	for (u32 y = 0; y < height; ++y)
+		for (u32 x = 0; x < image->getDimension().Width; ++x)
+			if (image->getPixel(x, y) != expected(seed, x, y))
+				return false;
+	return true;
+}
+
+static void testImages(video::IVideoDriver *driver)
+{
+	writeImages(driver, "image_batch_%u.png", 6, 16);
+
+	core::array<io::path> names;
+	for (u32 i = 0; i < 6; ++i) {
+		c8 name[64];
+		snprintf(name, sizeof(name), "image_batch_%u.png", i);
+		names.push_back(name);
+	}
+	names.push_back("image_batch_missing.png");
+
+	core::array<video::IImage *> images;
+	driver->createImagesFromFiles(names, images);
+	check(images.size() == 7, "one result per file");
+	for (u32 i = 0; i < 6; ++i)
+		check(checkImage(images[i], i, 16), "image decoded");
+	check(images[6] == 0, "missing file");
+
+	for (u32 i = 0; i < images.size(); ++i) {
+		if (images[i])
+			images[i]->drop();
+	}
+}
+
+static void testTextures(video::IVideoDriver *driver)
+{
+	const u32 before = driver->getTextureCount();
+
+	core::array<io::path> names;
+	names.push_back("image_batch_0.png");
+	names.push_back("image_batch_1.png");
+	names.push_back("image_batch_missing.png");
+	names.push_back("image_batch_0.png");
+
+	core::array<video::ITexture *> textures;
+	driver->getTextures(names, textures);
+	check(textures.size() == 4, "one texture per file");
+	check(textures[0] && textures[0]->getOriginalSize() == core::dimension2du(4, 16), "texture created");
+	check(textures[1] && textures[1]->getOriginalSize() == core::dimension2du(8, 16), "second texture created");
+	check(textures[2] == 0, "missing texture");
+	check(textures[3] == textures[0], "file listed twice");
+	check(driver->getTextureCount() == before + 2, "textures added to the cache");
+
+	// loaded textures come from the cache
+	names.push_back("image_batch_2.png");
+	core::array<video::ITexture *> again;
+	driver->getTextures(names, again);
+	check(again[0] == textures[0] && again[1] == textures[1] && again[4] != 0, "cached textures");
+	check(driver->getTexture("image_batch_2.png") == again[4], "same as getTexture");
+	check(driver->getTextureCount() == before + 3, "only the new texture added");
+
+	for (u32 i = 0; i < 6; ++i) {
+		c8 name[64];
+		snprintf(name, sizeof(name), "image_batch_%u.png", i);
+		remove(name);
+	}
+}
+
+static void benchmark(video::IVideoDriver *driver)
+{
+	const u32 count = 200;
+	writeImages(driver, "image_batch_benchmark_%u.png", count, 256);
+
+	core::array<io::path> names;
+	for (u32 i = 0; i < count; ++i) {
+		c8 name[64];
+		snprintf(name, sizeof(name), "image_batch_benchmark_%u.png", i);
+		names.push_back(name);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < count; ++i)
+		driver->createImageFromFile(names[i])->drop();
+	const double single = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	core::array<video::IImage *> images;
+	driver->createImagesFromFiles(names, images);
+	const double batch = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	for (u32 i = 0; i < count; ++i) {
+		images[i]->drop();
+		remove(names[i].c_str());
+	}
+
+	printf("%u PNG images: %.1f ms one after another, %.1f ms as a batch\n", count, single, batch);
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_NONE;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	video::IVideoDriver *driver = device->getVideoDriver();
+	testImages(driver);
+	testTextures(driver);
+
+	if (isBenchmark(argc, argv))
+		benchmark(driver);
+
+	device->drop();
+
+	return testResult();
+}
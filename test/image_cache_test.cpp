@@ -0,0 +1,224 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "test_check.h"
+
+using namespace irr;
+
+// Loads images through the decoded image cache and checks that changed
+// files are decoded again. Run with --benchmark to compare decoding with
+// loading from the cache.
+
+static const char *CACHE_DIR = "image_cache_test_dir";
+
+static video::SColor expected(u32 seed, u32 x, u32 y)
+{
+	return video::SColor(255, (x * seed) & 255, (y + seed) & 255, (x ^ (y * 3)) & 255);
+}
+
+static void writeImage(video::IVideoDriver *driver, const io::path &name, u32 seed, u32 size)
+{
+	video::IImage *image = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(size, size));
+	for (u32 y = 0; y < size; ++y)
+		for (u32 x = 0; x < size; ++x)
+			image->setPixel(x, y, expected(seed, x, y));
+	driver->writeImageToFile(image, name);
+	image->drop();
+}
+
+static bool checkImage(video::IImage *image, u32 seed, u32 size)
+{
+	if (!image || image->getDimension() != core::dimension2du(size, size))
+		return false;
+
+	for (u32 y = 0; y < size; ++y)
+		for (u32 x = 0; x < size; ++x)
+			if (image->getPixel(x, y) != expected(seed, x, y))
+				return false;
+	return true;
+}
+
+static bool loadAndCheck(video::IVideoDriver *driver, const io::path &name, u32 seed, u32 size)
+{
+	video::IImage *image = driver->createImageFromFile(name);
+	const bool ok = checkImage(image, seed, size);
+	if (image)
+		image->drop();
+	return ok;
+}
+
+// overwrites the pixels of a PNG, keeping its size and modification time
+static void damageFile(const char *name, bool keepTime)
+{
+	struct stat info;
+	stat(name, &info);
+
+	FILE *file = fopen(name, "r+b");
+	fseek(file, 64, SEEK_SET);
+	for (long i = 64; i < info.st_size; ++i)
+		fputc(0, file);
+	fclose(file);
+
+	if (keepTime) {
+		const timespec times[2] = {info.st_atim, info.st_mtim};
+		utimensat(AT_FDCWD, name, times, 0);
+	}
+}
+
+// moves the modification time of a file within its second
+static void touchWithinSecond(const char *name)
+{
+	struct stat info;
+	stat(name, &info);
+	timespec times[2] = {info.st_atim, info.st_mtim};
+	times[1].tv_nsec = times[1].tv_nsec < 500000000 ? times[1].tv_nsec + 1000 : times[1].tv_nsec - 1000;
+	utimensat(AT_FDCWD, name, times, 0);
+}
+
+static void testCache(video::IVideoDriver *driver, bool compress)
+{
+	const char *name = "image_cache_test.png";
+	writeImage(driver, name, 5, 32);
+
+	// the first time the image is decoded and stored
+	driver->setImageCache(CACHE_DIR, compress);
+	check(loadAndCheck(driver, name, 5, 32), "image decoded");
+
+	// the stored pixels are used while the file looks unchanged
+	damageFile(name, true);
+	check(loadAndCheck(driver, name, 5, 32), "image from the cache");
+
+	// a file changed within the same second is decoded again
+	touchWithinSecond(name);
+	video::IImage *image = driver->createImageFromFile(name);
+	check(!checkImage(image, 5, 32), "file changed within a second decoded again");
+	if (image)
+		image->drop();
+
+	// a new modification time means the file is decoded again
+	damageFile(name, false);
+	utimbuf times;
+	times.actime = times.modtime = time(0) + 10;
+	utime(name, &times);
+	image = driver->createImageFromFile(name);
+	check(!checkImage(image, 5, 32), "changed file decoded again");
+	if (image)
+		image->drop();
+
+	// without the cache the file is always decoded
+	writeImage(driver, name, 7, 32);
+	driver->setImageCache("");
+	check(loadAndCheck(driver, name, 7, 32), "cache disabled");
+
+	remove(name);
+}
+
+// textures are decoded to the upload format, images keep the format of the file
+static void testFormats(video::IVideoDriver *driver)
+{
+	const char *name = "image_cache_test_formats.png";
+	writeImage(driver, name, 9, 16);
+	driver->setImageCache(CACHE_DIR, false);
+
+	driver->setTextureCreationFlag(video::ETCF_NO_ALPHA_CHANNEL, true);
+	video::ITexture *texture = driver->getTexture(name);
+	check(texture != 0, "texture loaded");
+	driver->setTextureCreationFlag(video::ETCF_NO_ALPHA_CHANNEL, false);
+
+	for (u32 i = 0; i < 2; ++i) {
+		video::IImage *image = driver->createImageFromFile(name);
+		check(image && image->getColorFormat() == video::ECF_A8R8G8B8, "image not taken from the texture decode");
+		check(checkImage(image, 9, 16), "pixels of the image");
+		if (image)
+			image->drop();
+	}
+
+	driver->removeTexture(texture);
+	driver->setImageCache("");
+	remove(name);
+}
+
+// the cache files have generated names
+static void removeCache(io::IFileSystem *fs)
+{
+	const io::path working = fs->getWorkingDirectory();
+	fs->changeWorkingDirectoryTo(CACHE_DIR);
+	io::IFileList *list = fs->createFileList();
+	for (u32 i = 0; i < list->getFileCount(); ++i) {
+		if (!list->isDirectory(i))
+			remove(list->getFullFileName(i).c_str());
+	}
+	list->drop();
+	fs->changeWorkingDirectoryTo(working);
+	rmdir(CACHE_DIR);
+}
+
+static void benchmark(video::IVideoDriver *driver)
+{
+	const u32 count = 50;
+	core::array<io::path> names;
+	for (u32 i = 0; i < count; ++i) {
+		c8 name[64];
+		snprintf(name, sizeof(name), "image_cache_benchmark_%u.png", i);
+		writeImage(driver, name, i, 512);
+		names.push_back(name);
+	}
+
+	for (u32 compress = 0; compress < 2; ++compress) {
+		driver->setImageCache(CACHE_DIR, compress != 0);
+
+		double ms[2];
+		for (u32 pass = 0; pass < 2; ++pass) {
+			auto start = std::chrono::steady_clock::now();
+			for (u32 i = 0; i < count; ++i)
+				driver->createImageFromFile(names[i])->drop();
+			ms[pass] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+		printf("%u PNG images of 512x512%s: %.1f ms decoding and storing, %.1f ms from the cache\n",
+				count, compress ? ", compressed cache" : "", ms[0], ms[1]);
+
+		// the next round starts with an outdated cache
+		for (u32 i = 0; i < count; ++i) {
+			utimbuf times;
+			times.actime = times.modtime = time(0) + 100 + compress;
+			utime(names[i].c_str(), &times);
+		}
+	}
+
+	driver->setImageCache("");
+	for (u32 i = 0; i < count; ++i)
+		remove(names[i].c_str());
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_NONE;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	mkdir(CACHE_DIR, 0755);
+	video::IVideoDriver *driver = device->getVideoDriver();
+	testCache(driver, false);
+	testCache(driver, true);
+	testFormats(driver);
+
+	if (isBenchmark(argc, argv))
+		benchmark(driver);
+
+	removeCache(device->getFileSystem());
+	device->drop();
+
+	return testResult();
+}
@@ -110,11 +110,48 @@ void printImageBytes(const video::IImage *img)
 	}
 }
 
+// loads the image cut off before its end as a texture, which must fail
+static void testTruncated(const char *filename)
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_NONE;
+
+	auto *device = createDeviceEx(p);
+	if (!device)
+		throw std::runtime_error("Failed to create device");
+
+	io::IFileSystem *fs = device->getFileSystem();
+	io::IReadFile *file = fs->createAndOpenFile(filename);
+	if (!file)
+		throw std::runtime_error("Failed to open image");
+	std::vector<u8> data(file->getSize());
+	file->read(data.data(), data.size());
+	file->drop();
+
+	// cut off the checksum of the IEND chunk, so that all rows decode and
+	// only reading the end fails
+	if (data.size() <= 4)
+		throw std::runtime_error("Image too small");
+	io::IReadFile *truncated = fs->createMemoryReadFile(data.data(), data.size() - 4, filename);
+	video::ITexture *texture = device->getVideoDriver()->getTexture(truncated);
+	truncated->drop();
+	if (texture)
+		throw std::runtime_error("Truncated image loaded");
+
+	device->drop();
+}
+
 int main(int argc, char *argv[])
 try {
 	if (argc != 3)
 		throw std::runtime_error("Invalid arguments. Expected sample ID and image file name");
 
+	if (strcmp(argv[1], "truncated") == 0) {
+		testTruncated(argv[2]);
+		return 0;
+	}
+
 	const ImageDesc *sample = nullptr;
 	for (auto &&image : test_images) {
 		if (strcmp(argv[1], image.name) == 0)
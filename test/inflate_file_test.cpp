@@ -0,0 +1,185 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+
+#include "test_check.h"
+#include "zip_writer.h"
+
+using namespace irr;
+
+// Reads a large deflated zip entry in pieces and out of order. Run with
+// --benchmark to measure reading all entries of a large archive.
+
+static const u32 SIZE = 1024 * 1024 + 17;
+
+static u8 expected(u32 pos)
+{
+	return (u8)((pos * 7) ^ (pos >> 11));
+}
+
+static void writeArchive(io::IFileSystem *fs, const io::path &name)
+{
+	core::array<u8> data;
+	data.set_used(SIZE);
+	for (u32 i = 0; i < SIZE; ++i)
+		data[i] = expected(i);
+
+	core::array<u8> zip;
+	zipwriter::addDeflatedEntry(zip, "data.bin", data);
+	zipwriter::endArchive(zip);
+	zipwriter::writeFile(fs, name, zip);
+}
+
+static bool compare(const u8 *data, u32 pos, u32 size)
+{
+	for (u32 i = 0; i < size; ++i) {
+		if (data[i] != expected(pos + i))
+			return false;
+	}
+	return true;
+}
+
+static void testEntry(io::IReadFile *file)
+{
+	check(file->getType() == io::ERFT_INFLATE_READ_FILE, "entry is inflated while reading");
+	check(file->getSize() == SIZE, "size");
+
+	core::array<u8> buffer;
+	buffer.set_used(SIZE);
+	u8 *data = buffer.pointer();
+
+	check(file->read(data, 16) == 16 && compare(data, 0, 16), "header");
+
+	// forward seeks skip data without returning it
+	check(file->seek(300000) && file->read(data, 1000) == 1000 && compare(data, 300000, 1000), "seek forward");
+	check(file->seek(-3000, true) && file->read(data, 100) == 100 && compare(data, 298000, 100), "seek back within the window");
+
+	// a large read goes straight into the destination
+	check(file->read(data, 200000) == 200000 && compare(data, 298100, 200000), "large read");
+	check(file->seek(-1000, true) && file->read(data, 10) == 10 && compare(data, 497100, 10), "seek back after a large read");
+
+	check(file->seek(SIZE - 10) && file->read(data, 100) == 10 && compare(data, SIZE - 10, 10), "read stops at the end");
+	check(file->read(data, 100) == 0, "nothing left");
+	check(!file->seek(SIZE + 1), "seek past the end fails");
+
+	// seeking back further inflates everything
+	check(file->seek(5) && file->read(data, 20) == 20 && compare(data, 5, 20), "seek back to the start");
+	check(file->seek(0) && file->read(data, SIZE) == SIZE && compare(data, 0, SIZE), "read everything");
+}
+
+// reads every entry of an archive with 32 large and 1024 small files
+static void benchmark(io::IFileSystem *fs)
+{
+	const u32 largeCount = 32;
+	const u32 largeSize = 2 * 1024 * 1024;
+	const u32 smallCount = 1024;
+	const u32 smallSize = 32 * 1024;
+
+	// text like data, which deflates to about a half
+	core::array<u8> data;
+	data.set_used(largeSize);
+	u32 random = 1;
+	for (u32 i = 0; i < largeSize; ++i) {
+		random = random * 1103515245 + 12345;
+		data[i] = (u8)"etaoin shrdlu\n"[(random >> 16) % 14];
+	}
+
+	core::array<u8> zip;
+	core::array<u8> small;
+	c8 name[32];
+	for (u32 i = 0; i < largeCount; ++i) {
+		snprintf(name, sizeof(name), "large%02u.bin", i);
+		data[0] = (u8)i;
+		zipwriter::addDeflatedEntry(zip, name, data);
+	}
+	for (u32 i = 0; i < smallCount; ++i) {
+		snprintf(name, sizeof(name), "small%04u.bin", i);
+		small.set_used(0);
+		for (u32 j = 0; j < smallSize; ++j)
+			small.push_back(data[(i * 977 + j) % largeSize]);
+		zipwriter::addDeflatedEntry(zip, name, small);
+	}
+	zipwriter::endArchive(zip);
+	zipwriter::writeFile(fs, "inflate_file_benchmark.zip", zip);
+	fs->addFileArchive("inflate_file_benchmark.zip", true, true, io::EFAT_ZIP);
+	const io::IFileList *list = fs->getFileArchive(0)->getFileList();
+
+	const u32 rounds = 3;
+	double whole = 0;
+	double pieces = 0;
+	for (u32 r = 0; r < rounds; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		for (u32 i = 0; i < list->getFileCount(); ++i) {
+			io::IReadFile *file = fs->createAndOpenFile(list->getFullFileName(i));
+			file->read(data.pointer(), file->getSize());
+			file->drop();
+		}
+		whole += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		for (u32 i = 0; i < list->getFileCount(); ++i) {
+			io::IReadFile *file = fs->createAndOpenFile(list->getFullFileName(i));
+			while (file->read(data.pointer(), 16 * 1024) == 16 * 1024) {
+			}
+			file->drop();
+		}
+		pieces += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	const u32 total = largeCount * largeSize + smallCount * smallSize;
+	printf("%u entries, %u bytes deflated to %u: %.1f ms reading each at once, %.1f ms in 16 KB pieces\n",
+			list->getFileCount(), total, zip.size(), whole / rounds, pieces / rounds);
+
+	fs->removeFileArchive((u32)0);
+	remove("inflate_file_benchmark.zip");
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_ERROR;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	io::IFileSystem *fs = device->getFileSystem();
+	writeArchive(fs, "inflate_file_test.zip");
+
+	// archive mapped into memory
+	check(fs->addFileArchive("inflate_file_test.zip", true, true, io::EFAT_ZIP), "archive added");
+	io::IReadFile *entry = fs->createAndOpenFile("data.bin");
+	check(entry != 0, "entry opened");
+	if (entry) {
+		testEntry(entry);
+		entry->drop();
+	}
+	fs->removeFileArchive((u32)0);
+
+	// archive only accessible through read(), which reads the input in chunks
+	io::IReadFile *zip = fs->createAndOpenFile("inflate_file_test.zip");
+	io::IReadFile *limited = fs->createLimitReadFile("inflate_file_test.zip", zip, 0, zip->getSize());
+	zip->drop();
+	check(fs->addFileArchive(limited, true, true, io::EFAT_ZIP), "archive added from a file");
+	limited->drop();
+	entry = fs->createAndOpenFile("data.bin");
+	check(entry != 0, "entry opened from a file");
+	if (entry) {
+		testEntry(entry);
+		entry->drop();
+	}
+
+	fs->removeFileArchive((u32)0);
+	remove("inflate_file_test.zip");
+
+	if (isBenchmark(argc, argv))
+		benchmark(fs);
+
+	device->drop();
+
+	return testResult();
+}
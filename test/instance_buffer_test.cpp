@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <irrlicht.h>
+
+#include "OpenGL/InstanceBuffer.h"
+#include "mock_gl.h"
+#include "test_check.h"
+
+using namespace irr;
+using video::COpenGL3InstanceBuffer;
+using video::SMeshBufferDraw;
+
+// Checks how the OpenGL 3 driver groups draws into instanced ones and how it
+// streams their matrices, against the recording mock GL
+
+// the first command of a kind since the last clearCommands()
+static const mockgl::Command *findCommand(mockgl::Function function, std::vector<mockgl::Command> &commands)
+{
+	commands = mockgl::getCommands();
+	for (const mockgl::Command &command : commands)
+		if (command.Func == function)
+			return &command;
+	return 0;
+}
+
+// Splits a draw list the way the driver does and returns the run lengths
+static std::vector<u32> splitRuns(const std::vector<SMeshBufferDraw> &draws)
+{
+	std::vector<u32> runs;
+	for (u32 i = 0; i < draws.size();) {
+		const u32 run = COpenGL3InstanceBuffer::getInstanceRun(&draws[i], draws.size() - i);
+		runs.push_back(run);
+		i += run;
+	}
+	return runs;
+}
+
+static void testBatching()
+{
+	scene::SMeshBuffer box, other, points;
+	box.Indices.push_back(0);
+	other.Indices.push_back(0);
+	points.Indices.push_back(0);
+	points.setPrimitiveType(scene::EPT_POINTS);
+
+	video::SMaterial solid, solidCopy, wireframe, custom;
+	wireframe.Wireframe = true;
+	custom.MaterialType = (video::E_MATERIAL_TYPE)(video::EMT_ONETEXTURE_BLEND + 1);
+
+	core::matrix4 world;
+
+	// equal materials in different objects are merged as well
+	std::vector<SMeshBufferDraw> draws = {
+			{&box, &solid, &world},
+			{&box, &solid, &world},
+			{&box, &solidCopy, &world},
+			{&other, &solid, &world},
+			{&box, &wireframe, &world},
+			{&box, &wireframe, &world},
+			{&box, &solid, &world},
+		};
+	check(splitRuns(draws) == std::vector<u32>({3, 1, 2, 1}), "runs of same buffer and material");
+
+	// custom shaders and point lists are drawn one by one
+	draws = {
+			{&box, &custom, &world},
+			{&box, &custom, &world},
+			{&points, &solid, &world},
+			{&points, &solid, &world},
+		};
+	check(splitRuns(draws) == std::vector<u32>({1, 1, 1, 1}), "draws which can't be instanced");
+
+	scene::SMeshBuffer unindexed;
+	check(!COpenGL3InstanceBuffer::canDrawInstanced({&unindexed, &solid, &world}), "buffer without indices");
+}
+
+static void testStreaming()
+{
+	mockgl::clearCommands();
+
+	video::SMaterial material;
+	scene::SMeshBuffer mb;
+	std::vector<core::matrix4> worlds(3);
+	for (u32 i = 0; i < worlds.size(); ++i)
+		worlds[i].setTranslation(core::vector3df((f32)i, 2.f, 3.f));
+
+	std::vector<SMeshBufferDraw> draws;
+	for (const core::matrix4 &world : worlds)
+		draws.push_back({&mb, &material, &world});
+
+	std::vector<mockgl::Command> commands;
+	{
+		COpenGL3InstanceBuffer buffer;
+		buffer.bind(draws.data(), draws.size());
+
+		check(mockgl::countCommands(mockgl::GenBuffers) == 1, "buffer created once");
+		check(mockgl::countCommands(mockgl::BufferData) == 1, "storage allocated");
+		check(mockgl::countCommands(mockgl::BufferSubData) == 1, "matrices uploaded at once");
+		check(mockgl::countCommands(mockgl::VertexAttribDivisor) == 4, "four attributes per instance");
+
+		const mockgl::Command *bind = findCommand(mockgl::BindBuffer, commands);
+		const u32 name = bind ? bind->Args[1] : 0;
+		for (const mockgl::Command &command : commands) {
+			if (command.Func == mockgl::BufferSubData) {
+				check(command.Args[1] == 0 && command.Args[2] == 3 * 64, "upload range");
+				const f32 *data = reinterpret_cast<const f32 *>(mockgl::getBufferData(name).data());
+				check(data[16 + 12] == 1.f && data[32 + 12] == 2.f, "matrix data");
+			} else if (command.Func == mockgl::VertexAttribPointer) {
+				// index, size, type, normalized, stride, pointer
+				const u32 column = command.Args[0] - COpenGL3InstanceBuffer::FirstAttribute;
+				check(column < 4 && command.Args[5] == column * 16 && command.Args[4] == 64, "column layout");
+			} else if (command.Func == mockgl::VertexAttribDivisor) {
+				check(command.Args[1] == 1, "divisor of one");
+			}
+		}
+		check(commands.back().Func == mockgl::BindBuffer && commands.back().Args[1] == 0, "array buffer unbound");
+
+		mockgl::clearCommands();
+		buffer.unbind();
+		check(mockgl::countCommands(mockgl::DisableVertexAttribArray) == 4, "attributes disabled");
+		check(mockgl::countCommands(mockgl::VertexAttribDivisor) == 4, "divisors reset");
+
+		// the next batch goes behind the first one in the same storage
+		mockgl::clearCommands();
+		buffer.bind(draws.data(), 2);
+		check(mockgl::countCommands(mockgl::GenBuffers) == 0 && mockgl::countCommands(mockgl::BufferData) == 0, "buffer reused");
+		const mockgl::Command *upload = findCommand(mockgl::BufferSubData, commands);
+		check(upload && upload->Args[1] == 3 * 64, "streamed behind previous batch");
+
+		// a batch which doesn't fit anymore orphans the storage
+		std::vector<SMeshBufferDraw> many(1024, draws[0]);
+		mockgl::clearCommands();
+		buffer.bind(many.data(), many.size());
+		upload = findCommand(mockgl::BufferSubData, commands);
+		check(mockgl::countCommands(mockgl::BufferData) == 1 && upload && upload->Args[1] == 0, "storage orphaned when full");
+
+		mockgl::clearCommands();
+	}
+	check(mockgl::countCommands(mockgl::DeleteBuffers) == 1, "buffer deleted");
+}
+
+int main(int argc, char *argv[])
+{
+	video::IContextManager *contextManager = new mockgl::HeadlessContextManager(false);
+	GL.LoadAllProcedures(contextManager);
+	contextManager->drop();
+
+	testBatching();
+	testStreaming();
+
+	return testResult();
+}
@@ -0,0 +1,151 @@
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <irrlicht.h>
+#include <IMemoryReadFile.h>
+
+#include "test_check.h"
+#include "zip_writer.h"
+
+using namespace irr;
+
+// Reads files and archive entries through memory mapped files
+
+static const char obj[] =
+		"v 0 0 0\n"
+		"v 1 0 0\n"
+		"v 0 1 0\n"
+		"f 1 2 3";
+
+static const char text[] = "deflated with a single stored block";
+
+// an archive with the obj file stored and the text deflated
+static void writeArchive(io::IFileSystem *fs, const io::path &name)
+{
+	core::array<u8> zip;
+	zipwriter::addStoredEntry(zip, "tri.obj", obj, sizeof(obj) - 1);
+
+	const u16 textSize = sizeof(text) - 1;
+	zipwriter::putLocalHeader(zip, "text.txt", 8, textSize + 5, textSize);
+	zip.push_back(1); // final block, stored
+	zipwriter::put16(zip, textSize);
+	zipwriter::put16(zip, ~textSize);
+	for (u32 i = 0; i < textSize; ++i)
+		zip.push_back(text[i]);
+
+	zipwriter::endArchive(zip);
+	zipwriter::writeFile(fs, name, zip);
+}
+
+static void testFile(io::IFileSystem *fs)
+{
+	io::IWriteFile *out = fs->createAndWriteFile("mapped_file_test.obj");
+	out->write(obj, sizeof(obj) - 1);
+	out->drop();
+
+	io::IReadFile *file = fs->createAndOpenFile("mapped_file_test.obj");
+	check(file && file->getType() == io::ERFT_MAPPED_READ_FILE, "file on disk is mapped");
+	if (!file)
+		return;
+
+	const c8 *buffer = static_cast<const c8 *>(static_cast<io::IMemoryReadFile *>(file)->getBuffer());
+	check(file->getSize() == sizeof(obj) - 1, "size");
+	check(memcmp(buffer, obj, sizeof(obj) - 1) == 0, "buffer content");
+	check(buffer[sizeof(obj) - 1] == 0, "zero after the mapping");
+
+	c8 word[8] = {};
+	check(file->seek(8) && file->read(word, 7) == 7 && strcmp(word, "v 1 0 0") == 0, "seek and read");
+	check(file->seek(-2, true) && file->getPos() == 13, "relative seek");
+	check(!file->seek(file->getSize() + 1), "seek past the end fails");
+	check(file->seek(file->getSize() - 2) && file->read(word, 8) == 2, "read stops at the end");
+	file->drop();
+
+	check(fs->createAndOpenFile("mapped_file_test.missing") == 0, "missing file");
+}
+
+static void testArchive(scene::ISceneManager *smgr, io::IFileSystem *fs)
+{
+	writeArchive(fs, "mapped_file_test.zip");
+	check(fs->addFileArchive("mapped_file_test.zip", true, true, io::EFAT_ZIP), "archive added");
+
+	io::IReadFile *stored = fs->createAndOpenFile("tri.obj");
+	check(stored && stored->getType() == io::ERFT_MAPPED_READ_FILE, "stored entry is a view");
+	if (stored) {
+		check(stored->getSize() == sizeof(obj) - 1, "stored entry size");
+		check(memcmp(static_cast<io::IMemoryReadFile *>(stored)->getBuffer(), obj, sizeof(obj) - 1) == 0, "stored entry content");
+	}
+
+	io::IReadFile *deflated = fs->createAndOpenFile("text.txt");
+	check(deflated != 0, "deflated entry");
+	if (deflated) {
+		c8 buffer[sizeof(text)] = {};
+		check(deflated->read(buffer, sizeof(text)) == sizeof(text) - 1 && strcmp(buffer, text) == 0, "deflated entry content");
+		deflated->drop();
+	}
+
+	io::IReadFile *meshFile = fs->createAndOpenFile("tri.obj");
+	scene::IAnimatedMesh *mesh = meshFile ? smgr->getMesh(meshFile) : 0;
+	check(mesh && mesh->getMesh(0)->getMeshBuffer(0)->getVertexCount() == 3, "mesh loaded from the view");
+	if (meshFile)
+		meshFile->drop();
+
+	// the view keeps the mapping alive when the archive is gone
+	check(fs->removeFileArchive((u32)0), "archive removed");
+	if (stored) {
+		c8 buffer[sizeof(obj)] = {};
+		check(stored->read(buffer, sizeof(obj)) == sizeof(obj) - 1 && strcmp(buffer, obj) == 0, "view outlives the archive");
+		stored->drop();
+	}
+}
+
+// memory files are parsed in place, so the parser must not look past the
+// end of the buffer, which here is followed by an unreadable page
+static void testMemoryEnd(scene::ISceneManager *smgr, io::IFileSystem *fs)
+{
+	const char ending[] = "\nv";
+	const size_t size = sizeof(obj) - 1 + sizeof(ending) - 1;
+	const size_t page = sysconf(_SC_PAGESIZE);
+	u8 *pages = static_cast<u8 *>(mmap(0, page * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (pages == MAP_FAILED || mprotect(pages + page, page, PROT_NONE) != 0) {
+		check(false, "guard page mapped");
+		return;
+	}
+
+	c8 *data = reinterpret_cast<c8 *>(pages + page - size);
+	memcpy(data, obj, sizeof(obj) - 1);
+	memcpy(data + sizeof(obj) - 1, ending, sizeof(ending) - 1);
+
+	io::IReadFile *file = fs->createMemoryReadFile(data, size, "memory_end.obj");
+	scene::IAnimatedMesh *mesh = smgr->getMesh(file);
+	check(mesh && mesh->getMesh(0)->getMeshBuffer(0)->getVertexCount() == 3, "mesh ending in a single character loaded");
+	file->drop();
+	if (mesh)
+		smgr->getMeshCache()->removeMesh(mesh);
+
+	munmap(pages, page * 2);
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_ERROR;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	io::IFileSystem *fs = device->getFileSystem();
+	testFile(fs);
+	testArchive(device->getSceneManager(), fs);
+	testMemoryEnd(device->getSceneManager(), fs);
+
+	device->drop();
+	remove("mapped_file_test.obj");
+	remove("mapped_file_test.zip");
+
+	return testResult();
+}
@@ -0,0 +1,1034 @@
+// the GL constants come first, as in the drivers
+#include "vendor/gl.h"
+
+#include "mock_gl.h"
+
+#include <cstring>
+#include <map>
+#include <regex>
+#include <string>
+#include <type_traits>
+
+namespace mockgl
+{
+
+struct Shader
+{
+	std::string Source;
+};
+
+struct Uniform
+{
+	std::string Name;
+	GLenum Type;
+	GLint Size;
+};
+
+struct Program
+{
+	std::vector<GLuint> Shaders;
+	std::vector<Uniform> Uniforms;
+};
+
+// vertex attributes, and whether they read client memory
+struct VertexArray
+{
+	std::map<GLuint, bool> EnabledAttribs;
+	std::map<GLuint, bool> ClientAttribs;
+	GLuint ElementBuffer = 0;
+};
+
+static struct
+{
+	bool ES = true;
+	std::string Version;
+	std::vector<std::string> Extensions;
+	std::string ExtensionString;
+
+	std::vector<u32> Stream;
+	FrameCounters Frame;
+	std::vector<FrameCounters> Frames;
+
+	GLuint NextName = 1;
+	// deleted buffer names, handed out again like drivers do
+	std::vector<GLuint> FreeBuffers;
+	std::map<GLuint, Shader> Shaders;
+	std::map<GLuint, Program> Programs;
+
+	// hashes of the values of the pipeline state, see changeState()
+	std::map<u64, u64> Values;
+	std::map<u64, u64> UniformValues;
+
+	GLuint ActiveUnit = 0;
+	GLuint CurrentProgram = 0;
+	std::map<GLenum, GLuint> Buffers;
+	// contents of the buffer objects
+	std::map<GLuint, std::vector<u8>> Storage;
+	std::map<u64, GLuint> Textures;
+	// vertex array 0 stands for the default state
+	std::map<GLuint, VertexArray> VertexArrays;
+	GLuint CurrentVertexArray = 0;
+} State;
+
+static const char *FunctionNames[FunctionCount] = {
+#define MOCKGL_NAME(name) #name,
+		MOCKGL_FUNCTIONS(MOCKGL_NAME)
+#undef MOCKGL_NAME
+};
+
+const char *getFunctionName(Function function)
+{
+	return function < FunctionCount ? FunctionNames[function] : "";
+}
+
+static u32 word(f32 value)
+{
+	u32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static u32 word(const void *pointer)
+{
+	return (u32)(uintptr_t)pointer;
+}
+
+static void record(Function function, std::initializer_list<u32> args)
+{
+	State.Stream.push_back((function << 8) | (u32)args.size());
+	State.Stream.insert(State.Stream.end(), args);
+	++State.Frame.Calls;
+}
+
+static u64 hashWords(std::initializer_list<u32> words)
+{
+	u64 hash = 14695981039346656037ull;
+	for (u32 w : words) {
+		hash ^= w;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// Sets the state identified by the function and the selector, e.g. the
+// capability of Enable(), and counts whether it had that value already
+static void changeState(Function function, u64 selector, std::initializer_list<u32> value)
+{
+	const u64 key = ((u64)function << 48) ^ selector;
+	const u64 hash = hashWords(value);
+
+	auto it = State.Values.find(key);
+	if (it != State.Values.end() && it->second == hash)
+		++State.Frame.RedundantStateChanges;
+	++State.Frame.StateChanges;
+	State.Values[key] = hash;
+}
+
+// selector of state kept per vertex array
+static u64 vertexArraySelector(u32 selector)
+{
+	return ((u64)State.CurrentVertexArray << 32) | selector;
+}
+
+static void uploadUniform(GLint location, GLsizei count, const void *data, u32 size)
+{
+	++State.Frame.UniformUploads;
+
+	const u64 key = ((u64)State.CurrentProgram << 32) | (u32)location;
+	u64 hash = 14695981039346656037ull;
+	const u8 *bytes = (const u8 *)data;
+	for (u32 i = 0; i < size * count; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	auto it = State.UniformValues.find(key);
+	if (it != State.UniformValues.end() && it->second == hash)
+		++State.Frame.RedundantUniformUploads;
+	State.UniformValues[key] = hash;
+}
+
+static void draw(bool indexed)
+{
+	++State.Frame.DrawCalls;
+
+	VertexArray &vertexArray = State.VertexArrays[State.CurrentVertexArray];
+	bool client = indexed && !vertexArray.ElementBuffer;
+	for (const auto &attrib : vertexArray.EnabledAttribs)
+		client |= attrib.second && vertexArray.ClientAttribs[attrib.first];
+	if (client)
+		++State.Frame.ClientDraws;
+}
+
+static u32 getPixelSize(GLenum format, GLenum type)
+{
+	u32 components = 4;
+	switch (format) {
+	case GL_RED:
+	case GL_DEPTH_COMPONENT:
+		components = 1;
+		break;
+	case GL_RG:
+		components = 2;
+		break;
+	case GL_RGB:
+		components = 3;
+		break;
+	default:
+		break;
+	}
+
+	switch (type) {
+	case GL_UNSIGNED_SHORT_5_6_5:
+	case GL_UNSIGNED_SHORT_5_5_5_1:
+	case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+		return 2;
+	case GL_UNSIGNED_INT_8_8_8_8_REV:
+	case GL_UNSIGNED_INT_24_8:
+		return 4;
+	case GL_UNSIGNED_SHORT:
+	case GL_HALF_FLOAT:
+		return components * 2;
+	case GL_UNSIGNED_INT:
+	case GL_FLOAT:
+		return components * 4;
+	default:
+		return components;
+	}
+}
+
+static GLuint newName()
+{
+	return State.NextName++;
+}
+
+// the most recently deleted buffer name first
+static GLuint newBufferName()
+{
+	if (State.FreeBuffers.empty())
+		return newName();
+	const GLuint name = State.FreeBuffers.back();
+	State.FreeBuffers.pop_back();
+	return name;
+}
+
+// Every function records its call, most of them keep no other state
+
+static void APIENTRY mockActiveTexture(GLenum texture)
+{
+	record(ActiveTexture, {texture});
+	changeState(ActiveTexture, 0, {texture});
+	State.ActiveUnit = texture - GL_TEXTURE0;
+}
+
+static void APIENTRY mockAttachShader(GLuint program, GLuint shader)
+{
+	record(AttachShader, {program, shader});
+	State.Programs[program].Shaders.push_back(shader);
+}
+
+static void APIENTRY mockBindAttribLocation(GLuint program, GLuint index, const GLchar *name)
+{
+	record(BindAttribLocation, {program, index});
+}
+
+static void APIENTRY mockBindBuffer(GLenum target, GLuint buffer)
+{
+	record(BindBuffer, {target, buffer});
+	if (target == GL_ELEMENT_ARRAY_BUFFER) {
+		changeState(BindBuffer, vertexArraySelector(target), {buffer});
+		State.VertexArrays[State.CurrentVertexArray].ElementBuffer = buffer;
+	} else {
+		changeState(BindBuffer, target, {buffer});
+	}
+	State.Buffers[target] = buffer;
+}
+
+static void APIENTRY mockBindVertexArray(GLuint array)
+{
+	record(BindVertexArray, {array});
+	changeState(BindVertexArray, 0, {array});
+	State.CurrentVertexArray = array;
+	State.Buffers[GL_ELEMENT_ARRAY_BUFFER] = State.VertexArrays[array].ElementBuffer;
+}
+
+static void APIENTRY mockBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	record(BindFramebuffer, {target, framebuffer});
+	changeState(BindFramebuffer, target, {framebuffer});
+}
+
+static void APIENTRY mockBindTexture(GLenum target, GLuint texture)
+{
+	record(BindTexture, {target, texture});
+	const u64 unit = ((u64)State.ActiveUnit << 32) | target;
+	changeState(BindTexture, unit, {texture});
+	State.Textures[unit] = texture;
+}
+
+static void APIENTRY mockBlendEquation(GLenum mode)
+{
+	record(BlendEquation, {mode});
+	changeState(BlendEquation, 0, {mode});
+}
+
+static void APIENTRY mockBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	record(BlendFunc, {sfactor, dfactor});
+	changeState(BlendFuncSeparate, 0, {sfactor, dfactor, sfactor, dfactor});
+}
+
+static void APIENTRY mockBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha)
+{
+	record(BlendFuncSeparate, {sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha});
+	changeState(BlendFuncSeparate, 0, {sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha});
+}
+
+static void APIENTRY mockBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+	record(BufferData, {target, (u32)size, word(data), usage});
+	std::vector<u8> &storage = State.Storage[State.Buffers[target]];
+	storage.assign(size, 0);
+	if (data) {
+		memcpy(storage.data(), data, size);
+		State.Frame.BufferBytes += size;
+	}
+}
+
+static void APIENTRY mockBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
+{
+	record(BufferStorage, {target, (u32)size, word(data), flags});
+	std::vector<u8> &storage = State.Storage[State.Buffers[target]];
+	storage.assign(size, 0);
+	if (data) {
+		memcpy(storage.data(), data, size);
+		State.Frame.BufferBytes += size;
+	}
+}
+
+static void APIENTRY mockBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+	record(BufferSubData, {target, (u32)offset, (u32)size, word(data)});
+	std::vector<u8> &storage = State.Storage[State.Buffers[target]];
+	if ((size_t)(offset + size) <= storage.size())
+		memcpy(storage.data() + offset, data, size);
+	State.Frame.BufferBytes += size;
+}
+
+static GLenum APIENTRY mockCheckFramebufferStatus(GLenum target)
+{
+	record(CheckFramebufferStatus, {target});
+	return GL_FRAMEBUFFER_COMPLETE;
+}
+
+static void APIENTRY mockClear(GLbitfield mask)
+{
+	record(Clear, {mask});
+}
+
+static void APIENTRY mockClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	record(ClearColor, {word(red), word(green), word(blue), word(alpha)});
+	changeState(ClearColor, 0, {word(red), word(green), word(blue), word(alpha)});
+}
+
+static void APIENTRY mockClearDepthf(GLfloat d)
+{
+	record(ClearDepthf, {word(d)});
+	changeState(ClearDepthf, 0, {word(d)});
+}
+
+static void APIENTRY mockClearStencil(GLint s)
+{
+	record(ClearStencil, {(u32)s});
+	changeState(ClearStencil, 0, {(u32)s});
+}
+
+static GLenum APIENTRY mockClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+	record(ClientWaitSync, {word(sync), flags});
+	return GL_ALREADY_SIGNALED;
+}
+
+static void APIENTRY mockColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+	record(ColorMask, {red, green, blue, alpha});
+	changeState(ColorMask, 0, {red, green, blue, alpha});
+}
+
+static void APIENTRY mockCompileShader(GLuint shader)
+{
+	record(CompileShader, {shader});
+}
+
+static GLuint APIENTRY mockCreateProgram()
+{
+	const GLuint name = newName();
+	record(CreateProgram, {name});
+	State.Programs[name] = Program();
+	return name;
+}
+
+static GLuint APIENTRY mockCreateShader(GLenum type)
+{
+	const GLuint name = newName();
+	record(CreateShader, {type, name});
+	State.Shaders[name] = Shader();
+	return name;
+}
+
+static void APIENTRY mockCullFace(GLenum mode)
+{
+	record(CullFace, {mode});
+	changeState(CullFace, 0, {mode});
+}
+
+static void APIENTRY mockDebugMessageCallback(GLDEBUGPROC callback, const void *userParam)
+{
+	record(DebugMessageCallback, {});
+}
+
+static void APIENTRY mockDeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+	record(DeleteBuffers, {(u32)n, n ? buffers[0] : 0});
+	for (GLsizei i = 0; i < n; ++i) {
+		State.Storage.erase(buffers[i]);
+		if (buffers[i])
+			State.FreeBuffers.push_back(buffers[i]);
+	}
+}
+
+static void APIENTRY mockDeleteVertexArrays(GLsizei n, const GLuint *arrays)
+{
+	record(DeleteVertexArrays, {(u32)n, n ? arrays[0] : 0});
+	for (GLsizei i = 0; i < n; ++i) {
+		State.VertexArrays.erase(arrays[i]);
+		if (arrays[i] == State.CurrentVertexArray)
+			mockBindVertexArray(0);
+	}
+}
+
+static void APIENTRY mockDeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
+{
+	record(DeleteFramebuffers, {(u32)n, n ? framebuffers[0] : 0});
+}
+
+static void APIENTRY mockDeleteProgram(GLuint program)
+{
+	record(DeleteProgram, {program});
+	State.Programs.erase(program);
+}
+
+static void APIENTRY mockDeleteShader(GLuint shader)
+{
+	record(DeleteShader, {shader});
+	State.Shaders.erase(shader);
+}
+
+static void APIENTRY mockDeleteSync(GLsync sync)
+{
+	record(DeleteSync, {word(sync)});
+}
+
+static void APIENTRY mockDeleteTextures(GLsizei n, const GLuint *textures)
+{
+	record(DeleteTextures, {(u32)n, n ? textures[0] : 0});
+}
+
+static void APIENTRY mockDepthFunc(GLenum func)
+{
+	record(DepthFunc, {func});
+	changeState(DepthFunc, 0, {func});
+}
+
+static void APIENTRY mockDepthMask(GLboolean flag)
+{
+	record(DepthMask, {flag});
+	changeState(DepthMask, 0, {flag});
+}
+
+static void APIENTRY mockDisable(GLenum cap)
+{
+	record(Disable, {cap});
+	changeState(Enable, cap, {0});
+}
+
+static void APIENTRY mockDisableVertexAttribArray(GLuint index)
+{
+	record(DisableVertexAttribArray, {index});
+	changeState(EnableVertexAttribArray, vertexArraySelector(index), {0});
+	State.VertexArrays[State.CurrentVertexArray].EnabledAttribs[index] = false;
+}
+
+static void APIENTRY mockDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	record(DrawArrays, {mode, (u32)first, (u32)count});
+	draw(false);
+}
+
+static void APIENTRY mockDrawBuffer(GLenum buf)
+{
+	record(DrawBuffer, {buf});
+	changeState(DrawBuffers, 0, {1, buf});
+}
+
+static void APIENTRY mockDrawBuffers(GLsizei n, const GLenum *bufs)
+{
+	record(DrawBuffers, {(u32)n, n ? bufs[0] : 0});
+	changeState(DrawBuffers, 0, {(u32)n, n ? bufs[0] : 0});
+}
+
+static void APIENTRY mockDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+	record(DrawElements, {mode, (u32)count, type, word(indices)});
+	draw(true);
+}
+
+static void APIENTRY mockDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices, GLint basevertex)
+{
+	record(DrawElementsBaseVertex, {mode, (u32)count, type, word(indices), (u32)basevertex});
+	draw(true);
+}
+
+static void APIENTRY mockDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount)
+{
+	record(DrawElementsInstanced, {mode, (u32)count, type, word(indices), (u32)instancecount});
+	draw(true);
+}
+
+static void APIENTRY mockDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices)
+{
+	record(DrawRangeElements, {mode, start, end, (u32)count, type, word(indices)});
+	draw(true);
+}
+
+static void APIENTRY mockDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices, GLint basevertex)
+{
+	record(DrawRangeElementsBaseVertex, {mode, start, end, (u32)count, type, word(indices), (u32)basevertex});
+	draw(true);
+}
+
+static void APIENTRY mockEnable(GLenum cap)
+{
+	record(Enable, {cap});
+	changeState(Enable, cap, {1});
+}
+
+static void APIENTRY mockEnableVertexAttribArray(GLuint index)
+{
+	record(EnableVertexAttribArray, {index});
+	changeState(EnableVertexAttribArray, vertexArraySelector(index), {1});
+	State.VertexArrays[State.CurrentVertexArray].EnabledAttribs[index] = true;
+}
+
+static GLsync APIENTRY mockFenceSync(GLenum condition, GLbitfield flags)
+{
+	const GLsync sync = reinterpret_cast<GLsync>((uintptr_t)newName());
+	record(FenceSync, {condition, flags, word(sync)});
+	return sync;
+}
+
+static void APIENTRY mockFlush()
+{
+	record(Flush, {});
+}
+
+static void APIENTRY mockFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+	record(FramebufferTexture2D, {target, attachment, textarget, texture, (u32)level});
+}
+
+static void APIENTRY mockFrontFace(GLenum mode)
+{
+	record(FrontFace, {mode});
+	changeState(FrontFace, 0, {mode});
+}
+
+static void genNames(Function function, GLsizei n, GLuint *names, GLuint (*nextName)() = newName)
+{
+	for (GLsizei i = 0; i < n; ++i)
+		names[i] = nextName();
+	record(function, {(u32)n, n ? names[0] : 0});
+}
+
+static void APIENTRY mockGenBuffers(GLsizei n, GLuint *buffers)
+{
+	genNames(GenBuffers, n, buffers, newBufferName);
+}
+
+static void APIENTRY mockGenFramebuffers(GLsizei n, GLuint *framebuffers)
+{
+	genNames(GenFramebuffers, n, framebuffers);
+}
+
+static void APIENTRY mockGenTextures(GLsizei n, GLuint *textures)
+{
+	genNames(GenTextures, n, textures);
+}
+
+static void APIENTRY mockGenVertexArrays(GLsizei n, GLuint *arrays)
+{
+	genNames(GenVertexArrays, n, arrays);
+}
+
+static void APIENTRY mockGenerateMipmap(GLenum target)
+{
+	record(GenerateMipmap, {target});
+}
+
+static void APIENTRY mockGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name)
+{
+	record(GetActiveUniform, {program, index});
+	const std::vector<Uniform> &uniforms = State.Programs[program].Uniforms;
+	if (index >= uniforms.size() || bufSize <= 0)
+		return;
+
+	const Uniform &uniform = uniforms[index];
+	const GLsizei copied = std::min<GLsizei>(bufSize - 1, uniform.Name.size());
+	memcpy(name, uniform.Name.c_str(), copied);
+	name[copied] = 0;
+	if (length)
+		*length = copied;
+	*size = uniform.Size;
+	*type = uniform.Type;
+}
+
+static void APIENTRY mockGetAttachedShaders(GLuint program, GLsizei maxCount, GLsizei *count, GLuint *shaders)
+{
+	record(GetAttachedShaders, {program});
+	const std::vector<GLuint> &attached = State.Programs[program].Shaders;
+	GLsizei n = 0;
+	for (; n < maxCount && n < (GLsizei)attached.size(); ++n)
+		shaders[n] = attached[n];
+	if (count)
+		*count = n;
+}
+
+static GLenum APIENTRY mockGetError()
+{
+	record(GetError, {});
+	return GL_NO_ERROR;
+}
+
+static void APIENTRY mockGetFloatv(GLenum pname, GLfloat *data)
+{
+	record(GetFloatv, {pname});
+	switch (pname) {
+	case GL_MAX_TEXTURE_LOD_BIAS:
+		data[0] = 16.f;
+		break;
+	case GL_ALIASED_LINE_WIDTH_RANGE:
+		data[0] = 1.f;
+		data[1] = 64.f;
+		break;
+	case GL_ALIASED_POINT_SIZE_RANGE:
+		data[0] = 1.f;
+		data[1] = 256.f;
+		break;
+	default:
+		data[0] = 0.f;
+		break;
+	}
+}
+
+static void APIENTRY mockGetIntegerv(GLenum pname, GLint *data)
+{
+	record(GetIntegerv, {pname});
+	switch (pname) {
+	case GL_MAJOR_VERSION:
+		*data = 3;
+		break;
+	case GL_MINOR_VERSION:
+		*data = State.ES ? 0 : 3;
+		break;
+	case GL_NUM_EXTENSIONS:
+		*data = State.Extensions.size();
+		break;
+	case GL_CONTEXT_PROFILE_MASK:
+		*data = GL_CONTEXT_COMPATIBILITY_PROFILE_BIT;
+		break;
+	case GL_MAX_VERTEX_ATTRIBS:
+		*data = 16;
+		break;
+	case GL_MAX_TEXTURE_SIZE:
+		*data = 8192;
+		break;
+	case GL_MAX_COLOR_ATTACHMENTS:
+	case GL_MAX_DRAW_BUFFERS:
+		*data = 8;
+		break;
+	case GL_MAX_ELEMENTS_INDICES:
+		*data = 1 << 20;
+		break;
+	case GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT:
+		*data = 16;
+		break;
+	default:
+		*data = 0;
+		break;
+	}
+}
+
+static void APIENTRY mockGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+{
+	record(GetProgramInfoLog, {program});
+	if (length)
+		*length = 0;
+	if (bufSize > 0)
+		infoLog[0] = 0;
+}
+
+static void APIENTRY mockGetProgramiv(GLuint program, GLenum pname, GLint *params)
+{
+	record(GetProgramiv, {program, pname});
+	const std::vector<Uniform> &uniforms = State.Programs[program].Uniforms;
+	switch (pname) {
+	case GL_LINK_STATUS:
+		*params = GL_TRUE;
+		break;
+	case GL_ACTIVE_UNIFORMS:
+		*params = uniforms.size();
+		break;
+	case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+		*params = 0;
+		for (const Uniform &uniform : uniforms)
+			*params = std::max<GLint>(*params, uniform.Name.size() + 1);
+		break;
+	default:
+		*params = 0;
+		break;
+	}
+}
+
+static void APIENTRY mockGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+{
+	record(GetShaderInfoLog, {shader});
+	if (length)
+		*length = 0;
+	if (bufSize > 0)
+		infoLog[0] = 0;
+}
+
+static void APIENTRY mockGetShaderiv(GLuint shader, GLenum pname, GLint *params)
+{
+	record(GetShaderiv, {shader, pname});
+	*params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+static const GLubyte *APIENTRY mockGetString(GLenum name)
+{
+	record(GetString, {name});
+	switch (name) {
+	case GL_VERSION:
+		return (const GLubyte *)State.Version.c_str();
+	case GL_VENDOR:
+	case GL_RENDERER:
+		return (const GLubyte *)"Mock";
+	case GL_SHADING_LANGUAGE_VERSION:
+		return (const GLubyte *)(State.ES ? "OpenGL ES GLSL ES 3.00" : "3.30");
+	case GL_EXTENSIONS:
+		return (const GLubyte *)State.ExtensionString.c_str();
+	default:
+		return (const GLubyte *)"";
+	}
+}
+
+static const GLubyte *APIENTRY mockGetStringi(GLenum name, GLuint index)
+{
+	record(GetStringi, {name, index});
+	if (name != GL_EXTENSIONS || index >= State.Extensions.size())
+		return 0;
+	return (const GLubyte *)State.Extensions[index].c_str();
+}
+
+static void APIENTRY mockGetTexImage(GLenum target, GLint level, GLenum format, GLenum type, void *pixels)
+{
+	record(GetTexImage, {target, (u32)level, format, type});
+}
+
+static GLint APIENTRY mockGetUniformLocation(GLuint program, const GLchar *name)
+{
+	record(GetUniformLocation, {program});
+	const std::vector<Uniform> &uniforms = State.Programs[program].Uniforms;
+	for (u32 i = 0; i < uniforms.size(); ++i)
+		if (uniforms[i].Name == name)
+			return i;
+	return -1;
+}
+
+static void APIENTRY mockHint(GLenum target, GLenum mode)
+{
+	record(Hint, {target, mode});
+	changeState(Hint, target, {mode});
+}
+
+static void APIENTRY mockLineWidth(GLfloat width)
+{
+	record(LineWidth, {word(width)});
+	changeState(LineWidth, 0, {word(width)});
+}
+
+static GLenum getUniformType(const std::string &type)
+{
+	static const std::map<std::string, GLenum> types = {
+			{"float", GL_FLOAT},
+			{"vec2", GL_FLOAT_VEC2},
+			{"vec3", GL_FLOAT_VEC3},
+			{"vec4", GL_FLOAT_VEC4},
+			{"int", GL_INT},
+			{"ivec2", GL_INT_VEC2},
+			{"ivec3", GL_INT_VEC3},
+			{"ivec4", GL_INT_VEC4},
+			{"bool", GL_BOOL},
+			{"mat2", GL_FLOAT_MAT2},
+			{"mat3", GL_FLOAT_MAT3},
+			{"mat4", GL_FLOAT_MAT4},
+			{"sampler2D", GL_SAMPLER_2D},
+			{"samplerCube", GL_SAMPLER_CUBE},
+		};
+	auto it = types.find(type);
+	return it != types.end() ? it->second : GL_FLOAT;
+}
+
+// the uniforms are taken from the declarations in the sources
+static void APIENTRY mockLinkProgram(GLuint program)
+{
+	record(LinkProgram, {program});
+
+	static const std::regex declaration(R"(uniform\s+(?:(?:lowp|mediump|highp)\s+)?(\w+)\s+(\w+)\s*(?:\[\s*(\d+)\s*\])?\s*;)");
+	Program &p = State.Programs[program];
+	p.Uniforms.clear();
+	for (GLuint shader : p.Shaders) {
+		const std::string &source = State.Shaders[shader].Source;
+		for (std::sregex_iterator it(source.begin(), source.end(), declaration), end; it != end; ++it) {
+			const std::string name = (*it)[2];
+			bool known = false;
+			for (const Uniform &uniform : p.Uniforms)
+				known |= uniform.Name == name;
+			if (!known)
+				p.Uniforms.push_back({name, getUniformType((*it)[1]), (*it)[3].matched ? std::stoi((*it)[3]) : 1});
+		}
+	}
+}
+
+static void *APIENTRY mockMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+	record(MapBufferRange, {target, (u32)offset, (u32)length, access});
+	std::vector<u8> &storage = State.Storage[State.Buffers[target]];
+	if ((size_t)(offset + length) > storage.size())
+		return 0;
+	return storage.data() + offset;
+}
+
+static void APIENTRY mockPixelStorei(GLenum pname, GLint param)
+{
+	record(PixelStorei, {pname, (u32)param});
+	changeState(PixelStorei, pname, {(u32)param});
+}
+
+static void APIENTRY mockReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels)
+{
+	record(ReadPixels, {(u32)x, (u32)y, (u32)width, (u32)height, format, type});
+	memset(pixels, 0, (size_t)width * height * getPixelSize(format, type));
+}
+
+static void APIENTRY mockScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	record(Scissor, {(u32)x, (u32)y, (u32)width, (u32)height});
+	changeState(Scissor, 0, {(u32)x, (u32)y, (u32)width, (u32)height});
+}
+
+static void APIENTRY mockShaderSource(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length)
+{
+	record(ShaderSource, {shader, (u32)count});
+	std::string &source = State.Shaders[shader].Source;
+	source.clear();
+	for (GLsizei i = 0; i < count; ++i) {
+		if (length && length[i] >= 0)
+			source.append(string[i], length[i]);
+		else
+			source.append(string[i]);
+	}
+}
+
+static void APIENTRY mockTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels)
+{
+	record(TexImage2D, {target, (u32)level, (u32)internalformat, (u32)width, (u32)height, format, type, word(pixels)});
+	if (pixels)
+		State.Frame.TextureBytes += (u64)width * height * getPixelSize(format, type);
+}
+
+static void APIENTRY mockTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+	record(TexParameteri, {target, pname, (u32)param});
+	const GLuint texture = State.Textures[((u64)State.ActiveUnit << 32) | target];
+	changeState(TexParameteri, ((u64)texture << 32) | pname, {(u32)param});
+}
+
+static void APIENTRY mockTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels)
+{
+	record(TexSubImage2D, {target, (u32)level, (u32)xoffset, (u32)yoffset, (u32)width, (u32)height, format, type});
+	State.Frame.TextureBytes += (u64)width * height * getPixelSize(format, type);
+}
+
+#define MOCKGL_UNIFORM(name, type, components) \
+	static void APIENTRY mock##name(GLint location, GLsizei count, const type *value) \
+	{ \
+		record(name, {(u32)location, (u32)count}); \
+		uploadUniform(location, count, value, sizeof(type) * components); \
+	}
+
+MOCKGL_UNIFORM(Uniform1fv, GLfloat, 1)
+MOCKGL_UNIFORM(Uniform1iv, GLint, 1)
+MOCKGL_UNIFORM(Uniform2fv, GLfloat, 2)
+MOCKGL_UNIFORM(Uniform2iv, GLint, 2)
+MOCKGL_UNIFORM(Uniform3fv, GLfloat, 3)
+MOCKGL_UNIFORM(Uniform3iv, GLint, 3)
+MOCKGL_UNIFORM(Uniform4fv, GLfloat, 4)
+MOCKGL_UNIFORM(Uniform4iv, GLint, 4)
+#undef MOCKGL_UNIFORM
+
+#define MOCKGL_UNIFORM_MATRIX(name, components) \
+	static void APIENTRY mock##name(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) \
+	{ \
+		record(name, {(u32)location, (u32)count, transpose}); \
+		uploadUniform(location, count, value, sizeof(GLfloat) * components); \
+	}
+
+MOCKGL_UNIFORM_MATRIX(UniformMatrix2fv, 4)
+MOCKGL_UNIFORM_MATRIX(UniformMatrix3fv, 9)
+MOCKGL_UNIFORM_MATRIX(UniformMatrix4fv, 16)
+#undef MOCKGL_UNIFORM_MATRIX
+
+static GLboolean APIENTRY mockUnmapBuffer(GLenum target)
+{
+	record(UnmapBuffer, {target});
+	return GL_TRUE;
+}
+
+static void APIENTRY mockUseProgram(GLuint program)
+{
+	record(UseProgram, {program});
+	changeState(UseProgram, 0, {program});
+	State.CurrentProgram = program;
+}
+
+static void APIENTRY mockVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+	record(VertexAttribDivisor, {index, divisor});
+	changeState(VertexAttribDivisor, index, {divisor});
+}
+
+static void APIENTRY mockVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer)
+{
+	const GLuint buffer = State.Buffers[GL_ARRAY_BUFFER];
+	record(VertexAttribIPointer, {index, (u32)size, type, (u32)stride, word(pointer)});
+	changeState(VertexAttribPointer, vertexArraySelector(index), {(u32)size, type, 2, (u32)stride, word(pointer), buffer});
+	State.VertexArrays[State.CurrentVertexArray].ClientAttribs[index] = !buffer;
+}
+
+static void APIENTRY mockVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+	const GLuint buffer = State.Buffers[GL_ARRAY_BUFFER];
+	record(VertexAttribPointer, {index, (u32)size, type, normalized, (u32)stride, word(pointer)});
+	changeState(VertexAttribPointer, vertexArraySelector(index), {(u32)size, type, normalized, (u32)stride, word(pointer), buffer});
+	State.VertexArrays[State.CurrentVertexArray].ClientAttribs[index] = !buffer;
+}
+
+static void APIENTRY mockViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	record(Viewport, {(u32)x, (u32)y, (u32)width, (u32)height});
+	changeState(Viewport, 0, {(u32)x, (u32)y, (u32)width, (u32)height});
+}
+
+// the mocks must have the signatures of the procedures they stand in for
+#define MOCKGL_CHECK(name) \
+	static_assert(std::is_same<decltype(&mock##name), decltype(OpenGLProcedures::name)>::value, "signature of gl" #name);
+MOCKGL_FUNCTIONS(MOCKGL_CHECK)
+#undef MOCKGL_CHECK
+
+HeadlessContextManager::HeadlessContextManager(bool es, const std::vector<std::string> &extensions, u32 esMinorVersion)
+{
+	State.ES = es;
+	State.Version = es ? "OpenGL ES 3." + std::to_string(esMinorVersion) + " Mock" : "3.3.0 Mock";
+	State.Extensions = extensions;
+	State.ExtensionString.clear();
+	for (const std::string &extension : extensions)
+		State.ExtensionString += (State.ExtensionString.empty() ? "" : " ") + extension;
+}
+
+bool HeadlessContextManager::initialize(const SIrrlichtCreationParameters &params, const video::SExposedVideoData &data)
+{
+	Data = data;
+	return true;
+}
+
+void *HeadlessContextManager::getProcAddress(const std::string &procName)
+{
+	static const std::map<std::string, void *> procedures = {
+#define MOCKGL_PROCEDURE(name) {"gl" #name, (void *)mock##name},
+			MOCKGL_FUNCTIONS(MOCKGL_PROCEDURE)
+#undef MOCKGL_PROCEDURE
+		};
+	auto it = procedures.find(procName);
+	return it != procedures.end() ? it->second : 0;
+}
+
+bool HeadlessContextManager::swapBuffers()
+{
+	State.Frames.push_back(State.Frame);
+	State.Frame = FrameCounters();
+	return true;
+}
+
+const std::vector<u32> &getCommandStream()
+{
+	return State.Stream;
+}
+
+std::vector<Command> getCommands()
+{
+	std::vector<Command> commands;
+	for (size_t i = 0; i < State.Stream.size();) {
+		const u32 header = State.Stream[i];
+		commands.push_back({(Function)(header >> 8), &State.Stream[i + 1], header & 0xFF});
+		i += 1 + (header & 0xFF);
+	}
+	return commands;
+}
+
+u32 countCommands(Function function)
+{
+	u32 count = 0;
+	for (const Command &command : getCommands())
+		count += command.Func == function;
+	return count;
+}
+
+void clearCommands()
+{
+	State.Stream.clear();
+}
+
+const std::vector<u8> &getBufferData(u32 buffer)
+{
+	return State.Storage[buffer];
+}
+
+const FrameCounters &getCurrentFrame()
+{
+	return State.Frame;
+}
+
+const std::vector<FrameCounters> &getFrames()
+{
+	return State.Frames;
+}
+
+void clearFrames()
+{
+	State.Frames.clear();
+	State.Frame = FrameCounters();
+}
+
+} // end namespace mockgl
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <irrlicht.h>
+#include <IContextManager.h>
+#include <string>
+#include <vector>
+
+#include "mt_opengl.h"
+
+// Recording OpenGL implementation for running the GL drivers without a GPU.
+//
+// The headless context manager hands the mock functions to
+// OpenGLProcedures::LoadAllProcedures(). Every call is appended to a compact
+// command stream and counted for the current frame, which ends with
+// swapBuffers(). The mock keeps as much state as the drivers query: object
+// names, shader uniforms and the values of the pipeline state, so that
+// calls setting state to the value it already has can be told apart.
+
+namespace mockgl
+{
+
+using namespace irr;
+
+// the functions the drivers call, any other one is not handed out
+#define MOCKGL_FUNCTIONS(X) \
+	X(ActiveTexture) \
+	X(AttachShader) \
+	X(BindAttribLocation) \
+	X(BindBuffer) \
+	X(BindFramebuffer) \
+	X(BindTexture) \
+	X(BindVertexArray) \
+	X(BlendEquation) \
+	X(BlendFunc) \
+	X(BlendFuncSeparate) \
+	X(BufferData) \
+	X(BufferStorage) \
+	X(BufferSubData) \
+	X(CheckFramebufferStatus) \
+	X(Clear) \
+	X(ClearColor) \
+	X(ClearDepthf) \
+	X(ClearStencil) \
+	X(ClientWaitSync) \
+	X(ColorMask) \
+	X(CompileShader) \
+	X(CreateProgram) \
+	X(CreateShader) \
+	X(CullFace) \
+	X(DebugMessageCallback) \
+	X(DeleteBuffers) \
+	X(DeleteFramebuffers) \
+	X(DeleteProgram) \
+	X(DeleteShader) \
+	X(DeleteSync) \
+	X(DeleteTextures) \
+	X(DeleteVertexArrays) \
+	X(DepthFunc) \
+	X(DepthMask) \
+	X(Disable) \
+	X(DisableVertexAttribArray) \
+	X(DrawArrays) \
+	X(DrawBuffer) \
+	X(DrawBuffers) \
+	X(DrawElements) \
+	X(DrawElementsBaseVertex) \
+	X(DrawElementsInstanced) \
+	X(DrawRangeElements) \
+	X(DrawRangeElementsBaseVertex) \
+	X(Enable) \
+	X(EnableVertexAttribArray) \
+	X(FenceSync) \
+	X(Flush) \
+	X(FramebufferTexture2D) \
+	X(FrontFace) \
+	X(GenBuffers) \
+	X(GenFramebuffers) \
+	X(GenTextures) \
+	X(GenVertexArrays) \
+	X(GenerateMipmap) \
+	X(GetActiveUniform) \
+	X(GetAttachedShaders) \
+	X(GetError) \
+	X(GetFloatv) \
+	X(GetIntegerv) \
+	X(GetProgramInfoLog) \
+	X(GetProgramiv) \
+	X(GetShaderInfoLog) \
+	X(GetShaderiv) \
+	X(GetString) \
+	X(GetStringi) \
+	X(GetTexImage) \
+	X(GetUniformLocation) \
+	X(Hint) \
+	X(LineWidth) \
+	X(LinkProgram) \
+	X(MapBufferRange) \
+	X(PixelStorei) \
+	X(ReadPixels) \
+	X(Scissor) \
+	X(ShaderSource) \
+	X(TexImage2D) \
+	X(TexParameteri) \
+	X(TexSubImage2D) \
+	X(Uniform1fv) \
+	X(Uniform1iv) \
+	X(Uniform2fv) \
+	X(Uniform2iv) \
+	X(Uniform3fv) \
+	X(Uniform3iv) \
+	X(Uniform4fv) \
+	X(Uniform4iv) \
+	X(UniformMatrix2fv) \
+	X(UniformMatrix3fv) \
+	X(UniformMatrix4fv) \
+	X(UnmapBuffer) \
+	X(UseProgram) \
+	X(VertexAttribDivisor) \
+	X(VertexAttribIPointer) \
+	X(VertexAttribPointer) \
+	X(Viewport)
+
+enum Function : u32
+{
+#define MOCKGL_ENUM(name) name,
+	MOCKGL_FUNCTIONS(MOCKGL_ENUM)
+#undef MOCKGL_ENUM
+	FunctionCount
+};
+
+const char *getFunctionName(Function function);
+
+// Counters of one frame
+struct FrameCounters
+{
+	// all calls
+	u32 Calls = 0;
+	// DrawArrays, DrawElements and the like
+	u32 DrawCalls = 0;
+	// draws which read vertices or indices from client memory
+	u32 ClientDraws = 0;
+	// calls changing pipeline state, bindings or vertex attributes
+	u32 StateChanges = 0;
+	// state changes which set the value the state already had
+	u32 RedundantStateChanges = 0;
+	// Uniform* calls
+	u32 UniformUploads = 0;
+	// uploads of the values the uniform had already
+	u32 RedundantUniformUploads = 0;
+	// bytes passed to BufferData, BufferStorage and BufferSubData, writes
+	// to mapped buffers aren't seen
+	u64 BufferBytes = 0;
+	// bytes passed to TexImage2D and TexSubImage2D
+	u64 TextureBytes = 0;
+};
+
+// One call of the command stream
+struct Command
+{
+	Function Func;
+	// arguments as 32 bit words: integers and enums as they are, floats by
+	// their bits, pointers and sizes cut to their lower 32 bits
+	const u32 *Args;
+	u32 ArgCount;
+};
+
+// Context manager without window or GPU, handing out the mock functions
+class HeadlessContextManager : public video::IContextManager
+{
+public:
+	// es: report OpenGL ES 3.x instead of a 3.3 compatibility profile
+	// extensions: names the context reports
+	// esMinorVersion: the x of OpenGL ES 3.x, 2 has base vertex draws
+	HeadlessContextManager(bool es, const std::vector<std::string> &extensions = {}, u32 esMinorVersion = 0);
+
+	bool initialize(const SIrrlichtCreationParameters &params, const video::SExposedVideoData &data) override;
+	void terminate() override {}
+	bool generateSurface() override { return true; }
+	void destroySurface() override {}
+	bool generateContext() override { return true; }
+	void destroyContext() override {}
+	const video::SExposedVideoData &getContext() const override { return Data; }
+	bool activateContext(const video::SExposedVideoData &videoData, bool restorePrimaryOnZero) override { return true; }
+	void *getProcAddress(const std::string &procName) override;
+
+	// ends the frame
+	bool swapBuffers() override;
+
+private:
+	video::SExposedVideoData Data;
+};
+
+// The recorded calls since the last clearCommands(), one header word with
+// the function and the argument count followed by the arguments
+const std::vector<u32> &getCommandStream();
+std::vector<Command> getCommands();
+u32 countCommands(Function function);
+void clearCommands();
+
+// contents of a buffer object, as uploaded or written to its mapping
+const std::vector<u8> &getBufferData(u32 buffer);
+
+// counters of the frame in progress and of the frames ended so far
+const FrameCounters &getCurrentFrame();
+const std::vector<FrameCounters> &getFrames();
+void clearFrames();
+
+} // end namespace mockgl
@@ -0,0 +1,256 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+#include <png.h>
+#include <vector>
+
+#include "test_check.h"
+
+using namespace irr;
+
+// Decodes PNG images row by row into memory of the caller, in the format
+// of texture uploads. Run with --benchmark to compare with decoding an
+// image and converting it afterwards.
+
+static video::SColor expected(u32 x, u32 y, bool alpha)
+{
+	return video::SColor(alpha ? (x * 7 + y) & 255 : 255, (x * 3) & 255, (y * 5) & 255, (x ^ y) & 255);
+}
+
+static void writeImage(video::IVideoDriver *driver, const io::path &name, u32 size, bool alpha)
+{
+	video::IImage *image = driver->createImage(alpha ? video::ECF_A8R8G8B8 : video::ECF_R8G8B8, core::dimension2du(size, size));
+	for (u32 y = 0; y < size; ++y)
+		for (u32 x = 0; x < size; ++x)
+			image->setPixel(x, y, expected(x, y, alpha));
+	driver->writeImageToFile(image, name);
+	image->drop();
+}
+
+// interlaced gray images can't be written by the engine
+static void writeInterlacedGray(const char *name, u32 size)
+{
+	FILE *file = fopen(name, "wb");
+	png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
+	png_infop info = png_create_info_struct(png);
+	png_init_io(png, file);
+	png_set_IHDR(png, info, size, size, 8, PNG_COLOR_TYPE_GRAY, PNG_INTERLACE_ADAM7,
+			PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	png_set_sRGB(png, info, PNG_sRGB_INTENT_PERCEPTUAL);
+	png_write_info(png, info);
+
+	std::vector<png_byte> pixels(size * size);
+	std::vector<png_bytep> rows(size);
+	for (u32 y = 0; y < size; ++y) {
+		for (u32 x = 0; x < size; ++x)
+			pixels[y * size + x] = (png_byte)(x * 9 + y);
+		rows[y] = &pixels[y * size];
+	}
+	png_write_image(png, rows.data());
+	png_write_end(png, info);
+	png_destroy_write_struct(&png, &info);
+	fclose(file);
+}
+
+// rows with a pitch larger than needed, the gap between them must stay
+// untouched
+class PaddedRows : public video::IImageRowTarget
+{
+public:
+	PaddedRows() :
+			Format(video::ECF_UNKNOWN), Calls(0) {}
+
+	void *getRows(const core::dimension2du &size, video::ECOLOR_FORMAT format, u32 &pitch) override
+	{
+		++Calls;
+		Size = size;
+		Format = format;
+		Pitch = size.Width * video::IImage::getBitsPerPixelFromFormat(format) / 8 + 16;
+		Memory.assign(Pitch * size.Height, 0xCD);
+		pitch = Pitch;
+		return Memory.data();
+	}
+
+	video::SColor getPixel(u32 x, u32 y, bool swapped) const
+	{
+		const u8 *p = &Memory[y * Pitch];
+		if (Format == video::ECF_A8R8G8B8) {
+			p += x * 4;
+			return swapped ? video::SColor(p[3], p[0], p[1], p[2]) : video::SColor(p[3], p[2], p[1], p[0]);
+		}
+		p += x * 3;
+		return swapped ? video::SColor(255, p[2], p[1], p[0]) : video::SColor(255, p[0], p[1], p[2]);
+	}
+
+	bool paddingKept() const
+	{
+		const u32 used = Size.Width * video::IImage::getBitsPerPixelFromFormat(Format) / 8;
+		for (u32 y = 0; y < Size.Height; ++y)
+			for (u32 i = used; i < Pitch; ++i)
+				if (Memory[y * Pitch + i] != 0xCD)
+					return false;
+		return true;
+	}
+
+	core::dimension2du Size;
+	video::ECOLOR_FORMAT Format;
+	u32 Pitch;
+	u32 Calls;
+	std::vector<u8> Memory;
+};
+
+static video::IImageLoader *getPngLoader(video::IVideoDriver *driver)
+{
+	for (u32 i = 0; i < driver->getImageLoaderCount(); ++i)
+		if (driver->getImageLoader(i)->isALoadableFileExtension("a.png"))
+			return driver->getImageLoader(i);
+	return 0;
+}
+
+static bool decode(io::IFileSystem *fs, video::IImageLoader *loader, const io::path &name,
+		video::ECOLOR_FORMAT format, bool swap, video::IImageRowTarget *target)
+{
+	io::IReadFile *file = fs->createAndOpenFile(name);
+	if (!file)
+		return false;
+	const bool ok = loader->loadImageRows(file, format, swap, target);
+	file->drop();
+	return ok;
+}
+
+// compares the decoded rows with the image of the usual loader
+static bool matchesImage(video::IVideoDriver *driver, const io::path &name, const PaddedRows &rows, bool swapped, bool keepAlpha)
+{
+	video::IImage *image = driver->createImageFromFile(name);
+	bool ok = image && image->getDimension() == rows.Size && rows.paddingKept();
+	for (u32 y = 0; ok && y < rows.Size.Height; ++y) {
+		for (u32 x = 0; ok && x < rows.Size.Width; ++x) {
+			video::SColor color = image->getPixel(x, y);
+			if (!keepAlpha)
+				color.setAlpha(255);
+			ok = rows.getPixel(x, y, swapped) == color;
+		}
+	}
+	if (image)
+		image->drop();
+	return ok;
+}
+
+static void testFormats(IrrlichtDevice *device, video::IImageLoader *loader)
+{
+	video::IVideoDriver *driver = device->getVideoDriver();
+	io::IFileSystem *fs = device->getFileSystem();
+	writeImage(driver, "png_rows_rgb.png", 37, false);
+	writeImage(driver, "png_rows_rgba.png", 29, true);
+
+	const bool swaps[2] = {false, true};
+	for (bool swap : swaps) {
+		PaddedRows rgb;
+		check(decode(fs, loader, "png_rows_rgb.png", video::ECF_A8R8G8B8, swap, &rgb), "RGB to A8R8G8B8");
+		check(rgb.Format == video::ECF_A8R8G8B8 && matchesImage(driver, "png_rows_rgb.png", rgb, swap, true), "opaque alpha added");
+
+		PaddedRows rgba;
+		check(decode(fs, loader, "png_rows_rgba.png", video::ECF_A8R8G8B8, swap, &rgba), "RGBA to A8R8G8B8");
+		check(matchesImage(driver, "png_rows_rgba.png", rgba, swap, true), "RGBA rows");
+
+		PaddedRows stripped;
+		check(decode(fs, loader, "png_rows_rgba.png", video::ECF_R8G8B8, swap, &stripped), "RGBA to R8G8B8");
+		check(stripped.Format == video::ECF_R8G8B8 && matchesImage(driver, "png_rows_rgba.png", stripped, swap, false), "alpha stripped");
+	}
+
+	PaddedRows natural;
+	check(decode(fs, loader, "png_rows_rgb.png", video::ECF_UNKNOWN, false, &natural), "format of the file");
+	check(natural.Format == video::ECF_R8G8B8, "RGB file decoded as R8G8B8");
+
+	PaddedRows unsupported;
+	check(!decode(fs, loader, "png_rows_rgb.png", video::ECF_R5G6B5, false, &unsupported) && unsupported.Calls == 0, "unsupported format");
+
+	// the usual images keep the format of the file
+	video::IImage *image = driver->createImageFromFile("png_rows_rgb.png");
+	check(image && image->getColorFormat() == video::ECF_R8G8B8, "image in the format of the file");
+	if (image)
+		image->drop();
+
+	// textures are decoded in the format they are uploaded in
+	video::ITexture *texture = driver->getTexture("png_rows_rgb.png");
+	check(texture && texture->getOriginalSize() == core::dimension2du(37, 37), "texture");
+
+	remove("png_rows_rgb.png");
+	remove("png_rows_rgba.png");
+}
+
+static void testOtherImages(IrrlichtDevice *device, video::IImageLoader *loader, const char *palette)
+{
+	video::IVideoDriver *driver = device->getVideoDriver();
+	io::IFileSystem *fs = device->getFileSystem();
+
+	PaddedRows paletteRows;
+	check(decode(fs, loader, palette, video::ECF_A8R8G8B8, false, &paletteRows), "palette image");
+	check(matchesImage(driver, palette, paletteRows, false, true), "palette rows");
+
+	writeInterlacedGray("png_rows_interlaced.png", 45);
+	PaddedRows interlaced;
+	check(decode(fs, loader, "png_rows_interlaced.png", video::ECF_A8R8G8B8, true, &interlaced), "interlaced image");
+	check(matchesImage(driver, "png_rows_interlaced.png", interlaced, true, true), "interlaced rows");
+	remove("png_rows_interlaced.png");
+}
+
+static void benchmark(IrrlichtDevice *device, video::IImageLoader *loader)
+{
+	video::IVideoDriver *driver = device->getVideoDriver();
+	io::IFileSystem *fs = device->getFileSystem();
+	const u32 count = 50;
+	writeImage(driver, "png_rows_benchmark.png", 512, false);
+
+	// what creating a texture did before: decode, then convert to the
+	// upload format
+	auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < count; ++i) {
+		video::IImage *image = driver->createImageFromFile("png_rows_benchmark.png");
+		video::IImage *upload = driver->createImage(video::ECF_A8R8G8B8, image->getDimension());
+		image->copyTo(upload);
+		upload->drop();
+		image->drop();
+	}
+	const double converted = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < count; ++i) {
+		PaddedRows rows;
+		decode(fs, loader, "png_rows_benchmark.png", video::ECF_A8R8G8B8, false, &rows);
+	}
+	const double streamed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	remove("png_rows_benchmark.png");
+	printf("%u RGB PNG images of 512x512 to A8R8G8B8: %.1f ms decoding and converting, %.1f ms decoding rows\n",
+			count, converted, streamed);
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_NONE;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	video::IImageLoader *loader = getPngLoader(device->getVideoDriver());
+	check(loader != 0, "PNG loader");
+	if (loader) {
+		testFormats(device, loader);
+		if (argc > 1 && strcmp(argv[1], "--benchmark") != 0)
+			testOtherImages(device, loader, argv[1]);
+
+		if (argc > 1 && strcmp(argv[argc - 1], "--benchmark") == 0)
+			benchmark(device, loader);
+	}
+
+	device->drop();
+
+	return testResult();
+}
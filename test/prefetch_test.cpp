@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+
+#include "test_check.h"
+#include "zip_writer.h"
+
+using namespace irr;
+
+// Prefetches files from disk and from an archive and opens them afterwards
+
+static void writeFiles(io::IFileSystem *fs)
+{
+	core::array<u8> zip;
+	zipwriter::addDeflatedEntry(zip, "big.bin", 3, 300000);
+	zipwriter::addDeflatedEntry(zip, "small.bin", 5, 1000);
+	zipwriter::endArchive(zip);
+	zipwriter::writeFile(fs, "prefetch_test.zip", zip);
+
+	zip.clear();
+	zipwriter::addDeflatedEntry(zip, "small.bin", 9, 1000);
+	zipwriter::endArchive(zip);
+	zipwriter::writeFile(fs, "prefetch_other.zip", zip);
+
+	core::array<u8> data;
+	zipwriter::makeData(data, 7, 5000);
+	zipwriter::writeFile(fs, "prefetch_test.bin", data);
+}
+
+static void testPrefetch(io::IFileSystem *fs)
+{
+	check(fs->addFileArchive("prefetch_test.zip", true, true, io::EFAT_ZIP), "archive added");
+
+	core::array<io::path> names;
+	names.push_back("big.bin");
+	names.push_back("small.bin");
+	names.push_back("prefetch_test.bin");
+	names.push_back("missing.bin");
+	names.push_back("big.bin");
+	check(fs->prefetchFiles(names) == 3, "files queued");
+
+	const io::SPrefetchStats &stats = fs->getPrefetchStats();
+	check(stats.Queued == 3 && stats.Skipped == 1, "queued and skipped");
+	check(stats.CachedFiles == 3 && stats.CachedBytes == 306000, "cached size");
+
+	const u32 misses = stats.Misses;
+	check(zipwriter::checkContent(fs, "big.bin", 3, 300000), "large deflated entry");
+	check(zipwriter::checkContent(fs, "small.bin", 5, 1000), "small deflated entry");
+	check(zipwriter::checkContent(fs, "prefetch_test.bin", 7, 5000), "file on disk");
+	check(stats.Hits == 3 && stats.Misses == misses, "opened from the cache");
+	check(stats.CachedFiles == 0 && stats.CachedBytes == 0, "cache empty after opening");
+
+	// each file is handed out once
+	check(zipwriter::checkContent(fs, "big.bin", 3, 300000) && stats.Misses == misses + 1, "second open is a miss");
+
+	// the budget leaves out what doesn't fit
+	fs->setPrefetchBudget(10000);
+	check(fs->prefetchFiles(names) == 2 && stats.CachedBytes == 6000, "budget");
+	fs->clearPrefetchCache();
+	check(stats.CachedFiles == 0 && stats.CachedBytes == 0, "cache cleared");
+	fs->setPrefetchBudget(64 * 1024 * 1024);
+
+	fs->removeFileArchive((u32)0);
+}
+
+// prefetched files may come from another archive after the archives changed
+static void testChangedArchives(io::IFileSystem *fs)
+{
+	check(fs->addFileArchive("prefetch_test.zip", true, true, io::EFAT_ZIP), "first archive added");
+	core::array<io::path> names;
+	names.push_back("small.bin");
+	check(fs->prefetchFiles(names) == 1, "entry of the first archive queued");
+
+	fs->removeFileArchive((u32)0);
+	check(fs->getPrefetchStats().CachedFiles == 0, "cache cleared when an archive is removed");
+	check(fs->addFileArchive("prefetch_other.zip", true, true, io::EFAT_ZIP), "second archive added");
+	check(zipwriter::checkContent(fs, "small.bin", 9, 1000), "entry of the second archive opened");
+
+	check(fs->prefetchFiles(names) == 1, "entry of the second archive queued");
+	check(fs->addFileArchive("prefetch_test.zip", true, true, io::EFAT_ZIP), "first archive added again");
+	check(fs->getPrefetchStats().CachedFiles == 0, "cache cleared when an archive is added");
+	check(zipwriter::checkContent(fs, "small.bin", 9, 1000), "earlier archive still takes precedence");
+
+	check(fs->prefetchFiles(names) == 1, "entry queued again");
+	check(fs->moveFileArchive(1, -1), "archives reordered");
+	check(zipwriter::checkContent(fs, "small.bin", 5, 1000), "entry of the archive moved to the front");
+
+	fs->removeFileArchive((u32)0);
+	fs->removeFileArchive((u32)0);
+}
+
+static void testArchiveFromFile(io::IFileSystem *fs)
+{
+	// entries of this archive share its handle, they are read right away
+	io::IReadFile *zip = fs->createAndOpenFile("prefetch_test.zip");
+	io::IReadFile *limited = fs->createLimitReadFile("prefetch_test.zip", zip, 0, zip->getSize());
+	zip->drop();
+	check(fs->addFileArchive(limited, true, true, io::EFAT_ZIP), "archive added from a file");
+	limited->drop();
+
+	core::array<io::path> names;
+	names.push_back("big.bin");
+	names.push_back("small.bin");
+	check(fs->prefetchFiles(names) == 2, "files of the archive queued");
+	check(zipwriter::checkContent(fs, "big.bin", 3, 300000), "large entry of the archive");
+	check(zipwriter::checkContent(fs, "small.bin", 5, 1000), "small entry of the archive");
+
+	// files still in the cache are released with the file system
+	fs->prefetchFiles(names);
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_ERROR;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	io::IFileSystem *fs = device->getFileSystem();
+	writeFiles(fs);
+	testPrefetch(fs);
+	testChangedArchives(fs);
+	testArchiveFromFile(fs);
+
+	device->drop();
+	remove("prefetch_test.zip");
+	remove("prefetch_other.zip");
+	remove("prefetch_test.bin");
+
+	return testResult();
+}
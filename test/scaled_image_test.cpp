@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+
+#include "test_check.h"
+
+using namespace irr;
+
+// Loads JPEG images at reduced sizes. Run with --benchmark to compare with
+// decoding the full image and scaling it down.
+
+// smooth gradients survive the compression and the scaling
+static video::SColor expected(u32 x, u32 y, u32 width, u32 height)
+{
+	return video::SColor(255, x * 255 / width, y * 255 / height, 128);
+}
+
+static void writeImage(video::IVideoDriver *driver, const io::path &name, u32 width, u32 height)
+{
+	video::IImage *image = driver->createImage(video::ECF_R8G8B8, core::dimension2du(width, height));
+	for (u32 y = 0; y < height; ++y)
+		for (u32 x = 0; x < width; ++x)
+			image->setPixel(x, y, expected(x, y, width, height));
+	driver->writeImageToFile(image, name, 95);
+	image->drop();
+}
+
+static bool similar(u32 a, u32 b)
+{
+	return (a > b ? a - b : b - a) <= 12;
+}
+
+static bool checkImage(video::IImage *image, u32 width, u32 height)
+{
+	if (!image || image->getDimension() != core::dimension2du(width, height))
+		return false;
+
+	for (u32 y = 1; y < height - 1; y += 3) {
+		for (u32 x = 1; x < width - 1; x += 3) {
+			const video::SColor color = image->getPixel(x, y);
+			const video::SColor wanted = expected(x, y, width, height);
+			if (!similar(color.getRed(), wanted.getRed()) || !similar(color.getGreen(), wanted.getGreen()) ||
+					!similar(color.getBlue(), wanted.getBlue()))
+				return false;
+		}
+	}
+	return true;
+}
+
+static void testScaled(video::IVideoDriver *driver, const core::dimension2du &maxSize,
+		u32 width, u32 height, const char *what)
+{
+	video::IImage *image = driver->createScaledImageFromFile("scaled_image_test.jpg", maxSize);
+	check(checkImage(image, width, height), what);
+	if (image)
+		image->drop();
+}
+
+static void testJPEG(video::IVideoDriver *driver)
+{
+	writeImage(driver, "scaled_image_test.jpg", 256, 128);
+
+	testScaled(driver, core::dimension2du(0, 0), 256, 128, "no limit");
+	testScaled(driver, core::dimension2du(32, 32), 32, 16, "eighth");
+	testScaled(driver, core::dimension2du(20, 20), 32, 16, "smallest scale");
+	testScaled(driver, core::dimension2du(100, 100), 128, 64, "half");
+	testScaled(driver, core::dimension2du(64, 0), 64, 32, "width only");
+	testScaled(driver, core::dimension2du(0, 40), 128, 64, "height only");
+	testScaled(driver, core::dimension2du(200, 16), 32, 16, "height limits");
+	testScaled(driver, core::dimension2du(1024, 1024), 256, 128, "larger than the image");
+
+	video::IImage *image = driver->createImageFromFile("scaled_image_test.jpg");
+	check(checkImage(image, 256, 128), "full image");
+	if (image)
+		image->drop();
+
+	remove("scaled_image_test.jpg");
+}
+
+static void testOtherFormats(video::IVideoDriver *driver)
+{
+	// loaders which can't reduce the image return all of it
+	writeImage(driver, "scaled_image_test.png", 64, 32);
+	video::IImage *image = driver->createScaledImageFromFile("scaled_image_test.png", core::dimension2du(8, 8));
+	check(checkImage(image, 64, 32), "PNG at full size");
+	if (image)
+		image->drop();
+	remove("scaled_image_test.png");
+
+	check(driver->createScaledImageFromFile("scaled_image_missing.jpg", core::dimension2du(8, 8)) == 0, "missing file");
+}
+
+static void benchmark(video::IVideoDriver *driver)
+{
+	const u32 count = 20;
+	writeImage(driver, "scaled_image_benchmark.jpg", 2048, 2048);
+	const core::dimension2du thumbnail(256, 256);
+
+	auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < count; ++i) {
+		video::IImage *image = driver->createImageFromFile("scaled_image_benchmark.jpg");
+		video::IImage *scaled = driver->createImage(image->getColorFormat(), thumbnail);
+		image->copyToScaling(scaled);
+		scaled->drop();
+		image->drop();
+	}
+	const double full = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < count; ++i)
+		driver->createScaledImageFromFile("scaled_image_benchmark.jpg", thumbnail)->drop();
+	const double reduced = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	remove("scaled_image_benchmark.jpg");
+
+	printf("%u JPEG images of 2048x2048 to 256x256: %.1f ms decoding and scaling, %.1f ms scaled decoding\n",
+			count, full, reduced);
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_NONE;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	video::IVideoDriver *driver = device->getVideoDriver();
+	testJPEG(driver);
+	testOtherFormats(driver);
+
+	if (isBenchmark(argc, argv))
+		benchmark(driver);
+
+	device->drop();
+
+	return testResult();
+}
@@ -0,0 +1,576 @@
+#include <chrono>
+#include <cstdio>
+#include <irrlicht.h>
+
+#include "CSkinnedMesh.h"
+#include "test_check.h"
+
+using namespace irr;
+using scene::CSkinnedMesh;
+
+// Animates and skins a small synthetic mesh and compares the results of the
+// skinned mesh features with plain reference computations. Run with
+// --benchmark [model files] to time them on a large synthetic mesh and on
+// the models.
+
+static const f32 LastFrame = 10.f;
+
+// A strip of quads along Y. The root joint moves along X by one unit per
+// frame, the upper joint turns by 90 degrees over the animation. The lower
+// half belongs to the root, the upper half to the upper joint and the middle
+// row to both.
+static CSkinnedMesh *createStrip(scene::ISceneManager *smgr, u32 rows)
+{
+	CSkinnedMesh *mesh = static_cast<CSkinnedMesh *>(smgr->createSkinnedMesh());
+	scene::SSkinMeshBuffer *buffer = mesh->addMeshBuffer();
+	for (u32 y = 0; y <= rows; ++y) {
+		for (u32 x = 0; x < 2; ++x)
+			buffer->Vertices_Standard.push_back(video::S3DVertex((f32)x, (f32)y, 0.f, 0.f, 0.f, -1.f,
+					video::SColor(255, 255, 255, 255), (f32)x, (f32)y));
+		if (y < rows) {
+			const u16 i = y * 2;
+			const u16 quad[6] = {i, (u16)(i + 2), (u16)(i + 1), (u16)(i + 1), (u16)(i + 2), (u16)(i + 3)};
+			for (u16 index : quad)
+				buffer->Indices.push_back(index);
+		}
+	}
+
+	scene::ISkinnedMesh::SJoint *root = mesh->addJoint();
+	root->Name = "root";
+	mesh->addPositionKey(root)->frame = 0.f;
+	scene::ISkinnedMesh::SPositionKey *move = mesh->addPositionKey(root);
+	move->frame = LastFrame;
+	move->position.set(LastFrame, 0.f, 0.f);
+
+	scene::ISkinnedMesh::SJoint *upper = mesh->addJoint(root);
+	upper->Name = "upper";
+	const core::vector3df pivot(0.f, rows / 2.f, 0.f);
+	upper->LocalMatrix.setTranslation(pivot);
+	for (f32 frame : {0.f, LastFrame}) {
+		scene::ISkinnedMesh::SPositionKey *position = mesh->addPositionKey(upper);
+		position->frame = frame;
+		position->position = pivot;
+		scene::ISkinnedMesh::SRotationKey *rotation = mesh->addRotationKey(upper);
+		rotation->frame = frame;
+		rotation->rotation.set(0.f, 0.f, frame / LastFrame * core::HALF_PI);
+	}
+
+	for (u32 v = 0; v < buffer->getVertexCount(); ++v) {
+		const u32 row = v / 2;
+		const f32 upperStrength = row < rows / 2 ? 0.f : row == rows / 2 ? 0.5f : 1.f;
+		for (scene::ISkinnedMesh::SJoint *joint : {root, upper}) {
+			const f32 strength = joint == root ? 1.f - upperStrength : upperStrength;
+			if (strength == 0.f)
+				continue;
+			scene::ISkinnedMesh::SWeight *weight = mesh->addWeight(joint);
+			weight->buffer_id = 0;
+			weight->vertex_id = v;
+			weight->strength = strength;
+		}
+	}
+
+	mesh->finalize();
+	return mesh;
+}
+
+static bool sameBox(const core::aabbox3df &a, const core::aabbox3df &b)
+{
+	return a.MinEdge.getDistanceFrom(b.MinEdge) < 1e-4f && a.MaxEdge.getDistanceFrom(b.MaxEdge) < 1e-4f;
+}
+
+// bounding box of the mesh skinned in place at a frame
+static core::aabbox3df getPoseBox(CSkinnedMesh *mesh, f32 frame)
+{
+	mesh->animateMesh(frame, 1.f);
+	mesh->skinMesh();
+	mesh->updateBoundingBox();
+	return mesh->getBoundingBox();
+}
+
+// renders one node per frame, all sharing the mesh, and compares what each
+// node rendered with the reference
+static void checkNodes(scene::ISceneManager *smgr, CSkinnedMesh *mesh, CSkinnedMesh *reference,
+		const core::array<f32> &frames, const char *what)
+{
+	core::array<scene::IAnimatedMeshSceneNode *> nodes;
+	for (u32 i = 0; i < frames.size(); ++i) {
+		scene::IAnimatedMeshSceneNode *node = smgr->addAnimatedMeshSceneNode(mesh);
+		node->setFrameLoop(0, (s32)LastFrame);
+		node->setAnimationSpeed(0.f);
+		node->setCurrentFrame(frames[i]);
+		node->setAutomaticCulling(scene::EAC_OFF);
+		nodes.push_back(node);
+	}
+
+	smgr->drawAll();
+
+	bool ok = true;
+	for (u32 i = 0; i < nodes.size(); ++i) {
+		ok &= sameBox(nodes[i]->getBoundingBox(), getPoseBox(reference, frames[i]));
+		nodes[i]->remove();
+	}
+	check(ok, what);
+}
+
+// positions and normals of the vertices of each mesh buffer
+struct SPose
+{
+	core::array<core::vector3df> Pos;
+	core::array<core::vector3df> Normal;
+};
+
+static void getPose(CSkinnedMesh *mesh, core::array<SPose> &pose)
+{
+	pose.set_used(mesh->getMeshBufferCount());
+	for (u32 b = 0; b < pose.size(); ++b) {
+		const scene::IMeshBuffer *buffer = mesh->getMeshBuffer(b);
+		pose[b].Pos.set_used(buffer->getVertexCount());
+		pose[b].Normal.set_used(buffer->getVertexCount());
+		for (u32 v = 0; v < buffer->getVertexCount(); ++v) {
+			pose[b].Pos[v] = buffer->getPosition(v);
+			pose[b].Normal[v] = buffer->getNormal(v);
+		}
+	}
+}
+
+// Linear blend skinning of the static pose, weight by weight as skinMesh()
+// did before the influences were gathered per vertex. Needs the global
+// matrices of the joints, which skinMesh() computes.
+static void skinReference(CSkinnedMesh *mesh, const core::array<SPose> &bind, core::array<SPose> &out)
+{
+	out.set_used(bind.size());
+	for (u32 b = 0; b < bind.size(); ++b) {
+		out[b].Pos.set_used(bind[b].Pos.size());
+		out[b].Normal.set_used(bind[b].Normal.size());
+		for (u32 v = 0; v < bind[b].Pos.size(); ++v) {
+			out[b].Pos[v].set(0.f, 0.f, 0.f);
+			out[b].Normal[v].set(0.f, 0.f, 0.f);
+		}
+	}
+
+	const core::array<scene::ISkinnedMesh::SJoint *> &joints = mesh->getAllJoints();
+	for (u32 j = 0; j < joints.size(); ++j) {
+		core::matrix4 m;
+		m.setbyproduct(joints[j]->GlobalAnimatedMatrix, joints[j]->GlobalInversedMatrix);
+		for (u32 w = 0; w < joints[j]->Weights.size(); ++w) {
+			const scene::ISkinnedMesh::SWeight &weight = joints[j]->Weights[w];
+			core::vector3df pos, normal;
+			m.transformVect(pos, bind[weight.buffer_id].Pos[weight.vertex_id]);
+			m.rotateVect(normal, bind[weight.buffer_id].Normal[weight.vertex_id]);
+			out[weight.buffer_id].Pos[weight.vertex_id] += pos * weight.strength;
+			out[weight.buffer_id].Normal[weight.vertex_id] += normal * weight.strength;
+		}
+	}
+}
+
+static void testSkinning(scene::ISceneManager *smgr)
+{
+	CSkinnedMesh *mesh = createStrip(smgr, 8);
+	core::array<SPose> bind;
+	getPose(mesh, bind);
+
+	bool ok = true;
+	for (f32 frame : {0.f, 2.5f, 7.f, LastFrame}) {
+		mesh->animateMesh(frame, 1.f);
+		mesh->skinMesh();
+
+		core::array<SPose> skinned, expected;
+		getPose(mesh, skinned);
+		skinReference(mesh, bind, expected);
+		for (u32 v = 0; v < expected[0].Pos.size(); ++v) {
+			ok &= skinned[0].Pos[v].getDistanceFrom(expected[0].Pos[v]) < 1e-4f;
+			ok &= skinned[0].Normal[v].getDistanceFrom(expected[0].Normal[v]) < 1e-4f;
+		}
+	}
+	check(ok, "skinned vertices match linear blend skinning");
+
+	// the upper end turns around the pivot while the root moves along X
+	mesh->animateMesh(LastFrame, 1.f);
+	mesh->skinMesh();
+	const core::vector3df top = mesh->getMeshBuffer(0)->getPosition(mesh->getMeshBuffer(0)->getVertexCount() - 2);
+	check(top.getDistanceFrom(core::vector3df(LastFrame + 4.f, 4.f, 0.f)) < 1e-4f, "skinned vertex position");
+
+	mesh->drop();
+}
+
+// renders one node per frame in EJUOR_READ mode and returns the position of
+// the upper joint of each node and of a scene node attached to it
+static void drawReadingJoints(scene::ISceneManager *smgr, CSkinnedMesh *mesh, const core::array<f32> &frames,
+		s32 threads, core::array<core::vector3df> &positions)
+{
+	smgr->getParameters()->setAttribute(scene::ANIMATION_THREADS, threads);
+
+	core::array<scene::IAnimatedMeshSceneNode *> nodes;
+	core::array<scene::ISceneNode *> attached;
+	for (u32 i = 0; i < frames.size(); ++i) {
+		scene::IAnimatedMeshSceneNode *node = smgr->addAnimatedMeshSceneNode(mesh);
+		node->setFrameLoop(0, (s32)LastFrame);
+		node->setAnimationSpeed(0.f);
+		node->setCurrentFrame(frames[i]);
+		node->setAutomaticCulling(scene::EAC_OFF);
+		node->setJointMode(scene::EJUOR_READ);
+		scene::ISceneNode *child = smgr->addEmptySceneNode(node->getJointNode("upper"));
+		child->setPosition(core::vector3df(0.f, 1.f, 0.f));
+		nodes.push_back(node);
+		attached.push_back(child);
+	}
+
+	smgr->drawAll();
+
+	positions.set_used(0);
+	for (u32 i = 0; i < nodes.size(); ++i) {
+		positions.push_back(nodes[i]->getJointNode("upper")->getAbsolutePosition());
+		positions.push_back(attached[i]->getAbsolutePosition());
+		nodes[i]->remove();
+	}
+
+	smgr->getParameters()->setAttribute(scene::ANIMATION_THREADS, 0);
+}
+
+static void testReadJoints(scene::ISceneManager *smgr)
+{
+	CSkinnedMesh *mesh = createStrip(smgr, 8);
+	mesh->setPoseCacheSize(4);
+
+	core::array<f32> frames;
+	frames.push_back(1.f);
+	frames.push_back(2.f);
+	frames.push_back(3.f);
+	frames.push_back(2.f);
+
+	core::array<core::vector3df> serial, threaded;
+	drawReadingJoints(smgr, mesh, frames, 0, serial);
+	drawReadingJoints(smgr, mesh, frames, 2, threaded);
+
+	bool ok = true;
+	for (u32 i = 0; i < frames.size(); ++i)
+		ok &= serial[i * 2].getDistanceFrom(core::vector3df(frames[i], 4.f, 0.f)) < 1e-4f;
+	check(ok, "joints read back from the mesh");
+
+	ok = serial.size() == threaded.size();
+	for (u32 i = 0; ok && i < serial.size(); ++i)
+		ok &= serial[i].getDistanceFrom(threaded[i]) < 1e-4f;
+	check(ok, "joints read back after skinning on worker threads");
+
+	mesh->drop();
+}
+
+// A chain of joints with long position and rotation tracks, keyed at every
+// frame, and no vertices
+static CSkinnedMesh *createTracks(scene::ISceneManager *smgr, u32 jointCount, u32 keyCount)
+{
+	CSkinnedMesh *mesh = static_cast<CSkinnedMesh *>(smgr->createSkinnedMesh());
+	scene::ISkinnedMesh::SJoint *parent = 0;
+	for (u32 j = 0; j < jointCount; ++j) {
+		scene::ISkinnedMesh::SJoint *joint = mesh->addJoint(parent);
+		for (u32 k = 0; k < keyCount; ++k) {
+			scene::ISkinnedMesh::SPositionKey *position = mesh->addPositionKey(joint);
+			position->frame = (f32)k;
+			position->position.set((f32)(k * k % 7), (f32)j, (f32)k);
+			scene::ISkinnedMesh::SRotationKey *rotation = mesh->addRotationKey(joint);
+			rotation->frame = (f32)k;
+			rotation->rotation.set(0.f, (f32)(k % 5), 0.f);
+		}
+		parent = joint;
+	}
+	mesh->finalize();
+	return mesh;
+}
+
+// position of a track at a frame by a linear search
+static core::vector3df interpolate(const core::array<scene::ISkinnedMesh::SPositionKey> &keys, f32 frame)
+{
+	u32 k = 0;
+	while (keys[k].frame < frame)
+		++k;
+	if (k == 0)
+		return keys[0].position;
+	const f32 t = (frame - keys[k - 1].frame) / (keys[k].frame - keys[k - 1].frame);
+	return keys[k - 1].position.getInterpolated(keys[k].position, 1.f - t);
+}
+
+static void testEditedKeys(scene::ISceneManager *smgr)
+{
+	const u32 keyCount = 32;
+	CSkinnedMesh *mesh = createTracks(smgr, 1, keyCount);
+	scene::ISkinnedMesh::SJoint *joint = mesh->getAllJoints()[0];
+	const f32 last = (f32)(keyCount - 1);
+
+	bool ok = true;
+	for (f32 frame : {20.f, 3.5f, 27.25f, 0.f, last}) {
+		mesh->animateMesh(frame, 1.f);
+		ok &= joint->Animatedposition.getDistanceFrom(interpolate(joint->PositionKeys, frame)) < 1e-4f;
+	}
+	check(ok, "keys found through the index");
+
+	// crowd the keys towards the end without changing their number, so the
+	// index built by finalize() starts searching behind the right key
+	for (u32 k = 0; k < keyCount; ++k)
+		joint->PositionKeys[k].frame = last - (last - k) * (last - k) / last;
+
+	ok = true;
+	for (f32 frame : {20.f, 3.5f, 27.25f, 10.f, 0.f, last}) {
+		mesh->animateMesh(frame, 1.f);
+		ok &= joint->Animatedposition.getDistanceFrom(interpolate(joint->PositionKeys, frame)) < 1e-4f;
+	}
+	check(ok, "keys found after editing them in place");
+
+	mesh->drop();
+}
+
+// animates and skins both meshes and compares the skinned vertices
+static bool samePose(CSkinnedMesh *a, f32 frameA, CSkinnedMesh *b, f32 frameB, f32 tolerance)
+{
+	core::array<SPose> poseA, poseB;
+	a->animateMesh(frameA, 1.f);
+	a->skinMesh();
+	getPose(a, poseA);
+	b->animateMesh(frameB, 1.f);
+	b->skinMesh();
+	getPose(b, poseB);
+
+	for (u32 v = 0; v < poseA[0].Pos.size(); ++v)
+		if (poseA[0].Pos[v].getDistanceFrom(poseB[0].Pos[v]) > tolerance)
+			return false;
+	return true;
+}
+
+static void testBakedAnimation(scene::ISceneManager *smgr)
+{
+	CSkinnedMesh *mesh = createStrip(smgr, 8);
+	CSkinnedMesh *reference = createStrip(smgr, 8);
+
+	check(!mesh->bakeAnimation(5.f, 2.f), "no empty range baked");
+	check(mesh->bakeAnimation(0.f, LastFrame), "animation baked");
+	bool ok = true;
+	for (f32 frame : {0.f, 1.f, 7.f, LastFrame})
+		ok &= samePose(mesh, frame, reference, frame, 1e-4f);
+	check(ok, "baked frames match the keys");
+	check(samePose(mesh, 2.4f, reference, 2.f, 1e-4f) && samePose(mesh, 2.6f, reference, 3.f, 1e-4f),
+			"frames rounded to the nearest sample");
+
+	check(mesh->bakeAnimation(2.f, 6.f, 4.f), "animation baked at 4 samples per frame");
+	check(samePose(mesh, 2.25f, reference, 2.25f, 1e-4f), "samples between frames");
+	check(samePose(mesh, 8.f, reference, 8.f, 1e-4f), "frames outside the baked range interpolated");
+
+	// 16 bit floats keep about three decimal digits
+	check(mesh->bakeAnimation(0.f, LastFrame, 1.f, true), "animation baked in half precision");
+	ok = true;
+	for (f32 frame : {0.f, 3.f, 9.f})
+		ok &= samePose(mesh, frame, reference, frame, 0.02f);
+	check(ok, "half precision frames match the keys");
+
+	mesh->clearBakedAnimation();
+	check(samePose(mesh, 2.4f, reference, 2.4f, 1e-4f), "keys interpolated after clearing the table");
+
+	// poses cached before baking or clearing the table are skinned again
+	mesh->setPoseCacheSize(2);
+	mesh->getSkinnedPose(2.4f, 1.f, 100);
+	mesh->bakeAnimation(0.f, LastFrame);
+	check(sameBox(mesh->getSkinnedPose(2.4f, 1.f, 200)->getBoundingBox(), getPoseBox(reference, 2.f)),
+			"cached pose replaced by the baked one");
+	mesh->clearBakedAnimation();
+	check(sameBox(mesh->getSkinnedPose(2.4f, 1.f, 300)->getBoundingBox(), getPoseBox(reference, 2.4f)),
+			"cached pose replaced after clearing the table");
+
+	mesh->drop();
+	reference->drop();
+}
+
+static void testSharedPoses(scene::ISceneManager *smgr)
+{
+	CSkinnedMesh *mesh = createStrip(smgr, 8);
+	CSkinnedMesh *reference = createStrip(smgr, 8);
+	mesh->setPoseCacheSize(2);
+
+	// poses handed out during a frame stay until the frame ends
+	const core::aabbox3df meshBox = mesh->getBoundingBox();
+	scene::IMesh *first = mesh->getSkinnedPose(1.f, 1.f, 100);
+	scene::IMesh *second = mesh->getSkinnedPose(2.f, 1.f, 100);
+	check(sameBox(mesh->getBoundingBox(), meshBox), "box of the mesh kept when skinning poses");
+	scene::IMesh *third = mesh->getSkinnedPose(3.f, 1.f, 100);
+	check(first != second && first != mesh && second != mesh, "poses cached");
+	check(third == mesh && sameBox(mesh->getBoundingBox(), getPoseBox(reference, 3.f)), "skinned in place when all poses are in use");
+	check(sameBox(first->getBoundingBox(), getPoseBox(reference, 1.f)) &&
+					sameBox(second->getBoundingBox(), getPoseBox(reference, 2.f)),
+			"poses in use are kept");
+	check(mesh->getSkinnedPose(2.f, 1.f, 100) == second, "nodes in the same pose share it");
+	check(first->getMeshType() != scene::EAMT_SKINNED, "a pose is no skinned mesh");
+	check(mesh->getSkinnedPose(3.f, 1.f, 200) != mesh, "poses are free again in the next frame");
+
+	core::array<f32> frames;
+	frames.push_back(1.f);
+	frames.push_back(2.f);
+	frames.push_back(3.f);
+	frames.push_back(2.f);
+	checkNodes(smgr, mesh, reference, frames, "nodes sharing a mesh with fewer poses than frames");
+
+	mesh->setPoseCacheSize(4);
+	checkNodes(smgr, mesh, reference, frames, "nodes sharing a mesh with a pose for every frame");
+
+	mesh->drop();
+	reference->drop();
+}
+
+// cached poses skinned with other settings than the current ones are dropped
+static void testPoseCacheInvalidation(scene::ISceneManager *smgr)
+{
+	CSkinnedMesh *mesh = createStrip(smgr, 8);
+	mesh->setPoseCacheSize(2);
+
+	// same joints, but the root moves the other way
+	CSkinnedMesh *other = createStrip(smgr, 8);
+	other->getAllJoints()[0]->PositionKeys[1].position.set(-LastFrame, 0.f, 0.f);
+	const core::aabbox3df otherBox = getPoseBox(other, 5.f);
+
+	const core::aabbox3df before = mesh->getSkinnedPose(5.f, 1.f, 100)->getBoundingBox();
+	check(mesh->useAnimationFrom(other), "animation of the other mesh used");
+	scene::IMesh *pose = mesh->getSkinnedPose(5.f, 1.f, 200);
+	check(!sameBox(pose->getBoundingBox(), before) && sameBox(pose->getBoundingBox(), otherBox),
+			"pose skinned again after switching the animation");
+
+	other->setInterpolationMode(scene::EIM_CONSTANT);
+	mesh->setInterpolationMode(scene::EIM_CONSTANT);
+	pose = mesh->getSkinnedPose(5.f, 1.f, 300);
+	check(sameBox(pose->getBoundingBox(), getPoseBox(other, 5.f)) && !sameBox(pose->getBoundingBox(), otherBox),
+			"pose skinned again after changing the interpolation");
+
+	mesh->drop();
+	other->drop();
+}
+
+// microseconds per frame of animating and skinning the mesh, and of the
+// weight by weight reference
+static void benchmarkMesh(CSkinnedMesh *mesh, const char *name)
+{
+	const u32 frameCount = 200;
+	const f32 lastFrame = core::max_((f32)mesh->getFrameCount() - 1.f, 1.f);
+	core::array<SPose> bind, out;
+	getPose(mesh, bind);
+
+	u32 vertices = 0;
+	for (u32 b = 0; b < bind.size(); ++b)
+		vertices += bind[b].Pos.size();
+
+	std::chrono::steady_clock::duration skinning{}, reference{};
+	for (u32 i = 0; i < frameCount; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		mesh->animateMesh(lastFrame * i / frameCount, 1.f);
+		mesh->skinMesh();
+		auto skinned = std::chrono::steady_clock::now();
+		skinReference(mesh, bind, out);
+		reference += std::chrono::steady_clock::now() - skinned;
+		skinning += skinned - start;
+	}
+
+	printf("%s: %u joints, %u vertices: %.2f us animating and skinning, %.2f us skinning weight by weight\n",
+			name, mesh->getJointCount(), vertices,
+			std::chrono::duration<double, std::micro>(skinning).count() / frameCount,
+			std::chrono::duration<double, std::micro>(reference).count() / frameCount);
+}
+
+// microseconds per frame of animating the mesh at random frames or when
+// playing it
+static double timeAnimation(CSkinnedMesh *mesh, bool random)
+{
+	const u32 frameCount = 2000;
+	const f32 lastFrame = core::max_((f32)mesh->getFrameCount() - 1.f, 1.f);
+
+	u32 seed = 1;
+	auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < frameCount; ++i) {
+		seed = seed * 1103515245 + 12345;
+		const f32 frame = random ? lastFrame * (seed >> 8) / (1 << 24) : lastFrame * i / frameCount;
+		mesh->animateMesh(frame, 1.f);
+	}
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frameCount;
+}
+
+static void benchmarkSeeking(CSkinnedMesh *mesh, const char *name)
+{
+	printf("%s: %u joints: %.2f us animating at random frames, %.2f us playing\n",
+			name, mesh->getJointCount(), timeAnimation(mesh, true), timeAnimation(mesh, false));
+}
+
+// cost of interpolating and of reading baked samples, and the table size
+static void benchmarkBaking(CSkinnedMesh *mesh, const char *name)
+{
+	const f32 lastFrame = core::max_((f32)mesh->getFrameCount() - 1.f, 1.f);
+	const u32 samples = core::floor32(lastFrame) + 1;
+
+	const double interpolated = timeAnimation(mesh, true);
+	mesh->bakeAnimation(0.f, lastFrame);
+	const double baked = timeAnimation(mesh, true);
+	mesh->bakeAnimation(0.f, lastFrame, 1.f, true);
+	const double bakedHalf = timeAnimation(mesh, true);
+	mesh->clearBakedAnimation();
+
+	printf("%s: %u joints: %.2f us interpolating, %.2f us baked (%u bytes), %.2f us baked in half precision (%u bytes)\n",
+			name, mesh->getJointCount(), interpolated,
+			baked, samples * mesh->getJointCount() * 40,
+			bakedHalf, samples * mesh->getJointCount() * 20);
+}
+
+static void benchmark(IrrlichtDevice *device, int argc, char *argv[])
+{
+	scene::ISceneManager *smgr = device->getSceneManager();
+	CSkinnedMesh *strip = createStrip(smgr, 10000);
+	benchmarkMesh(strip, "synthetic strip");
+	strip->drop();
+
+	for (u32 keyCount : {30, 300, 3000}) {
+		CSkinnedMesh *tracks = createTracks(smgr, 64, keyCount);
+		c8 name[64];
+		snprintf(name, sizeof(name), "synthetic tracks of %u keys", keyCount);
+		benchmarkSeeking(tracks, name);
+		benchmarkBaking(tracks, name);
+		tracks->drop();
+	}
+
+	for (int i = 1; i < argc; ++i) {
+		if (argv[i][0] == '-')
+			continue;
+		io::IReadFile *file = device->getFileSystem()->createAndOpenFile(argv[i]);
+		scene::IAnimatedMesh *mesh = file ? smgr->getMesh(file) : 0;
+		if (file)
+			file->drop();
+		if (!mesh || mesh->getMeshType() != scene::EAMT_SKINNED) {
+			printf("%s is no skinned mesh\n", argv[i]);
+			continue;
+		}
+		benchmarkMesh(static_cast<CSkinnedMesh *>(mesh), argv[i]);
+		benchmarkSeeking(static_cast<CSkinnedMesh *>(mesh), argv[i]);
+		benchmarkBaking(static_cast<CSkinnedMesh *>(mesh), argv[i]);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_ERROR;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	scene::ISceneManager *smgr = device->getSceneManager();
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 5.f, -40.f), core::vector3df(0.f, 5.f, 0.f));
+
+	if (isBenchmark(argc, argv)) {
+		benchmark(device, argc, argv);
+	} else {
+		testSkinning(smgr);
+		testSharedPoses(smgr);
+		testPoseCacheInvalidation(smgr);
+		testReadJoints(smgr);
+		testEditedKeys(smgr);
+		testBakedAnimation(smgr);
+	}
+
+	device->drop();
+
+	return testResult();
+}
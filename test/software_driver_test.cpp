@@ -0,0 +1,237 @@
+#include <cstdio>
+#include <cstdlib>
+#include <irrlicht.h>
+
+#include "test_check.h"
+
+using namespace irr;
+
+// Renders small scenes with the software driver and checks single pixels
+
+static bool near(video::SColor a, video::SColor b, u32 tolerance = 2)
+{
+	return (u32)abs((s32)a.getRed() - (s32)b.getRed()) <= tolerance &&
+		   (u32)abs((s32)a.getGreen() - (s32)b.getGreen()) <= tolerance &&
+		   (u32)abs((s32)a.getBlue() - (s32)b.getBlue()) <= tolerance;
+}
+
+static video::SColor pixel(video::IVideoDriver *driver, u32 x, u32 y)
+{
+	video::IImage *shot = driver->createScreenShot();
+	const video::SColor color = shot->getPixel(x, y);
+	shot->drop();
+	return color;
+}
+
+static const video::SColor blue(255, 0, 0, 255);
+static const video::SColor red(255, 255, 0, 0);
+static const video::SColor green(255, 0, 255, 0);
+static const video::SColor white(255, 255, 255, 255);
+
+static void test2D(video::IVideoDriver *driver)
+{
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, blue);
+	driver->draw2DRectangle(red, core::recti(10, 10, 30, 30));
+	driver->draw2DRectangle(video::SColor(128, 255, 255, 255), core::recti(40, 0, 64, 10));
+	const core::recti clip(0, 40, 10, 60);
+	driver->draw2DRectangle(green, core::recti(0, 40, 20, 60), &clip);
+	driver->endScene();
+
+	check(near(pixel(driver, 20, 20), red), "rectangle filled");
+	check(near(pixel(driver, 10, 10), red) && near(pixel(driver, 29, 29), red), "rectangle corners");
+	check(near(pixel(driver, 30, 30), blue) && near(pixel(driver, 9, 20), blue), "nothing drawn outside");
+	check(near(pixel(driver, 50, 5), video::SColor(255, 128, 128, 255)), "alpha blended rectangle");
+	check(near(pixel(driver, 5, 50), green) && near(pixel(driver, 15, 50), blue), "clip rectangle");
+
+	// 2x2 texture scaled up to 4x4 pixels per texel
+	video::IImage *image = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(2, 2));
+	image->setPixel(0, 0, red);
+	image->setPixel(1, 0, green);
+	image->setPixel(0, 1, white);
+	image->setPixel(1, 1, video::SColor(0, 0, 0, 0));
+	video::ITexture *texture = driver->addTexture("checker", image);
+	image->drop();
+
+	driver->beginScene(video::ECBF_COLOR, blue);
+	driver->draw2DImage(texture, core::recti(8, 8, 16, 16), core::recti(0, 0, 2, 2), 0, 0, true);
+	driver->endScene();
+
+	check(near(pixel(driver, 9, 9), red) && near(pixel(driver, 14, 9), green), "texture upper row");
+	check(near(pixel(driver, 9, 14), white), "texture lower row");
+	check(near(pixel(driver, 14, 14), blue), "transparent texel blended");
+}
+
+static void test3D(video::IVideoDriver *driver)
+{
+	core::matrix4 projection, view;
+	projection.buildProjectionMatrixPerspectiveFovLH(core::PI / 2.f, 1.f, 1.f, 100.f, false);
+	view.buildCameraLookAtMatrixLH(core::vector3df(0, 0, -5), core::vector3df(0, 0, 0), core::vector3df(0, 1, 0));
+	driver->setTransform(video::ETS_PROJECTION, projection);
+	driver->setTransform(video::ETS_VIEW, view);
+	driver->setTransform(video::ETS_WORLD, core::matrix4());
+
+	video::SMaterial material;
+	material.Lighting = false;
+	driver->setMaterial(material);
+
+	// clockwise when seen from the camera, which is the front side
+	video::S3DVertex front[3] = {
+			video::S3DVertex(-2, -1, 0, 0, 0, -1, red, 0, 0),
+			video::S3DVertex(0, 2, 0, 0, 0, -1, red, 0, 0),
+			video::S3DVertex(2, -1, 0, 0, 0, -1, red, 0, 0),
+		};
+	video::S3DVertex behind[3] = {
+			video::S3DVertex(-4, -4, 2, 0, 0, -1, green, 0, 0),
+			video::S3DVertex(0, 4, 2, 0, 0, -1, green, 0, 0),
+			video::S3DVertex(4, -4, 2, 0, 0, -1, green, 0, 0),
+		};
+	const u16 indices[3] = {0, 1, 2};
+	const u16 reversed[3] = {0, 2, 1};
+
+	// the triangle behind is drawn last, the depth test keeps the front one
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, blue);
+	driver->drawIndexedTriangleList(front, 3, indices, 1);
+	driver->drawIndexedTriangleList(behind, 3, indices, 1);
+	driver->endScene();
+
+	check(near(pixel(driver, 32, 32), red), "depth test");
+	check(near(pixel(driver, 20, 40), green), "triangle behind visible around the front one");
+	check(near(pixel(driver, 1, 1), blue), "background");
+
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, blue);
+	driver->drawIndexedTriangleList(front, 3, reversed, 1);
+	driver->endScene();
+	check(near(pixel(driver, 32, 32), blue), "back face culled");
+
+	material.BackfaceCulling = false;
+	driver->setMaterial(material);
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, blue);
+	driver->drawIndexedTriangleList(front, 3, reversed, 1);
+	driver->endScene();
+	check(near(pixel(driver, 32, 32), red), "back face drawn without culling");
+
+	// a triangle crossing the near plane is clipped instead of dropped
+	video::S3DVertex crossing[3] = {
+			video::S3DVertex(-2, -1, -10, 0, 0, -1, white, 0, 0),
+			video::S3DVertex(0, 2, 5, 0, 0, -1, white, 0, 0),
+			video::S3DVertex(2, -1, 5, 0, 0, -1, white, 0, 0),
+		};
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, blue);
+	driver->drawIndexedTriangleList(crossing, 3, indices, 1);
+	driver->endScene();
+	check(near(pixel(driver, 32, 32), white), "near plane clipping");
+}
+
+// EMT_ONETEXTURE_BLEND uses the blend functions packed into MaterialTypeParam,
+// expects the transforms of test3D
+static void testBlendFunctions(video::IVideoDriver *driver)
+{
+	const video::SColor gray(255, 128, 128, 128);
+	video::S3DVertex quad[4] = {
+			video::S3DVertex(-2, -2, 0, 0, 0, -1, red, 0, 0),
+			video::S3DVertex(-2, 2, 0, 0, 0, -1, red, 0, 0),
+			video::S3DVertex(2, 2, 0, 0, 0, -1, red, 0, 0),
+			video::S3DVertex(2, -2, 0, 0, 0, -1, red, 0, 0),
+		};
+	const u16 indices[6] = {0, 1, 2, 0, 2, 3};
+
+	video::SMaterial solid;
+	solid.Lighting = false;
+	video::SMaterial blend = solid;
+	blend.MaterialType = video::EMT_ONETEXTURE_BLEND;
+
+	auto drawBlended = [&](video::E_BLEND_FACTOR src, video::E_BLEND_FACTOR dst, video::SColor color,
+			u32 alphaSource = video::EAS_TEXTURE) {
+		driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, blue);
+		driver->setMaterial(solid);
+		driver->drawIndexedTriangleList(quad, 4, indices, 2);
+		for (video::S3DVertex &v : quad)
+			v.Color = color;
+		blend.MaterialTypeParam = video::pack_textureBlendFunc(src, dst, video::EMFN_MODULATE_1X, alphaSource);
+		driver->setMaterial(blend);
+		driver->drawIndexedTriangleList(quad, 4, indices, 2);
+		driver->endScene();
+		for (video::S3DVertex &v : quad)
+			v.Color = red;
+	};
+
+	drawBlended(video::EBF_ONE, video::EBF_ONE, green);
+	check(near(pixel(driver, 32, 32), video::SColor(255, 255, 255, 0)), "additive blending");
+
+	drawBlended(video::EBF_DST_COLOR, video::EBF_ZERO, gray);
+	check(near(pixel(driver, 32, 32), video::SColor(255, 128, 0, 0)), "multiplicative blending");
+
+	// without a texture the texture alpha is 1
+	const video::SColor quarterGreen(64, 0, 255, 0);
+	drawBlended(video::EBF_SRC_ALPHA, video::EBF_ONE_MINUS_SRC_ALPHA, quarterGreen);
+	check(near(pixel(driver, 32, 32), green), "alpha of the texture");
+	drawBlended(video::EBF_SRC_ALPHA, video::EBF_ONE_MINUS_SRC_ALPHA, quarterGreen, video::EAS_VERTEX_COLOR);
+	check(near(pixel(driver, 32, 32), video::SColor(255, 191, 64, 0)), "alpha of the vertex colors");
+}
+
+// a texture removed during the frame is sampled before it's gone
+static void testRemovedTexture(video::IVideoDriver *driver)
+{
+	video::IImage *image = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(2, 2));
+	image->fill(green);
+	video::ITexture *texture = driver->addTexture("removed", image);
+	image->drop();
+
+	driver->beginScene(video::ECBF_COLOR, blue);
+	driver->draw2DImage(texture, core::recti(8, 8, 16, 16), core::recti(0, 0, 2, 2));
+	driver->removeTexture(texture);
+	driver->draw2DRectangle(red, core::recti(20, 8, 28, 16));
+	driver->endScene();
+
+	check(near(pixel(driver, 12, 12), green), "texture drawn before its removal");
+	check(near(pixel(driver, 24, 12), red), "drawing goes on after the removal");
+}
+
+// a resize during the frame finishes the old size and draws at the new one
+static void testResize(video::IVideoDriver *driver)
+{
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, blue);
+	driver->draw2DRectangle(red, core::recti(0, 0, 64, 64));
+	driver->OnResize(core::dimension2du(160, 96));
+	driver->draw2DRectangle(green, core::recti(120, 70, 150, 90));
+	driver->endScene();
+
+	video::IImage *shot = driver->createScreenShot();
+	check(shot->getDimension() == core::dimension2du(160, 96), "screenshot of the new size");
+	shot->drop();
+	check(near(pixel(driver, 130, 80), green), "drawn in the resized area");
+
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, blue);
+	driver->draw2DRectangle(red, core::recti(100, 0, 160, 96));
+	driver->endScene();
+	check(near(pixel(driver, 150, 50), red) && near(pixel(driver, 50, 50), blue), "next frame at the new size");
+
+	driver->OnResize(core::dimension2du(64, 64));
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_SOFTWARE;
+	p.WindowSize = core::dimension2du(64, 64);
+	p.LoggingLevel = ELL_ERROR;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no software device\n");
+		return 1;
+	}
+
+	video::IVideoDriver *driver = device->getVideoDriver();
+	check(driver->getDriverType() == video::EDT_SOFTWARE, "driver type");
+
+	test2D(driver);
+	test3D(driver);
+	testBlendFunctions(driver);
+	testRemovedTexture(driver);
+	testResize(driver);
+
+	device->drop();
+
+	return testResult();
+}
@@ -0,0 +1,175 @@
+#include <cstdio>
+#include <vector>
+#include <irrlicht.h>
+
+#include "test_check.h"
+
+using namespace irr;
+
+// Renders scenes through the sorted solid pass of the scene manager and
+// checks the draw order and the state changes counted by the driver.
+
+static std::vector<s32> RenderOrder;
+
+// solid node which renders itself and records the order
+class COrderNode : public scene::ISceneNode
+{
+public:
+	COrderNode(scene::ISceneManager *smgr, s32 id, const core::vector3df &position, video::ITexture *texture) :
+			scene::ISceneNode(smgr->getRootSceneNode(), smgr, id, position),
+			Box(-1.f, -1.f, -1.f, 1.f, 1.f, 1.f)
+	{
+		Material.setTexture(0, texture);
+		setAutomaticCulling(scene::EAC_OFF);
+	}
+
+	void OnRegisterSceneNode() override
+	{
+		if (IsVisible)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+		ISceneNode::OnRegisterSceneNode();
+	}
+
+	void render() override { RenderOrder.push_back(getID()); }
+
+	const core::aabbox3d<f32> &getBoundingBox() const override { return Box; }
+	u32 getMaterialCount() const override { return 1; }
+	video::SMaterial &getMaterial(u32 num) override { return Material; }
+
+private:
+	core::aabbox3df Box;
+	video::SMaterial Material;
+};
+
+static video::ITexture *createTexture(video::IVideoDriver *driver, const io::path &name)
+{
+	video::IImage *image = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(4, 4));
+	image->fill(video::SColor(255, 255, 255, 255));
+	video::ITexture *texture = driver->addTexture(name, image);
+	image->drop();
+	return texture;
+}
+
+static scene::SMesh *createTriangle()
+{
+	scene::SMesh *mesh = new scene::SMesh();
+	scene::SMeshBuffer *buffer = new scene::SMeshBuffer();
+	for (u32 i = 0; i < 3; ++i)
+		buffer->Vertices.push_back(video::S3DVertex((f32)i, (f32)(i % 2), 0.f, 0.f, 0.f, -1.f, video::SColor(255, 255, 255, 255), 0.f, 0.f));
+	for (u16 i = 0; i < 3; ++i)
+		buffer->Indices.push_back(i);
+	buffer->recalculateBoundingBox();
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+	mesh->recalculateBoundingBox();
+	return mesh;
+}
+
+static void drawFrame(scene::ISceneManager *smgr)
+{
+	video::IVideoDriver *driver = smgr->getVideoDriver();
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+}
+
+static void testOrder(scene::ISceneManager *smgr, video::ITexture *a, video::ITexture *b)
+{
+	// ids: texture a 1x, texture b 2x, ordered by distance within each
+	const f32 distances[] = {30.f, 10.f, 20.f};
+	core::array<scene::ISceneNode *> nodes;
+	for (u32 i = 0; i < 3; ++i) {
+		nodes.push_back(new COrderNode(smgr, 10 + (s32)distances[i] / 10, core::vector3df(0.f, 0.f, distances[i]), a));
+		nodes.push_back(new COrderNode(smgr, 20 + (s32)distances[i] / 10, core::vector3df(0.f, 0.f, distances[i]), b));
+	}
+
+	RenderOrder.clear();
+	drawFrame(smgr);
+
+	// the texture decides which group comes first
+	std::vector<s32> expected = {11, 12, 13, 21, 22, 23};
+	if (RenderOrder.size() == 6 && RenderOrder[0] >= 20)
+		expected = {21, 22, 23, 11, 12, 13};
+	check(RenderOrder == expected, "solid nodes grouped by texture and drawn front to back");
+
+	for (u32 i = 0; i < nodes.size(); ++i) {
+		nodes[i]->remove();
+		nodes[i]->drop();
+	}
+}
+
+static void testStateChanges(scene::ISceneManager *smgr, video::ITexture *a, video::ITexture *b)
+{
+	scene::SMesh *mesh = createTriangle();
+
+	// alternating textures, which take a texture change per node unsorted
+	core::array<scene::ISceneNode *> nodes;
+	for (u32 i = 0; i < 40; ++i) {
+		scene::IMeshSceneNode *node = smgr->addMeshSceneNode(mesh, 0, -1, core::vector3df(0.f, 0.f, 5.f + i * 0.5f));
+		node->setAutomaticCulling(scene::EAC_OFF);
+		node->getMaterial(0).setTexture(0, i % 2 ? a : b);
+		nodes.push_back(node);
+	}
+
+	drawFrame(smgr);
+	const video::SFrameStats &stats = smgr->getVideoDriver()->getFrameStats();
+	check(stats.DrawCalls == 40, "every mesh buffer drawn");
+	check(stats.TextureChanges <= 2, "one texture change per texture");
+	check(stats.MaterialChanges <= 2, "one material change per texture");
+
+	for (u32 i = 0; i < nodes.size(); ++i)
+		nodes[i]->remove();
+	mesh->drop();
+}
+
+// the solid buffer is drawn directly, the transparent one by render()
+static void testMixedNode(scene::ISceneManager *smgr)
+{
+	scene::SMesh *mesh = createTriangle();
+	scene::SMesh *second = createTriangle();
+	mesh->addMeshBuffer(second->getMeshBuffer(0));
+	second->drop();
+
+	scene::IMeshSceneNode *node = smgr->addMeshSceneNode(mesh, 0, -1, core::vector3df(0.f, 0.f, 10.f));
+	node->setAutomaticCulling(scene::EAC_OFF);
+	node->getMaterial(1).MaterialType = video::EMT_TRANSPARENT_VERTEX_ALPHA;
+
+	drawFrame(smgr);
+	check(smgr->getVideoDriver()->getFrameStats().DrawCalls == 2, "solid and transparent buffers of a node drawn once");
+
+	node->remove();
+	mesh->drop();
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_ERROR;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	scene::ISceneManager *smgr = device->getSceneManager();
+	video::IVideoDriver *driver = device->getVideoDriver();
+	video::ITexture *a = createTexture(driver, "a");
+	video::ITexture *b = createTexture(driver, "b");
+
+	// depth buckets are a fraction of the far value
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 0.f, 0.f), core::vector3df(0.f, 0.f, 1.f))->setFarValue(40.f);
+
+	testOrder(smgr, a, b);
+
+	// near nodes still get buckets of their own with a usual far value
+	smgr->getActiveCamera()->setFarValue(10000.f);
+	testOrder(smgr, a, b);
+	testStateChanges(smgr, a, b);
+	testMixedNode(smgr);
+
+	device->drop();
+
+	return testResult();
+}
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <irrlicht.h>
+
+#include "test_check.h"
+#include "CMeshSceneNode.h"
+#include "CSceneNodeOctree.h"
+
+using namespace irr;
+
+// Checks the nodes registered through the spatial index of the scene manager
+// against culling every node on its own, while the scene changes. Run with
+// --benchmark to time registration against the number of nodes in view.
+
+static std::vector<s32> Registered;
+static u32 AnimateCount = 0;
+
+// mesh node which records which nodes register and get animated
+class CRecordingNode : public scene::CMeshSceneNode
+{
+public:
+	CRecordingNode(scene::IMesh *mesh, scene::ISceneManager *smgr, s32 id, const core::vector3df &position) :
+			scene::CMeshSceneNode(mesh, smgr->getRootSceneNode(), smgr, id, position)
+	{
+	}
+
+	void OnRegisterSceneNode() override
+	{
+		if (IsVisible && !SceneManager->isCulled(this))
+			Registered.push_back(getID());
+		scene::CMeshSceneNode::OnRegisterSceneNode();
+	}
+
+	void OnAnimate(u32 timeMs) override
+	{
+		++AnimateCount;
+		scene::CMeshSceneNode::OnAnimate(timeMs);
+	}
+};
+
+static u32 Seed = 1;
+
+static f32 randomFloat(f32 low, f32 high)
+{
+	Seed = Seed * 1103515245 + 12345;
+	return low + (high - low) * ((Seed >> 8) & 0xffff) / 65535.f;
+}
+
+static scene::SMesh *createCube(f32 size)
+{
+	scene::SMesh *mesh = new scene::SMesh();
+	scene::SMeshBuffer *buffer = new scene::SMeshBuffer();
+	for (u32 i = 0; i < 8; ++i) {
+		buffer->Vertices.push_back(video::S3DVertex(i & 1 ? size : -size, i & 2 ? size : -size, i & 4 ? size : -size,
+				0.f, 0.f, -1.f, video::SColor(255, 255, 255, 255), 0.f, 0.f));
+	}
+	for (u16 i = 0; i < 6; ++i)
+		buffer->Indices.push_back(i);
+	buffer->recalculateBoundingBox();
+	mesh->addMeshBuffer(buffer);
+	buffer->drop();
+	mesh->recalculateBoundingBox();
+	return mesh;
+}
+
+static core::vector3df randomPosition(f32 range)
+{
+	return core::vector3df(randomFloat(-range, range), randomFloat(-range, range), randomFloat(-range, range));
+}
+
+static void drawFrame(scene::ISceneManager *smgr)
+{
+	video::IVideoDriver *driver = smgr->getVideoDriver();
+	Registered.clear();
+	AnimateCount = 0;
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+}
+
+// The nodes which cull themselves, and which the index rejects when their
+// boxes are completely outside of the frustum. Nodes with children or without
+// culling aren't indexed.
+static std::vector<s32> getExpected(scene::ISceneManager *smgr, const core::array<scene::ISceneNode *> &nodes, bool indexed)
+{
+	const scene::SViewFrustum &frustum = *smgr->getActiveCamera()->getViewFrustum();
+	std::vector<s32> expected;
+	for (u32 i = 0; i < nodes.size(); ++i) {
+		scene::ISceneNode *node = nodes[i];
+		if (!node->isVisible() || smgr->isCulled(node))
+			continue;
+
+		if (indexed && node->getAutomaticCulling() != scene::EAC_OFF && node->getChildren().empty()) {
+			const core::aabbox3df box = node->getTransformedBoundingBox();
+			bool outside = false;
+			for (u32 p = 0; p < scene::SViewFrustum::VF_PLANE_COUNT; ++p)
+				outside |= box.classifyPlaneRelation(frustum.planes[p]) == core::ISREL3D_FRONT;
+			if (outside)
+				continue;
+		}
+		expected.push_back(node->getID());
+	}
+	std::sort(expected.begin(), expected.end());
+	return expected;
+}
+
+static bool registeredAsExpected(scene::ISceneManager *smgr, const core::array<scene::ISceneNode *> &nodes, bool indexed = true)
+{
+	std::sort(Registered.begin(), Registered.end());
+	return Registered == getExpected(smgr, nodes, indexed);
+}
+
+static void testChangingScene(scene::ISceneManager *smgr, scene::ICameraSceneNode *camera)
+{
+	scene::SMesh *small = createCube(1.f);
+	scene::SMesh *large = createCube(20.f);
+
+	s32 nextId = 0;
+	core::array<scene::ISceneNode *> nodes;
+	for (u32 i = 0; i < 2000; ++i)
+		nodes.push_back(new CRecordingNode(small, smgr, nextId++, randomPosition(300.f)));
+
+	smgr->getParameters()->setAttribute(scene::SPATIAL_INDEX, true);
+	drawFrame(smgr);
+	check(registeredAsExpected(smgr, nodes), "nodes in view registered after indexing");
+
+	drawFrame(smgr);
+	check(AnimateCount == 0, "unchanged mesh nodes not animated");
+	check(registeredAsExpected(smgr, nodes), "nodes in view registered when nothing changed");
+
+	nodes[0]->setPosition(core::vector3df(0.f, 0.f, 50.f));
+	drawFrame(smgr);
+	check(AnimateCount == 1, "only the moved node animated");
+	check(registeredAsExpected(smgr, nodes), "moved node registered at its new position");
+
+	bool same = true;
+	for (u32 frame = 0; frame < 40; ++frame) {
+		camera->setTarget(randomPosition(100.f));
+
+		for (u32 i = 0; i < 50; ++i)
+			nodes[(u32)randomFloat(0.f, nodes.size() - 1.f)]->setPosition(randomPosition(300.f));
+		nodes[(u32)randomFloat(0.f, nodes.size() - 1.f)]->setScale(core::vector3df(randomFloat(0.5f, 10.f)));
+		nodes[(u32)randomFloat(0.f, nodes.size() - 1.f)]->setRotation(randomPosition(180.f));
+		((scene::IMeshSceneNode *)nodes[(u32)randomFloat(0.f, nodes.size() - 1.f)])->setMesh(frame % 2 ? small : large);
+
+		scene::ISceneNode *changed = nodes[(u32)randomFloat(0.f, nodes.size() - 1.f)];
+		switch (frame % 5) {
+		case 0:
+			changed->setAutomaticCulling(changed->getAutomaticCulling() == scene::EAC_OFF ? scene::EAC_BOX : scene::EAC_OFF);
+			break;
+		case 1:
+			if (changed->getChildren().empty())
+				smgr->addEmptySceneNode(changed);
+			else
+				changed->removeAll();
+			break;
+		case 2:
+			changed->setVisible(!changed->isVisible());
+			break;
+		case 3: {
+			// replace some nodes
+			for (u32 i = 0; i < 20; ++i) {
+				const u32 index = (u32)randomFloat(0.f, nodes.size() - 1.f);
+				nodes[index]->remove();
+				nodes[index]->drop();
+				nodes[index] = new CRecordingNode(small, smgr, nextId++, randomPosition(300.f));
+			}
+			break;
+		}
+		case 4:
+			smgr->getRootSceneNode()->setPosition(randomPosition(20.f));
+			break;
+		}
+
+		drawFrame(smgr);
+		same &= registeredAsExpected(smgr, nodes);
+	}
+	check(same, "nodes in view registered while the scene changes");
+
+	// brute force registration gives the same nodes
+	smgr->getParameters()->setAttribute(scene::SPATIAL_INDEX, false);
+	drawFrame(smgr);
+	check(registeredAsExpected(smgr, nodes, false), "nodes in view registered without the index");
+
+	smgr->getRootSceneNode()->setPosition(core::vector3df(0.f));
+	for (u32 i = 0; i < nodes.size(); ++i) {
+		nodes[i]->remove();
+		nodes[i]->drop();
+	}
+	small->drop();
+	large->drop();
+}
+
+static void testReleasedCells(scene::ISceneManager *smgr)
+{
+	scene::SMesh *mesh = createCube(1.f);
+	scene::CSceneNodeOctree octree;
+
+	core::array<scene::ISceneNode *> nodes;
+	for (u32 i = 0; i < 500; ++i) {
+		scene::ISceneNode *node = new scene::CMeshSceneNode(mesh, 0, smgr, -1, randomPosition(100.f));
+		node->updateAbsolutePosition();
+		octree.update(node);
+		nodes.push_back(node);
+	}
+	const u32 cells = octree.getCellCount();
+
+	// moving the nodes back and forth reuses the cells they left
+	u32 mostCells = 0;
+	for (u32 pass = 0; pass < 10; ++pass) {
+		const core::vector3df offset(pass % 2 ? 0.f : 10000.f, 0.f, 0.f);
+		for (u32 i = 0; i < nodes.size(); ++i) {
+			nodes[i]->setPosition(offset + randomPosition(100.f));
+			nodes[i]->updateAbsolutePosition();
+			octree.update(nodes[i]);
+		}
+		mostCells = core::max_(mostCells, octree.getCellCount());
+	}
+	check(mostCells < cells * 3, "cells released after the nodes left");
+
+	for (u32 i = 0; i < nodes.size(); ++i) {
+		octree.remove(nodes[i]);
+		nodes[i]->drop();
+	}
+	check(octree.getCellCount() == 0, "all cells released with the last node");
+	mesh->drop();
+}
+
+// milliseconds per registration pass of the whole scene, the nodes in view
+// are left in Registered
+static f64 timeRegistration(scene::ISceneManager *smgr)
+{
+	const u32 passes = 20;
+	f64 total = 0.0;
+	for (u32 pass = 0; pass < passes; ++pass) {
+		Registered.clear();
+		const auto start = std::chrono::steady_clock::now();
+		smgr->getRootSceneNode()->OnRegisterSceneNode();
+		total += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+		smgr->clearAllRegisteredNodesForRendering();
+	}
+	return total / passes;
+}
+
+// registration cost against the number of nodes in view, which grows with
+// the far value
+static void benchmark(scene::ISceneManager *smgr)
+{
+	scene::SMesh *mesh = createCube(1.f);
+	core::array<scene::ISceneNode *> nodes;
+	for (u32 i = 0; i < 100000; ++i)
+		nodes.push_back(new CRecordingNode(mesh, smgr, i, randomPosition(1000.f)));
+
+	printf("100000 nodes, milliseconds per registration pass:\n");
+	for (f32 far : {50.f, 100.f, 200.f, 400.f, 800.f, 1600.f}) {
+		smgr->getActiveCamera()->setFarValue(far);
+		f64 times[2];
+		for (u32 index = 0; index < 2; ++index) {
+			smgr->getParameters()->setAttribute(scene::SPATIAL_INDEX, index == 1);
+			// builds the index and updates the view frustum
+			drawFrame(smgr);
+			times[index] = timeRegistration(smgr);
+		}
+		printf("far %6.0f: %6u nodes in view, index off %.3f ms, index on %.3f ms\n",
+				far, (u32)Registered.size(), times[0], times[1]);
+	}
+
+	smgr->getParameters()->setAttribute(scene::SPATIAL_INDEX, false);
+	for (u32 i = 0; i < nodes.size(); ++i) {
+		nodes[i]->remove();
+		nodes[i]->drop();
+	}
+	mesh->drop();
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_ERROR;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	scene::ISceneManager *smgr = device->getSceneManager();
+	scene::ICameraSceneNode *camera = smgr->addCameraSceneNode(0, core::vector3df(0.f), core::vector3df(0.f, 0.f, 1.f));
+	camera->setFarValue(150.f);
+
+	if (isBenchmark(argc, argv)) {
+		benchmark(smgr);
+		device->drop();
+		return 0;
+	}
+
+	testChangingScene(smgr, camera);
+	testReleasedCells(smgr);
+
+	device->drop();
+
+	return testResult();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <irrTypes.h>
+
+// Harness shared by the tests: check() reports a failed condition and goes
+// on, testResult() prints the outcome and returns the exit code of main().
+
+inline irr::u32 failures = 0;
+
+inline void check(bool condition, const char *what)
+{
+	if (!condition) {
+		printf("FAILED: %s\n", what);
+		++failures;
+	}
+}
+
+// true if the test was started with --benchmark
+inline bool isBenchmark(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark") == 0)
+			return true;
+	}
+	return false;
+}
+
+inline int testResult()
+{
+	if (failures)
+		return 1;
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,196 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+#include <zlib.h>
+#ifdef _IRR_COMPILE_WITH_LZMA_
+#include <lzma.h>
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+#include <zstd.h>
+#endif
+#include "test_check.h"
+#include "zip_writer.h"
+
+using namespace irr;
+
+// Compresses files with each enabled zip compression method and reads them
+// back from an archive. Run with --benchmark to compare the decompression
+// speed of the methods.
+
+#ifdef _IRR_COMPILE_WITH_LZMA_
+// the zip flavor of LZMA: version, size of the properties, properties, raw stream
+static bool lzmaData(const core::array<u8> &data, core::array<u8> &out)
+{
+	lzma_options_lzma options;
+	lzma_lzma_preset(&options, 6);
+	lzma_filter filters[2];
+	filters[0].id = LZMA_FILTER_LZMA1;
+	filters[0].options = &options;
+	filters[1].id = LZMA_VLI_UNKNOWN;
+	filters[1].options = 0;
+
+	u8 properties[5];
+	if (lzma_properties_encode(&filters[0], properties) != LZMA_OK)
+		return false;
+
+	out.clear();
+	out.push_back(9);
+	out.push_back(20);
+	zipwriter::put16(out, 5);
+	for (u32 i = 0; i < 5; ++i)
+		out.push_back(properties[i]);
+
+	const u32 header = out.size();
+	out.set_used(header + data.size() + data.size() / 2 + 1024);
+
+	lzma_stream stream = LZMA_STREAM_INIT;
+	if (lzma_raw_encoder(&stream, filters) != LZMA_OK)
+		return false;
+	stream.next_in = data.const_pointer();
+	stream.avail_in = data.size();
+	stream.next_out = out.pointer() + header;
+	stream.avail_out = out.size() - header;
+	const bool ok = lzma_code(&stream, LZMA_FINISH) == LZMA_STREAM_END;
+	out.set_used(header + (u32)stream.total_out);
+	lzma_end(&stream);
+	return ok;
+}
+#endif
+
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+static bool zstdData(const core::array<u8> &data, core::array<u8> &out)
+{
+	out.set_used(ZSTD_compressBound(data.size()));
+	const size_t size = ZSTD_compress(out.pointer(), out.size(), data.const_pointer(), data.size(), 3);
+	if (ZSTD_isError(size))
+		return false;
+	out.set_used(size);
+	return true;
+}
+#endif
+
+static bool compressData(u16 method, const core::array<u8> &data, core::array<u8> &out)
+{
+	switch (method) {
+	case 8:
+		return zipwriter::deflateData(data, out);
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	case 14:
+		return lzmaData(data, out);
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+	case 93:
+		return zstdData(data, out);
+#endif
+	default:
+		// stand in for a method which can't be written here
+		out = data;
+		return true;
+	}
+}
+
+static void addEntry(core::array<u8> &zip, const io::path &name, u16 method, u32 seed, u32 size)
+{
+	core::array<u8> data;
+	zipwriter::makeData(data, seed, size);
+	core::array<u8> compressed;
+	check(compressData(method, data, compressed), "compressed");
+
+	// LZMA streams end with a marker
+	zipwriter::addEntry(zip, name, method, compressed, size, crc32(0, data.const_pointer(), size), method == 14 ? 2 : 0);
+}
+
+static void testMethod(io::IFileSystem *fs, u16 method, bool supported, const char *what)
+{
+	core::array<u8> zip;
+	addEntry(zip, "small.bin", method, 3, 1000);
+	addEntry(zip, "large.bin", method, 5, 300000);
+	zipwriter::endArchive(zip);
+	zipwriter::writeFile(fs, "zip_methods_test.zip", zip);
+
+	if (!fs->addFileArchive("zip_methods_test.zip", true, true, io::EFAT_ZIP)) {
+		check(false, what);
+		return;
+	}
+
+	if (supported) {
+		const bool ok = zipwriter::checkContent(fs, "small.bin", 3, 1000) && zipwriter::checkContent(fs, "large.bin", 5, 300000);
+		check(ok, what);
+	} else {
+		// without the library the files can't be opened, but nothing breaks
+		io::IReadFile *file = fs->createAndOpenFile("large.bin");
+		check(!file, what);
+		if (file)
+			file->drop();
+	}
+
+	fs->removeFileArchive((u32)0);
+	remove("zip_methods_test.zip");
+}
+
+static void benchmark(io::IFileSystem *fs, u16 method, const char *name)
+{
+	const u32 size = 16 * 1024 * 1024;
+	core::array<u8> zip;
+	addEntry(zip, "data.bin", method, 7, size);
+	zipwriter::endArchive(zip);
+
+	io::IReadFile *archive = fs->createMemoryReadFile(zip.const_pointer(), zip.size(), "benchmark.zip");
+	fs->addFileArchive(archive, true, true, io::EFAT_ZIP);
+	archive->drop();
+
+	core::array<u8> data;
+	data.set_used(size);
+	const u32 rounds = 4;
+	auto start = std::chrono::steady_clock::now();
+	for (u32 r = 0; r < rounds; ++r) {
+		io::IReadFile *file = fs->createAndOpenFile("data.bin");
+		file->read(data.pointer(), size);
+		file->drop();
+	}
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+	printf("%-8s %8u bytes compressed, %.2f ms to read %u bytes\n", name, zip.size(), ms, size);
+	fs->removeFileArchive((u32)0);
+}
+
+int main(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.LoggingLevel = ELL_NONE;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device) {
+		printf("FAILED: no null device\n");
+		return 1;
+	}
+
+	io::IFileSystem *fs = device->getFileSystem();
+	testMethod(fs, 8, true, "deflate");
+#ifdef _IRR_COMPILE_WITH_LZMA_
+	testMethod(fs, 14, true, "lzma");
+#else
+	testMethod(fs, 14, false, "lzma not enabled");
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+	testMethod(fs, 93, true, "zstd");
+#else
+	testMethod(fs, 93, false, "zstd not enabled");
+#endif
+
+	if (isBenchmark(argc, argv)) {
+		benchmark(fs, 8, "deflate");
+#ifdef _IRR_COMPILE_WITH_LZMA_
+		benchmark(fs, 14, "lzma");
+#endif
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+		benchmark(fs, 93, "zstd");
+#endif
+	}
+
+	device->drop();
+
+	return testResult();
+}
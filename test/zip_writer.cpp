@@ -0,0 +1,132 @@
+#include "zip_writer.h"
+
+#include <cstring>
+#include <zlib.h>
+
+namespace zipwriter
+{
+
+void put16(core::array<u8> &out, u16 value)
+{
+	out.push_back(value & 0xff);
+	out.push_back(value >> 8);
+}
+
+void put32(core::array<u8> &out, u32 value)
+{
+	put16(out, value & 0xffff);
+	put16(out, value >> 16);
+}
+
+void putLocalHeader(core::array<u8> &zip, const io::path &name, u16 method, u32 compressedSize,
+		u32 size, u32 crc, u16 flags)
+{
+	put32(zip, 0x04034b50);
+	put16(zip, method == 0 ? 10 : method == 8 ? 20 : 63); // version to extract
+	put16(zip, flags);
+	put16(zip, method);
+	put32(zip, 0); // time and date
+	put32(zip, crc);
+	put32(zip, compressedSize);
+	put32(zip, size);
+	put16(zip, (u16)name.size());
+	put16(zip, 0); // extra field
+	for (u32 i = 0; i < name.size(); ++i)
+		zip.push_back(name[i]);
+}
+
+void addEntry(core::array<u8> &zip, const io::path &name, u16 method, const core::array<u8> &compressed,
+		u32 size, u32 crc, u16 flags)
+{
+	putLocalHeader(zip, name, method, compressed.size(), size, crc, flags);
+	for (u32 i = 0; i < compressed.size(); ++i)
+		zip.push_back(compressed[i]);
+}
+
+void addStoredEntry(core::array<u8> &zip, const io::path &name, const void *data, u32 size)
+{
+	const u8 *bytes = static_cast<const u8 *>(data);
+	putLocalHeader(zip, name, 0, size, size, crc32(0, bytes, size));
+	for (u32 i = 0; i < size; ++i)
+		zip.push_back(bytes[i]);
+}
+
+void addDeflatedEntry(core::array<u8> &zip, const io::path &name, const core::array<u8> &data)
+{
+	core::array<u8> deflated;
+	deflateData(data, deflated);
+	addEntry(zip, name, 8, deflated, data.size(), crc32(0, data.const_pointer(), data.size()));
+}
+
+bool deflateData(const core::array<u8> &data, core::array<u8> &out)
+{
+	out.set_used(compressBound(data.size()));
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+	stream.next_in = (Bytef *)data.const_pointer();
+	stream.avail_in = data.size();
+	stream.next_out = out.pointer();
+	stream.avail_out = out.size();
+	const bool ok = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+	out.set_used(stream.total_out);
+	deflateEnd(&stream);
+	return ok;
+}
+
+void endArchive(core::array<u8> &zip)
+{
+	put32(zip, 0x06054b50);
+}
+
+void writeFile(io::IFileSystem *fs, const io::path &name, const core::array<u8> &data)
+{
+	io::IWriteFile *file = fs->createAndWriteFile(name);
+	file->write(data.const_pointer(), data.size());
+	file->drop();
+}
+
+u8 expectedByte(u32 seed, u32 pos)
+{
+	u32 hash = ((pos >> 2) + seed) * 2654435761u;
+	hash ^= hash >> 15;
+	hash *= 2246822519u;
+	hash ^= hash >> 13;
+	return (u8)"abcdefghijklmnop"[(hash >> (pos & 3) * 4) & 15];
+}
+
+void makeData(core::array<u8> &data, u32 seed, u32 size)
+{
+	data.set_used(size);
+	for (u32 i = 0; i < size; ++i)
+		data[i] = expectedByte(seed, i);
+}
+
+void addDeflatedEntry(core::array<u8> &zip, const io::path &name, u32 seed, u32 size)
+{
+	core::array<u8> data;
+	makeData(data, seed, size);
+	addDeflatedEntry(zip, name, data);
+}
+
+bool checkContent(io::IFileSystem *fs, const io::path &name, u32 seed, u32 size)
+{
+	io::IReadFile *file = fs->createAndOpenFile(name);
+	if (!file)
+		return false;
+
+	core::array<u8> data;
+	data.set_used(size + 1);
+	bool ok = file->getSize() == (long)size && file->read(data.pointer(), size + 1) == size;
+	for (u32 i = 0; ok && i < size; ++i)
+		ok = data[i] == expectedByte(seed, i);
+
+	// seek back and read a piece again
+	ok = ok && file->seek(size / 3) && file->read(data.pointer(), 10) == 10;
+	for (u32 i = 0; ok && i < 10; ++i)
+		ok = data[i] == expectedByte(seed, size / 3 + i);
+	file->drop();
+	return ok;
+}
+
+} // end namespace zipwriter
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <irrlicht.h>
+
+// Writes zip archives for the tests. Only the local headers are written,
+// which is all the zip reader needs, and the end marker follows them.
+
+namespace zipwriter
+{
+
+using namespace irr;
+
+// little endian values
+void put16(core::array<u8> &out, u16 value);
+void put32(core::array<u8> &out, u32 value);
+
+// local header of an entry, the name follows it
+// method: 0 stored, 8 deflated, 14 LZMA, 93 zstd
+void putLocalHeader(core::array<u8> &zip, const io::path &name, u16 method, u32 compressedSize,
+		u32 size, u32 crc = 0, u16 flags = 0);
+
+// entry with data compressed already, the crc isn't checked by the reader
+void addEntry(core::array<u8> &zip, const io::path &name, u16 method, const core::array<u8> &compressed,
+		u32 size, u32 crc = 0, u16 flags = 0);
+void addStoredEntry(core::array<u8> &zip, const io::path &name, const void *data, u32 size);
+void addDeflatedEntry(core::array<u8> &zip, const io::path &name, const core::array<u8> &data);
+
+// raw deflate stream as in zip entries
+bool deflateData(const core::array<u8> &data, core::array<u8> &out);
+
+// end of the local headers
+void endArchive(core::array<u8> &zip);
+
+void writeFile(io::IFileSystem *fs, const io::path &name, const core::array<u8> &data);
+
+// Test data made from a seed, compressible but not trivially
+u8 expectedByte(u32 seed, u32 pos);
+void makeData(core::array<u8> &data, u32 seed, u32 size);
+
+// deflated entry of size bytes of test data
+void addDeflatedEntry(core::array<u8> &zip, const io::path &name, u32 seed, u32 size);
+
+// opens the file and checks its size and test data, also after seeking back
+bool checkContent(io::IFileSystem *fs, const io::path &name, u32 seed, u32 size);
+
+} // end namespace zipwriter